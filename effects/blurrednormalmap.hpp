@@ -67,7 +67,7 @@ public:
     virtual void render (Tucano::Mesh& mesh, const Tucano::Trackball& cameraTrackball)
     {
         Eigen::Vector4f viewport = cameraTrackball.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
 
         if (fbo.getWidth() != (viewport[2]-viewport[1]) || fbo.getHeight() != (viewport[3]-viewport[1]))
@@ -88,9 +88,9 @@ public:
 
         mesh.setAttributeLocation(normalmap_shader);
 
-        glEnable(GL_DEPTH_TEST);
+        glState().enable(GL_DEPTH_TEST);
         mesh.render();
-        glDisable(GL_DEPTH_TEST);
+        glState().disable(GL_DEPTH_TEST);
 
         normalmap_shader.unbind();
 
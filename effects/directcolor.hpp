@@ -85,7 +85,7 @@ public:
     {
 
         Eigen::Vector4f viewport = camera.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
         directcolor_shader.bind();
 
@@ -98,7 +98,7 @@ public:
 
         mesh.setAttributeLocation(directcolor_shader);
 
-        glEnable(GL_DEPTH_TEST);
+        glState().enable(GL_DEPTH_TEST);
         mesh.render();
 
         directcolor_shader.unbind();
@@ -67,7 +67,7 @@ public:
 	virtual void render(Tucano::Mesh& mesh, const Tucano::Camera& camera)
     {
         Eigen::Vector4f viewport = camera.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
         normalmap_shader.bind();
 
@@ -78,9 +78,9 @@ public:
 
         mesh.setAttributeLocation(normalmap_shader);
 
-        glEnable(GL_DEPTH_TEST);
+        glState().enable(GL_DEPTH_TEST);
         mesh.render();
-        glDisable(GL_DEPTH_TEST);
+        glState().disable(GL_DEPTH_TEST);
 
         normalmap_shader.unbind();
     }
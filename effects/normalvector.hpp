@@ -68,7 +68,7 @@ public:
 	virtual void render(Tucano::Mesh& mesh, const Tucano::Camera& camera)
     {
         Eigen::Vector4f viewport = camera.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
         normalvec_shader.bind();
 
@@ -79,9 +79,9 @@ public:
 
         mesh.setAttributeLocation(normalvec_shader);
 
-        glEnable(GL_DEPTH_TEST);
+        glState().enable(GL_DEPTH_TEST);
         mesh.render();
-        glDisable(GL_DEPTH_TEST);
+        glState().disable(GL_DEPTH_TEST);
 
         normalvec_shader.unbind();
     }
@@ -27,6 +27,7 @@
 #include <effect.hpp>
 #include <mesh.hpp>
 #include <camera.hpp>
+#include <frameuniforms.hpp>
 
 using namespace Tucano;
 
@@ -70,6 +71,7 @@ public:
 		initGL();
         // searches in default shader directory (/shaders) for shader files phongShader.(vert,frag,geom,comp)
         loadShader(phong_shader, "phongshader") ;
+        FrameUniforms::attach(phong_shader);
     }
 
 	/**
@@ -89,21 +91,21 @@ public:
     {
 
         Eigen::Vector4f viewport = camera.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        // camera and light matrices, only uploaded when they changed
+        sharedFrameUniforms().update(camera, lightTrackball);
 
         phong_shader.bind();
 
         // sets all uniform variables for the phong shader
-        phong_shader.setUniform("projectionMatrix", camera.getProjectionMatrix());
         phong_shader.setUniform("modelMatrix", mesh.getModelMatrix());
-        phong_shader.setUniform("viewMatrix", camera.getViewMatrix());
-        phong_shader.setUniform("lightViewMatrix", lightTrackball.getViewMatrix());
         phong_shader.setUniform("has_color", mesh.hasAttribute("in_Color"));
 		phong_shader.setUniform("default_color", default_color);
 
         mesh.setAttributeLocation(phong_shader);
 
-        glEnable(GL_DEPTH_TEST);
+        glState().enable(GL_DEPTH_TEST);
         mesh.render();
 
         phong_shader.unbind();
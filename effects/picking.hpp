@@ -24,6 +24,7 @@
 #define __PICKING___
 
 #include <tucano.hpp>
+#include <utils/bvh.hpp>
 
 namespace Effects
 {
@@ -64,7 +65,7 @@ public:
     virtual void render (Tucano::Mesh& mesh, const Tucano::Camera& camera)
     {
         Eigen::Vector4f viewport = camera.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
 
         if (fbo.getWidth() != (viewport[2]-viewport[1]) || fbo.getHeight() != (viewport[3]-viewport[1]))
@@ -86,7 +87,7 @@ public:
         mesh.setAttributeLocation(worldcoords_shader);
 
         glPointSize(5.0);
-        glEnable(GL_DEPTH_TEST);
+        glState().enable(GL_DEPTH_TEST);
         mesh.render();
         glPointSize(1.0);
 
@@ -114,6 +115,52 @@ public:
         return fbo.readPixel(0, pos);
     }
 
+    /**
+    * @brief Returns the object coordinates of the mesh point projected on given pixel, casting a ray on the CPU.
+    *
+    * Does not need the render pass nor reads back from the GPU, the triangles are searched in a hierarchy built from
+    * the mesh arrays. Follows the conventions of the FBO version: pixel coordinates with origin at the bottom left
+    * corner of the viewport, and a zero vector returned when no triangle is hit.
+    * @param bvh Hierarchy built from the mesh vertex positions and indices
+    * @param mesh Mesh, for its model matrix
+    * @param camera Given camera trackball
+    * @param pos Screen position
+    * @return object coordinates of projected point in given position, with w = 1, or zero if there is no point
+    */
+    Eigen::Vector4f pick (const Tucano::TriangleBVH& bvh, const Tucano::Mesh& mesh, const Tucano::Camera& camera, const Eigen::Vector2i &pos)
+    {
+        Eigen::Vector3f origin, direction;
+        pickRay(mesh, camera, pos, origin, direction);
+
+        Tucano::RayHit hit;
+        if (!bvh.intersect(origin, direction, hit))
+            return Eigen::Vector4f::Zero();
+        Eigen::Vector3f point = origin + direction * hit.t;
+        return Eigen::Vector4f(point[0], point[1], point[2], 1.0);
+    }
+
+    /**
+    * @brief Computes the ray in object coordinates through the center of a pixel, from the near to the far plane.
+    * @param mesh Mesh, for its model matrix
+    * @param camera Given camera trackball
+    * @param pos Screen position
+    * @param origin Receives the ray origin on the near plane
+    * @param direction Receives the ray direction, its length reaches the far plane
+    */
+    static void pickRay (const Tucano::Mesh& mesh, const Tucano::Camera& camera, const Eigen::Vector2i &pos, Eigen::Vector3f& origin, Eigen::Vector3f& direction)
+    {
+        Eigen::Vector4f viewport = camera.getViewport();
+        Eigen::Matrix4f inverse = (camera.getProjectionMatrix() * camera.getViewMatrix().matrix() * mesh.getModelMatrix().matrix()).inverse();
+
+        float x = 2.0 * (pos[0] + 0.5 - viewport[0]) / viewport[2] - 1.0;
+        float y = 2.0 * (pos[1] + 0.5 - viewport[1]) / viewport[3] - 1.0;
+        Eigen::Vector4f near_point = inverse * Eigen::Vector4f(x, y, -1.0, 1.0);
+        Eigen::Vector4f far_point = inverse * Eigen::Vector4f(x, y, 1.0, 1.0);
+
+        origin = near_point.head<3>() / near_point[3];
+        direction = far_point.head<3>() / far_point[3] - origin;
+    }
+
 private:
 
     Tucano::Shader worldcoords_shader;
@@ -72,7 +72,7 @@ public:
      */
     void renderTexture (Texture& tex, Eigen::Vector2i viewport)
     {
-        glViewport(0, 0, viewport[0], viewport[1]);
+        glState().viewport(0, 0, viewport[0], viewport[1]);
 
         shader.bind();
         shader.setUniform("imageTexture", tex.bind());
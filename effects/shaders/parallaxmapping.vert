@@ -1,11 +1,10 @@
 #version 330 core
 
 // Input vertex data, different for all executions of this shader.
-layout(location = 0) in vec3 in_Position;
-layout(location = 1) in vec2 in_TexCoord;
-layout(location = 2) in vec3 in_Normal;
-layout(location = 3) in vec3 in_Tangent;
-layout(location = 4) in vec3 in_Bitangent;
+layout(location = 0) in vec4 in_Position;
+layout(location = 1) in vec3 in_Normal;
+layout(location = 3) in vec2 in_TexCoords;
+layout(location = 4) in vec4 in_Tangent; // w holds the bitangent sign
 
 // Output data ; will be interpolated for each fragment.
 out vec3 normalCoord;
@@ -29,14 +28,14 @@ void main()
 	mat4 modelViewMatrix = viewMatrix * modelMatrix;
 
 	// Output position of the vertex, in clip space : MVP * position
-	gl_Position = (projectionMatrix * modelViewMatrix) * vec4(in_Position, 1);
+	gl_Position = (projectionMatrix * modelViewMatrix) * vec4(in_Position.xyz, 1);
 
 	// Position of the vertex, in worldspace : modelMatrix * position
-	positionWorldSpace = (modelMatrix * vec4(in_Position, 1)).xyz;
+	positionWorldSpace = (modelMatrix * vec4(in_Position.xyz, 1)).xyz;
 
 	// Vector that goes from the vertex to the camera, in camera space.
 	// In camera space, the camera is at the origin (0,0,0).
-	vec3 vertexPositionCameraSpace = (viewMatrix * modelMatrix * vec4(in_Position, 1)).xyz;
+	vec3 vertexPositionCameraSpace = (viewMatrix * modelMatrix * vec4(in_Position.xyz, 1)).xyz;
 	eyeDirectionCameraSpace = vec3(0, 0, 0) - vertexPositionCameraSpace;
 
 	// Compute light direction
@@ -44,14 +43,15 @@ void main()
 	lightDirectionCameraSpace = normalize(lightDirection);
 
 	// UV of the vertex. No special space for this one.
-	texCoord = in_TexCoord;
+	texCoord = in_TexCoords;
 
 	// Normal of the vertex. No special space for this one.
 	normalCoord = in_Normal;
 
 	// model to camera = ModelView
-	vec3 vertexTangentCameraSpace = MV3x3 * in_Tangent;
-	vec3 vertexBitangentCameraSpace = MV3x3 * in_Bitangent;
+	vec3 bitangent = cross(in_Normal, in_Tangent.xyz) * in_Tangent.w;
+	vec3 vertexTangentCameraSpace = MV3x3 * in_Tangent.xyz;
+	vec3 vertexBitangentCameraSpace = MV3x3 * bitangent;
 	vec3 vertexNormalCameraSpace = MV3x3 * in_Normal;
 
 	mat3 TBN = transpose(mat3(
@@ -9,7 +9,14 @@ in float depth;
 
 out vec4 out_Color;
 
-uniform mat4 lightViewMatrix;
+// per frame camera and light data, shared by all shaders (see frameuniforms.hpp)
+layout(std140) uniform FrameUniforms
+{
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    mat4 lightViewMatrix;
+    vec4 viewport;
+};
 
 void main(void)
 {
@@ -9,8 +9,15 @@ out vec3 normal;
 out vec4 vert;
 	 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+
+// per frame camera and light data, shared by all shaders (see frameuniforms.hpp)
+layout(std140) uniform FrameUniforms
+{
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    mat4 lightViewMatrix;
+    vec4 viewport;
+};
 
 
 uniform bool has_color;
@@ -270,7 +270,7 @@ public:
         Eigen::Vector4f viewport = camera_trackball.getViewport();
         Eigen::Vector2i viewport_size = camera_trackball.getViewportSize();
 
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
         // check if viewport was modified, if so, regenerate fbo
         if (fbo->getWidth() != viewport_size[0] || fbo->getHeight() != viewport_size[1])
@@ -278,8 +278,8 @@ public:
             fbo->create(viewport_size[0], viewport_size[1], 5);
         }
 
-        glEnable(GL_DEPTH_TEST);
-        glClearColor(1.0, 1.0, 1.0, 0.0);
+        glState().enable(GL_DEPTH_TEST);
+        glState().clearColor(1.0, 1.0, 1.0, 0.0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // first pass
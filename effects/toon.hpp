@@ -24,6 +24,7 @@
 #define __TOON__
 
 #include <tucano.hpp>
+#include <frameuniforms.hpp>
 
 using namespace Tucano;
 
@@ -75,6 +76,7 @@ public:
 	{
 		initGL();
 		loadShader(toon_shader, "toonshader");
+		FrameUniforms::attach(toon_shader);
 	}
 
     /**
@@ -87,14 +89,13 @@ public:
 	{       
 
         Eigen::Vector4f viewport = cameraTrackball.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        sharedFrameUniforms().update(cameraTrackball, lightTrackball);
 
         toon_shader.bind();
 
-        toon_shader.setUniform("projectionMatrix", cameraTrackball.getProjectionMatrix());
         toon_shader.setUniform("modelMatrix", mesh.getModelMatrix());
-        toon_shader.setUniform("viewMatrix", cameraTrackball.getViewMatrix());
-        toon_shader.setUniform("lightViewMatrix", lightTrackball.getViewMatrix());
         toon_shader.setUniform("has_color", mesh.hasAttribute("in_Color"));
         toon_shader.setUniform("quantizationLevel", quantization_level);
 
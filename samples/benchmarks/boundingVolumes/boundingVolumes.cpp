@@ -0,0 +1,105 @@
+// Computes the bounding volumes of a large random point cloud with Mesh::computeBoundingInfo,
+// serial and threaded, with and without the tight sphere, and compares with three plain passes
+// (box, centroid, radius). Also checks that the results agree and that the spheres hold every point.
+//
+// Usage: boundingVolumes [millions of vertices] [threads] [runs]
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+#include <mesh.hpp>
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+// box, centroid and radius around the centroid in three separate passes
+static void threePasses (const vector<Eigen::Vector4f>& vert, BoundingInfo& info)
+{
+	info.box.setEmpty();
+	for (size_t i = 0; i < vert.size(); ++i)
+		info.box.extend(vert[i].head<3>());
+
+	Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+	for (size_t i = 0; i < vert.size(); ++i)
+		sum += vert[i].head<3>().cast<double>();
+	info.centroid = (sum / (double)vert.size()).cast<float>();
+
+	float radius2 = 0.0f;
+	for (size_t i = 0; i < vert.size(); ++i)
+		radius2 = max(radius2, (vert[i].head<3>() - info.centroid).squaredNorm());
+	info.radius = sqrt(radius2);
+	info.sphere_center = info.centroid;
+	info.sphere_radius = info.radius;
+}
+
+// largest distance of a point outside a sphere, relative to its radius
+static float sphereExcess (const vector<Eigen::Vector4f>& vert, const Eigen::Vector3f& center, float radius)
+{
+	float excess = 0.0f;
+	for (size_t i = 0; i < vert.size(); ++i)
+		excess = max(excess, (vert[i].head<3>() - center).norm() - radius);
+	return excess / radius;
+}
+
+int main (int argc, char** argv)
+{
+	size_t num_vertices = (size_t)(1e6 * ((argc > 1) ? atof(argv[1]) : 50.0));
+	unsigned int threads = (argc > 2) ? atoi(argv[2]) : max(1u, thread::hardware_concurrency());
+	int runs = (argc > 3) ? atoi(argv[3]) : 3;
+
+	// a box away from the origin, filled unevenly so the tight sphere differs from the centroid sphere
+	vector<Eigen::Vector4f> vert;
+	vert.reserve(num_vertices);
+	mt19937 generator (1234);
+	uniform_real_distribution<float> unit (0.0f, 1.0f);
+	for (size_t i = 0; i < num_vertices; ++i)
+	{
+		float u = unit(generator);
+		vert.push_back(Eigen::Vector4f(20.0f*u*u, 10.0f*unit(generator), 40.0f*unit(generator), 1.0f));
+	}
+
+	struct Method
+	{
+		const char* name;
+		int threads;
+		bool tight;
+	};
+	const Method methods[5] = {{"three passes", -1, false}, {"fused, 1 thread", 1, false}, {"fused + tight sphere, 1 thread", 1, true},
+							   {"fused, all threads", (int)threads, false}, {"fused + tight sphere, all threads", (int)threads, true}};
+
+	cout << num_vertices/1e6 << "M vertices, " << threads << " threads" << endl;
+
+	BoundingInfo reference;
+	bool agree = true;
+	for (int m = 0; m < 5; ++m)
+	{
+		BoundingInfo info;
+		double best = 0.0;
+		for (int r = 0; r < runs; ++r)
+		{
+			Stopwatch watch;
+			if (methods[m].threads < 0)
+				threePasses(vert, info);
+			else
+				Mesh::computeBoundingInfo(vert, info, methods[m].tight, methods[m].threads);
+			double time = watch.seconds();
+			best = (r == 0) ? time : min(best, time);
+		}
+		if (m == 0)
+			reference = info;
+
+		bool same = info.box.isApprox(reference.box) && info.centroid.isApprox(reference.centroid, 1e-5f) &&
+					fabs(info.radius - reference.radius) <= 1e-5f*reference.radius &&
+					sphereExcess(vert, info.sphere_center, info.sphere_radius) <= 0.0f;
+		agree = agree && same;
+
+		printf("%-34s %8.1f ms  %6.0f Mvertices/s  sphere radius %.3f%s\n", methods[m].name, 1000.0*best, num_vertices/best/1e6,
+			   info.sphere_radius, same ? "" : "  MISMATCH");
+	}
+
+	return agree ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+// Builds a TriangleBVH over copies of toy.ply side by side, on one thread and on all threads,
+// then measures closest hit rays (coherent, from a camera, and incoherent, random), occlusion
+// rays and nearest point queries per second.
+//
+// Usage: bvhRayCast [models directory] [copies] [threads] [rays]
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include <utils/plyimporter.hpp>
+#include <utils/bvh.hpp>
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+struct Ray
+{
+	Eigen::Vector3f origin, direction;
+};
+
+// runs a query on every ray, split among threads, and returns queries per second and the number of hits
+template <class Query>
+static double queriesPerSecond (const vector<Ray>& rays, unsigned int threads, Query query, size_t& hits)
+{
+	atomic<size_t> count (0);
+	Stopwatch watch;
+	Misc::parallelFor(rays.size(), [&] (size_t begin, size_t end, unsigned int)
+	{
+		size_t block_hits = 0;
+		for (size_t i = begin; i < end; ++i)
+			if (query(rays[i]))
+				++block_hits;
+		count += block_hits;
+	}, threads);
+	double time = watch.seconds();
+	hits = count;
+	return rays.size() / time;
+}
+
+int main (int argc, char** argv)
+{
+	string models = modelsDirectory(argc, argv);
+	int copies = (argc > 2) ? atoi(argv[2]) : 64;
+	unsigned int threads = (argc > 3) ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+	int num_rays = (argc > 4) ? atoi(argv[4]) : 1000000;
+
+	MeshData toy, data;
+	if (!MeshImporter::readPlyFile(models + "toy.ply", toy))
+	{
+		cerr << "<Error> cannot read " << models << "toy.ply" << endl;
+		return EXIT_FAILURE;
+	}
+	replicateMesh(toy, copies, data);
+	size_t triangles = data.indices.size()/3;
+	cout << copies << " copies of toy.ply: " << triangles << " triangles" << endl;
+
+	// build, the hierarchy must not depend on the number of threads
+	TriangleBVH bvh, serial_bvh;
+	Stopwatch watch;
+	serial_bvh.build(data, 1);
+	double serial_time = watch.seconds();
+	watch.restart();
+	bvh.build(data, threads);
+	double time = watch.seconds();
+
+	const vector<BVHNode>& a = bvh.getNodes();
+	const vector<BVHNode>& b = serial_bvh.getNodes();
+	bool same = a.size() == b.size() && memcmp(a.data(), b.data(), a.size()*sizeof(BVHNode)) == 0;
+	printf("build, 1 thread     %8.1f ms  %5.2f Mtriangles/s  %zu nodes\n", 1000.0*serial_time, triangles/serial_time/1e6, b.size());
+	printf("build, %2u threads   %8.1f ms  %5.2f Mtriangles/s  %s hierarchy\n", threads, 1000.0*time, triangles/time/1e6, same ? "same" : "DIFFERENT");
+
+	// coherent rays from a camera in front of the mesh through a grid over its box,
+	// incoherent rays from random points in the box toward random directions
+	Eigen::AlignedBox3f box = bvh.getBoundingBox();
+	Eigen::Vector3f center = box.center(), size = box.sizes();
+	float diagonal = size.norm();
+	mt19937 generator (1234);
+	uniform_real_distribution<float> unit (0.0f, 1.0f);
+	normal_distribution<float> gauss;
+
+	vector<Ray> primary (num_rays), incoherent (num_rays), points (num_rays);
+	int side = (int)sqrt((float)num_rays);
+	Eigen::Vector3f eye = center + Eigen::Vector3f(0.0f, 0.0f, diagonal);
+	for (int i = 0; i < num_rays; ++i)
+	{
+		float u = (i % side + 0.5f) / side, v = ((i / side) % side + 0.5f) / side;
+		Eigen::Vector3f target (box.min()[0] + u*size[0], box.min()[1] + v*size[1], center[2]);
+		primary[i].origin = eye;
+		primary[i].direction = (target - eye).normalized();
+
+		Eigen::Vector3f origin (box.min()[0] + unit(generator)*size[0], box.min()[1] + unit(generator)*size[1], box.min()[2] + unit(generator)*size[2]);
+		incoherent[i].origin = origin;
+		incoherent[i].direction = Eigen::Vector3f(gauss(generator), gauss(generator), gauss(generator)).normalized();
+		points[i].origin = origin;
+	}
+
+	const float occlusion_distance = 0.1f*diagonal;
+	unsigned int thread_counts[2] = {1, threads};
+	for (int t = 0; t < ((threads > 1) ? 2 : 1); ++t)
+	{
+		size_t hits;
+		printf("%u thread(s):\n", thread_counts[t]);
+
+		double rate = queriesPerSecond(primary, thread_counts[t], [&] (const Ray& ray) { RayHit hit; return bvh.intersect(ray.origin, ray.direction, hit); }, hits);
+		printf("    primary rays        %6.2f Mrays/s    %4.1f%% hit\n", rate/1e6, 100.0*hits/num_rays);
+
+		rate = queriesPerSecond(incoherent, thread_counts[t], [&] (const Ray& ray) { RayHit hit; return bvh.intersect(ray.origin, ray.direction, hit); }, hits);
+		printf("    incoherent rays     %6.2f Mrays/s    %4.1f%% hit\n", rate/1e6, 100.0*hits/num_rays);
+
+		rate = queriesPerSecond(incoherent, thread_counts[t], [&] (const Ray& ray) { return bvh.occluded(ray.origin, ray.direction, occlusion_distance); }, hits);
+		printf("    occlusion rays      %6.2f Mrays/s    %4.1f%% occluded\n", rate/1e6, 100.0*hits/num_rays);
+
+		rate = queriesPerSecond(points, thread_counts[t], [&] (const Ray& ray) { NearestHit nearest; return bvh.nearestPoint(ray.origin, nearest); }, hits);
+		printf("    nearest points      %6.2f Mqueries/s\n", rate/1e6);
+	}
+
+	return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,113 @@
+// Renders a large grid mesh with the Phong effect in an offscreen framebuffer, with one buffer
+// per attribute and with the interleaved layout, in float and compact encodings, and reports
+// the time per frame. Separate and interleaved layouts of the same encoding must give the same image.
+//
+// Usage: interleavedLayout [grid rows] [frames per round] [image size] [rounds]
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include <phongshader.hpp>
+#include <framebuffer.hpp>
+#include "OffscreenContext.h"
+#include "TestUtils.h"
+
+#ifndef TUCANO_SHADERS_DIR
+#define TUCANO_SHADERS_DIR "../../effects/shaders/"
+#endif
+
+using namespace Tucano;
+
+struct Layout
+{
+	const char* name;
+	bool interleaved;
+	unsigned int encoding;
+};
+
+int main (int argc, char** argv)
+{
+	int rows = (argc > 1) ? atoi(argv[1]) : 1000;
+	int frames = (argc > 2) ? atoi(argv[2]) : 20;
+	int size = (argc > 3) ? atoi(argv[3]) : 256;
+	int rounds = (argc > 4) ? atoi(argv[4]) : 3;
+
+	OffscreenContext context;
+	if (!context.isValid())
+		return TEST_SKIPPED;
+
+	MeshData data;
+	makeGrid(data, rows, rows);
+
+	Effects::Phong phong;
+	phong.setShadersDir(TUCANO_SHADERS_DIR);
+	phong.initialize();
+
+	// the grid seen at an angle, most triangles cover less than a pixel so the vertex stage dominates
+	Camera camera, light;
+	camera.setPerspectiveMatrix(60.0, 1.0, 0.1f, 100.0f);
+	camera.setViewport(Eigen::Vector2f(size, size));
+	camera.translate(Eigen::Vector3f(0.0, 0.0, -3.0));
+	camera.rotate(Eigen::Quaternionf(Eigen::AngleAxisf(-0.8f, Eigen::Vector3f::UnitX())));
+
+	Framebuffer fbo (size, size, 1);
+
+	const Layout layouts[4] = {{"separate, float", false, 0}, {"interleaved, float", true, 0},
+							   {"separate, compact", false, ENCODE_COMPACT}, {"interleaved, compact", true, ENCODE_COMPACT}};
+
+	cout << rows*rows << " vertices, " << data.indices.size()/3 << " triangles, " << size << "x" << size << " image" << endl;
+
+	Mesh meshes[4];
+	for (int l = 0; l < 4; ++l)
+	{
+		meshes[l].setInterleaved(layouts[l].interleaved);
+		meshes[l].setEncoding(layouts[l].encoding);
+		MeshImporter::uploadMeshData(&meshes[l], data);
+	}
+
+	// the layouts take turns for a few rounds and the best round of each is kept,
+	// so warming up the driver is not charged to the first layout
+	double times[4];
+	vector<float> images[4];
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (int l = 0; l < 4; ++l)
+		{
+			Stopwatch watch;
+			for (int f = 0; f < frames; ++f)
+			{
+				fbo.clearAttachments();
+				fbo.bindRenderBuffer(0);
+				phong.render(meshes[l], camera, light);
+			}
+			glFinish();
+			double time = watch.seconds() / frames;
+			times[l] = (round == 0) ? time : min(times[l], time);
+		}
+	}
+	fbo.unbind();
+
+	bool same_images = true;
+	for (int l = 0; l < 4; ++l)
+	{
+		fbo.clearAttachments();
+		fbo.bindRenderBuffer(0);
+		phong.render(meshes[l], camera, light);
+		fbo.unbind();
+		fbo.readBuffer(0, images[l]);
+
+		printf("%-22s %8.1f ms/frame", layouts[l].name, 1000.0*times[l]);
+		if (layouts[l].interleaved)
+		{
+			// the separate layout of the same encoding comes just before
+			bool same = (images[l] == images[l-1]);
+			same_images = same_images && same;
+			printf("    %.2fx, %s image", times[l-1]/times[l], same ? "same" : "DIFFERENT");
+		}
+		printf("\n");
+	}
+
+	return same_images ? EXIT_SUCCESS : EXIT_FAILURE;
+}
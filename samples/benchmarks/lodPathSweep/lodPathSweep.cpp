@@ -0,0 +1,144 @@
+// Renders a dense bumpy sphere with the Phong effect along a Path camera animation that zooms
+// out to 150 times its radius and back, drawing the full mesh and then the level chosen by
+// LodMesh at each frame. Reports the triangles submitted and the time per frame.
+//
+// Usage: lodPathSweep [sphere subdivisions] [frames] [pixel error]
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include <lodmesh.hpp>
+#include <phongshader.hpp>
+#include <framebuffer.hpp>
+#include <shapes/spheregeometry.hpp>
+#include <utils/meshnormals.hpp>
+#include <shapes/coordinateaxes.hpp>
+#include <utils/path.hpp>
+#include "OffscreenContext.h"
+#include "TestUtils.h"
+
+#ifndef TUCANO_SHADERS_DIR
+#define TUCANO_SHADERS_DIR "../../effects/shaders/"
+#endif
+
+using namespace Tucano;
+
+// unit sphere with bumps at a few scales, so every level of detail has some error
+static void bumpySphere (MeshData& data, int subdivisions)
+{
+	data.clear();
+	Shapes::icosahedronGeometry(data.vertices, data.indices);
+	Shapes::subdivideSphere(data.vertices, data.indices, subdivisions);
+	for (size_t i = 0; i < data.vertices.size(); ++i)
+	{
+		Eigen::Vector3f p = data.vertices[i].head<3>();
+		float r = 1.0f + 0.05f*sin(9.0f*p[0])*sin(11.0f*p[1])*sin(7.0f*p[2]) + 0.01f*sin(60.0f*p[0])*sin(70.0f*p[1])*sin(50.0f*p[2])
+				  + 0.003f*sin(200.0f*p[0] + 170.0f*p[1])*sin(230.0f*p[2]);
+		data.vertices[i].head<3>() = p*r;
+	}
+	MeshImporter::generateNormals(data);
+}
+
+int main (int argc, char** argv)
+{
+	int subdivisions = (argc > 1) ? atoi(argv[1]) : 7;
+	int frames = (argc > 2) ? atoi(argv[2]) : 240;
+	float pixel_error = (argc > 3) ? atof(argv[3]) : 1.0f;
+	const int width = 1024, height = 768;
+
+	OffscreenContext context;
+	if (!context.isValid())
+		return TEST_SKIPPED;
+
+	MeshData data;
+	bumpySphere(data, subdivisions);
+
+	LodMesh mesh;
+	mesh.loadVertices(data.vertices);
+	mesh.loadNormals(data.normals);
+	mesh.setDefaultAttribLocations();
+	SimplificationReport report;
+	mesh.buildLevels(data, MeshImporter::defaultLodTargets(8), &report);
+	mesh.setPixelError(pixel_error);
+
+	cout << mesh.getNumberOfLevels() << " levels built in " << report.milliseconds << " ms:";
+	for (int l = 0; l < mesh.getNumberOfLevels(); ++l)
+		cout << " " << mesh.getLevelTriangles(l);
+	cout << " triangles" << endl;
+
+	Effects::Phong phong;
+	phong.setShadersDir(TUCANO_SHADERS_DIR);
+	phong.initialize();
+	Framebuffer fbo (width, height, 1);
+
+	Camera camera, light;
+	camera.setPerspectiveMatrix(60.0, width/(float)height, 0.1f, 1000.0f);
+	camera.setViewport(Eigen::Vector2f(width, height));
+
+	// zoom out and back in, looking at the sphere
+	Path path;
+	const float distances[9] = {1.3f, 3.0f, 10.0f, 40.0f, 150.0f, 40.0f, 10.0f, 3.0f, 1.3f};
+	for (int k = 0; k < 9; ++k)
+	{
+		float z = distances[k];
+		camera.lookAt(Eigen::Vector3f(0.3f*z, 0.2f*z, z), Eigen::Vector3f::Zero(), Eigen::Vector3f(0.0, 1.0, 0.0));
+		path.addKeyPosition(camera);
+	}
+
+	// length of the path, to cover it in the given number of frames
+	int length = 0;
+	path.setAnimSpeed(1.0);
+	path.resetAnimation();
+	do
+	{
+		path.stepForward();
+		++length;
+	} while (path.animTime() >= 1.0f);
+	path.setAnimSpeed(length / (float)frames);
+
+	// the first frame also warms up the driver, keep it out of the measure
+	fbo.clearAttachments();
+	fbo.bindRenderBuffer(0);
+	phong.render(mesh, camera, light);
+	glFinish();
+
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		double triangles = 0.0, min_triangles = 0.0, max_triangles = 0.0, total_time = 0.0, max_time = 0.0;
+		int switches = 0;
+		mesh.setLevel(0);
+		path.resetAnimation();
+		for (int f = 0; f < frames; ++f)
+		{
+			camera.setViewMatrix(path.cameraAtCurrentTime().inverse());
+			path.stepForward();
+
+			Stopwatch watch;
+			int previous = mesh.getLevel();
+			if (mode == 1)
+				mesh.selectLevel(camera);
+			fbo.clearAttachments();
+			fbo.bindRenderBuffer(0);
+			phong.render(mesh, camera, light);
+			glFinish();
+			double time = watch.seconds();
+
+			double count = mesh.getLevelTriangles(mesh.getLevel());
+			triangles += count;
+			min_triangles = (f == 0) ? count : min(min_triangles, count);
+			max_triangles = max(max_triangles, count);
+			total_time += time;
+			max_time = max(max_time, time);
+			if (f > 0 && mesh.getLevel() != previous)
+				++switches;
+		}
+		fbo.unbind();
+
+		printf("%s: %.0f triangles/frame (%.0f to %.0f), %.1f ms/frame (at most %.1f), %d level switches\n", (mode == 0) ? "full mesh" : "LodMesh  ",
+			   triangles/frames, min_triangles, max_triangles, 1000.0*total_time/frames, 1000.0*max_time, switches);
+	}
+
+	return EXIT_SUCCESS;
+}
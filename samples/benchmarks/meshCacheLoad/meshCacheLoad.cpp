@@ -0,0 +1,105 @@
+// Compares loading a large OBJ file, made of copies of toy.obj side by side, from text and from
+// the binary mesh cache (see meshcache.hpp):
+//  - text: cache disabled, the file is parsed;
+//  - cold: cache enabled but empty, the file is parsed and the cache entry written;
+//  - warm: cache enabled and up to date, the entry is memory mapped.
+// Loads upload the mesh to the GL, decodes only fill the CPU side arrays.
+//
+// Usage: meshCacheLoad [models directory] [copies] [runs]
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include <utils/objimporter.hpp>
+#include "OffscreenContext.h"
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+// best time of a few loads with the given settings, uncache removes the cache entry before each load
+static double timeLoad (const string& filename, const MeshImportSettings& settings, bool uncache, int runs)
+{
+	double best = 0.0;
+	for (int r = 0; r < runs; ++r)
+	{
+		if (uncache)
+			remove(MeshImporter::meshCachePath(filename, settings).c_str());
+		Mesh mesh;
+		Stopwatch watch;
+		MeshImporter::loadObjFile(&mesh, filename, settings);
+		glFinish();
+		double time = watch.seconds();
+		best = (r == 0) ? time : min(best, time);
+	}
+	return best;
+}
+
+int main (int argc, char** argv)
+{
+	string models = modelsDirectory(argc, argv);
+	int copies = (argc > 2) ? atoi(argv[2]) : 100;
+	int runs = (argc > 3) ? atoi(argv[3]) : 3;
+
+	OffscreenContext context;
+	if (!context.isValid())
+		return TEST_SKIPPED;
+
+	MeshData toy, scaled;
+	if (!MeshImporter::readObjFile(models + "toy.obj", toy, 1))
+	{
+		cerr << "<Error> cannot read " << models << "toy.obj" << endl;
+		return EXIT_FAILURE;
+	}
+	replicateMesh(toy, copies, scaled);
+	const string filename = "toy_scaled.obj";
+	if (!writeObjFile(scaled, filename))
+	{
+		cerr << "<Error> cannot write " << filename << endl;
+		return EXIT_FAILURE;
+	}
+	scaled.clear();
+
+	MeshImportSettings text, cached;
+	cached.cache = MeshCacheSettings("mesh_cache");
+	string entry = MeshImporter::meshCachePath(filename, cached);
+
+	double text_time = timeLoad(filename, text, false, runs);
+	double cold_time = timeLoad(filename, cached, true, runs);
+	double warm_time = timeLoad(filename, cached, false, runs);
+
+	// decode only, without the upload
+	MeshData data;
+	BoundingInfo bounds;
+	double text_decode = 0.0, warm_decode = 0.0;
+	for (int r = 0; r < runs; ++r)
+	{
+		Stopwatch watch;
+		MeshImporter::readObjFile(filename, data, 0);
+		double time = watch.seconds();
+		text_decode = (r == 0) ? time : min(text_decode, time);
+
+		watch.restart();
+		MeshImporter::readCachedMesh(filename, cached, data, bounds);
+		time = watch.seconds();
+		warm_decode = (r == 0) ? time : min(warm_decode, time);
+	}
+
+	ifstream source (filename.c_str(), ios::binary | ios::ate), cache (entry.c_str(), ios::binary | ios::ate);
+	const double MB = 1024.0*1024.0;
+	cout << copies << " copies of toy.obj: " << data.vertices.size() << " vertices, " << data.indices.size()/3 << " triangles" << endl;
+	cout << "text file " << source.tellg()/MB << " MB, cache entry " << cache.tellg()/MB << " MB" << endl;
+	printf("load, text (no cache)    %8.1f ms\n", 1000.0*text_time);
+	printf("load, cold cache         %8.1f ms\n", 1000.0*cold_time);
+	printf("load, warm cache         %8.1f ms    (%.1fx faster than text)\n", 1000.0*warm_time, text_time/warm_time);
+	printf("decode, text             %8.1f ms\n", 1000.0*text_decode);
+	printf("decode, warm cache       %8.1f ms    (%.1fx faster than text)\n", 1000.0*warm_decode, text_decode/warm_decode);
+	source.close();
+	cache.close();
+
+	remove(entry.c_str());
+	remove(filename.c_str());
+
+	return EXIT_SUCCESS;
+}
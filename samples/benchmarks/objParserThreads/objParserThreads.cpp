@@ -0,0 +1,97 @@
+// Parses a large OBJ file, made of copies of toy.obj side by side, with an increasing number of
+// threads and reports the speedup over the serial parse, from the timing returned by readObjFile.
+// Also checks that every thread count gives the same arrays as the serial parse.
+//
+// Usage: objParserThreads [models directory] [copies] [max threads] [runs]
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+
+#include <utils/objimporter.hpp>
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+template <class T>
+static bool sameArray (const vector<T>& a, const vector<T>& b)
+{
+	return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size()*sizeof(T)) == 0);
+}
+
+int main (int argc, char** argv)
+{
+	string models = modelsDirectory(argc, argv);
+	int copies = (argc > 2) ? atoi(argv[2]) : 100;
+	int max_threads = (argc > 3) ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+	int runs = (argc > 4) ? atoi(argv[4]) : 3;
+
+	MeshData toy, scaled;
+	if (!MeshImporter::readObjFile(models + "toy.obj", toy, 1))
+	{
+		cerr << "<Error> cannot read " << models << "toy.obj" << endl;
+		return EXIT_FAILURE;
+	}
+	replicateMesh(toy, copies, scaled);
+
+	const string filename = "toy_scaled.obj";
+	if (!writeObjFile(scaled, filename))
+	{
+		cerr << "<Error> cannot write " << filename << endl;
+		return EXIT_FAILURE;
+	}
+	ifstream file (filename.c_str(), ios::binary | ios::ate);
+	double megabytes = file.tellg() / (1024.0*1024.0);
+	file.close();
+
+	cout << copies << " copies of toy.obj: " << scaled.vertices.size() << " vertices, " << scaled.indices.size()/3
+		 << " triangles, " << megabytes << " MB" << endl;
+	cout << "threads    parse (ms)    MB/s    speedup    total (ms)    same as serial" << endl;
+
+	// powers of two up to the number of threads
+	vector<int> thread_counts;
+	for (int threads = 1; threads < max_threads; threads *= 2)
+		thread_counts.push_back(threads);
+	thread_counts.push_back(max_threads);
+
+	MeshData serial, data;
+	double serial_time = 0.0;
+	bool all_same = true;
+	for (size_t i = 0; i < thread_counts.size(); ++i)
+	{
+		int threads = thread_counts[i];
+
+		// best of a few runs, the first one also warms up the file cache
+		ObjParseReport best;
+		for (int r = 0; r < runs; ++r)
+		{
+			ObjParseReport report;
+			MeshImporter::readObjFile(filename, data, threads, &report);
+			if (r == 0 || report.parse_milliseconds < best.parse_milliseconds)
+				best = report;
+		}
+
+		bool same = true;
+		if (threads == 1)
+		{
+			serial_time = best.parse_milliseconds;
+			swap(serial, data);
+		}
+		else
+		{
+			same = sameArray(data.vertices, serial.vertices) && sameArray(data.normals, serial.normals) &&
+				   sameArray(data.texCoords, serial.texCoords) && sameArray(data.indices, serial.indices);
+		}
+		all_same = all_same && same;
+
+		printf("%7u    %10.1f    %4.0f    %7.2f    %10.1f    %s\n", best.threads, best.parse_milliseconds, best.megabytes_per_second,
+			   serial_time/best.parse_milliseconds, best.milliseconds, same ? "yes" : "NO");
+	}
+
+	remove(filename.c_str());
+
+	return all_same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -39,7 +39,7 @@ void Flyscene::paintGL (void)
    	flycamera.updateViewMatrix();
    	Eigen::Vector4f viewport = flycamera.getViewport(); 
 	
- 	glClearColor(0.9, 0.9, 0.9, 0.0);
+ 	Tucano::glState().clearColor(0.9, 0.9, 0.9, 0.0);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
 	if (camerapath.isAnimating())
@@ -64,10 +64,10 @@ void Flyscene::paintGL (void)
 	
 	// clear central margin black
 	glScissor(viewport[2], viewport[1], 20, viewport[1]+viewport[3]);
-	glEnable(GL_SCISSOR_TEST);
-	glClearColor(0.3, 0.6, 0.9, 0.0);
+	Tucano::glState().enable(GL_SCISSOR_TEST);
+	Tucano::glState().clearColor(0.3, 0.6, 0.9, 0.0);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-	glDisable(GL_SCISSOR_TEST);
+	Tucano::glState().disable(GL_SCISSOR_TEST);
 
 
 }
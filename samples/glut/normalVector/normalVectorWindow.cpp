@@ -49,7 +49,7 @@ void NormalVectorWindow::OnInit(void)
 	mesh.normalizeModelMatrix();
 
 
-	glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
+	Tucano::glState().clearColor(0.2f, 0.2f, 0.3f, 1.0f);
 }
 
 void NormalVectorWindow::OnClose()
@@ -70,7 +70,7 @@ void NormalVectorWindow::OnRender(void)
 
 void NormalVectorWindow::OnResize(int w, int h)
 {
-	glViewport(0,0,w,h);
+	Tucano::glState().viewport(0,0,w,h);
 }
 
 
@@ -48,7 +48,7 @@ void SimpleTextureWindow::OnInit(void)
 	rendertexture.setShadersDir(shaders_dir);
 	rendertexture.initialize();
 
-	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+	Tucano::glState().clearColor(0.2f, 0.2f, 0.2f, 1.0f);
 }
 
 void SimpleTextureWindow::OnClose()
@@ -58,7 +58,7 @@ void SimpleTextureWindow::OnClose()
 
 void SimpleTextureWindow::OnResize(int w, int h)
 {
-	glViewport(0,0,w,h);
+	Tucano::glState().viewport(0,0,w,h);
 }
 
 
@@ -42,7 +42,7 @@ void GLWidget::paintGL (void)
 {
     makeCurrent();
 
-    glClearColor(1.0, 1.0, 1.0, 0.0);
+    Tucano::glState().clearColor(1.0, 1.0, 1.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
     Eigen::Vector2i viewport (this->width(), this->height()) ;
@@ -16,7 +16,7 @@ void GLWidget::paintGL (void)
 {
     makeCurrent();
 
-    glClearColor(1.0, 1.0, 1.0, 0.0);
+    Tucano::glState().clearColor(1.0, 1.0, 1.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
     phong.render(mesh, camera, light_trackball);
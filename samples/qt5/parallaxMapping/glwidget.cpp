@@ -1,6 +1,5 @@
 #include "glwidget.h"
 #include <QDebug>
-#include "tbn.h"
 
 
 
@@ -23,7 +22,7 @@ GLWidget::~GLWidget()
 		height_map[i]->destroy();
 		delete height_map[i];
 	}
-	bumpMesh.cleanupGL();
+	mesh.reset();
 	doneCurrent();
 }
 
@@ -89,7 +88,7 @@ void GLWidget::loadTextures()
 void GLWidget::initializeGL (void)
 {
 	initGL();
-	bumpMesh.initGL();
+	mesh.initGL();
 
 	// look for mesh file
 	QFile file;
@@ -113,17 +112,19 @@ void GLWidget::initializeGL (void)
 	parallaxMapping.setTextures(*diffuse_map[currentMap], *normal_map[currentMap], *specular_map[currentMap], *height_map[currentMap]);
     
 
-	if (!bumpMesh.loadOBJ(mesh_file.c_str()))
+	// the normal map needs a tangent frame per vertex
+	Tucano::MeshData data;
+	if (!Tucano::MeshImporter::readObjFile(mesh_file, data, 0) || !Tucano::MeshImporter::generateTangents(data))
 		std::cerr << "<Error> Could not load obj file" << std::endl;
 	else
-		bumpMesh.initBuffers();
+		Tucano::MeshImporter::uploadMeshData(&mesh, std::move(data));
 
 
 	Tucano::QtTrackballWidget::initialize();
 	camera->setPerspectiveMatrix(60.0, (float)this->width() / (float)this->height(), 0.1f, 100.0f);
 	
-	glClearColor(0.1f, 0.15f, 0.1f, 0.0f);		// background color
-	glEnable(GL_DEPTH_TEST);					// Enable depth test
+	Tucano::glState().clearColor(0.1f, 0.15f, 0.1f, 0.0f);		// background color
+	Tucano::glState().enable(GL_DEPTH_TEST);					// Enable depth test
 	glDepthFunc(GL_LESS);						// Accept fragment if it closer to the camera than the former one
 
 }
@@ -135,12 +136,8 @@ void GLWidget::paintGL (void)
 	// Clear the screen
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	
-	bumpMesh.bind();
-	parallaxMapping.bind(mesh, *camera, *light_trackball);
 	glPolygonMode(GL_FRONT_AND_BACK, wireframeEnabled ? GL_LINE : GL_FILL);
-	bumpMesh.draw();
-	parallaxMapping.unbind();
-	bumpMesh.unbind();
+	parallaxMapping.render(mesh, *camera, *light_trackball);
 
 	camera->render();
 
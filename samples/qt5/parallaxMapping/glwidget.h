@@ -5,7 +5,6 @@
 #include <phongshader.hpp>
 #include <parallaxmapping.hpp>
 #include <texture.hpp>
-#include <bumpmesh.hpp>
 
 
 class GLWidget : public Tucano::QtTrackballWidget
@@ -61,8 +60,6 @@ private:
 	/// A simple normal mapping shader for rendering meshes
 	Effects::ParallaxMapping parallaxMapping;
 
-	Tucano::BumpMesh bumpMesh;
-
 
 	GLboolean wireframeEnabled;
 	int currentMap;
@@ -28,6 +28,7 @@
 #include <mesh.hpp>
 #include <camera.hpp>
 #include <texture.hpp>
+#include <utils/meshtangents.hpp>
 
 using namespace Tucano;
 
@@ -155,7 +156,7 @@ public:
 		const Tucano::Camera& lightTrackball)
 	{
 		Eigen::Vector4f viewport = camera.getViewport();
-		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		Tucano::glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
 		normal_mapping_shader.bind();
 
@@ -200,6 +201,19 @@ public:
 		height_map->unbind();
 	}
 
+	/**
+	* @brief Renders a mesh with tangents (in_Tangent, see MeshImporter::generateTangents)
+	*/
+	void render(Tucano::Mesh& mesh,
+		const Tucano::Camera& camera,
+		const Tucano::Camera& lightTrackball)
+	{
+		bind(mesh, camera, lightTrackball);
+		mesh.setAttributeLocation(normal_mapping_shader);
+		mesh.render();
+		unbind();
+	}
+
 
 };
 
@@ -67,7 +67,7 @@ void GLWidget::paintGL (void)
 {
     makeCurrent();
 
-    glClearColor(1.0, 1.0, 1.0, 0.0);
+    Tucano::glState().clearColor(1.0, 1.0, 1.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
 
@@ -84,7 +84,7 @@ void GLWidget::paintGL (void)
 		ssao->render(mesh, *camera, *light_trackball);
 	}
 
-    glEnable(GL_DEPTH_TEST);
+    Tucano::glState().enable(GL_DEPTH_TEST);
     if (draw_trackball)
     {
         camera->render();
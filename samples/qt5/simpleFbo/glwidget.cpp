@@ -51,7 +51,7 @@ void GLWidget::paintGL (void)
 
 	fbo->bind();
 	{
-		glClearColor(1.0, 1.0, 1.0, 0.0);
+		Tucano::glState().clearColor(1.0, 1.0, 1.0, 0.0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		phong.render(mesh, *camera, *light_trackball);
@@ -62,9 +62,9 @@ void GLWidget::paintGL (void)
 
 	makeCurrent();
 
-	glDisable(GL_DEPTH_TEST);
+	Tucano::glState().disable(GL_DEPTH_TEST);
 	Eigen::Vector2i viewport(this->width(), this->height());
 	rendertexture.renderTexture(*fbo->getTexture(0), viewport);
-	glEnable(GL_DEPTH_TEST);
+	Tucano::glState().enable(GL_DEPTH_TEST);
 
 }
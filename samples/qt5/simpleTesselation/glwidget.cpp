@@ -41,9 +41,9 @@ void GLWidget::initializeGL(void)
 	icosahedron->bindBuffers();
 	
 	// Initialize various state:
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-	glClearColor(0.7f, 0.6f, 0.5f, 1.0f);
+	Tucano::glState().enable(GL_DEPTH_TEST);
+	Tucano::glState().enable(GL_CULL_FACE);
+	Tucano::glState().clearColor(0.7f, 0.6f, 0.5f, 1.0f);
 
 	Tucano::QtTrackballWidget::initialize();
 	camera->setPerspectiveMatrix(40.0f, width() / height(), 0.1f, 100.0f);
@@ -79,7 +79,7 @@ void GLWidget::paintGL(void)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glPolygonMode(GL_FRONT_AND_BACK, wireframeEnabled ? GL_LINE : GL_FILL);
 	glPatchParameteri(GL_PATCH_VERTICES, 3);
-	glDrawElements(GL_PATCHES, icosahedron->getNumberOfElements(), GL_UNSIGNED_INT, 0);
+	glDrawElements(GL_PATCHES, icosahedron->getNumberOfElements(), icosahedron->getIndexType(), 0);
 }
 
 
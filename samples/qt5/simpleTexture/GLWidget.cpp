@@ -52,7 +52,7 @@ void GLWidget::paintGL()
 {
 	makeCurrent();
 	
-	glClearColor(0.0, 0.2, 0.3, 0.0);
+	Tucano::glState().clearColor(0.0, 0.2, 0.3, 0.0);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// renders the given image, not that we are setting a fixed viewport that follows the widgets size
@@ -70,8 +70,8 @@ void GLWidget::initializeGL (void)
 	Tucano::QtFlycameraWidget::initialize();
 	camera->setPerspectiveMatrix(60.0, (float)this->width() / (float)this->height(), 0.1f, 100.0f);
 	
-	glClearColor(0.1f, 0.15f, 0.1f, 0.0f);		// background color
-	glEnable(GL_DEPTH_TEST);					// Enable depth test
+	Tucano::glState().clearColor(0.1f, 0.15f, 0.1f, 0.0f);		// background color
+	Tucano::glState().enable(GL_DEPTH_TEST);					// Enable depth test
 	glDepthFunc(GL_LESS);						// Accept fragment if it closer to the camera than the former one
 
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -86,7 +86,7 @@ void GLWidget::paintGL (void)
 	
 
 	Eigen::Vector4f viewport = camera->getViewport();
-	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	Tucano::glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
 	shader.bind();
 
@@ -116,7 +116,7 @@ void GLWidget::paintGL (void)
 
 	terrainMesh.setAttributeLocation(shader);
 
-	glEnable(GL_DEPTH_TEST);
+	Tucano::glState().enable(GL_DEPTH_TEST);
 	terrainMesh.render();
 
 	shader.unbind();
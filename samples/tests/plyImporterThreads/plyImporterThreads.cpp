@@ -0,0 +1,124 @@
+// Decodes the sample PLY files on many threads at once and checks that every result is
+// bit-identical to a serial decode of the same file.
+//
+// Usage: plyImporterThreads [models directory] [threads] [decodes per thread]
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <utils/plyimporter.hpp>
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+struct PlyFile
+{
+	string filename;
+	MeshData data;
+};
+
+template <class T>
+static bool sameArray (const vector<T>& a, const vector<T>& b)
+{
+	return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size()*sizeof(T)) == 0);
+}
+
+static bool sameMeshData (const MeshData& a, const MeshData& b)
+{
+	return sameArray(a.vertices, b.vertices) && sameArray(a.normals, b.normals) && sameArray(a.texCoords, b.texCoords) &&
+		sameArray(a.colors, b.colors) && sameArray(a.tangents, b.tangents) && sameArray(a.indices, b.indices);
+}
+
+// Writes an ascii copy of a mesh, ascii files are parsed by the rply callbacks instead of the memory mapped reader.
+static bool writeAsciiPly (const MeshData& data, const string& filename)
+{
+	ofstream out (filename.c_str());
+	if (!out)
+		return false;
+
+	out << "ply\nformat ascii 1.0\nelement vertex " << data.vertices.size() << "\n";
+	out << "property float x\nproperty float y\nproperty float z\n";
+	if (!data.normals.empty())
+		out << "property float nx\nproperty float ny\nproperty float nz\n";
+	if (!data.colors.empty())
+		out << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+	out << "element face " << data.indices.size()/3 << "\nproperty list uchar int vertex_indices\nend_header\n";
+
+	out.precision(9);
+	for (size_t i = 0; i < data.vertices.size(); ++i)
+	{
+		out << data.vertices[i][0] << " " << data.vertices[i][1] << " " << data.vertices[i][2];
+		if (!data.normals.empty())
+			out << " " << data.normals[i][0] << " " << data.normals[i][1] << " " << data.normals[i][2];
+		if (!data.colors.empty())
+			for (int k = 0; k < 3; ++k)
+				out << " " << (int)(data.colors[i][k]*255.0f + 0.5f);
+		out << "\n";
+	}
+	for (size_t i = 0; i+2 < data.indices.size(); i += 3)
+		out << "3 " << data.indices[i] << " " << data.indices[i+1] << " " << data.indices[i+2] << "\n";
+
+	return (bool)out;
+}
+
+int main (int argc, char** argv)
+{
+	string models = modelsDirectory(argc, argv);
+	int num_threads = (argc > 2) ? atoi(argv[2]) : 16;
+	int decodes = (argc > 3) ? atoi(argv[3]) : 25;
+
+	vector<PlyFile> files(4);
+	files[0].filename = models + "sphere.ply";
+	files[1].filename = models + "toy.ply";
+	files[2].filename = "sphere_ascii.ply";
+	files[3].filename = "toy_ascii.ply";
+
+	// serial reference decodes
+	for (int i = 0; i < 4; ++i)
+	{
+		if (i >= 2 && !writeAsciiPly(files[i-2].data, files[i].filename))
+		{
+			cerr << "<Error> cannot write " << files[i].filename << endl;
+			return EXIT_FAILURE;
+		}
+		if (!MeshImporter::readPlyFile(files[i].filename, files[i].data) || files[i].data.indices.empty())
+		{
+			cerr << "<Error> cannot read " << files[i].filename << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	atomic<int> failures (0), mismatches (0);
+	vector<thread> threads;
+	for (int t = 0; t < num_threads; ++t)
+	{
+		threads.push_back(thread([&, t] ()
+		{
+			MeshData data;
+			for (int i = 0; i < decodes; ++i)
+			{
+				// each thread walks the files from a different start, so different files are decoded at the same time
+				const PlyFile& file = files[(t + i) % files.size()];
+				if (!MeshImporter::readPlyFile(file.filename, data))
+					++failures;
+				else if (!sameMeshData(data, file.data))
+					++mismatches;
+			}
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+
+	remove(files[2].filename.c_str());
+	remove(files[3].filename.c_str());
+
+	cout << num_threads*decodes << " decodes on " << num_threads << " threads: " << mismatches << " mismatches, " << failures << " failures" << endl;
+
+	return (failures == 0 && mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+// Reads PLY files whose faces reference negative or out of range vertices, and checks that they
+// are rejected by both the memory mapped binary reader and the rply callbacks, while the same
+// files with valid indices are read.
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <utils/plyimporter.hpp>
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+// Appends a little endian integer of the given size.
+static void writeLittleEndian (ofstream& out, long value, int bytes)
+{
+	for (int i = 0; i < bytes; ++i)
+		out.put((char)((value >> (8*i)) & 0xFF));
+}
+
+// Writes a triangle of three vertices, its indices stored with the given type and size.
+static bool writeTriangle (const string& filename, bool binary, const string& index_type, int index_size, const long indices[3])
+{
+	ofstream out (filename.c_str(), ios::binary);
+	if (!out)
+		return false;
+
+	out << "ply\nformat " << (binary ? "binary_little_endian" : "ascii") << " 1.0\nelement vertex 3\n";
+	out << "property float x\nproperty float y\nproperty float z\n";
+	out << "element face 1\nproperty list uchar " << index_type << " vertex_indices\nend_header\n";
+
+	const float vertices[9] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+	if (binary)
+	{
+		for (int i = 0; i < 9; ++i)
+		{
+			union { float f; uint32_t u; } value;
+			value.f = vertices[i];
+			writeLittleEndian(out, value.u, 4);
+		}
+		writeLittleEndian(out, 3, 1);
+		for (int k = 0; k < 3; ++k)
+			writeLittleEndian(out, indices[k], index_size);
+	}
+	else
+	{
+		for (int i = 0; i < 3; ++i)
+			out << vertices[3*i] << " " << vertices[3*i+1] << " " << vertices[3*i+2] << "\n";
+		out << "3 " << indices[0] << " " << indices[1] << " " << indices[2] << "\n";
+	}
+	return (bool)out;
+}
+
+int main (void)
+{
+	const string filename = "invalid_indices.ply";
+	const long valid[3] = {0, 1, 2};
+	const long negative[3] = {0, -1, 2};
+	const long past_end[3] = {0, 1, 3};
+
+	struct Case { bool binary; const char* type; int size; };
+	// int with 4 bytes is copied as is by the binary reader, the others are converted one by one
+	const Case cases[] = {{true, "int", 4}, {true, "short", 2}, {true, "uint", 4}, {false, "int", 4}};
+
+	bool ok = true;
+	for (size_t c = 0; c < sizeof(cases)/sizeof(cases[0]); ++c)
+	{
+		const long* all_indices[3] = {valid, negative, past_end};
+		for (int i = 0; i < 3; ++i)
+		{
+			// unsigned types cannot store negative indices
+			if (i == 1 && cases[c].type[0] == 'u')
+				continue;
+
+			if (!writeTriangle(filename, cases[c].binary, cases[c].type, cases[c].size, all_indices[i]))
+			{
+				cerr << "<Error> cannot write " << filename << endl;
+				return EXIT_FAILURE;
+			}
+
+			MeshData data;
+			bool read = MeshImporter::readPlyFile(filename, data);
+			bool expected = (i == 0);
+			cout << (cases[c].binary ? "binary " : "ascii ") << cases[c].type << " indices " << all_indices[i][0] << " " << all_indices[i][1] << " "
+				 << all_indices[i][2] << ": " << (read ? "read" : "rejected") << endl;
+
+			if (read != expected || (read && (data.indices.size() != 3 || data.indices[1] != 1 || data.indices[2] != 2)))
+			{
+				cerr << "<Error> expected the file to be " << (expected ? "read" : "rejected") << endl;
+				ok = false;
+			}
+		}
+	}
+
+	remove(filename.c_str());
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
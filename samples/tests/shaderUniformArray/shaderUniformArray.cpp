@@ -0,0 +1,88 @@
+// Links shaders declaring arrays of a single element next to plain uniforms, and checks that
+// both kinds are set correctly through their names. Arrays have no value slot in the table of
+// cached uniforms, a size-1 array must not be given one.
+
+#include <iostream>
+#include <cmath>
+
+#include <shader.hpp>
+#include "OffscreenContext.h"
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+static const char* vertex_code =
+	"#version 330\n"
+	"in vec4 in_Position;\n"
+	"void main (void) { gl_Position = in_Position; }\n";
+
+// the array is declared last, so that its location is usually the largest one
+static const char* fragment_code =
+	"#version 330\n"
+	"uniform float scale;\n"
+	"uniform vec4 zz[1];\n"
+	"out vec4 out_Color;\n"
+	"void main (void) { out_Color = scale * zz[0]; }\n";
+
+// only an array, so there are no cached uniforms at all
+static const char* array_only_code =
+	"#version 330\n"
+	"uniform vec4 zz[1];\n"
+	"out vec4 out_Color;\n"
+	"void main (void) { out_Color = zz[0]; }\n";
+
+// Reads back a uniform and compares it to the expected values.
+static bool checkUniform (Shader& shader, const char* name, const GLfloat* expected, int count)
+{
+	GLfloat value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	glGetUniformfv(shader.getShaderProgram(), shader.getUniformLocation(name), value);
+	for (int i = 0; i < count; ++i)
+	{
+		if (fabs(value[i] - expected[i]) > 1e-6f)
+		{
+			cerr << "<Error> uniform " << name << "[" << i << "] is " << value[i] << ", expected " << expected[i] << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main (void)
+{
+	OffscreenContext context;
+	if (!context.isValid())
+		return TEST_SKIPPED;
+
+	bool ok = true;
+
+	Shader shader("uniformArray");
+	shader.initializeFromStrings(vertex_code, fragment_code);
+	shader.bind();
+	// set twice, the second update must not be elided
+	for (int round = 0; round < 2; ++round)
+	{
+		GLfloat scale = 1.0f + round;
+		GLfloat zz[4] = {0.25f, 0.5f + round, 0.75f, 1.0f};
+		shader.setUniform("scale", scale);
+		shader.setUniform("zz", Eigen::Vector4f(zz[0], zz[1], zz[2], zz[3]));
+		ok = checkUniform(shader, "scale", &scale, 1) && checkUniform(shader, "zz", zz, 4) && ok;
+	}
+	shader.unbind();
+
+	Shader array_only("uniformArrayOnly");
+	array_only.initializeFromStrings(vertex_code, array_only_code);
+	array_only.bind();
+	GLfloat zz[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+	array_only.setUniform("zz[0]", Eigen::Vector4f(zz[0], zz[1], zz[2], zz[3]));
+	ok = checkUniform(array_only, "zz", zz, 4) && ok;
+	array_only.unbind();
+
+	if (glGetError() != GL_NO_ERROR)
+	{
+		cerr << "<Error> OpenGL error while setting the uniforms" << endl;
+		ok = false;
+	}
+
+	cout << (ok ? "size-1 array uniforms are set correctly" : "size-1 array uniforms are wrong") << endl;
+	return ok ? 0 : 1;
+}
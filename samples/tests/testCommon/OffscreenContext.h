@@ -0,0 +1,72 @@
+#ifndef __OFFSCREENCONTEXT_H__
+#define __OFFSCREENCONTEXT_H__
+
+#include <tucano.hpp>
+#include <glstate.hpp>
+#include <utils/misc.hpp>
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+/**
+ * OpenGL context of a hidden GLFW window, for the tests that need the GL but draw nothing on screen.
+ * Check isValid before using it: machines without a display or an OpenGL 4.3 driver cannot create it.
+ * The context has its own state tracker, deleted with the objects it owns before the context is destroyed.
+ */
+class OffscreenContext
+{
+public:
+
+	OffscreenContext (int width = 64, int height = 64) : window(NULL), state(NULL)
+	{
+		if (!glfwInit())
+		{
+			std::cerr << "<Info> could not start GLFW3" << std::endl;
+			return;
+		}
+
+		glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, OPENGL_MAJOR_VERSION);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, OPENGL_MINOR_VERSION);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		window = glfwCreateWindow(width, height, "Tucano test", NULL, NULL);
+		if (!window)
+		{
+			std::cerr << "<Info> could not create an OpenGL " << OPENGL_MAJOR_VERSION << "." << OPENGL_MINOR_VERSION << " context" << std::endl;
+			glfwTerminate();
+			return;
+		}
+		glfwMakeContextCurrent(window);
+
+		Tucano::Misc::initGlew();
+
+		state = new Tucano::GLState();
+		state->makeCurrent();
+	}
+
+	~OffscreenContext (void)
+	{
+		if (window)
+		{
+			delete state;
+			glfwDestroyWindow(window);
+			glfwTerminate();
+		}
+	}
+
+	bool isValid (void) const
+	{
+		return window != NULL;
+	}
+
+private:
+
+	OffscreenContext (const OffscreenContext&);
+	OffscreenContext& operator= (const OffscreenContext&);
+
+	GLFWwindow* window;
+	Tucano::GLState* state;
+};
+
+#endif
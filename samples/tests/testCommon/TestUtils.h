@@ -0,0 +1,164 @@
+#ifndef __TESTUTILS_H__
+#define __TESTUTILS_H__
+
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <utils/meshdata.hpp>
+
+#ifndef TUCANO_MODELS_DIR
+#define TUCANO_MODELS_DIR "../../samples/models/"
+#endif
+
+// Exit code of a test that cannot run on this machine, reported as skipped by ctest.
+#define TEST_SKIPPED 77
+
+/**
+ * Returns the directory of the sample models, given as first argument or set at compile time.
+ */
+inline std::string modelsDirectory (int argc, char** argv)
+{
+	std::string dir = (argc > 1) ? argv[1] : TUCANO_MODELS_DIR;
+	if (!dir.empty() && dir[dir.size()-1] != '/')
+		dir += '/';
+	return dir;
+}
+
+/**
+ * Fills a mesh with a rows x cols grid of vertices on a wavy surface, with normals, texture coordinates, colors and triangles.
+ * The arrays are reserved to their exact size, so the grid takes no more memory than its sizeInBytes.
+ */
+inline void makeGrid (Tucano::MeshData& data, int rows, int cols)
+{
+	data.clear();
+	size_t num_vertices = (size_t)rows*cols;
+	data.vertices.reserve(num_vertices);
+	data.normals.reserve(num_vertices);
+	data.texCoords.reserve(num_vertices);
+	data.colors.reserve(num_vertices);
+	data.indices.reserve(6*(size_t)(rows-1)*(cols-1));
+
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			float u = j/(float)(cols-1), v = i/(float)(rows-1);
+			float z = 0.05f*sin(20.0f*u)*cos(20.0f*v);
+			Eigen::Vector3f du (2.0f, 0.0f, cos(20.0f*u)*cos(20.0f*v)), dv (0.0f, 2.0f, -sin(20.0f*u)*sin(20.0f*v));
+			data.vertices.push_back(Eigen::Vector4f(2.0f*u - 1.0f, 2.0f*v - 1.0f, z, 1.0f));
+			data.normals.push_back(du.cross(dv).normalized());
+			data.texCoords.push_back(Eigen::Vector2f(u, v));
+			data.colors.push_back(Eigen::Vector4f(u, v, 0.5f, 1.0f));
+		}
+	}
+
+	for (int i = 0; i+1 < rows; ++i)
+	{
+		for (int j = 0; j+1 < cols; ++j)
+		{
+			GLuint a = i*cols + j, b = a + 1, c = a + cols, d = c + 1;
+			data.indices.push_back(a); data.indices.push_back(b); data.indices.push_back(d);
+			data.indices.push_back(a); data.indices.push_back(d); data.indices.push_back(c);
+		}
+	}
+}
+
+/**
+ * Fills a mesh with copies of another one side by side on a square grid, to get large meshes from the sample models.
+ */
+inline void replicateMesh (const Tucano::MeshData& in, int copies, Tucano::MeshData& out)
+{
+	out.clear();
+	if (in.vertices.empty())
+		return;
+
+	Eigen::AlignedBox3f box;
+	for (size_t i = 0; i < in.vertices.size(); ++i)
+		box.extend(in.vertices[i].head<3>());
+	Eigen::Vector3f size = box.sizes() * 1.1f;
+	int side = (int)ceil(sqrt((float)copies));
+
+	out.vertices.reserve(in.vertices.size()*copies);
+	out.normals.reserve(in.normals.size()*copies);
+	out.texCoords.reserve(in.texCoords.size()*copies);
+	out.colors.reserve(in.colors.size()*copies);
+	out.indices.reserve(in.indices.size()*copies);
+
+	for (int c = 0; c < copies; ++c)
+	{
+		Eigen::Vector4f offset ((c % side)*size[0], (c / side)*size[1], 0.0f, 0.0f);
+		GLuint first = (GLuint)out.vertices.size();
+		for (size_t i = 0; i < in.vertices.size(); ++i)
+			out.vertices.push_back(in.vertices[i] + offset);
+		out.normals.insert(out.normals.end(), in.normals.begin(), in.normals.end());
+		out.texCoords.insert(out.texCoords.end(), in.texCoords.begin(), in.texCoords.end());
+		out.colors.insert(out.colors.end(), in.colors.begin(), in.colors.end());
+		for (size_t i = 0; i < in.indices.size(); ++i)
+			out.indices.push_back(in.indices[i] + first);
+	}
+}
+
+/**
+ * Writes the positions, normals, texture coordinates and triangles of a mesh as an OBJ file.
+ */
+inline bool writeObjFile (const Tucano::MeshData& data, const std::string& filename)
+{
+	std::ofstream out (filename.c_str());
+	if (!out)
+		return false;
+
+	bool has_normals = !data.normals.empty(), has_texcoords = !data.texCoords.empty();
+	out.precision(7);
+	for (size_t i = 0; i < data.vertices.size(); ++i)
+		out << "v " << data.vertices[i][0] << " " << data.vertices[i][1] << " " << data.vertices[i][2] << "\n";
+	for (size_t i = 0; i < data.normals.size(); ++i)
+		out << "vn " << data.normals[i][0] << " " << data.normals[i][1] << " " << data.normals[i][2] << "\n";
+	for (size_t i = 0; i < data.texCoords.size(); ++i)
+		out << "vt " << data.texCoords[i][0] << " " << data.texCoords[i][1] << "\n";
+
+	for (size_t i = 0; i+2 < data.indices.size(); i += 3)
+	{
+		out << "f";
+		for (int k = 0; k < 3; ++k)
+		{
+			GLuint v = data.indices[i+k] + 1;
+			out << " " << v;
+			if (has_texcoords)
+				out << "/" << v;
+			if (has_normals)
+				out << (has_texcoords ? "/" : "//") << v;
+		}
+		out << "\n";
+	}
+	return (bool)out;
+}
+
+/**
+ * Measures the wall clock time since its creation or the last restart.
+ */
+class Stopwatch
+{
+public:
+
+	Stopwatch (void)
+	{
+		restart();
+	}
+
+	void restart (void)
+	{
+		start = std::chrono::steady_clock::now();
+	}
+
+	double seconds (void) const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+private:
+
+	std::chrono::steady_clock::time_point start;
+};
+
+#endif
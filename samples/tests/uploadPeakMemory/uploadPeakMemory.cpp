@@ -0,0 +1,86 @@
+// Uploads a large synthetic mesh and checks that the peak memory of the process grows by about
+// the largest attribute array, not by the whole mesh: the arrays moved into uploadMeshData are
+// released right after their upload and no intermediate copy is made.
+//
+// Usage: uploadPeakMemory [grid rows]
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <mesh.hpp>
+#include <utils/meshdata.hpp>
+#include "OffscreenContext.h"
+#include "TestUtils.h"
+
+using namespace Tucano;
+
+#ifndef _WIN32
+// Peak resident memory of the process in bytes.
+static double peakMemory (void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return (double)usage.ru_maxrss;
+#else
+	return 1024.0*usage.ru_maxrss;
+#endif
+}
+#endif
+
+int main (int argc, char** argv)
+{
+#ifdef _WIN32
+	cout << "peak memory is not measured on this platform" << endl;
+	return TEST_SKIPPED;
+#else
+	int rows = (argc > 1) ? atoi(argv[1]) : 1500;
+
+	OffscreenContext context;
+	if (!context.isValid())
+		return TEST_SKIPPED;
+
+	// the first upload also initializes the driver, keep it out of the measure
+	{
+		MeshData warmup;
+		makeGrid(warmup, 16, 16);
+		Mesh mesh;
+		MeshImporter::uploadMeshData(&mesh, std::move(warmup));
+		glFinish();
+	}
+
+	MeshData data;
+	makeGrid(data, rows, rows);
+
+	const double MB = 1024.0*1024.0;
+	double total = data.sizeInBytes();
+	double largest = max(max(data.vertices.size()*sizeof(Eigen::Vector4f), data.normals.size()*sizeof(Eigen::Vector3f)),
+						 max(max(data.texCoords.size()*sizeof(Eigen::Vector2f), data.colors.size()*sizeof(Eigen::Vector4f)),
+							 data.indices.size()*sizeof(GLuint)));
+
+	double before = peakMemory();
+	Mesh mesh;
+	MeshImporter::uploadMeshData(&mesh, std::move(data));
+	glFinish();
+	double growth = peakMemory() - before;
+
+	// drivers keeping the buffers in system memory hold a copy of the uploaded arrays, and allocate a little on their own
+	double limit = largest + total/8.0;
+
+	cout << "mesh " << total/MB << " MB, largest array " << largest/MB << " MB, peak memory growth " << growth/MB
+		 << " MB (limit " << limit/MB << " MB)" << endl;
+
+	if (mesh.getNumberOfVertices() != rows*rows || !data.vertices.empty())
+	{
+		cerr << "<Error> mesh was not uploaded" << endl;
+		return EXIT_FAILURE;
+	}
+
+	return (growth <= limit) ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif
+}
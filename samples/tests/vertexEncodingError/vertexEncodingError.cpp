@@ -0,0 +1,239 @@
+// Packs random vertex attributes with each compact encoding (see vertexencoding.hpp), decodes
+// them back and checks the largest error against the precision of each format.
+// The attributes are decoded on the CPU with decodeAttribute, and by OpenGL from a mesh using the
+// encoding: a shader writes the attributes of each vertex to a pixel of float render targets.
+// Also reports the size of a vertex, to compare with the float layout.
+// The OpenGL decode is skipped (exit 77) when no context can be created, after the CPU checks.
+//
+// Usage: vertexEncodingError [number of vertices]
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include <sstream>
+
+#include <mesh.hpp>
+#include <framebuffer.hpp>
+#include <utils/meshdata.hpp>
+#include "TestUtils.h"
+
+#ifdef TESTS_WITH_OPENGL
+#include "OffscreenContext.h"
+#endif
+
+using namespace Tucano;
+
+struct EncodingErrors
+{
+	float position;		// largest distance between positions
+	float normal;		// largest angle between normals, in radians
+	float texcoord;		// largest texture coordinate error, relative to the value (absolute below 2^-14)
+	float color;		// largest color component error
+};
+
+static float angle (const Eigen::Vector3f& a, const Eigen::Vector3f& b)
+{
+	return atan2(a.cross(b).norm(), a.dot(b));
+}
+
+// Accumulates the errors of the decoded position, normal, texcoord and color of vertex i.
+static void addErrors (const MeshData& data, size_t i, const float out[4][4], EncodingErrors& err)
+{
+	err.position = max(err.position, (Eigen::Vector4f(out[0]) - data.vertices[i]).norm());
+	err.normal = max(err.normal, angle(Eigen::Vector3f(out[1]), data.normals[i]));
+	for (int k = 0; k < 2; ++k)
+		err.texcoord = max(err.texcoord, fabs(out[2][k] - data.texCoords[i][k]) / max(fabs(data.texCoords[i][k]), ldexp(1.0f, -14)));
+	for (int k = 0; k < 4; ++k)
+		err.color = max(err.color, fabs(out[3][k] - data.colors[i][k]));
+}
+
+// Packs the arrays interleaved, then decodes every attribute at its offset in the vertex.
+static int measureErrors (const MeshData& data, unsigned int encoding, EncodingErrors& err)
+{
+	vector<char> packed;
+	int stride = Mesh::packInterleaved(data.vertices, data.normals, data.texCoords, data.colors, encoding, packed);
+
+	VertexFormat formats[4] = {Misc::positionFormat(encoding), Misc::normalFormat(encoding),
+									 Misc::texCoordFormat(encoding), Misc::colorFormat(encoding)};
+	err.position = err.normal = err.texcoord = err.color = 0.0f;
+
+	for (size_t i = 0; i < data.vertices.size(); ++i)
+	{
+		const char* p = &packed[i*stride];
+		float out[4][4];
+		for (int k = 0; k < 4; ++k)
+		{
+			out[k][3] = 1.0f;
+			Misc::decodeAttribute(formats[k], p, out[k]);
+			p += formats[k].bytes;
+		}
+		addErrors(data, i, out, err);
+	}
+	return stride;
+}
+
+#ifdef TESTS_WITH_OPENGL
+// Uploads the arrays to a mesh with the encoding and layout, and lets OpenGL decode them: each vertex is drawn
+// as a point on its own pixel, and its attributes are written to four float render targets and read back.
+static void measureGLErrors (const MeshData& data, unsigned int encoding, bool interleaved, EncodingErrors& err)
+{
+	const int width = 256;
+	int height = (int)((data.vertices.size() + width - 1) / width);
+	bool octahedral = (encoding & ENCODE_NORMAL_OCTAHEDRAL) != 0;
+
+	ostringstream vertex_code;
+	vertex_code << "#version 330\n"
+				<< "in vec4 in_Position;\n"
+				<< (octahedral ? "in vec2 in_Normal;\n" : "in vec3 in_Normal;\n")
+				<< "in vec2 in_TexCoords;\n"
+				<< "in vec4 in_Color;\n"
+				<< "flat out vec4 position;\nflat out vec3 normal;\nflat out vec2 texcoord;\nflat out vec4 color;\n"
+				<< OCTAHEDRAL_DECODE_GLSL
+				<< "void main (void)\n{\n"
+				<< "    position = in_Position;\n"
+				<< (octahedral ? "    normal = octahedralDecode(in_Normal);\n" : "    normal = in_Normal;\n")
+				<< "    texcoord = in_TexCoords;\n"
+				<< "    color = in_Color;\n"
+				<< "    vec2 pixel = vec2(gl_VertexID % " << width << ", gl_VertexID / " << width << ") + 0.5;\n"
+				<< "    gl_Position = vec4(2.0 * pixel / vec2(" << width << ", " << height << ") - 1.0, 0.0, 1.0);\n"
+				<< "}\n";
+
+	string fragment_code = "#version 330\n"
+			"flat in vec4 position;\nflat in vec3 normal;\nflat in vec2 texcoord;\nflat in vec4 color;\n"
+			"layout(location = 0) out vec4 out_Position;\nlayout(location = 1) out vec4 out_Normal;\n"
+			"layout(location = 2) out vec4 out_TexCoord;\nlayout(location = 3) out vec4 out_Color;\n"
+			"void main (void)\n{\n"
+			"    out_Position = position;\n"
+			"    out_Normal = vec4(normal, 0.0);\n"
+			"    out_TexCoord = vec4(texcoord, 0.0, 0.0);\n"
+			"    out_Color = color;\n"
+			"}\n";
+
+	Shader shader ("decodeAttributes");
+	shader.initializeFromStrings(vertex_code.str(), fragment_code);
+
+	Mesh mesh;
+	mesh.setEncoding(encoding);
+	mesh.setInterleaved(interleaved);
+	MeshImporter::uploadMeshData(&mesh, data);
+	mesh.setAttributeLocation(shader);
+
+	Framebuffer fbo (width, height, 4);
+	fbo.clearAttachments();
+	fbo.bindRenderBuffers(0, 1, 2, 3);
+	glState().viewport(0, 0, width, height);
+	shader.bind();
+	mesh.bindBuffers();
+	mesh.renderPoints();
+	mesh.unbindBuffers();
+	shader.unbind();
+	fbo.unbind();
+
+	vector<float> pixels[4];
+	for (int k = 0; k < 4; ++k)
+		fbo.readBuffer(k, pixels[k]);
+
+	err.position = err.normal = err.texcoord = err.color = 0.0f;
+	for (size_t i = 0; i < data.vertices.size(); ++i)
+	{
+		float out[4][4];
+		for (int k = 0; k < 4; ++k)
+			copy(&pixels[k][4*i], &pixels[k][4*i] + 4, out[k]);
+		addErrors(data, i, out, err);
+	}
+}
+#endif
+
+// Checks the errors against the bounds of an encoding and prints them.
+static bool checkErrors (const EncodingErrors& err, float normal_bound, float texcoord_bound, float color_bound)
+{
+	const float degrees = 180.0f / M_PI;
+	bool ok = err.position == 0.0f && err.normal <= normal_bound && err.texcoord <= texcoord_bound && err.color <= color_bound;
+
+	cout << "    position error " << err.position << endl;
+	cout << "    normal error " << err.normal*degrees << " degrees (bound " << normal_bound*degrees << ")" << endl;
+	cout << "    texcoord relative error " << err.texcoord << " (bound " << texcoord_bound << ")" << endl;
+	cout << "    color error " << err.color << " (bound " << color_bound << ")" << endl;
+	cout << (ok ? "    passed" : "    FAILED") << endl;
+	return ok;
+}
+
+int main (int argc, char** argv)
+{
+	int num_vertices = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+	MeshData data;
+	mt19937 generator (1234);
+	uniform_real_distribution<float> unit (-1.0f, 1.0f);
+	for (int i = 0; i < num_vertices; ++i)
+	{
+		Eigen::Vector3f n;
+		if (i < 6)
+			n = Eigen::Vector3f::Unit(i/2) * ((i % 2) ? -1.0f : 1.0f); // axes, where the octahedral map folds
+		else
+			do { n = Eigen::Vector3f(unit(generator), unit(generator), unit(generator)); } while (n.norm() < 0.1f || n.norm() > 1.0f);
+		data.vertices.push_back(Eigen::Vector4f(100.0f*unit(generator), 100.0f*unit(generator), 100.0f*unit(generator), 1.0f));
+		data.normals.push_back(n.normalized());
+		data.texCoords.push_back(Eigen::Vector2f(4.0f*unit(generator), 0.5f + 0.5f*unit(generator)));
+		data.colors.push_back(Eigen::Vector4f(0.5f + 0.5f*unit(generator), 0.5f + 0.5f*unit(generator), 0.5f + 0.5f*unit(generator), 1.0f));
+	}
+
+	// bounds from the precision of each format: a snorm with b bits rounds each component by 1/(2*(2^(b-1)-1)),
+	// which turns a unit vector by at most sqrt(3) times that for 2_10_10_10 and 2*sqrt(6) times that in octahedral
+	// coordinates; half floats keep 11 significant bits, unorm8 rounds by 1/(2*255)
+	const float snorm10 = 0.5f/511.0f, snorm16 = 0.5f/32767.0f;
+	const float normal_bound[3] = {1e-6f, asin(sqrt(3.0f)*snorm10), 2.0f*sqrt(6.0f)*snorm16};
+	const float texcoord_bound = ldexp(1.0f, -11), color_bound = 0.5f/255.0f + 1e-6f;
+
+	const unsigned int encodings[3] = {0, ENCODE_COMPACT, ENCODE_POSITION_XYZ | ENCODE_NORMAL_OCTAHEDRAL | ENCODE_TEXCOORD_HALF | ENCODE_COLOR_UNORM8};
+	const char* names[3] = {"float", "compact (2_10_10_10 normals)", "compact (octahedral normals)"};
+
+	bool passed = true;
+	int float_stride = 0;
+	for (int e = 0; e < 3; ++e)
+	{
+		EncodingErrors err;
+		int stride = measureErrors(data, encodings[e], err);
+		if (e == 0)
+			float_stride = stride;
+
+		cout << names[e] << ": " << stride << " bytes per vertex (" << float_stride/(float)stride << "x smaller)" << endl;
+		passed = checkErrors(err, normal_bound[e], (e == 0 ? 0.0f : texcoord_bound), (e == 0 ? 0.0f : color_bound)) && passed;
+	}
+
+	if (!passed)
+		return EXIT_FAILURE;
+
+#ifdef TESTS_WITH_OPENGL
+	OffscreenContext context;
+	if (!context.isValid())
+		return TEST_SKIPPED;
+
+	// a subset of the vertices is enough for the GL decode, it fits a small render target
+	MeshData subset;
+	size_t count = min(data.vertices.size(), (size_t)65536);
+	subset.vertices.assign(data.vertices.begin(), data.vertices.begin() + count);
+	subset.normals.assign(data.normals.begin(), data.normals.begin() + count);
+	subset.texCoords.assign(data.texCoords.begin(), data.texCoords.begin() + count);
+	subset.colors.assign(data.colors.begin(), data.colors.begin() + count);
+
+	for (int e = 0; e < 3; ++e)
+	{
+		for (int interleaved = 0; interleaved < 2; ++interleaved)
+		{
+			EncodingErrors err;
+			measureGLErrors(subset, encodings[e], interleaved != 0, err);
+			cout << names[e] << ", decoded by OpenGL from " << (interleaved ? "an interleaved buffer" : "separate buffers") << ":" << endl;
+			passed = checkErrors(err, normal_bound[e], (e == 0 ? 0.0f : texcoord_bound), (e == 0 ? 0.0f : color_bound)) && passed;
+		}
+	}
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+	cout << "built without OpenGL tests, the OpenGL decode is skipped" << endl;
+	return TEST_SKIPPED;
+#endif
+}
@@ -50,6 +50,7 @@ protected:
      */
     virtual void create(void)
     {
+        initGL();
         // declare and generate a buffer object name
         glGenBuffers(1, &buffer_id);
         bind();
@@ -102,7 +103,7 @@ public:
      */
     virtual void bind (void)
     {
-        glBindBuffer(buffer_type, buffer_id);
+        glState().bindBuffer(buffer_type, buffer_id);
     }
 
     /**
@@ -112,14 +113,14 @@ public:
     void bindBase (int index)
     {
         binding_point = index;
-        glBindBufferBase(buffer_type, binding_point, buffer_id);
+        glState().bindBufferBase(buffer_type, binding_point, buffer_id);
     }
 
     /**
      * @brief Unbinds buffer from binding point.
      */
     void unbindBase (void) {
-        glBindBufferBase(buffer_type, binding_point, 0);
+        glState().bindBufferBase(buffer_type, binding_point, 0);
         binding_point = -1;
     }
 
@@ -128,7 +129,7 @@ public:
      */
     virtual void unbind(void)
     {
-        glBindBuffer(buffer_type, 0);
+        glState().bindBuffer(buffer_type, 0);
     }
 
     /**
@@ -223,6 +224,37 @@ public:
     AtomicBuffer (int s) : BufferObject<GLuint>(s, GL_ATOMIC_COUNTER_BUFFER) {}
 };
 
+/**
+ * @brief A Uniform Buffer object (inherited from BufferObject), holding the values of a GLSL uniform block.
+ *
+ * The size is given in bytes and the contents must follow the block layout (usually std140).
+ * Bind it to the binding point of the block with bindBase, and bind the block of each shader to
+ * the same point with Shader::setUniformBlockBinding.
+ */
+class UniformBuffer : public BufferObject <GLubyte>
+{
+
+public:
+    /**
+     * @brief Uniform Buffer constructor.
+     * @param s Size of buffer in bytes.
+     */
+    UniformBuffer (int s) : BufferObject<GLubyte>(s, GL_UNIFORM_BUFFER) {}
+
+    /**
+     * @brief Uploads a range of the buffer.
+     * @param data Values, laid out as the uniform block.
+     * @param bytes Number of bytes to upload.
+     * @param offset Offset in bytes of the first value in the buffer.
+     */
+    void update (const void* data, int bytes, int offset = 0)
+    {
+        bind();
+        glBufferSubData(buffer_type, offset, bytes, data);
+        unbind();
+    }
+};
+
 /**
  * @brief The buffer object of thype ShaderStorageBuffer with Float elements
  */
@@ -68,15 +68,6 @@ protected:
     /// Format as defined by OpenGL (ex. GL_RGBA, GL_RGBA_INTEGER ...)
     GLenum format;
 
-    /**
-     * @brief Flag to indicate if buffer is binded or not
-     *
-     * In operations where the buffer needs to be binded (such as read, clear, etc)
-     * it will be automatically binded and then unbided if flag is not currently binded,
-     * otherwise, if it was already binded, it will be left binded.
-     */
-    bool is_binded;
-
 public:
 
     /**
@@ -95,7 +86,6 @@ public:
         texture_type(textype), internal_format(int_frm), pixel_type(pix_type), format(frm)
     {
         fbo_id = 0;
-        is_binded = false;
         fboTextures.clear();
         create(w, h, num_buffers);
     }
@@ -106,7 +96,6 @@ public:
     Framebuffer (void) : texture_type(GL_TEXTURE_2D), internal_format(GL_RGBA32F), pixel_type(GL_UNSIGNED_BYTE), format(GL_RGBA)
     {
         fbo_id = 0;
-        is_binded = false;
         size = Eigen::Vector2i(0,0);
     }
 
@@ -149,7 +138,7 @@ public:
 
         if(fbo_id)
         {
-            glDeleteFramebuffers(1, &fbo_id);
+            glState().deleteFramebuffer(fbo_id);
         }
 
         if(depthbuffer)
@@ -213,14 +202,11 @@ public:
 
     /**
      * @brief Binds framebuffer object.
+     * Nothing is issued if it is already bound (see GLState).
      */
     virtual void bind (void)
     {
-        if (!is_binded)
-        {
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo_id);
-        }
-        is_binded = true;
+        glState().bindFramebuffer(GL_FRAMEBUFFER, fbo_id);
     }
 
     /**
@@ -230,7 +216,7 @@ public:
     virtual void bindRenderBuffer (GLuint attachID)
     {
         bind();
-        glDrawBuffer(GL_COLOR_ATTACHMENT0+attachID);
+        glState().drawBuffer(GL_COLOR_ATTACHMENT0+attachID);
     }
 
     /**
@@ -242,7 +228,7 @@ public:
     {
         bind();
         GLenum buffers[2] = {GL_COLOR_ATTACHMENT0+attachID0, GL_COLOR_ATTACHMENT0+attachID1};
-        glDrawBuffers(2, buffers);
+        glState().drawBuffers(2, buffers);
     }
 
     /**
@@ -256,7 +242,7 @@ public:
         bind();
         GLenum buffers[3] = {GL_COLOR_ATTACHMENT0+attachID0, GL_COLOR_ATTACHMENT0+attachID1,
                              GL_COLOR_ATTACHMENT0+attachID2};
-        glDrawBuffers(3, buffers);
+        glState().drawBuffers(3, buffers);
     }
 
     /**
@@ -271,7 +257,7 @@ public:
         bind();
         GLenum buffers[4] = {GL_COLOR_ATTACHMENT0+attachID0, GL_COLOR_ATTACHMENT0+attachID1,
                              GL_COLOR_ATTACHMENT0+attachID2, GL_COLOR_ATTACHMENT0+attachID3};
-        glDrawBuffers(4, buffers);
+        glState().drawBuffers(4, buffers);
     }
 
     /**
@@ -289,7 +275,7 @@ public:
         GLenum buffers[5] = {GL_COLOR_ATTACHMENT0+attachID0, GL_COLOR_ATTACHMENT0+attachID1,
                              GL_COLOR_ATTACHMENT0+attachID2, GL_COLOR_ATTACHMENT0+attachID3,
                              GL_COLOR_ATTACHMENT0+attachID4};
-        glDrawBuffers(5, buffers);
+        glState().drawBuffers(5, buffers);
     }
 
     /**
@@ -308,7 +294,7 @@ public:
         GLenum buffers[6] = {GL_COLOR_ATTACHMENT0+attachID0, GL_COLOR_ATTACHMENT0+attachID1,
                              GL_COLOR_ATTACHMENT0+attachID2, GL_COLOR_ATTACHMENT0+attachID3,
                              GL_COLOR_ATTACHMENT0+attachID4, GL_COLOR_ATTACHMENT0+attachID5};
-        glDrawBuffers(6, buffers);
+        glState().drawBuffers(6, buffers);
     }
 
     /**
@@ -329,7 +315,7 @@ public:
                              GL_COLOR_ATTACHMENT0+attachID2, GL_COLOR_ATTACHMENT0+attachID3,
                              GL_COLOR_ATTACHMENT0+attachID4, GL_COLOR_ATTACHMENT0+attachID5,
                              GL_COLOR_ATTACHMENT0+attachID6};
-        glDrawBuffers(7, buffers);
+        glState().drawBuffers(7, buffers);
     }
 
     /**
@@ -351,7 +337,7 @@ public:
                              GL_COLOR_ATTACHMENT0+attachID2, GL_COLOR_ATTACHMENT0+attachID3,
                              GL_COLOR_ATTACHMENT0+attachID4, GL_COLOR_ATTACHMENT0+attachID5,
                              GL_COLOR_ATTACHMENT0+attachID6, GL_COLOR_ATTACHMENT0+attachID7};
-        glDrawBuffers(8, buffers);
+        glState().drawBuffers(8, buffers);
     }
 
     /**
@@ -362,7 +348,7 @@ public:
     virtual void bindRenderBuffers (GLsizei n, GLuint* buffers)
     {
         bind();
-        glDrawBuffers(n, buffers);
+        glState().drawBuffers(n, buffers);
     }
 
     /**
@@ -370,8 +356,7 @@ public:
      */
     virtual void unbindFBO (void)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        is_binded = false;
+        glState().bindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
     /**
@@ -381,7 +366,7 @@ public:
     {
         unbindFBO();
         unbindAttachments();
-        glDrawBuffer(GL_BACK);
+        glState().drawBuffer(GL_BACK);
     }
 
     /**
@@ -390,20 +375,20 @@ public:
      */
     void clearAttachments (Eigen::Vector4f clear_color = Eigen::Vector4f::Zero())
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
 
         bind();
         if (pixel_type == GL_RGBA32UI)
         {
-            glClearColor(0, 0, 0, 0);
+            glState().clearColor(0, 0, 0, 0);
         }
         else
         {
-            glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+            glState().clearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
         }
         for (unsigned int i = 0; i < fboTextures.size(); ++i)
         {
-            glDrawBuffer(GL_COLOR_ATTACHMENT0 + i);
+            glState().drawBuffer(GL_COLOR_ATTACHMENT0 + i);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         }
         if (!was_binded)
@@ -419,10 +404,10 @@ public:
      */
     void clearAttachment (int attachment, Eigen::Vector4f clear_color = Eigen::Vector4f::Zero())
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         bind();
-        glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
-        glDrawBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+        glState().clearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+        glState().drawBuffer(GL_COLOR_ATTACHMENT0 + attachment);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         if (!was_binded)
         {
@@ -435,7 +420,7 @@ public:
      */
     void clearDepth (void)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         bind();
         glClear(GL_DEPTH_BUFFER_BIT);
         if (!was_binded)
@@ -530,7 +515,7 @@ public:
      */
     Eigen::Vector4f readPixel (int attach,  Eigen::Vector2i pos)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         bind();
         glReadBuffer(GL_COLOR_ATTACHMENT0+attach);
         GLfloat pixel[4];
@@ -552,7 +537,7 @@ public:
      */
     void readBuffer (int attach_id,  GLfloat *pixels)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         if (pixels)
         {
             delete [] pixels;
@@ -577,7 +562,7 @@ public:
     */
     void readBuffer (int attach_id,  GLbyte * pixels)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         if (pixels)
         {
             delete [] pixels;
@@ -602,7 +587,7 @@ public:
      */
     void readBuffer (int attach_id,  unsigned char * pixels)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         if (pixels)
         {
             delete [] pixels;
@@ -627,7 +612,7 @@ public:
      */
     void readBuffer (int attach_id, vector<unsigned char>& pixels)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         pixels.clear();
         pixels.resize((int)(size[0]*size[1]*4));
         bind();
@@ -648,7 +633,7 @@ public:
      */
     void readBuffer (int attach_id, vector<float>& pixels)
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
         pixels.clear();
         pixels.resize((int)(size[0]*size[1]*4), 0.0);
         bind();
@@ -689,7 +674,7 @@ public:
 		out_stream << size[0] << " " << size[1] << "\n";
 		out_stream << "255\n";
 
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
 
         GLfloat * pixels = new GLfloat[(int)(size[0]*size[1]*4)];
         bind();
@@ -725,7 +710,7 @@ public:
      */
     void printBuffer (int attach, Eigen::Vector4f exception = Eigen::Vector4f(0.0,0.0,0.0,0.0) )
     {
-        bool was_binded = is_binded;
+        bool was_binded = isBinded();
 
         GLfloat * pixels = new GLfloat[(int)(size[0]*size[1]*4)];
         bind();
@@ -818,7 +803,7 @@ public:
      */
     bool isBinded (void)
     {
-        return is_binded;
+        return fbo_id != 0 && glState().getDrawFramebuffer() == fbo_id;
     }
 
 protected:
@@ -834,13 +819,12 @@ protected:
      */
     virtual void createFramebuffer (int viewportWidth, int viewportHeight, int numberOfTextures = 1)
     {
-        is_binded = false;
         // update dimensions
         size << viewportWidth, viewportHeight;
 
         //Creating Framebuffer:
         if(fbo_id) {
-            glDeleteFramebuffers(1, &fbo_id);
+            glState().deleteFramebuffer(fbo_id);
         }
         glGenFramebuffers(1, &fbo_id);
         bind();
@@ -884,9 +868,9 @@ protected:
     {
         fboTextures[attach_id].create(texture_type, internal_format, size[0], size[1], format, pixel_type);
 
-        glBindTexture(texture_type, fboTextures[attach_id].texID());
+        glState().bindTexture(texture_type, fboTextures[attach_id].texID());
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+attach_id, texture_type, fboTextures[attach_id].texID() , 0);
-        glBindTexture(texture_type, 0);
+        glState().bindTexture(texture_type, 0);
     }
 
 
@@ -0,0 +1,176 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __FRAMEUNIFORMS__
+#define __FRAMEUNIFORMS__
+
+#include "bufferobject.hpp"
+#include "camera.hpp"
+#include "glstate.hpp"
+#include <cstring>
+#include <Eigen/Dense>
+
+namespace Tucano
+{
+
+/// Binding point of the per frame uniform block.
+const GLuint FRAME_UNIFORMS_BINDING = 0;
+
+/// GLSL declaration of the per frame uniform block, its members are accessed by name as plain uniforms.
+const string frame_uniforms_block = ""
+        "layout(std140) uniform FrameUniforms\n"
+        "{\n"
+        "    mat4 projectionMatrix;\n"
+        "    mat4 viewMatrix;\n"
+        "    mat4 lightViewMatrix;\n"
+        "    vec4 viewport;\n"
+        "};\n";
+
+/**
+ * @brief Uniform buffer holding the camera and light data shared by all shaders in a frame.
+ *
+ * Shaders declare the FrameUniforms block (see frame_uniforms_block) instead of the projectionMatrix, viewMatrix and
+ * lightViewMatrix uniforms, and bind it once with attach. The buffer is filled from the camera and light with update,
+ * which only uploads when the data changed, so it can be called before every draw: the data is uploaded once per frame
+ * no matter how many shaders or objects are rendered.
+ */
+class FrameUniforms : public UniformBuffer, public GLStateResource
+{
+
+public:
+
+    /**
+     * @brief Contents of the uniform block, in std140 layout.
+     */
+    struct Block
+    {
+        /// Projection matrix, column major.
+        GLfloat projection_matrix[16];
+
+        /// View matrix, column major.
+        GLfloat view_matrix[16];
+
+        /// Light view matrix, column major.
+        GLfloat light_view_matrix[16];
+
+        /// Camera viewport (x, y, width, height).
+        GLfloat viewport[4];
+    };
+
+    /**
+     * @brief Default constructor, requires a current OpenGL context.
+     */
+    FrameUniforms (void) : UniformBuffer(sizeof(Block)), uploads(0), valid(false)
+    {
+    }
+
+    /**
+     * @brief Destructor, deletes the buffer, requires its context to be current.
+     */
+    virtual ~FrameUniforms (void)
+    {
+        glState().deleteBuffer(buffer_id);
+    }
+
+    /**
+     * @brief Fills the block from a camera and a light, uploading it if it changed, and binds the buffer to its binding point.
+     * @param camera Given camera
+     * @param light Given light camera
+     */
+    void update (const Camera& camera, const Camera& light)
+    {
+        Block current;
+        Eigen::Map<Eigen::Matrix4f>(current.projection_matrix) = camera.getProjectionMatrix();
+        Eigen::Map<Eigen::Matrix4f>(current.view_matrix) = camera.getViewMatrix().matrix();
+        Eigen::Map<Eigen::Matrix4f>(current.light_view_matrix) = light.getViewMatrix().matrix();
+        Eigen::Map<Eigen::Vector4f>(current.viewport) = camera.getViewport();
+
+        if (!valid || memcmp(&current, &block, sizeof(Block)) != 0)
+        {
+            UniformBuffer::update(&current, sizeof(Block));
+            block = current;
+            valid = true;
+            uploads++;
+        }
+        bindBase(FRAME_UNIFORMS_BINDING);
+    }
+
+    /**
+     * @brief Returns the last uploaded block.
+     * @return Block contents.
+     */
+    const Block& getBlock (void) const
+    {
+        return block;
+    }
+
+    /**
+     * @brief Returns the number of uploads since the buffer was created.
+     * @return Number of uploads.
+     */
+    size_t getNumberOfUploads (void) const
+    {
+        return uploads;
+    }
+
+    /**
+     * @brief Binds the FrameUniforms block of a shader to the frame binding point, also after reloads.
+     * @param shader Given shader
+     * @return True if the linked shader declares the block.
+     */
+    static bool attach (Shader& shader)
+    {
+        return shader.setUniformBlockBinding("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    }
+
+private:
+
+    /// Last uploaded block.
+    Block block;
+
+    /// Number of uploads.
+    size_t uploads;
+
+    /// False until the first upload.
+    bool valid;
+};
+
+/**
+ * @brief Returns the frame uniform buffer shared by the effects and shapes of the current context.
+ * It is created on first use and owned by the state tracker of the context (see glState), so it is deleted with it.
+ * @return Shared frame uniforms.
+ */
+inline FrameUniforms& sharedFrameUniforms (void)
+{
+    GLState& state = glState();
+    FrameUniforms* frame_uniforms = static_cast<FrameUniforms*>(state.getResource("FrameUniforms"));
+    if (!frame_uniforms)
+    {
+        frame_uniforms = new FrameUniforms();
+        state.setResource("FrameUniforms", frame_uniforms);
+    }
+    return *frame_uniforms;
+}
+
+}
+#endif
@@ -0,0 +1,699 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __GLSTATE__
+#define __GLSTATE__
+
+#include "tucano.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Counters of state changes requested through a GLState.
+ *
+ * Issued counts GL calls sent to OpenGL, elided counts requests skipped because the state already had the value.
+ */
+struct GLStateStatistics
+{
+    /// Number of GL calls issued.
+    size_t issued;
+
+    /// Number of redundant calls elided.
+    size_t elided;
+
+    GLStateStatistics (void) : issued(0), elided(0) {}
+};
+
+/**
+ * @brief Base of the objects owned by the tracker of a context, see GLState::setResource.
+ */
+class GLStateResource
+{
+public:
+    virtual ~GLStateResource (void) {}
+};
+
+/**
+ * @brief Tracker of the OpenGL state of one context, eliding calls that would not change it.
+ *
+ * Tucano classes bind programs, vertex arrays, framebuffers, textures and buffers, set the viewport, clear color
+ * and draw buffers, and enable capabilities through the tracker of the current context (see glState), so effects
+ * can set the state they need before every draw without issuing redundant calls.
+ *
+ * The tracker only knows the state changed through it. Code changing the same state directly, for example a
+ * toolkit binding its own framebuffer before painting, must call invalidate afterwards.
+ * Objects must be deleted through the tracker (deleteBuffer, deleteTexture, ...), since OpenGL unbinds deleted
+ * objects and their names may be reused.
+ * The tracker also owns the objects shared by everything rendered in its context, such as the frame uniforms, and
+ * deletes them with itself: destroy the tracker while its context is still current.
+ */
+class GLState : public GLObject
+{
+
+public:
+
+    /// Value of a state not known by the tracker, the next request for it is always issued.
+    static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+    /**
+     * @brief Default constructor, requires a current OpenGL context. All state starts unknown.
+     */
+    GLState (void)
+    {
+        initGL();
+        invalidate();
+    }
+
+    /**
+     * @brief Destructor, deletes the owned resources, requires the context of the tracker to be current.
+     * glState returns the default tracker again if this one was current.
+     */
+    ~GLState (void)
+    {
+        // the resources delete their objects through this tracker
+        GLState* previous = currentPointer();
+        currentPointer() = this;
+        for (unsigned int i = 0; i < resources.size(); ++i)
+            delete resources[i].second;
+        currentPointer() = (previous == this) ? NULL : previous;
+    }
+
+    /**
+     * @brief Forgets all tracked state, the next request for each state is issued.
+     * Call after OpenGL state was changed without the tracker.
+     */
+    void invalidate (void)
+    {
+        program = UNKNOWN;
+        vertex_array = UNKNOWN;
+        draw_framebuffer = UNKNOWN;
+        read_framebuffer = UNKNOWN;
+        active_texture = UNKNOWN;
+        viewport_known = false;
+        clear_color_known = false;
+        capabilities.clear();
+        textures.clear();
+        buffers.clear();
+        indexed_buffers.clear();
+        draw_buffers.clear();
+    }
+
+    /**
+     * @brief Makes this tracker the one returned by glState.
+     * Applications with several contexts keep one tracker per context, and make it current with its context
+     * (the Qt widgets do it before painting and resizing).
+     */
+    void makeCurrent (void)
+    {
+        currentPointer() = this;
+    }
+
+    /**
+     * @brief Returns the tracker of the current context.
+     * A default tracker is created the first time, for applications with a single context. It is never destroyed,
+     * since there is no context left at exit: its resources are released with the context.
+     * @return Current tracker.
+     */
+    static GLState& current (void)
+    {
+        GLState*& state = currentPointer();
+        if (!state)
+        {
+            static GLState* default_state = new GLState();
+            state = default_state;
+        }
+        return *state;
+    }
+
+    /**
+     * @brief Returns a resource owned by this tracker.
+     * @param name Name the resource was given to setResource.
+     * @return The resource, or NULL if there is none with this name.
+     */
+    GLStateResource* getResource (const string& name) const
+    {
+        for (unsigned int i = 0; i < resources.size(); ++i)
+        {
+            if (resources[i].first == name)
+                return resources[i].second;
+        }
+        return NULL;
+    }
+
+    /**
+     * @brief Gives a resource to this tracker, which deletes it with itself (or when replaced by another one).
+     * @param name Name of the resource.
+     * @param resource Resource created in the context of this tracker.
+     */
+    void setResource (const string& name, GLStateResource* resource)
+    {
+        for (unsigned int i = 0; i < resources.size(); ++i)
+        {
+            if (resources[i].first == name)
+            {
+                if (resources[i].second != resource)
+                    delete resources[i].second;
+                resources[i].second = resource;
+                return;
+            }
+        }
+        resources.push_back(make_pair(name, resource));
+    }
+
+    /**
+     * @brief Returns the counters of issued and elided calls since the last reset.
+     *
+     * Reset once per frame with resetStatistics to get per frame counts.
+     * @return Call counters.
+     */
+    const GLStateStatistics& getStatistics (void) const
+    {
+        return statistics;
+    }
+
+    /**
+     * @brief Resets the counters of issued and elided calls.
+     */
+    void resetStatistics (void)
+    {
+        statistics = GLStateStatistics();
+    }
+
+    //============================ Program and vertex array ==========================================
+
+    /**
+     * @brief Makes a program current (glUseProgram).
+     * @param id Program name, 0 for none.
+     */
+    void useProgram (GLuint id)
+    {
+        if (!changed(program, id))
+            return;
+        glUseProgram(id);
+    }
+
+    /**
+     * @brief Binds a vertex array object (glBindVertexArray).
+     * The element array buffer binding belongs to the vertex array, so it becomes unknown when the vertex array changes.
+     * @param id Vertex array name, 0 for none.
+     */
+    void bindVertexArray (GLuint id)
+    {
+        if (!changed(vertex_array, id))
+            return;
+        glBindVertexArray(id);
+        forgetBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    }
+
+    /**
+     * @brief Deletes a vertex array object, which is unbound if current.
+     * @param id Vertex array name.
+     */
+    void deleteVertexArray (GLuint id)
+    {
+        glDeleteVertexArrays(1, &id);
+        if (vertex_array == id)
+        {
+            vertex_array = 0;
+            forgetBuffer(GL_ELEMENT_ARRAY_BUFFER);
+        }
+    }
+
+    //============================ Framebuffers ======================================================
+
+    /**
+     * @brief Binds a framebuffer object (glBindFramebuffer).
+     * @param target GL_FRAMEBUFFER (draw and read), GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER.
+     * @param id Framebuffer name, 0 for the default framebuffer.
+     */
+    void bindFramebuffer (GLenum target, GLuint id)
+    {
+        bool draw = (target != GL_READ_FRAMEBUFFER);
+        bool read = (target != GL_DRAW_FRAMEBUFFER);
+        if ((!draw || draw_framebuffer == id) && (!read || read_framebuffer == id))
+        {
+            ++statistics.elided;
+            return;
+        }
+        glBindFramebuffer(target, id);
+        ++statistics.issued;
+        if (draw)
+            draw_framebuffer = id;
+        if (read)
+            read_framebuffer = id;
+    }
+
+    /**
+     * @brief Returns the framebuffer bound for drawing.
+     * @return Framebuffer name, or UNKNOWN.
+     */
+    GLuint getDrawFramebuffer (void) const
+    {
+        return draw_framebuffer;
+    }
+
+    /**
+     * @brief Deletes a framebuffer object, the default framebuffer is bound instead if it was bound.
+     * @param id Framebuffer name.
+     */
+    void deleteFramebuffer (GLuint id)
+    {
+        glDeleteFramebuffers(1, &id);
+        if (draw_framebuffer == id)
+            draw_framebuffer = 0;
+        if (read_framebuffer == id)
+            read_framebuffer = 0;
+        for (unsigned int i = 0; i < draw_buffers.size(); ++i)
+        {
+            if (draw_buffers[i].first == id)
+            {
+                draw_buffers.erase(draw_buffers.begin() + i);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Selects the color buffer drawn into, for the bound draw framebuffer (glDrawBuffer).
+     * @param buffer Color buffer (ex. GL_COLOR_ATTACHMENT0 or GL_BACK).
+     */
+    void drawBuffer (GLenum buffer)
+    {
+        vector<GLenum>* current = drawBuffersOf(draw_framebuffer);
+        if (current && current->size() == 1 && (*current)[0] == buffer)
+        {
+            ++statistics.elided;
+            return;
+        }
+        glDrawBuffer(buffer);
+        ++statistics.issued;
+        if (current)
+            current->assign(1, buffer);
+    }
+
+    /**
+     * @brief Selects the color buffers drawn into, for the bound draw framebuffer (glDrawBuffers).
+     * @param n Number of buffers.
+     * @param attachments Color buffers (ex. GL_COLOR_ATTACHMENT0 + i).
+     */
+    void drawBuffers (GLsizei n, const GLenum* attachments)
+    {
+        vector<GLenum>* current = drawBuffersOf(draw_framebuffer);
+        if (current && current->size() == (size_t)n && equal(attachments, attachments + n, current->begin()))
+        {
+            ++statistics.elided;
+            return;
+        }
+        glDrawBuffers(n, attachments);
+        ++statistics.issued;
+        if (current)
+            current->assign(attachments, attachments + n);
+    }
+
+    //============================ Fixed state =======================================================
+
+    /**
+     * @brief Sets the viewport (glViewport).
+     * @param x Left corner.
+     * @param y Bottom corner.
+     * @param width Width.
+     * @param height Height.
+     */
+    void viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        if (viewport_known && current_viewport[0] == x && current_viewport[1] == y && current_viewport[2] == width && current_viewport[3] == height)
+        {
+            ++statistics.elided;
+            return;
+        }
+        glViewport(x, y, width, height);
+        ++statistics.issued;
+        current_viewport[0] = x; current_viewport[1] = y; current_viewport[2] = width; current_viewport[3] = height;
+        viewport_known = true;
+    }
+
+    /**
+     * @brief Sets the clear color (glClearColor).
+     * @param r Red.
+     * @param g Green.
+     * @param b Blue.
+     * @param a Alpha.
+     */
+    void clearColor (GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+    {
+        if (clear_color_known && current_clear_color[0] == r && current_clear_color[1] == g && current_clear_color[2] == b && current_clear_color[3] == a)
+        {
+            ++statistics.elided;
+            return;
+        }
+        glClearColor(r, g, b, a);
+        ++statistics.issued;
+        current_clear_color[0] = r; current_clear_color[1] = g; current_clear_color[2] = b; current_clear_color[3] = a;
+        clear_color_known = true;
+    }
+
+    /**
+     * @brief Enables a capability (glEnable).
+     * @param cap Capability (ex. GL_DEPTH_TEST).
+     */
+    void enable (GLenum cap)
+    {
+        setCapability(cap, true);
+    }
+
+    /**
+     * @brief Disables a capability (glDisable).
+     * @param cap Capability (ex. GL_DEPTH_TEST).
+     */
+    void disable (GLenum cap)
+    {
+        setCapability(cap, false);
+    }
+
+    /**
+     * @brief Enables or disables a capability.
+     * @param cap Capability (ex. GL_DEPTH_TEST).
+     * @param flag True to enable.
+     */
+    void setCapability (GLenum cap, bool flag)
+    {
+        vector< pair<GLenum, bool> >::iterator it = capabilities.begin();
+        while (it != capabilities.end() && it->first != cap)
+            ++it;
+        if (it != capabilities.end() && it->second == flag)
+        {
+            ++statistics.elided;
+            return;
+        }
+        if (flag)
+            glEnable(cap);
+        else
+            glDisable(cap);
+        ++statistics.issued;
+        if (it == capabilities.end())
+            capabilities.push_back(make_pair(cap, flag));
+        else
+            it->second = flag;
+    }
+
+    //============================ Textures ==========================================================
+
+    /**
+     * @brief Selects the active texture unit (glActiveTexture).
+     * @param unit Texture unit index, starting at zero.
+     */
+    void activeTexture (GLuint unit)
+    {
+        if (!changed(active_texture, unit))
+            return;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    /**
+     * @brief Binds a texture to a texture unit, making the unit active if the texture is not already bound to it.
+     * @param unit Texture unit index, starting at zero.
+     * @param target Texture target (ex. GL_TEXTURE_2D).
+     * @param id Texture name, 0 to unbind.
+     */
+    void bindTexture (GLuint unit, GLenum target, GLuint id)
+    {
+        TextureBinding* binding = textureBinding(unit, target);
+        if (binding->id == id)
+        {
+            ++statistics.elided;
+            return;
+        }
+        activeTexture(unit);
+        glBindTexture(target, id);
+        ++statistics.issued;
+        binding->id = id;
+    }
+
+    /**
+     * @brief Binds a texture to the active texture unit, used for creating and updating textures.
+     * @param target Texture target (ex. GL_TEXTURE_2D).
+     * @param id Texture name, 0 to unbind.
+     */
+    void bindTexture (GLenum target, GLuint id)
+    {
+        if (active_texture == UNKNOWN)
+        {
+            glBindTexture(target, id);
+            ++statistics.issued;
+            return;
+        }
+        bindTexture(active_texture, target, id);
+    }
+
+    /**
+     * @brief Deletes a texture, which is unbound from all units.
+     * @param id Texture name.
+     */
+    void deleteTexture (GLuint id)
+    {
+        glDeleteTextures(1, &id);
+        for (unsigned int i = 0; i < textures.size(); ++i)
+        {
+            if (textures[i].id == id)
+                textures[i].id = 0;
+        }
+    }
+
+    //============================ Buffers ===========================================================
+
+    /**
+     * @brief Binds a buffer to a target (glBindBuffer).
+     * The GL_ELEMENT_ARRAY_BUFFER binding is recorded by the bound vertex array object.
+     * @param target Buffer target (ex. GL_ARRAY_BUFFER).
+     * @param id Buffer name, 0 to unbind.
+     */
+    void bindBuffer (GLenum target, GLuint id)
+    {
+        vector< pair<GLenum, GLuint> >::iterator it = buffers.begin();
+        while (it != buffers.end() && it->first != target)
+            ++it;
+        if (it != buffers.end() && it->second == id)
+        {
+            ++statistics.elided;
+            return;
+        }
+        glBindBuffer(target, id);
+        ++statistics.issued;
+        if (it == buffers.end())
+            buffers.push_back(make_pair(target, id));
+        else
+            it->second = id;
+    }
+
+    /**
+     * @brief Binds a buffer to an indexed binding point (glBindBufferBase), also binding it to the generic target.
+     * @param target Buffer target (ex. GL_UNIFORM_BUFFER).
+     * @param index Binding point.
+     * @param id Buffer name, 0 to unbind.
+     */
+    void bindBufferBase (GLenum target, GLuint index, GLuint id)
+    {
+        for (unsigned int i = 0; i < indexed_buffers.size(); ++i)
+        {
+            if (indexed_buffers[i].target == target && indexed_buffers[i].index == index)
+            {
+                if (indexed_buffers[i].id == id)
+                {
+                    ++statistics.elided;
+                    return;
+                }
+                indexed_buffers.erase(indexed_buffers.begin() + i);
+                break;
+            }
+        }
+        glBindBufferBase(target, index, id);
+        ++statistics.issued;
+        IndexedBufferBinding binding = {target, index, id};
+        indexed_buffers.push_back(binding);
+        forgetBuffer(target);
+        buffers.push_back(make_pair(target, id));
+    }
+
+    /**
+     * @brief Deletes a buffer, which is unbound from all targets and binding points.
+     * @param id Buffer name.
+     */
+    void deleteBuffer (GLuint id)
+    {
+        glDeleteBuffers(1, &id);
+        for (unsigned int i = 0; i < buffers.size(); ++i)
+        {
+            if (buffers[i].second == id)
+                buffers[i].second = 0;
+        }
+        for (unsigned int i = 0; i < indexed_buffers.size(); ++i)
+        {
+            if (indexed_buffers[i].id == id)
+                indexed_buffers[i].id = 0;
+        }
+    }
+
+private:
+
+    /// Texture bound to a target of a texture unit.
+    struct TextureBinding
+    {
+        GLuint unit;
+        GLenum target;
+        GLuint id;
+    };
+
+    /// Buffer bound to an indexed binding point.
+    struct IndexedBufferBinding
+    {
+        GLenum target;
+        GLuint index;
+        GLuint id;
+    };
+
+    /// Current program.
+    GLuint program;
+
+    /// Bound vertex array object.
+    GLuint vertex_array;
+
+    /// Framebuffer bound for drawing.
+    GLuint draw_framebuffer;
+
+    /// Framebuffer bound for reading.
+    GLuint read_framebuffer;
+
+    /// Active texture unit index.
+    GLuint active_texture;
+
+    /// Current viewport, valid if viewport_known.
+    GLint current_viewport[4];
+    bool viewport_known;
+
+    /// Current clear color, valid if clear_color_known.
+    GLfloat current_clear_color[4];
+    bool clear_color_known;
+
+    /// State of the capabilities set so far.
+    vector< pair<GLenum, bool> > capabilities;
+
+    /// Textures bound so far, per unit and target.
+    vector< TextureBinding > textures;
+
+    /// Buffer bound to each target.
+    vector< pair<GLenum, GLuint> > buffers;
+
+    /// Buffers bound to indexed binding points.
+    vector< IndexedBufferBinding > indexed_buffers;
+
+    /// Draw buffers set for each framebuffer.
+    vector< pair<GLuint, vector<GLenum> > > draw_buffers;
+
+    /// Counters of issued and elided calls.
+    GLStateStatistics statistics;
+
+    /// Resources owned by the tracker, by name.
+    vector< pair<string, GLStateResource*> > resources;
+
+    /// Holds the tracker returned by current.
+    static GLState*& currentPointer (void)
+    {
+        static GLState* state = NULL;
+        return state;
+    }
+
+    /**
+     * @brief Updates a tracked value and counts the request.
+     * @return True if the value changed and the call must be issued.
+     */
+    bool changed (GLuint& state, GLuint value)
+    {
+        if (state == value)
+        {
+            ++statistics.elided;
+            return false;
+        }
+        state = value;
+        ++statistics.issued;
+        return true;
+    }
+
+    /// Makes the binding of a buffer target unknown.
+    void forgetBuffer (GLenum target)
+    {
+        for (unsigned int i = 0; i < buffers.size(); ++i)
+        {
+            if (buffers[i].first == target)
+            {
+                buffers.erase(buffers.begin() + i);
+                return;
+            }
+        }
+    }
+
+    /// Returns the tracked binding of a texture unit target, created as unknown if not tracked yet.
+    TextureBinding* textureBinding (GLuint unit, GLenum target)
+    {
+        for (unsigned int i = 0; i < textures.size(); ++i)
+        {
+            if (textures[i].unit == unit && textures[i].target == target)
+                return &textures[i];
+        }
+        TextureBinding binding = {unit, target, UNKNOWN};
+        textures.push_back(binding);
+        return &textures.back();
+    }
+
+    /// Returns the tracked draw buffers of a framebuffer, created empty if not tracked yet, or NULL if the framebuffer is unknown.
+    vector<GLenum>* drawBuffersOf (GLuint framebuffer)
+    {
+        if (framebuffer == UNKNOWN)
+            return NULL;
+        for (unsigned int i = 0; i < draw_buffers.size(); ++i)
+        {
+            if (draw_buffers[i].first == framebuffer)
+                return &draw_buffers[i].second;
+        }
+        draw_buffers.push_back(make_pair(framebuffer, vector<GLenum>()));
+        return &draw_buffers.back().second;
+    }
+
+};
+
+/**
+ * @brief Returns the state tracker of the current context, see GLState.
+ * @return Current tracker.
+ */
+inline GLState& glState (void)
+{
+    return GLState::current();
+}
+
+}
+#endif
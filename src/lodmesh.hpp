@@ -0,0 +1,287 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __LODMESH__
+#define __LODMESH__
+
+#include "mesh.hpp"
+#include "camera.hpp"
+#include "utils/meshsimplifier.hpp"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Mesh with several levels of detail chosen per frame from their projected error.
+ *
+ * All levels share the vertex attributes of the mesh and are stored one after the other in a single index buffer,
+ * so switching levels only changes the range given to the draw call.
+ * Before rendering with a camera, the level is chosen as the coarsest one whose geometric error, projected at the
+ * nearest point of the bounding sphere, stays under a budget in pixels. A coarser level is only taken when it stays
+ * under a fraction of the budget (hysteresis), so the level does not flicker when the error is close to the budget.
+ */
+class LodMesh : public Mesh {
+
+public:
+
+    /**
+     * @brief Default Constructor.
+     */
+    LodMesh (void) : current_level(0), pixel_error(1.0), hysteresis(0.25)
+    {
+    }
+
+    /**
+     * @brief Loads the levels of detail in the index buffer.
+     *
+     * The vertex attributes must be loaded separately (see uploadMeshData), the levels index them.
+     * @param lods Levels from the finest to the coarsest, as built by MeshImporter::buildLodChain.
+     */
+    void loadLevels (const vector<LodLevel>& lods)
+    {
+        levels.clear();
+        vector<GLuint> all;
+        for (unsigned int i = 0; i < lods.size(); ++i)
+        {
+            Level level;
+            level.first = all.size();
+            level.count = lods[i].indices.size();
+            level.error = lods[i].error;
+            levels.push_back(level);
+            all.insert(all.end(), lods[i].indices.begin(), lods[i].indices.end());
+        }
+        loadIndices(all);
+        current_level = 0;
+    }
+
+    /**
+     * @brief Builds the levels of detail of a triangle mesh and loads them in the index buffer.
+     * @param data Mesh arrays, the vertex attributes must be uploaded from the same arrays.
+     * @param targets Stopping criteria of each level after the first, see MeshImporter::defaultLodTargets.
+     * @param report If not null receives the timing of the simplification.
+     */
+    void buildLevels (const MeshData& data, const vector<LodTarget>& targets, SimplificationReport* report = 0)
+    {
+        vector<LodLevel> lods;
+        MeshImporter::buildLodChain(data.vertices, data.indices, targets, lods, report);
+        loadLevels(lods);
+    }
+
+    /**
+     * @brief Returns the number of levels of detail.
+     * @return Number of levels, zero if none was loaded.
+     */
+    int getNumberOfLevels (void) const
+    {
+        return (int)levels.size();
+    }
+
+    /**
+     * @brief Returns the current level of detail.
+     * @return Index of the level drawn by render, 0 is the finest.
+     */
+    int getLevel (void) const
+    {
+        return current_level;
+    }
+
+    /**
+     * @brief Forces the level of detail drawn by render.
+     * @param level Index of the level, clamped to the loaded levels.
+     */
+    void setLevel (int level)
+    {
+        current_level = max(0, min(level, (int)levels.size()-1));
+    }
+
+    /**
+     * @brief Returns the number of triangles of a level.
+     * @param level Index of the level.
+     * @return Number of triangles.
+     */
+    size_t getLevelTriangles (int level) const
+    {
+        return levels[level].count / 3;
+    }
+
+    /**
+     * @brief Returns the geometric error of a level, in object space.
+     * @param level Index of the level.
+     * @return Geometric error.
+     */
+    float getLevelError (int level) const
+    {
+        return levels[level].error;
+    }
+
+    /**
+     * @brief Sets the largest projected error allowed.
+     * @param pixels Error budget in pixels.
+     */
+    void setPixelError (float pixels)
+    {
+        pixel_error = pixels;
+    }
+
+    /**
+     * @brief Returns the largest projected error allowed.
+     * @return Error budget in pixels.
+     */
+    float getPixelError (void) const
+    {
+        return pixel_error;
+    }
+
+    /**
+     * @brief Sets the hysteresis of the level selection.
+     *
+     * A coarser level is only chosen when its projected error is below (1 - fraction) times the budget.
+     * @param fraction Fraction of the budget, 0 disables the hysteresis.
+     */
+    void setHysteresis (float fraction)
+    {
+        hysteresis = fraction;
+    }
+
+    /**
+     * @brief Returns the number of pixels covered by one object space unit at the nearest point of the bounding sphere.
+     *
+     * Uses the tight bounding sphere transformed by the model matrix, the camera view and projection and the viewport height.
+     * For a perspective camera the projection scale is Camera::getPerspectiveScale divided by the distance.
+     * @param camera Camera used for rendering.
+     * @return Pixels per object space unit.
+     */
+    float pixelsPerUnit (const Camera& camera) const
+    {
+        Eigen::Affine3f model_view = camera.getViewMatrix() * model_matrix;
+        Eigen::Matrix4f projection = camera.getProjectionMatrix();
+
+        // model matrix scale, for the radius and the error
+        Eigen::Matrix3f linear = model_view.linear();
+        float view_scale = max(linear.col(0).norm(), max(linear.col(1).norm(), linear.col(2).norm()));
+
+        // clip w at the nearest point of the sphere: the depth for a perspective projection, one for an orthographic one
+        Eigen::Vector3f center = model_view * sphere_center;
+        float depth = max(-center.z() - sphere_radius * view_scale, camera.getNearPlane());
+        float w = -projection(3,2) * depth + projection(3,3);
+        if (w <= 0.0)
+            return numeric_limits<float>::max();
+
+        return 0.5f * camera.getViewport()[3] * projection(1,1) * view_scale / w;
+    }
+
+    /**
+     * @brief Chooses the level of detail for a camera.
+     *
+     * Refines while the projected error of the current level is over the budget, otherwise coarsens while the
+     * next level stays under the budget reduced by the hysteresis.
+     * @param camera Camera used for rendering.
+     * @return Chosen level, also set as the current level.
+     */
+    int selectLevel (const Camera& camera)
+    {
+        if (levels.empty())
+            return 0;
+
+        float pixels = pixelsPerUnit(camera);
+        int level = current_level;
+        while (level > 0 && levels[level].error * pixels > pixel_error)
+            --level;
+        if (level == current_level)
+        {
+            float coarsen = pixel_error * (1.0f - hysteresis);
+            while (level+1 < (int)levels.size() && levels[level+1].error * pixels <= coarsen)
+                ++level;
+        }
+        current_level = level;
+        return level;
+    }
+
+    /**
+     * @brief Chooses the level of detail for a camera and renders it.
+     * @param camera Camera used for rendering.
+     */
+    virtual void render (const Camera& camera)
+    {
+        selectLevel(camera);
+        render();
+    }
+
+    /**
+     * @brief Renders the current level of detail.
+     */
+    virtual void render (void)
+    {
+        Mesh::render();
+    }
+
+    /**
+     * @brief Draws the triangles of the current level.
+     * @param gl_element Primitive type.
+     */
+    virtual void renderElements (GLenum gl_element = GL_TRIANGLES)
+    {
+        if (levels.empty())
+        {
+            Mesh::renderElements(gl_element);
+            return;
+        }
+        const Level& level = levels[current_level];
+        glDrawElements(gl_element, level.count, index_type, (GLvoid*)(level.first * VertexAttribute::typeSize(index_type)));
+    }
+
+protected:
+
+    /// Range of a level in the index buffer.
+    struct Level
+    {
+        /// Index of the first index of the level.
+        size_t first;
+
+        /// Number of indices.
+        size_t count;
+
+        /// Geometric error in object space.
+        float error;
+    };
+
+    /// Levels from the finest to the coarsest.
+    vector<Level> levels;
+
+    /// Level drawn by render.
+    int current_level;
+
+    /// Largest projected error allowed, in pixels.
+    float pixel_error;
+
+    /// Fraction of the budget kept as margin before coarsening.
+    float hysteresis;
+};
+
+}
+#endif
@@ -25,12 +25,19 @@
 
 #include "model.hpp"
 #include "shader.hpp"
+#include "vertexencoding.hpp"
+#include "utils/parallel.hpp"
+#include <cstring>
+#include <memory>
 
 using namespace std;
 
 namespace Tucano
 {
 
+/// Index value ending the current strip or fan when primitive restart is enabled (see Mesh::setPrimitiveRestart).
+const GLuint PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+
 /**
  * @brief A vertex attribute of a mesh.
  *
@@ -54,16 +61,24 @@ private:
     GLenum type;
     /// Type of attribute array (GL_ARRAY_BUFFER for most cases), indices are GL_ELEMENT_ARRAY_BUFFER
     GLenum array_type;
+    /// Distance in bytes between consecutive attributes in the buffer, 0 if tightly packed
+    GLsizei stride;
+    /// Offset in bytes of the first attribute in the buffer
+    size_t offset;
+    /// If true integer values are normalized to [0,1] (unsigned) or [-1,1] (signed) when fetched
+    bool normalized;
+    /// Number of instances sharing one value of the attribute, 0 for per vertex attributes
+    GLuint divisor;
 
 public:
 
-    VertexAttribute() : name(""), size(0), element_size(0), location(-1), bufferID(0), type(GL_FLOAT), array_type(GL_ARRAY_BUFFER)
+    VertexAttribute() : name(""), size(0), element_size(0), location(-1), bufferID(0), type(GL_FLOAT), array_type(GL_ARRAY_BUFFER), stride(0), offset(0), normalized(false), divisor(0)
 	{
 		initGL();
 	}
 
     VertexAttribute(string in_name, int in_num_elements, int in_element_size, GLenum in_type, GLenum in_array_type = GL_ARRAY_BUFFER) :
-        name(in_name), size(in_num_elements), element_size(in_element_size), type(in_type), array_type (in_array_type)
+        name(in_name), size(in_num_elements), element_size(in_element_size), type(in_type), array_type (in_array_type), stride(0), offset(0), normalized(false), divisor(0)
     {
         location = -1;
 
@@ -73,6 +88,17 @@ public:
         glGenBuffers(1, &bufferID);
     }
 
+    /**
+     * @brief Creates an attribute stored in an existing buffer, shared with other attributes (interleaved layout).
+     * No buffer is created, the attribute reads its values from the given buffer with the given stride and offset.
+     */
+    VertexAttribute(string in_name, int in_num_elements, int in_element_size, GLenum in_type, GLuint in_buffer_id, GLsizei in_stride, size_t in_offset, bool in_normalized = false) :
+        name(in_name), size(in_num_elements), element_size(in_element_size), location(-1), bufferID(in_buffer_id), type(in_type), array_type (GL_ARRAY_BUFFER),
+        stride(in_stride), offset(in_offset), normalized(in_normalized), divisor(0)
+    {
+		initGL();
+    }
+
     /// copy constructor
     VertexAttribute(const VertexAttribute& copy)
     {
@@ -85,6 +111,10 @@ public:
         this->bufferID = copy.bufferID;
         this->type = copy.type;
         this->array_type = copy.array_type;
+        this->stride = copy.stride;
+        this->offset = copy.offset;
+        this->normalized = copy.normalized;
+        this->divisor = copy.divisor;
     }
 
     /// Destructor. Note that deleting the buffer here, will delete a buffer of a original attribute if by chance you copy
@@ -94,7 +124,7 @@ public:
     void destroy(void)
     {
         if (bufferID != 0)
-            glDeleteBuffers(1, &bufferID);
+            glState().deleteBuffer(bufferID);
     }
 
     /**
@@ -134,6 +164,59 @@ public:
      */
     void setArrayType (GLenum at) {array_type = at;}
 
+    /**
+     * @brief Returns the distance in bytes between consecutive attributes in the buffer
+     * @return Stride, 0 if the attributes are tightly packed
+     */
+    GLsizei getStride (void) const {return stride;}
+
+    /**
+     * @brief Returns the offset in bytes of the first attribute in the buffer
+     * @return Offset, 0 unless the buffer is shared with other attributes
+     */
+    size_t getOffset (void) const {return offset;}
+
+    /**
+     * @brief Returns wether integer values are normalized when fetched by the shader
+     * @return True if normalized
+     */
+    bool isNormalized (void) const {return normalized;}
+
+    /**
+     * @brief Sets wether integer values are normalized when fetched by the shader
+     * (ex. colors stored as GL_UNSIGNED_BYTE are read as [0,1] floats)
+     * @param flag True to normalize
+     */
+    void setNormalized (bool flag) {normalized = flag;}
+
+    /**
+     * @brief Returns the attribute divisor
+     * @return Number of instances sharing one value, 0 if the attribute advances per vertex
+     */
+    GLuint getDivisor (void) const {return divisor;}
+
+    /**
+     * @brief Sets the attribute divisor, making it a per instance attribute when non zero
+     * (ex. with divisor 1 the attribute advances once per instance in an instanced draw call)
+     * @param d Number of instances sharing one value, 0 for per vertex attributes
+     */
+    void setDivisor (GLuint d) {divisor = d;}
+
+    /**
+     * @brief Returns the number of consecutive shader locations used by the attribute
+     * Matrices are fed to the shader as one vector per column: 3 for a mat3 (9 components),
+     * 4 for a mat4 (16 components), 1 for scalars and vectors.
+     * @return Number of locations
+     */
+    int getNumberOfColumns (void) const
+    {
+        if (element_size <= 4)
+            return 1;
+        if (element_size == 9)
+            return 3;
+        return element_size / 4;
+    }
+
     /**
      * @brief Returns the location of the attribute.
      * The location is usually set by the shader, since it can be used by different
@@ -149,43 +232,227 @@ public:
      */
     void setLocation(GLint loc) {location = loc;}
 
+    /**
+     * @brief Returns wether another attribute is fed to the shader exactly as this one.
+     * Compares everything a vertex array object records: location, buffer, layout and divisor.
+     * @param other Attribute to compare with
+     * @return True if both attributes produce the same vertex array state
+     */
+    bool sameBinding (const VertexAttribute& other) const
+    {
+        return location == other.location && bufferID == other.bufferID && element_size == other.element_size && type == other.type
+            && stride == other.stride && offset == other.offset && normalized == other.normalized && divisor == other.divisor;
+    }
+
     /**
      * @brief Returns the id of the vertex array of this attribute
      * @return Buffer ID
      */
     GLuint getBufferID (void) {return bufferID;}
 
+    /**
+     * @brief Returns the size in bytes of one component of the attribute
+     * @return Size of one component (ex. 4 for GL_FLOAT)
+     */
+    int getTypeSize (void) const
+    {
+        return typeSize(type);
+    }
+
+    /**
+     * @brief Returns the size in bytes of a component type
+     * @param component_type Component type (ex. GL_FLOAT)
+     * @return Size of one component
+     */
+    static int typeSize (GLenum component_type)
+    {
+        switch (component_type)
+        {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE:
+                return 1;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:
+                return 2;
+            case GL_DOUBLE:
+                return 8;
+            default:
+                return 4;
+        }
+    }
+
+    /**
+     * @brief Returns the size in bytes of one attribute with a given type and number of components
+     * Packed types (ex. GL_INT_2_10_10_10_REV) hold all components in 4 bytes.
+     * @param component_type Component type (ex. GL_FLOAT)
+     * @param components Number of components
+     * @return Size of one attribute
+     */
+    static int elementBytes (GLenum component_type, int components)
+    {
+        if (component_type == GL_INT_2_10_10_10_REV || component_type == GL_UNSIGNED_INT_2_10_10_10_REV)
+            return 4;
+        return components * typeSize(component_type);
+    }
+
+    /**
+     * @brief Returns the size in bytes of one attribute
+     * @return Size of one attribute (ex. 12 for a vec3 of floats)
+     */
+    int getElementBytes (void) const
+    {
+        return elementBytes(type, element_size);
+    }
+
+    /**
+     * @brief Returns the size in bytes of the whole attribute array
+     * For attributes sharing an interleaved buffer this is the size of the attribute values only.
+     * @return Size of the attribute values
+     */
+    size_t getSizeInBytes (void) const
+    {
+        return (size_t)size * getElementBytes();
+    }
+
     /// Bind the attribute
     void bind(void)
     {
-        glBindBuffer(array_type, bufferID);
+        glState().bindBuffer(array_type, bufferID);
+    }
+
+    /**
+     * @brief Allocates uninitialized storage for the whole attribute array.
+     * The content can be filled later, possibly in several steps, with update.
+     * Only for attributes owning a tightly packed buffer.
+     * @param usage Buffer usage hint
+     */
+    void allocate (GLenum usage = GL_STATIC_DRAW)
+    {
+        bind();
+        glBufferData(array_type, getSizeInBytes(), NULL, usage);
+        unbind();
+    }
+
+    /**
+     * @brief Replaces the whole attribute array, resizing the buffer storage if necessary.
+     * The storage is reallocated only when the number of attributes changes,
+     * otherwise the values are overwritten in place.
+     * Only for attributes owning a tightly packed buffer.
+     * @param count New number of attributes
+     * @param data Pointer to the attribute values, tightly packed
+     * @param usage Buffer usage hint used when the storage is reallocated
+     */
+    void load (int count, const GLvoid* data, GLenum usage = GL_DYNAMIC_DRAW)
+    {
+        bind();
+        if (count != size)
+        {
+            size = count;
+            glBufferData(array_type, getSizeInBytes(), data, usage);
+        }
+        else
+        {
+            glBufferSubData(array_type, 0, getSizeInBytes(), data);
+        }
+        unbind();
+    }
+
+    /**
+     * @brief Uploads a range of attributes to the buffer storage.
+     * The storage must have been allocated before.
+     * @param first Index of the first attribute to be written
+     * @param count Number of attributes to be written
+     * @param data Pointer to the attribute values, tightly packed
+     */
+    void update (int first, int count, const GLvoid* data)
+    {
+        size_t element_bytes = getElementBytes();
+        bind();
+        glBufferSubData(array_type, first*element_bytes, count*element_bytes, data);
+        unbind();
     }
 
     /// Bind the attribute to a given location
     void enable(GLint loc)
     {
         setLocation(loc);
-        glBindBuffer(array_type, bufferID);
-        glVertexAttribPointer(location, element_size, type, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(location);
+        enable();
     }
 
-    /// Binds the attribute to its location
+    /**
+     * @brief Binds the attribute to its location
+     * Matrix attributes are bound column by column to consecutive locations,
+     * and per instance attributes have their divisor set.
+     */
     void enable()
     {
         if (location != -1)
         {
-            glBindBuffer(array_type, bufferID);
-            glVertexAttribPointer(location, element_size, type, GL_FALSE, 0, NULL);
-            glEnableVertexAttribArray(location);
+            glState().bindBuffer(array_type, bufferID);
+            int columns = getNumberOfColumns();
+            if (columns == 1)
+            {
+                glVertexAttribPointer(location, element_size, type, normalized ? GL_TRUE : GL_FALSE, stride, (const GLvoid*)offset);
+                glEnableVertexAttribArray(location);
+            }
+            else
+            {
+                int rows = element_size / columns;
+                GLsizei column_stride = (stride == 0) ? getElementBytes() : stride;
+                for (int i = 0; i < columns; ++i)
+                {
+                    glVertexAttribPointer(location + i, rows, type, normalized ? GL_TRUE : GL_FALSE, column_stride, (const GLvoid*)(offset + i*rows*getTypeSize()));
+                    glEnableVertexAttribArray(location + i);
+                }
+            }
+            if (divisor != 0)
+                applyDivisor();
+        }
+    }
+
+    /**
+     * @brief Sets the divisor of the attribute locations in the bound vertex array
+     * The divisor is kept by the vertex array, so per vertex attributes reset it
+     * when their location was previously used by a per instance attribute.
+     */
+    void applyDivisor (void)
+    {
+        if (location != -1)
+        {
+            for (int i = 0; i < getNumberOfColumns(); ++i)
+                glVertexAttribDivisor(location + i, divisor);
         }
     }
 
 
+    /**
+     * @brief Reads back the whole attribute array from the buffer storage.
+     * @param data Pointer to a destination with at least getSizeInBytes() bytes
+     */
+    void read (GLvoid* data)
+    {
+        size_t value_size = getElementBytes();
+        bind();
+        if (stride == 0 || (size_t)stride == value_size)
+        {
+            glGetBufferSubData(array_type, offset, getSizeInBytes(), data);
+        }
+        else if (size > 0)
+        {
+            // interleaved, read the whole span and keep only this attribute
+            vector<char> span ((size_t)(size-1)*stride + value_size);
+            glGetBufferSubData(array_type, offset, span.size(), &span[0]);
+            for (int i = 0; i < size; ++i)
+                memcpy((char*)data + i*value_size, &span[(size_t)i*stride], value_size);
+        }
+        unbind();
+    }
+
     /// Unbind the attribute
     void unbind(void)
     {
-        glBindBuffer(array_type, 0);
+        glState().bindBuffer(array_type, 0);
     }
 
     /// Disables associated location if attribute has one
@@ -193,13 +460,34 @@ public:
     {
         if (location != -1)
         {
-            glDisableVertexAttribArray(location);
+            for (int i = 0; i < getNumberOfColumns(); ++i)
+                glDisableVertexAttribArray(location + i);
         }
     }
 
 
 };
 
+/**
+ * @brief Counters of vertex array binds of a mesh.
+ *
+ * Attribute bindings are recorded once in a vertex array object, so after the first draw
+ * binding a mesh costs a constant number of GL calls regardless of its number of attributes.
+ */
+struct VertexArrayStatistics
+{
+    /// Number of times the mesh buffers were bound.
+    size_t binds;
+
+    /// Number of times attribute bindings were recorded in a vertex array object.
+    size_t records;
+
+    /// Number of GL calls made by bindBuffers and unbindBuffers, before redundant ones are elided by GLState.
+    size_t gl_calls;
+
+    VertexArrayStatistics (void) : binds(0), records(0), gl_calls(0) {}
+};
+
 /**
  * @brief A common Mesh, usually containing triagles or points.
  *
@@ -221,12 +509,21 @@ public:
         numberOfNormals = 0;
         numberOfElements = 0;
         numberOfTexCoords = 0;
+        numberOfColors = 0;
 
         radius = 1.0;
         scale = 1.0;
 
-        vao_id = 0;
+        next_vertex_array = 0;
+        vertex_arrays_dirty = false;
         index_buffer_id = 0;
+
+        interleaved = false;
+        encoding = 0;
+
+        index_type = GL_UNSIGNED_INT;
+        smallest_index_type = GL_UNSIGNED_SHORT;
+        primitive_restart = false;
     }
 
     /**
@@ -267,24 +564,71 @@ public:
 
         for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
         {
-            vertex_attributes[i].destroy();
+            // interleaved attributes share one buffer, delete it only once
+            bool shared = false;
+            for (unsigned int j = 0; j < i && !shared; ++j)
+            {
+                shared = (vertex_attributes[j].getBufferID() == vertex_attributes[i].getBufferID());
+            }
+            if (!shared && !isSharedBuffer(vertex_attributes[i].getBufferID()))
+            {
+                vertex_attributes[i].destroy();
+            }
         }
         vertex_attributes.clear();
 
-        if (vao_id > 0)
-            glDeleteVertexArrays(1, &vao_id);
-		vao_id = 0;
+        deleteVertexArrays();
 
-        if (index_buffer_id > 0)
-            glDeleteBuffers(1, &index_buffer_id);
+        if (index_buffer_id > 0 && !isSharedBuffer(index_buffer_id))
+            glState().deleteBuffer(index_buffer_id);
 		index_buffer_id = 0;
 
+        shared_geometry.reset();
     }
 
     /**
-    * @brief Reset the whole mesh, including deleting buffers and cleaning arrays
+     * @brief Makes this mesh render the buffers of another mesh instead of its own.
+     *
+     * Attributes, index buffer, counts and bounds are copied from the source, no buffer is duplicated.
+     * The source is kept alive while this mesh uses its buffers, and the shared buffers are never deleted by this mesh.
+     * Only the VAO is per mesh, so both meshes must live in the same GL context (or share group).
+     * Attributes loaded afterwards are owned by this mesh as usual.
+     * @param source Mesh owning the buffers.
+     */
+    void shareGeometry (const shared_ptr<Mesh>& source)
+    {
+        deleteBuffers();
+        shared_geometry = source;
+
+        vertex_attributes = source->vertex_attributes;
+        resetLocations();
+        index_buffer_id = source->index_buffer_id;
+        index_type = source->index_type;
+        primitive_restart = source->primitive_restart;
+
+        numberOfVertices = source->numberOfVertices;
+        numberOfNormals = source->numberOfNormals;
+        numberOfElements = source->numberOfElements;
+        numberOfTexCoords = source->numberOfTexCoords;
+        numberOfColors = source->numberOfColors;
+
+        setBoundingInfo(source->getBoundingInfo());
+    }
+
+    /**
+     * @brief Returns the mesh whose buffers are rendered by this mesh, if any (see shareGeometry).
+     * @return Mesh owning the shared buffers, or an empty pointer if this mesh owns all its buffers.
+     */
+    shared_ptr<Mesh> getSharedGeometry (void) const
+    {
+        return shared_geometry;
+    }
+
+    /**
+    * @brief Deletes the buffers and clears the attribute counts, keeping the model matrix and the bounding volumes.
+    * Used to replace the content of a mesh that is already placed in the scene.
     */
-    void reset (void)
+    void clearGeometry (void)
     {
         deleteBuffers();
 
@@ -292,9 +636,22 @@ public:
         numberOfNormals = 0;
         numberOfElements = 0;
         numberOfTexCoords = 0;
+        numberOfColors = 0;
+        index_type = GL_UNSIGNED_INT;
+    }
+
+    /**
+    * @brief Reset the whole mesh, including deleting buffers and cleaning arrays
+    */
+    void reset (void)
+    {
+        clearGeometry();
 
         radius = 1.0;
         scale = 1.0;
+        bounding_box.setEmpty();
+        sphere_center = Eigen::Vector3f::Zero();
+        sphere_radius = 1.0;
 
 		resetModelMatrix();
     }
@@ -328,186 +685,919 @@ protected:
     /// Index Buffer
     GLuint index_buffer_id;
 
-    /// Vertex Array Object ID (VAO is just a descriptor, does not contain any data)
-    GLuint vao_id;
-
-public:
-
-    /**
-     * @brief Load vertices (x,y,z,w) and creates appropriate vertex attribute.
-     * The default attribute name is "in_Position".
-     * Computes bounding box and centroid and normalization factors (scale).
-     * @param vert Array of vertices.
-     */
-    void loadVertices (vector<Eigen::Vector4f> &vert)
-    {
+    /// Type of the indices in the index buffer (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+    GLenum index_type;
 
-        numberOfVertices = vert.size();
+    /// Smallest index type chosen when loading indices
+    GLenum smallest_index_type;
 
-        // creates new attribute and load vertex coordinates
-        createAttribute("in_Position", vert);
+    /// If true, PRIMITIVE_RESTART_INDEX in the index buffer starts a new primitive
+    bool primitive_restart;
 
-        // from now on we are just computing some information about the model such as bounding box, centroid ...
+    /// A Vertex Array Object together with the attribute bindings recorded in it
+    struct RecordedVertexArray
+    {
+        /// Vertex Array Object ID (VAO is just a descriptor, does not contain any data)
+        GLuint vao_id;
 
-        float xMax = 0; float xMin = 0; float yMax = 0; float yMin = 0; float zMax = 0; float zMin = 0;
+        /// Attributes as they were when the bindings were recorded
+        vector < VertexAttribute > attributes;
 
-        int temp = 0;
-        for(unsigned int i = 0; i < numberOfVertices*4; i+=4) {
+        /// Index buffer recorded in the VAO
+        GLuint index_buffer_id;
 
-            //X:
-            if(vert[temp][0] > xMax) {
-                xMax = vert[temp][0];
-            }
-            if(vert[temp][0] < xMin) {
-                xMin = vert[temp][0];
+        /**
+         * @brief Returns true if the VAO holds the bindings of the given attributes and index buffer.
+         */
+        bool matches (const vector < VertexAttribute >& current, GLuint current_index_buffer) const
+        {
+            if (index_buffer_id != current_index_buffer || attributes.size() != current.size())
+                return false;
+            for (unsigned int i = 0; i < current.size(); ++i)
+            {
+                if (!attributes[i].sameBinding(current[i]))
+                    return false;
             }
+            return true;
+        }
+    };
 
-            //Y:
-            if(vert[temp][1] > yMax) {
-                yMax = vert[temp][1];
-            }
-            if(vert[temp][1] < yMin) {
-                yMin = vert[temp][1];
-            }
+    /// Maximum number of VAOs kept by a mesh, one per set of attribute locations (usually one per shader)
+    enum {MAX_VERTEX_ARRAYS = 4};
 
-            //Z:
-            if(vert[temp][2] > zMax) {
-                zMax = vert[temp][2];
-            }
-            if(vert[temp][2] < zMin) {
-                zMin = vert[temp][2];
-            }
+    /// VAOs recorded for the attribute bindings used so far
+    vector < RecordedVertexArray > vertex_arrays;
 
-            //W:
-            temp++;
-        }
+    /// VAO slot recorded again when all MAX_VERTEX_ARRAYS are in use
+    unsigned int next_vertex_array;
 
-        scale = 1.0/max(max(xMax-xMin, yMax-yMin), zMax-zMin);
+    /// If true the VAOs are recorded again at the next bind, set when buffers are replaced
+    bool vertex_arrays_dirty;
 
-        float centerX = (xMax+xMin)/2.0;
-        float centerY = (yMax+yMin)/2.0;
-        float centerZ = (zMax+zMin)/2.0;
-        objectCenter = Eigen::Vector3f(centerX, centerY, centerZ);
+    /// Counters of VAO binds and records
+    VertexArrayStatistics vertex_array_statistics;
 
-        // compute the centroid (different from the box center)
-        centroid = Eigen::Vector3f::Zero();
-        for(unsigned int i = 0; i < numberOfVertices; i++) {
-            centroid = centroid + vert[i].head(3);//Eigen::Vector3f(vert[i][0], vert[i][1], vert[i][2]);
-        }
-        centroid = centroid / numberOfVertices;
+    /// Mesh owning the buffers rendered by this mesh, empty if the mesh owns all its buffers
+    shared_ptr<Mesh> shared_geometry;
 
-        // compute the radius of the bounding sphere
-        // most distance point from the centroid
-        radius = 0.0;
-        for(unsigned int i = 0; i < numberOfVertices; i++) {
-            radius = max(radius, ( vert[i].head(3) - centroid ).norm());
+    /**
+     * @brief Returns true if the buffer belongs to the shared geometry and must not be deleted by this mesh.
+     * @param id Buffer ID.
+     * @return True if the buffer is owned by the shared geometry.
+     */
+    bool isSharedBuffer (GLuint id)
+    {
+        if (!shared_geometry || id == 0)
+            return false;
+        if (id == shared_geometry->index_buffer_id)
+            return true;
+        for (unsigned int i = 0; i < shared_geometry->vertex_attributes.size(); ++i)
+        {
+            if (shared_geometry->vertex_attributes[i].getBufferID() == id)
+                return true;
         }
-
-        scale = 1.0/radius;
-
+        return false;
     }
 
     /**
-     * @brief Load normals (x,y,z) as a vertex attribute.
-     * @param norm Normals list.
+     * @brief Deletes all recorded VAOs, they are recorded again at the next bind.
      */
-    void loadNormals (vector<Eigen::Vector3f> &norm)
+    void deleteVertexArrays (void)
     {
-        numberOfNormals = norm.size();
-
-        createAttribute("in_Normal", norm);
+        for (unsigned int i = 0; i < vertex_arrays.size(); ++i)
+        {
+            glState().deleteVertexArray(vertex_arrays[i].vao_id);
+        }
+        vertex_arrays.clear();
+        next_vertex_array = 0;
     }
 
     /**
-     * @brief Load tex coords (u,v) as a vertex attribute.
-     * Optionally normalizes coords in range [0,1]
-     * @param tex Texture coordinates array.
-     * @param normalize If true normalizes the texcoords in range [0,1], otherwise does not normalize.
+     * @brief Records the current attribute bindings and index buffer in a VAO, and leaves it bound.
+     *
+     * A new VAO is created if less than MAX_VERTEX_ARRAYS exist, otherwise the oldest one is recorded again.
      */
-    void loadTexCoords (vector<Eigen::Vector2f> &tex, bool normalize = false)
+    void recordVertexArray (void)
     {
-        numberOfTexCoords = tex.size();
-
-        if (normalize)
+        unsigned int slot;
+        if (vertex_arrays.size() < MAX_VERTEX_ARRAYS)
         {
-            vector<Eigen::Vector2f> tex_normalized;
-
-            float texXmax = tex[0][0];
-            float texXmin = tex[0][0];
-            float texYmax = tex[0][1];
-            float texYmin = tex[0][1];
+            RecordedVertexArray va;
+            glGenVertexArrays(1, &va.vao_id);
+            vertex_arrays.push_back(va);
+            slot = vertex_arrays.size() - 1;
+            ++vertex_array_statistics.gl_calls;
+        }
+        else
+        {
+            slot = next_vertex_array;
+            next_vertex_array = (next_vertex_array + 1) % MAX_VERTEX_ARRAYS;
+        }
+        RecordedVertexArray& va = vertex_arrays[slot];
 
-            // compute min and max values for x and y
-            for(unsigned int i = 0; i < numberOfTexCoords; i++)
-            {
-                if (tex[i][0] < texXmin) texXmin = tex[i][0];
-                if (tex[i][0] > texXmax) texXmax = tex[i][0];
-                if (tex[i][1] < texYmin) texYmin = tex[i][1];
-                if (tex[i][1] > texYmax) texYmax = tex[i][1];
+        glState().bindVertexArray(va.vao_id);
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
+        vertex_array_statistics.gl_calls += 2;
 
-            }
-            for(unsigned int i = 0; i < numberOfTexCoords; i++)
-            {
-                tex_normalized.push_back ( Eigen::Vector2f(
-                                               (tex[i][0] - texXmin) / (texXmax - texXmin),
-                                           (tex[i][1] - texYmin) / (texYmax - texYmin) ) );
-            }
-            createAttribute("in_TexCoords", tex_normalized);
+        // locations enabled by the previous bindings of a reused VAO
+        for (unsigned int i = 0; i < va.attributes.size(); ++i)
+        {
+            va.attributes[i].disable();
+            if (va.attributes[i].getLocation() != -1)
+                vertex_array_statistics.gl_calls += va.attributes[i].getNumberOfColumns();
         }
-        else
+
+        // the divisor is part of the VAO state, per vertex attributes reset it as the location may have had one
+        for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
         {
-            createAttribute("in_TexCoords", tex);
+            vertex_attributes[i].enable();
+            if (vertex_attributes[i].getDivisor() == 0)
+                vertex_attributes[i].applyDivisor();
+            if (vertex_attributes[i].getLocation() != -1)
+                vertex_array_statistics.gl_calls += 1 + 3*vertex_attributes[i].getNumberOfColumns();
         }
+        glState().bindBuffer(GL_ARRAY_BUFFER, 0);
+        ++vertex_array_statistics.gl_calls;
+
+        va.attributes = vertex_attributes;
+        va.index_buffer_id = index_buffer_id;
+        ++vertex_array_statistics.records;
     }
 
+    /// If true the loaders pack position, normal, texcoord and color in a single interleaved buffer
+    bool interleaved;
+
+    /// Encoding flags of the standard attributes (ENCODE_* in vertexencoding.hpp), zero for floats
+    unsigned int encoding;
 
     /**
-     * @brief Load colors (r,g,b,a) as a vertex attribute.
-     * @param clrs Colors array.
+     * @brief Creates a standard attribute in the format selected by the encoding flags.
+     * Float formats are uploaded directly, other formats are encoded in a temporary array first.
+     * @param name Name of the attribute.
+     * @param attrib Array with new attribute.
+     * @param format Format of the attribute in the buffer.
+     * @param encode Function writing one encoded attribute.
+     * @return Pointer to created attribute
      */
-    void loadColors (vector<Eigen::Vector4f> &clrs)
+    template <class T, class Encoder>
+    VertexAttribute* createEncodedAttribute (string name, const vector<T> &attrib, const VertexFormat& format, Encoder encode)
     {
-        createAttribute("in_Color", clrs);
+        if (format.type == GL_FLOAT && format.bytes == (int)sizeof(T))
+        {
+            return createAttribute(name, attrib.size(), format.components, GL_FLOAT, attrib.data());
+        }
+        vector<char> encoded;
+        Misc::encodeArray(attrib, encoding, format.bytes, encode, encoded);
+        return createAttribute(name, attrib.size(), format.components, format.type, encoded.data(), format.normalized);
     }
 
+public:
 
     /**
-     * @brief Load indices into indices array
-     * @param ind Indices array.
+     * @brief Load vertices (x,y,z,w) and creates appropriate vertex attribute.
+     * The default attribute name is "in_Position".
+     * Computes bounding box and centroid and normalization factors (scale).
+     * @param vert Array of vertices.
      */
-    void loadIndices (vector<GLuint> &ind)
+    void loadVertices (const vector<Eigen::Vector4f> &vert)
     {
-        numberOfElements = ind.size();
 
-        GLuint *indices = new GLuint[ind.size()];
+        numberOfVertices = vert.size();
 
-        //Indices:
-        for(unsigned int i = 0; i < ind.size(); i++) {
-            indices[i] = ind[i];
-        }
+        // creates new attribute and load vertex coordinates
+        createEncodedAttribute("in_Position", vert, Misc::positionFormat(encoding), Misc::encodePosition);
 
-        glGenBuffers(1, &index_buffer_id);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, ind.size()*sizeof(GLuint), indices, GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        BoundingInfo info;
+        computeBoundingInfo(vert, info);
+        setBoundingInfo(info);
+    }
 
-        delete [] indices;
+    /**
+     * @brief Load vertices and release the array right after the upload.
+     * @param vert Array of vertices, empty on return.
+     */
+    void loadVertices (vector<Eigen::Vector4f> &&vert)
+    {
+        loadVertices(vert);
+        vector<Eigen::Vector4f>().swap(vert);
     }
 
     /**
-     * @brief Sets default attribute locations.
-     * vertex coords -> location 0
-     * normals -> location 1
-     * colors -> location 2
-     * texCoords -> location 3
+     * @brief Computes the bounding volumes of a set of vertices.
+     *
+     * The box and centroid are reduced in a first pass, the radius around the centroid and the tight sphere
+     * (Ritter's algorithm, seeded from the box) in a second one. Each pass is split among threads for large arrays,
+     * the spheres grown by each thread are then merged.
+     * Does not touch OpenGL or the mesh, so it can run on a worker thread.
+     * @param vert Array of vertices.
+     * @param info Receives the bounding volumes.
+     * @param tight_sphere If false the tight sphere is not computed and is set to the sphere around the centroid.
+     * @param num_threads Number of threads, if zero uses the number of hardware threads for large arrays.
      */
-    void setDefaultAttribLocations (void)
+    static void computeBoundingInfo (const vector<Eigen::Vector4f> &vert, BoundingInfo& info, bool tight_sphere = true, unsigned int num_threads = 0)
     {
-		resetLocations();
-        for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
+        info = BoundingInfo();
+        size_t n = vert.size();
+        if (n == 0)
+            return;
+
+        // small arrays are not worth the threads
+        const size_t min_vertices_per_thread = 1 << 16;
+        if (num_threads == 0)
+            num_threads = (unsigned int)min((size_t)Misc::defaultThreadCount(), n / min_vertices_per_thread + 1);
+
+        // first pass: box and sum of the vertices
+        struct Partial
         {
-            if (!vertex_attributes[i].getName().compare("in_Position"))
-            {
+            Eigen::Array4f lo, hi;
+            Eigen::Vector4d sum;
+        };
+        vector<Partial, Eigen::aligned_allocator<Partial> > partials (num_threads);
+        num_threads = Misc::parallelFor(n, [&](size_t begin, size_t end, unsigned int block)
+        {
+            Partial p;
+            p.lo = p.hi = vert[begin].array();
+            p.sum = Eigen::Vector4d::Zero();
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Eigen::Array4f v = vert[i].array();
+                p.lo = p.lo.min(v);
+                p.hi = p.hi.max(v);
+                p.sum += vert[i].cast<double>();
+            }
+            partials[block] = p;
+        }, num_threads);
+
+        Partial total = partials[0];
+        for (unsigned int t = 1; t < num_threads; ++t)
+        {
+            const Partial& p = partials[t];
+            total.lo = total.lo.min(p.lo);
+            total.hi = total.hi.max(p.hi);
+            total.sum += p.sum;
+        }
+
+        info.box = Eigen::AlignedBox3f(total.lo.head<3>().matrix(), total.hi.head<3>().matrix());
+        info.centroid = (total.sum.head<3>() / (double)n).cast<float>();
+
+        // the tight sphere starts at the box center, spanning the largest box side
+        Eigen::Vector3f seed_center = info.box.center();
+        float seed_radius = info.box.sizes().maxCoeff() * 0.5f;
+
+        // second pass: radius around the centroid and sphere growth, compared in squared distances
+        struct Spheres
+        {
+            float radius2;
+            Eigen::Vector3f center;
+            float radius;
+        };
+        vector<Spheres> spheres (num_threads);
+        Misc::parallelFor(n, [&](size_t begin, size_t end, unsigned int block)
+        {
+            Spheres s;
+            s.radius2 = 0.0;
+            s.center = seed_center;
+            s.radius = seed_radius;
+            const Eigen::Vector3f c = info.centroid;
+            if (!tight_sphere)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    s.radius2 = max(s.radius2, (vert[i].head<3>() - c).squaredNorm());
+            }
+            else
+            {
+                float r2 = s.radius * s.radius;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const Eigen::Vector3f v = vert[i].head<3>();
+                    s.radius2 = max(s.radius2, (v - c).squaredNorm());
+                    Eigen::Vector3f d = v - s.center;
+                    float d2 = d.squaredNorm();
+                    if (d2 > r2)
+                    {
+                        // grow the sphere just enough to touch the point, keeping the opposite side
+                        float dist = sqrt(d2);
+                        float new_radius = (s.radius + dist) * 0.5f;
+                        s.center += d * ((new_radius - s.radius) / dist);
+                        s.radius = new_radius;
+                        r2 = s.radius * s.radius;
+                    }
+                }
+            }
+            spheres[block] = s;
+        }, num_threads);
+
+        float radius2 = 0.0;
+        for (unsigned int t = 0; t < num_threads; ++t)
+            radius2 = max(radius2, spheres[t].radius2);
+        info.radius = sqrt(radius2);
+
+        if (!tight_sphere)
+        {
+            info.sphere_center = info.centroid;
+            info.sphere_radius = info.radius;
+            return;
+        }
+
+        // merge the spheres grown by each thread
+        info.sphere_center = spheres[0].center;
+        info.sphere_radius = spheres[0].radius;
+        for (unsigned int t = 1; t < num_threads; ++t)
+        {
+            Eigen::Vector3f d = spheres[t].center - info.sphere_center;
+            float dist = d.norm();
+            if (dist + spheres[t].radius <= info.sphere_radius)
+                continue;
+            if (dist + info.sphere_radius <= spheres[t].radius)
+            {
+                info.sphere_center = spheres[t].center;
+                info.sphere_radius = spheres[t].radius;
+                continue;
+            }
+            float new_radius = (dist + info.sphere_radius + spheres[t].radius) * 0.5f;
+            info.sphere_center += d * ((new_radius - info.sphere_radius) / dist);
+            info.sphere_radius = new_radius;
+        }
+
+        // never worse than the sphere around the centroid, and safe against rounding
+        if (info.radius <= info.sphere_radius)
+        {
+            info.sphere_center = info.centroid;
+            info.sphere_radius = info.radius;
+        }
+        info.sphere_radius *= 1.0f + 1e-6f;
+    }
+
+    /**
+     * @brief Computes the bounding information of a set of vertices.
+     *
+     * Does not touch OpenGL or the mesh, so it can run on a worker thread.
+     * @param vert Array of vertices.
+     * @param center Receives the center of the axis-aligned bounding box.
+     * @param centroid Receives the average of the vertices.
+     * @param radius Receives the radius of the bounding sphere around the centroid.
+     */
+    static void computeBoundingInfo (const vector<Eigen::Vector4f> &vert, Eigen::Vector3f& center, Eigen::Vector3f& centroid, float& radius)
+    {
+        BoundingInfo info;
+        computeBoundingInfo(vert, info, false);
+        center = info.box.isEmpty() ? Eigen::Vector3f(Eigen::Vector3f::Zero()) : info.box.center();
+        centroid = info.centroid;
+        radius = info.radius;
+    }
+
+    using Model::setBoundingInfo;
+
+    /**
+     * @brief Sets the bounding information of the mesh and the normalization scale.
+     *
+     * The box and tight sphere are set conservatively from the sphere around the centroid.
+     * @param center Center of the axis-aligned bounding box.
+     * @param center_of_mass Average of the vertices.
+     * @param bounding_radius Radius of the bounding sphere around the centroid.
+     */
+    void setBoundingInfo (const Eigen::Vector3f& center, const Eigen::Vector3f& center_of_mass, float bounding_radius)
+    {
+        setBoundingInfo(BoundingInfo(center, center_of_mass, bounding_radius));
+    }
+
+    /**
+     * @brief Load normals (x,y,z) as a vertex attribute.
+     * @param norm Normals list.
+     */
+    void loadNormals (const vector<Eigen::Vector3f> &norm)
+    {
+        numberOfNormals = norm.size();
+
+        createEncodedAttribute("in_Normal", norm, Misc::normalFormat(encoding), Misc::encodeNormal);
+    }
+
+    /**
+     * @brief Load normals and release the array right after the upload.
+     * @param norm Normals list, empty on return.
+     */
+    void loadNormals (vector<Eigen::Vector3f> &&norm)
+    {
+        loadNormals(norm);
+        vector<Eigen::Vector3f>().swap(norm);
+    }
+
+    /**
+     * @brief Load tex coords (u,v) as a vertex attribute.
+     * Optionally normalizes coords in range [0,1]
+     * @param tex Texture coordinates array.
+     * @param normalize If true normalizes the texcoords in range [0,1], otherwise does not normalize.
+     */
+    void loadTexCoords (const vector<Eigen::Vector2f> &tex, bool normalize = false)
+    {
+        numberOfTexCoords = tex.size();
+
+        if (normalize)
+        {
+            vector<Eigen::Vector2f> tex_normalized;
+            tex_normalized.reserve(numberOfTexCoords);
+
+            float texXmax = tex[0][0];
+            float texXmin = tex[0][0];
+            float texYmax = tex[0][1];
+            float texYmin = tex[0][1];
+
+            // compute min and max values for x and y
+            for(unsigned int i = 0; i < numberOfTexCoords; i++)
+            {
+                if (tex[i][0] < texXmin) texXmin = tex[i][0];
+                if (tex[i][0] > texXmax) texXmax = tex[i][0];
+                if (tex[i][1] < texYmin) texYmin = tex[i][1];
+                if (tex[i][1] > texYmax) texYmax = tex[i][1];
+
+            }
+            for(unsigned int i = 0; i < numberOfTexCoords; i++)
+            {
+                tex_normalized.push_back ( Eigen::Vector2f(
+                                               (tex[i][0] - texXmin) / (texXmax - texXmin),
+                                           (tex[i][1] - texYmin) / (texYmax - texYmin) ) );
+            }
+            createEncodedAttribute("in_TexCoords", tex_normalized, Misc::texCoordFormat(encoding), Misc::encodeTexCoord);
+        }
+        else
+        {
+            createEncodedAttribute("in_TexCoords", tex, Misc::texCoordFormat(encoding), Misc::encodeTexCoord);
+        }
+    }
+
+    /**
+     * @brief Load tex coords and release the array right after the upload.
+     * The normalization, if requested, is done in place instead of in a copy.
+     * @param tex Texture coordinates array, empty on return.
+     * @param normalize If true normalizes the texcoords in range [0,1], otherwise does not normalize.
+     */
+    void loadTexCoords (vector<Eigen::Vector2f> &&tex, bool normalize = false)
+    {
+        if (normalize && !tex.empty())
+        {
+            Eigen::Vector2f tex_min = tex[0];
+            Eigen::Vector2f tex_max = tex[0];
+            for (unsigned int i = 0; i < tex.size(); i++)
+            {
+                tex_min = tex_min.cwiseMin(tex[i]);
+                tex_max = tex_max.cwiseMax(tex[i]);
+            }
+            Eigen::Vector2f extent = tex_max - tex_min;
+            for (unsigned int i = 0; i < tex.size(); i++)
+            {
+                tex[i] = (tex[i] - tex_min).cwiseQuotient(extent);
+            }
+        }
+        loadTexCoords(tex, false);
+        vector<Eigen::Vector2f>().swap(tex);
+    }
+
+
+    /**
+     * @brief Load colors (r,g,b,a) as a vertex attribute.
+     * @param clrs Colors array.
+     */
+    void loadColors (const vector<Eigen::Vector4f> &clrs)
+    {
+        createEncodedAttribute("in_Color", clrs, Misc::colorFormat(encoding), Misc::encodeColor);
+    }
+
+    /**
+     * @brief Load colors and release the array right after the upload.
+     * @param clrs Colors array, empty on return.
+     */
+    void loadColors (vector<Eigen::Vector4f> &&clrs)
+    {
+        loadColors(clrs);
+        vector<Eigen::Vector4f>().swap(clrs);
+    }
+
+    /**
+     * @brief Load tangents as a vertex attribute (in_Tangent).
+     *
+     * The w component holds the bitangent sign, shaders rebuild the bitangent as cross(normal, tangent.xyz) * tangent.w.
+     * Tangents are stored as floats whatever the encoding (see MeshImporter::computeTangents).
+     * @param tang Tangents array.
+     */
+    void loadTangents (const vector<Eigen::Vector4f> &tang)
+    {
+        createAttribute("in_Tangent", tang);
+    }
+
+    /**
+     * @brief Load tangents and release the array right after the upload.
+     * @param tang Tangents array, empty on return.
+     */
+    void loadTangents (vector<Eigen::Vector4f> &&tang)
+    {
+        loadTangents(tang);
+        vector<Eigen::Vector4f>().swap(tang);
+    }
+
+
+    /**
+     * @brief Load indices into indices array
+     * @param ind Indices array.
+     */
+    void loadIndices (const vector<GLuint> &ind)
+    {
+        loadIndices(ind.data(), ind.size());
+    }
+
+    /**
+     * @brief Load indices and release the array right after the upload.
+     * @param ind Indices array, empty on return.
+     */
+    void loadIndices (vector<GLuint> &&ind)
+    {
+        loadIndices(ind);
+        vector<GLuint>().swap(ind);
+    }
+
+    /**
+     * @brief Selects the buffer layout used when loading meshes.
+     *
+     * With the interleaved layout, uploadMeshData (and thus the importers and MeshLoader) store position, normal,
+     * texcoord and color of each vertex contiguously in a single buffer, so a vertex fetch touches one buffer instead
+     * of one per attribute. Attribute names and locations are the same in both layouts, so effects work unchanged.
+     * Must be set before loading, it does not change the buffers already loaded.
+     * @param flag If true use the interleaved layout, otherwise one buffer per attribute (default).
+     */
+    void setInterleaved (bool flag)
+    {
+        interleaved = flag;
+    }
+
+    /**
+     * @brief Returns wether the loaders use the interleaved layout.
+     * @return True if attributes are packed in a single buffer.
+     */
+    bool isInterleaved (void) const
+    {
+        return interleaved;
+    }
+
+    /**
+     * @brief Selects compressed encodings for the standard attributes.
+     *
+     * The loaders (loadVertices, loadNormals, loadTexCoords, loadColors, and the interleaved layout) store the
+     * attributes in the formats selected by the flags (ENCODE_* in vertexencoding.hpp), with the normalized flag
+     * set accordingly. ENCODE_COMPACT needs no shader changes, octahedral normals must be decoded in the shader.
+     * Must be set before loading, it does not change the buffers already loaded.
+     * @param flags Bitwise or of ENCODE_* flags, zero for floats (default).
+     */
+    void setEncoding (unsigned int flags)
+    {
+        encoding = flags;
+    }
+
+    /**
+     * @brief Returns the encoding flags used by the loaders.
+     * @return Bitwise or of ENCODE_* flags.
+     */
+    unsigned int getEncoding (void) const
+    {
+        return encoding;
+    }
+
+    /**
+     * @brief Packs the standard attributes of each vertex contiguously.
+     *
+     * The order is position, normal, texcoord and color, each in the format selected by the encoding flags.
+     * Arrays whose size does not match the number of vertices are left out.
+     * @param vert Array of vertices.
+     * @param norm Normals, may be empty.
+     * @param tex Texture coordinates, may be empty.
+     * @param clrs Colors, may be empty.
+     * @param encoding Encoding flags (ENCODE_*).
+     * @param packed Receives the interleaved values.
+     * @return Number of bytes per vertex.
+     */
+    static int packInterleaved (const vector<Eigen::Vector4f> &vert, const vector<Eigen::Vector3f> &norm,
+                                const vector<Eigen::Vector2f> &tex, const vector<Eigen::Vector4f> &clrs,
+                                unsigned int encoding, vector<char> &packed)
+    {
+        size_t n = vert.size();
+        bool has_norm = (norm.size() == n), has_tex = (tex.size() == n), has_clrs = (clrs.size() == n);
+        int position_bytes = Misc::positionFormat(encoding).bytes;
+        int normal_bytes = has_norm ? Misc::normalFormat(encoding).bytes : 0;
+        int tex_bytes = has_tex ? Misc::texCoordFormat(encoding).bytes : 0;
+        int color_bytes = has_clrs ? Misc::colorFormat(encoding).bytes : 0;
+        int stride = position_bytes + normal_bytes + tex_bytes + color_bytes;
+
+        packed.resize(n * stride);
+        for (size_t i = 0; i < n; ++i)
+        {
+            char* p = &packed[i*stride];
+            Misc::encodePosition(vert[i], encoding, p); p += position_bytes;
+            if (has_norm)
+            {
+                Misc::encodeNormal(norm[i], encoding, p); p += normal_bytes;
+            }
+            if (has_tex)
+            {
+                Misc::encodeTexCoord(tex[i], encoding, p); p += tex_bytes;
+            }
+            if (has_clrs)
+            {
+                Misc::encodeColor(clrs[i], encoding, p);
+            }
+        }
+        return stride;
+    }
+
+    /**
+     * @brief Adds the attributes stored in an interleaved buffer filled with packInterleaved.
+     *
+     * The mesh takes ownership of the buffer.
+     * @param buffer_id Buffer holding the interleaved values.
+     * @param count Number of vertices.
+     * @param has_normals True if the buffer holds normals.
+     * @param has_texcoords True if the buffer holds texture coordinates.
+     * @param has_colors True if the buffer holds colors.
+     * @param packed_encoding Encoding flags used when packing, may differ from the current mesh encoding.
+     */
+    void addInterleavedAttributes (GLuint buffer_id, int count, bool has_normals, bool has_texcoords, bool has_colors, unsigned int packed_encoding)
+    {
+        VertexFormat formats[4] = {Misc::positionFormat(packed_encoding), Misc::normalFormat(packed_encoding),
+                                   Misc::texCoordFormat(packed_encoding), Misc::colorFormat(packed_encoding)};
+        const char* names[4] = {"in_Position", "in_Normal", "in_TexCoords", "in_Color"};
+        bool present[4] = {true, has_normals, has_texcoords, has_colors};
+
+        GLsizei stride = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (present[i])
+                stride += formats[i].bytes;
+        }
+
+        size_t offset = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (!present[i])
+                continue;
+            addAttribute(VertexAttribute(names[i], count, formats[i].components, formats[i].type, buffer_id, stride, offset, formats[i].normalized));
+            offset += formats[i].bytes;
+        }
+    }
+
+    /**
+     * @brief Loads position, normal, texcoord and color in a single interleaved buffer.
+     *
+     * Attributes are stored in the formats selected by setEncoding.
+     * Computes the bounding information like loadVertices. Arrays whose size does not match
+     * the number of vertices are ignored.
+     * @param vert Array of vertices.
+     * @param norm Normals, may be empty.
+     * @param tex Texture coordinates, may be empty.
+     * @param clrs Colors, may be empty.
+     */
+    void loadInterleaved (const vector<Eigen::Vector4f> &vert, const vector<Eigen::Vector3f> &norm,
+                          const vector<Eigen::Vector2f> &tex, const vector<Eigen::Vector4f> &clrs)
+    {
+        vector<char> packed;
+        int bytes_per_vertex = packInterleaved(vert, norm, tex, clrs, encoding, packed);
+
+        // the buffer is created through an attribute holding the whole packed array
+        VertexAttribute buffer ("interleaved", vert.size(), bytes_per_vertex, GL_UNSIGNED_BYTE);
+        buffer.bind();
+        glBufferData(GL_ARRAY_BUFFER, buffer.getSizeInBytes(), packed.data(), GL_STATIC_DRAW);
+        buffer.unbind();
+
+        addInterleavedAttributes(buffer.getBufferID(), vert.size(), norm.size() == vert.size(),
+                                 tex.size() == vert.size(), clrs.size() == vert.size(), encoding);
+
+        BoundingInfo info;
+        computeBoundingInfo(vert, info);
+        setBoundingInfo(info);
+    }
+
+    /**
+     * @brief Adds an attribute whose buffer was already created and filled elsewhere.
+     *
+     * The mesh takes ownership of the buffer, and deletes it with the other buffers.
+     * Used when the attribute content is uploaded in several steps, see MeshLoader.
+     * @param va Vertex attribute to be added.
+     * @return Pointer to added attribute
+     */
+    VertexAttribute* addAttribute (const VertexAttribute& va)
+    {
+        if (!va.getName().compare("in_Position"))
+            numberOfVertices = va.getSize();
+        else if (!va.getName().compare("in_Normal"))
+            numberOfNormals = va.getSize();
+        else if (!va.getName().compare("in_TexCoords"))
+            numberOfTexCoords = va.getSize();
+        else if (!va.getName().compare("in_Color"))
+            numberOfColors = va.getSize();
+
+        vertex_attributes.push_back(va);
+        vertex_arrays_dirty = true;
+        return &vertex_attributes.back();
+    }
+
+    /**
+     * @brief Sets the index buffer from an already filled buffer.
+     *
+     * The mesh takes ownership of the buffer, a previous index buffer is deleted.
+     * @param indices Attribute holding the index buffer (array type GL_ELEMENT_ARRAY_BUFFER), its type is used for drawing.
+     */
+    void setIndexBuffer (VertexAttribute& indices)
+    {
+        if (index_buffer_id > 0 && !isSharedBuffer(index_buffer_id))
+            glState().deleteBuffer(index_buffer_id);
+        index_buffer_id = indices.getBufferID();
+        vertex_arrays_dirty = true;
+        numberOfElements = indices.getSize();
+        index_type = indices.getType();
+    }
+
+    /**
+     * @brief Returns the smallest index type able to hold the given indices.
+     *
+     * The largest value of each type is kept free for primitive restart, and PRIMITIVE_RESTART_INDEX entries are ignored.
+     * @param ind Pointer to the first index.
+     * @param count Number of indices.
+     * @param smallest Smallest type to be chosen (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+     * @return Index type.
+     */
+    static GLenum chooseIndexType (const GLuint* ind, size_t count, GLenum smallest = GL_UNSIGNED_SHORT)
+    {
+        if (smallest == GL_UNSIGNED_INT)
+            return GL_UNSIGNED_INT;
+
+        GLuint max_index = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (ind[i] != PRIMITIVE_RESTART_INDEX && ind[i] > max_index)
+                max_index = ind[i];
+        }
+
+        if (max_index < 0xFF && smallest == GL_UNSIGNED_BYTE)
+            return GL_UNSIGNED_BYTE;
+        if (max_index < 0xFFFF)
+            return GL_UNSIGNED_SHORT;
+        return GL_UNSIGNED_INT;
+    }
+
+    /**
+     * @brief Converts indices to a smaller index type.
+     *
+     * PRIMITIVE_RESTART_INDEX entries become the largest value of the type, as expected by GL_PRIMITIVE_RESTART_FIXED_INDEX.
+     * @param ind Pointer to the first index.
+     * @param count Number of indices.
+     * @param type Index type returned by chooseIndexType.
+     * @param narrowed Receives the converted indices.
+     */
+    static void narrowIndices (const GLuint* ind, size_t count, GLenum type, vector<char> &narrowed)
+    {
+        int size = VertexAttribute::typeSize(type);
+        narrowed.resize(count * size);
+        if (type == GL_UNSIGNED_SHORT)
+        {
+            GLushort* out = (GLushort*)narrowed.data();
+            for (size_t i = 0; i < count; ++i)
+                out[i] = (GLushort)ind[i];
+        }
+        else if (type == GL_UNSIGNED_BYTE)
+        {
+            GLubyte* out = (GLubyte*)narrowed.data();
+            for (size_t i = 0; i < count; ++i)
+                out[i] = (GLubyte)ind[i];
+        }
+        else
+        {
+            memcpy(narrowed.data(), ind, count * size);
+        }
+    }
+
+    /**
+     * @brief Load indices from a contiguous array.
+     *
+     * The indices are stored with the smallest type able to hold them, see setSmallestIndexType.
+     * @param ind Pointer to the first index.
+     * @param count Number of indices.
+     */
+    void loadIndices (const GLuint* ind, size_t count)
+    {
+        numberOfElements = count;
+        index_type = chooseIndexType(ind, count, smallest_index_type);
+
+        vector<char> narrowed;
+        const GLvoid* data = ind;
+        if (index_type != GL_UNSIGNED_INT)
+        {
+            narrowIndices(ind, count, index_type, narrowed);
+            data = narrowed.data();
+        }
+
+        if (index_buffer_id > 0 && !isSharedBuffer(index_buffer_id))
+            glState().deleteBuffer(index_buffer_id);
+        glGenBuffers(1, &index_buffer_id);
+        vertex_arrays_dirty = true;
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count*VertexAttribute::typeSize(index_type), data, GL_STATIC_DRAW);
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    /**
+     * @brief Reads back the index buffer.
+     *
+     * Indices are widened to GLuint, primitive restart entries are returned as PRIMITIVE_RESTART_INDEX.
+     * @param ind Receives the indices, empty if the mesh has no index buffer.
+     */
+    void readIndices (vector<GLuint> &ind)
+    {
+        ind.resize(index_buffer_id > 0 ? numberOfElements : 0);
+        if (ind.empty())
+            return;
+
+        int size = VertexAttribute::typeSize(index_type);
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
+        glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, ind.size()*size, &ind[0]);
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        // widen in place, from the back so narrow values are read before being overwritten
+        if (index_type == GL_UNSIGNED_SHORT)
+        {
+            const GLushort* in = (const GLushort*)&ind[0];
+            for (size_t i = ind.size(); i-- > 0; )
+                ind[i] = (in[i] == 0xFFFF) ? PRIMITIVE_RESTART_INDEX : in[i];
+        }
+        else if (index_type == GL_UNSIGNED_BYTE)
+        {
+            const GLubyte* in = (const GLubyte*)&ind[0];
+            for (size_t i = ind.size(); i-- > 0; )
+                ind[i] = (in[i] == 0xFF) ? PRIMITIVE_RESTART_INDEX : in[i];
+        }
+    }
+
+    /**
+     * @brief Returns the type of the indices in the index buffer.
+     * @return GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+     */
+    GLenum getIndexType (void) const
+    {
+        return index_type;
+    }
+
+    /**
+     * @brief Sets the smallest index type chosen when indices are loaded.
+     *
+     * Defaults to GL_UNSIGNED_SHORT. GL_UNSIGNED_BYTE indices are allowed but are slow on some hardware,
+     * GL_UNSIGNED_INT keeps 32 bit indices. Only affects indices loaded afterwards.
+     * @param type GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+     */
+    void setSmallestIndexType (GLenum type)
+    {
+        smallest_index_type = type;
+    }
+
+    /**
+     * @brief Returns the smallest index type chosen when indices are loaded.
+     * @return GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+     */
+    GLenum getSmallestIndexType (void) const
+    {
+        return smallest_index_type;
+    }
+
+    /**
+     * @brief Enables or disables primitive restart.
+     *
+     * When enabled, PRIMITIVE_RESTART_INDEX entries in the loaded indices end the current strip or fan
+     * and start a new one, so several strips are drawn with a single call.
+     * @param flag True to enable primitive restart.
+     */
+    void setPrimitiveRestart (bool flag)
+    {
+        primitive_restart = flag;
+    }
+
+    /**
+     * @brief Returns true if primitive restart is enabled.
+     * @return True if enabled.
+     */
+    bool isPrimitiveRestartEnabled (void) const
+    {
+        return primitive_restart;
+    }
+
+    /**
+     * @brief Sets default attribute locations.
+     * vertex coords -> location 0
+     * normals -> location 1
+     * colors -> location 2
+     * texCoords -> location 3
+     * tangents -> location 4
+     */
+    void setDefaultAttribLocations (void)
+    {
+		resetLocations();
+        for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
+        {
+            if (!vertex_attributes[i].getName().compare("in_Position"))
+            {
                 vertex_attributes[i].setLocation(0);
             }
             else if (!vertex_attributes[i].getName().compare("in_Normal"))
@@ -522,6 +1612,10 @@ public:
             {
                 vertex_attributes[i].setLocation(3);
             }
+            else if (!vertex_attributes[i].getName().compare("in_Tangent"))
+            {
+                vertex_attributes[i].setLocation(4);
+            }
         }
     }
 
@@ -542,6 +1636,23 @@ public:
         return false;
     }
 
+    /**
+     * @brief Returns an attribute given its name.
+     * @param name Name of attribute to be queried.
+     * @return Pointer to the attribute, or NULL if it does not exist.
+     */
+    VertexAttribute* getAttribute (const string& name)
+    {
+        for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
+        {
+            if (!vertex_attributes[i].getName().compare(name))
+            {
+                return &vertex_attributes[i];
+            }
+        }
+        return NULL;
+    }
+
     /**
      * @brief Automatically sets the attribute locations for a given Shader.
      *
@@ -582,126 +1693,156 @@ public:
 
 
     /**
-     * @brief Creates and loads a new mesh attribute of 4 floats.
+     * @brief Creates and loads a new mesh attribute from a contiguous array.
      * @param name Name of the attribute.
-     * @param attrib Array with new attribute.
+     * @param count Number of attributes (usually number of vertices).
+     * @param element_size Number of components per attribute.
+     * @param type Type of each component (ex. GL_FLOAT).
+     * @param data Pointer to the tightly packed attribute values.
+     * @param normalized If true integer values are normalized when fetched by the shader.
      * @return Pointer to created attribute
      */
-    VertexAttribute* createAttribute (string name, vector<Eigen::Vector4f> &attrib)
+    VertexAttribute* createAttribute (string name, int count, int element_size, GLenum type, const GLvoid* data, bool normalized = false)
     {
-        // create new vertex attribute
-        VertexAttribute va (name, attrib.size(), 4, GL_FLOAT);
-        vertex_attributes.push_back(va);
-
-        float * attrib_array = new float[va.getSize()*va.getElementSize()];
-        int temp = 0;
-        for(int i = 0; i < va.getSize()*va.getElementSize(); i+=4) {
-            attrib_array[i] = attrib[temp][0];
-            attrib_array[i+1] = attrib[temp][1];
-            attrib_array[i+2] = attrib[temp][2];
-            attrib_array[i+3] = attrib[temp][3];
-            temp++;
-        }
+        VertexAttribute va (name, count, element_size, type);
+        va.setNormalized(normalized);
 
         // fill buffer with attribute data
         va.bind();
-        glBufferData(va.getArrayType(), va.getSize()*va.getElementSize()*sizeof(va.getType()), attrib_array, GL_STATIC_DRAW);
+        glBufferData(va.getArrayType(), va.getSizeInBytes(), data, GL_STATIC_DRAW);
         va.unbind();
 
-        delete [] attrib_array;
-        return &vertex_attributes.back();
+        return addAttribute(va);
+    }
 
+    /**
+     * @brief Creates and loads a new mesh attribute of 4 floats.
+     * The array is handed directly to the GL, no intermediate copy is made.
+     * @param name Name of the attribute.
+     * @param attrib Array with new attribute.
+     * @return Pointer to created attribute
+     */
+    VertexAttribute* createAttribute (string name, const vector<Eigen::Vector4f> &attrib)
+    {
+        return createAttribute(name, attrib.size(), 4, GL_FLOAT, attrib.data());
     }
 
     /**
      * @brief Creates and loads a new mesh attribute of 3 floats.
+     * The array is handed directly to the GL, no intermediate copy is made.
      * @param name Name of the attribute.
      * @param attrib Array with new attribute.
      * @return Pointer to created attribute
      */
-    VertexAttribute* createAttribute(string name, vector<Eigen::Vector3f> &attrib)
+    VertexAttribute* createAttribute(string name, const vector<Eigen::Vector3f> &attrib)
     {
-        // create new vertex attribute
-        VertexAttribute va (name, attrib.size(), 3, GL_FLOAT);
-        vertex_attributes.push_back(va);
-
-        float * attrib_array = new float[va.getSize()*va.getElementSize()];
-
-        int temp = 0;
-        for(int i = 0; i < va.getSize()*va.getElementSize(); i+=3) {
-            attrib_array[i] = attrib[temp][0];
-            attrib_array[i+1] = attrib[temp][1];
-            attrib_array[i+2] = attrib[temp][2];
-            temp++;
-        }
-
-        // fill buffer with attribute data
-        va.bind();
-        glBufferData(va.getArrayType(), va.getSize()*va.getElementSize()*sizeof(va.getType()), attrib_array, GL_STATIC_DRAW);
-        va.unbind();
-
-        delete [] attrib_array;
-        return &vertex_attributes.back();
+        return createAttribute(name, attrib.size(), 3, GL_FLOAT, attrib.data());
     }
 
     /**
      * @brief Creates and loads a new mesh attribute of 2 floats.
+     * The array is handed directly to the GL, no intermediate copy is made.
      * @param name Name of the attribute.
      * @param attrib Array with new attribute.
      * @return Pointer to created attribute
      */
-    VertexAttribute* createAttribute(string name, vector<Eigen::Vector2f> &attrib)
+    VertexAttribute* createAttribute(string name, const vector<Eigen::Vector2f> &attrib)
     {
-        // create new vertex attribute
-        VertexAttribute va (name, attrib.size(), 2, GL_FLOAT);
-        vertex_attributes.push_back(va);
-
-        float * attrib_array = new float[va.getSize()*va.getElementSize()];
+        return createAttribute(name, attrib.size(), 2, GL_FLOAT, attrib.data());
+    }
 
-        int temp = 0;
-        for(int i = 0; i < va.getSize()*va.getElementSize(); i+=2) {
-            attrib_array[i] = attrib[temp][0];
-            attrib_array[i+1] = attrib[temp][1];
-            temp++;
+    /**
+     * @brief Creates or updates a per instance attribute.
+     *
+     * The attribute advances once every divisor instances in the instanced draw calls
+     * (see renderInstanced and renderElementsInstanced) instead of once per vertex.
+     * If an attribute with the same name already exists its buffer is reused, and only
+     * reallocated when the number of instances changes, so it can be refreshed every frame.
+     * Matrices are passed with 16 (mat4) or 9 (mat3) components and read by the shader as a matrix attribute.
+     * @param name Name of the attribute.
+     * @param count Number of attribute values.
+     * @param element_size Number of components per value.
+     * @param type Type of each component (ex. GL_FLOAT).
+     * @param data Pointer to the tightly packed attribute values.
+     * @param divisor Number of consecutive instances sharing one value.
+     * @return Pointer to the attribute
+     */
+    VertexAttribute* loadInstanceAttribute (const string& name, int count, int element_size, GLenum type, const GLvoid* data, GLuint divisor = 1)
+    {
+        VertexAttribute* va = getAttribute(name);
+        if (va && (va->getElementSize() != element_size || va->getType() != type || isSharedBuffer(va->getBufferID())))
+        {
+            if (!isSharedBuffer(va->getBufferID()))
+                va->destroy();
+            vertex_attributes.erase(vertex_attributes.begin() + (va - &vertex_attributes[0]));
+            vertex_arrays_dirty = true;
+            va = NULL;
+        }
+        if (!va)
+        {
+            VertexAttribute instance_attrib (name, 0, element_size, type);
+            va = addAttribute(instance_attrib);
         }
+        va->setDivisor(divisor);
+        va->load(count, data);
+        return va;
+    }
 
-        // fill buffer with attribute data
-        va.bind();
-        glBufferData(va.getArrayType(), va.getSize()*va.getElementSize()*sizeof(va.getType()), attrib_array, GL_STATIC_DRAW);
-        va.unbind();
+    /**
+     * @brief Creates or updates a per instance attribute of 4x4 float matrices (ex. one model matrix per instance).
+     * @param name Name of the attribute.
+     * @param attrib Array of matrices.
+     * @param divisor Number of consecutive instances sharing one value.
+     * @return Pointer to the attribute
+     */
+    VertexAttribute* loadInstanceAttribute (const string& name, const vector<Eigen::Matrix4f> &attrib, GLuint divisor = 1)
+    {
+        return loadInstanceAttribute(name, attrib.size(), 16, GL_FLOAT, attrib.data(), divisor);
+    }
 
-        delete [] attrib_array;
-        return &vertex_attributes.back();
+    /**
+     * @brief Creates or updates a per instance attribute of 4 floats (ex. one color per instance).
+     * @param name Name of the attribute.
+     * @param attrib Array with the attribute values.
+     * @param divisor Number of consecutive instances sharing one value.
+     * @return Pointer to the attribute
+     */
+    VertexAttribute* loadInstanceAttribute (const string& name, const vector<Eigen::Vector4f> &attrib, GLuint divisor = 1)
+    {
+        return loadInstanceAttribute(name, attrib.size(), 4, GL_FLOAT, attrib.data(), divisor);
     }
 
 
     /**
      * @brief Binds all buffers.
      *
-     * If no Vertex Array has been generated yet, one will be created.
-     * If there is a index buffer it will also be binded.
-     * Then, binds one buffer for each vertex attribute.
+     * The attribute bindings (buffers, layouts, locations and divisors) and the index buffer are recorded
+     * once in a Vertex Array Object, later binds only bind it.
+     * A VAO is recorded again only when the bindings change, for example when setAttributeLocation
+     * gives an attribute a different location. Up to MAX_VERTEX_ARRAYS VAOs are kept, so a mesh
+     * rendered alternately with shaders having different attribute locations does not record at every bind.
      */
     virtual void bindBuffers (void) 
     {
-
-        if (vao_id == 0)
+        if (vertex_arrays_dirty)
         {
-            glGenVertexArrays(1, &vao_id);
+            deleteVertexArrays();
+            vertex_arrays_dirty = false;
         }
 
-        glBindVertexArray(vao_id); //Vertex Array Object
+        ++vertex_array_statistics.binds;
 
-        if (index_buffer_id > 0)
+        for (unsigned int i = 0; i < vertex_arrays.size(); ++i)
         {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
+            if (vertex_arrays[i].matches(vertex_attributes, index_buffer_id))
+            {
+                glState().bindVertexArray(vertex_arrays[i].vao_id);
+                ++vertex_array_statistics.gl_calls;
+                return;
+            }
         }
 
-        // bind generic attributes
-        for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
-        {
-            vertex_attributes[i].enable();
-        }
+        recordVertexArray();
 
         #ifdef TUCANODEBUG
         errorCheckFunc(__FILE__, __LINE__);
@@ -710,17 +1851,29 @@ public:
 
     /**
      * @brief Unbinds all buffers.
+     * The attribute bindings stay recorded in the VAO.
      */
     virtual void unbindBuffers (void) 
     {
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER,0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0);
+        glState().bindVertexArray(0);
+        ++vertex_array_statistics.gl_calls;
+    }
 
-        for (unsigned int i = 0; i < vertex_attributes.size(); ++i)
-        {
-            vertex_attributes[i].disable();
-        }
+    /**
+     * @brief Returns the counters of VAO binds, records and issued GL calls since the last reset.
+     * @return Vertex array counters.
+     */
+    const VertexArrayStatistics& getVertexArrayStatistics (void) const
+    {
+        return vertex_array_statistics;
+    }
+
+    /**
+     * @brief Resets the counters of VAO binds, records and issued GL calls.
+     */
+    void resetVertexArrayStatistics (void)
+    {
+        vertex_array_statistics = VertexArrayStatistics();
     }
 
     /**
@@ -737,14 +1890,37 @@ public:
      */
 	virtual void renderElements(GLenum gl_element = GL_TRIANGLES)
     {
+        if (primitive_restart)
+            glState().enable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+
+		glDrawElements(gl_element, numberOfElements, index_type, (GLvoid*)0);
 
-		glDrawElements(gl_element, numberOfElements, GL_UNSIGNED_INT, (GLvoid*)0);
+        if (primitive_restart)
+            glState().disable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    }
+
+    /**
+     * @brief Draws several instances of the indexed primitives with a single call.
+     * Per instance attributes (see loadInstanceAttribute) and gl_InstanceID distinguish the instances in the shader.
+     * The buffers must be bound (see bindBuffers).
+     * @param count Number of instances.
+     * @param gl_element Primitive type.
+     */
+    virtual void renderElementsInstanced (GLsizei count, GLenum gl_element = GL_TRIANGLES)
+    {
+        if (primitive_restart)
+            glState().enable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+
+        glDrawElementsInstanced(gl_element, numberOfElements, index_type, (GLvoid*)0, count);
+
+        if (primitive_restart)
+            glState().disable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
     }
 
 	virtual void renderPatches(int patch_vert_count)
 	{
 		glPatchParameteri(GL_PATCH_VERTICES, patch_vert_count);
-		glDrawElements(GL_PATCHES, numberOfElements, GL_UNSIGNED_INT, (GLvoid*)0);
+		glDrawElements(GL_PATCHES, numberOfElements, index_type, (GLvoid*)0);
 	}
 
     /**
@@ -762,6 +1938,22 @@ public:
         unbindBuffers();
     }
 
+    /**
+     * @brief Render several instances of the mesh with a single draw call.
+     * The method binds the buffers, draws the instances, and then unbinds all buffers.
+     * Meshes without index buffer are drawn as points.
+     * @param count Number of instances.
+     */
+    virtual void renderInstanced (GLsizei count)
+    {
+        bindBuffers();
+        if (numberOfElements == 0)
+            glDrawArraysInstanced(GL_POINTS, 0, numberOfVertices, count);
+        else
+            renderElementsInstanced(count);
+        unbindBuffers();
+    }
+
     /**
      * @brief Sets the mesh as a Parallelpiped with given dimensions, scales so larger side is equal to 1.
      * @param x Width
@@ -0,0 +1,271 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHLETMESH__
+#define __MESHLETMESH__
+
+#include "mesh.hpp"
+#include "camera.hpp"
+#include "utils/frustum.hpp"
+#include "utils/meshlets.hpp"
+#include <vector>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Counters of the last meshlet culling pass.
+ */
+struct MeshletStatistics
+{
+    /// Number of meshlets of the mesh.
+    size_t meshlets;
+
+    /// Meshlets outside the view frustum.
+    size_t frustum_culled;
+
+    /// Meshlets with all triangles facing away from the camera.
+    size_t backface_culled;
+
+    /// Meshlets drawn.
+    size_t drawn;
+
+    /// Triangles drawn.
+    size_t drawn_triangles;
+
+    MeshletStatistics (void) : meshlets(0), frustum_culled(0), backface_culled(0), drawn(0), drawn_triangles(0) {}
+};
+
+/**
+ * @brief Mesh split in meshlets that are culled on the CPU before drawing.
+ *
+ * The index buffer holds the triangles meshlet by meshlet. Before rendering with a camera, meshlets whose bounding
+ * sphere is outside the view frustum or whose normal cone faces away from the camera are discarded, and the
+ * remaining ones are drawn with a single glMultiDrawElements call.
+ * The model matrix is assumed to be a similarity (no shear or non uniform scale), so normal cones stay valid.
+ */
+class MeshletMesh : public Mesh {
+
+public:
+
+    /**
+     * @brief Default Constructor.
+     */
+    MeshletMesh (void) : frustum_culling(true), backface_culling(true)
+    {
+    }
+
+    /**
+     * @brief Loads the meshlets and their indices in the index buffer.
+     *
+     * The vertex attributes must be loaded separately (see uploadMeshData). All meshlets are drawn until the first cull.
+     * @param meshlet_list Meshlets, as built by MeshImporter::buildMeshlets.
+     * @param meshlet_indices Triangle list ordered meshlet by meshlet.
+     */
+    void loadMeshlets (const vector<Meshlet>& meshlet_list, const vector<GLuint>& meshlet_indices)
+    {
+        meshlets = meshlet_list;
+        loadIndices(meshlet_indices);
+
+        draw_counts.clear();
+        draw_offsets.clear();
+        statistics = MeshletStatistics();
+        statistics.meshlets = statistics.drawn = meshlets.size();
+        for (unsigned int i = 0; i < meshlets.size(); ++i)
+        {
+            draw_counts.push_back(meshlets[i].count);
+            draw_offsets.push_back((const GLvoid*)(meshlets[i].first * (size_t)VertexAttribute::typeSize(index_type)));
+            statistics.drawn_triangles += meshlets[i].count / 3;
+        }
+    }
+
+    /**
+     * @brief Partitions the triangles of a mesh in meshlets and loads them in the index buffer.
+     * @param data Mesh arrays, the vertex attributes must be uploaded from the same arrays.
+     * @param max_vertices Largest number of vertices per meshlet.
+     * @param max_triangles Largest number of triangles per meshlet.
+     */
+    void buildMeshlets (const MeshData& data, unsigned int max_vertices = 64, unsigned int max_triangles = 124)
+    {
+        vector<Meshlet> meshlet_list;
+        vector<GLuint> meshlet_indices;
+        MeshImporter::buildMeshlets(data.vertices, data.indices, max_vertices, max_triangles, meshlet_list, meshlet_indices);
+        loadMeshlets(meshlet_list, meshlet_indices);
+    }
+
+    /**
+     * @brief Returns the meshlets.
+     * @return Meshlets in index buffer order.
+     */
+    const vector<Meshlet>& getMeshlets (void) const
+    {
+        return meshlets;
+    }
+
+    /**
+     * @brief Returns the counters of the last culling pass.
+     * @return Culling statistics.
+     */
+    const MeshletStatistics& getStatistics (void) const
+    {
+        return statistics;
+    }
+
+    /**
+     * @brief Enables or disables the view frustum test.
+     * @param flag True to cull meshlets outside the frustum.
+     */
+    void setFrustumCulling (bool flag)
+    {
+        frustum_culling = flag;
+    }
+
+    /**
+     * @brief Enables or disables the normal cone test.
+     *
+     * Only valid when back faces are culled by OpenGL as well.
+     * @param flag True to cull meshlets facing away from the camera.
+     */
+    void setBackfaceCulling (bool flag)
+    {
+        backface_culling = flag;
+    }
+
+    /**
+     * @brief Selects the meshlets visible from a camera.
+     *
+     * Tests are done in object space. The back-face test uses the bounding sphere, so it is conservative for
+     * cameras close to the meshlet: a meshlet is culled when every point of its sphere sees its triangles from behind.
+     * @param camera Camera used for rendering.
+     * @return Statistics of the pass.
+     */
+    const MeshletStatistics& cull (const Camera& camera)
+    {
+        Eigen::Affine3f model_view = camera.getViewMatrix() * model_matrix;
+        Eigen::Matrix4f projection = camera.getProjectionMatrix();
+        Frustum frustum (projection * model_view.matrix());
+
+        // camera position, or view direction for an orthographic projection, in object space
+        Eigen::Affine3f inverse = model_view.inverse();
+        bool perspective = (projection(3,3) == 0.0);
+        Eigen::Vector3f eye = inverse.translation();
+        Eigen::Vector3f direction = (inverse.linear() * Eigen::Vector3f(0.0, 0.0, -1.0)).normalized();
+
+        draw_counts.clear();
+        draw_offsets.clear();
+        statistics = MeshletStatistics();
+        statistics.meshlets = meshlets.size();
+        int index_size = VertexAttribute::typeSize(index_type);
+        for (unsigned int i = 0; i < meshlets.size(); ++i)
+        {
+            const Meshlet& m = meshlets[i];
+            if (frustum_culling && frustum.isCullable(m.center, m.radius))
+            {
+                statistics.frustum_culled++;
+                continue;
+            }
+            if (backface_culling && m.cone_cutoff < 1.0)
+            {
+                bool back;
+                if (perspective)
+                {
+                    Eigen::Vector3f view = m.center - eye;
+                    back = view.dot(m.cone_axis) >= m.cone_cutoff * view.norm() + m.radius;
+                }
+                else
+                {
+                    back = direction.dot(m.cone_axis) >= m.cone_cutoff;
+                }
+                if (back)
+                {
+                    statistics.backface_culled++;
+                    continue;
+                }
+            }
+            draw_counts.push_back(m.count);
+            draw_offsets.push_back((const GLvoid*)(m.first * (size_t)index_size));
+            statistics.drawn_triangles += m.count / 3;
+        }
+        statistics.drawn = draw_counts.size();
+        return statistics;
+    }
+
+    /**
+     * @brief Culls the meshlets for a camera and renders the visible ones.
+     * @param camera Camera used for rendering.
+     */
+    virtual void render (const Camera& camera)
+    {
+        cull(camera);
+        render();
+    }
+
+    /**
+     * @brief Renders the meshlets kept by the last culling pass.
+     */
+    virtual void render (void)
+    {
+        Mesh::render();
+    }
+
+    /**
+     * @brief Draws the meshlets kept by the last culling pass with a single call.
+     * @param gl_element Primitive type.
+     */
+    virtual void renderElements (GLenum gl_element = GL_TRIANGLES)
+    {
+        if (meshlets.empty())
+        {
+            Mesh::renderElements(gl_element);
+            return;
+        }
+        if (draw_counts.empty())
+            return;
+        glMultiDrawElements(gl_element, &draw_counts[0], index_type, &draw_offsets[0], (GLsizei)draw_counts.size());
+    }
+
+protected:
+
+    /// Meshlets in index buffer order.
+    vector<Meshlet> meshlets;
+
+    /// Index count of each meshlet to draw.
+    vector<GLsizei> draw_counts;
+
+    /// Byte offset in the index buffer of each meshlet to draw.
+    vector<const GLvoid*> draw_offsets;
+
+    /// Counters of the last culling pass.
+    MeshletStatistics statistics;
+
+    /// Cull meshlets outside the view frustum.
+    bool frustum_culling;
+
+    /// Cull meshlets facing away from the camera.
+    bool backface_culling;
+};
+
+}
+#endif
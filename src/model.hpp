@@ -11,6 +11,44 @@ using namespace std;
 namespace Tucano
 {
 
+/**
+ * @brief Bounding volumes of a model, in object space.
+ */
+struct BoundingInfo
+{
+    /// Axis-aligned bounding box, empty if the model has no vertices.
+    Eigen::AlignedBox3f box;
+
+    /// Average of the vertices.
+    Eigen::Vector3f centroid;
+
+    /// Radius of the sphere centered at the centroid enclosing all vertices.
+    float radius;
+
+    /// Center of the tight bounding sphere, see Mesh::computeBoundingInfo.
+    Eigen::Vector3f sphere_center;
+
+    /// Radius of the tight bounding sphere.
+    float sphere_radius;
+
+    BoundingInfo (void) : centroid(Eigen::Vector3f::Zero()), radius(0.0), sphere_center(Eigen::Vector3f::Zero()), sphere_radius(0.0) {}
+
+    /**
+     * @brief Builds the bounding information known only from the box center, centroid and centroid sphere.
+     *
+     * The box and tight sphere are set conservatively to the bounds of the centroid sphere.
+     * @param center Center of the axis-aligned bounding box.
+     * @param center_of_mass Average of the vertices.
+     * @param bounding_radius Radius of the bounding sphere around the centroid.
+     */
+    BoundingInfo (const Eigen::Vector3f& center, const Eigen::Vector3f& center_of_mass, float bounding_radius) :
+        centroid(center_of_mass), radius(bounding_radius), sphere_center(center_of_mass), sphere_radius(bounding_radius)
+    {
+        Eigen::Vector3f extent = Eigen::Vector3f::Constant(bounding_radius + (center - center_of_mass).norm());
+        box = Eigen::AlignedBox3f(center - extent, center + extent);
+    }
+};
+
 /**
  * @brief The Model class is a holder for any kind of model, such as meshes, point clouds, surfaces ... that should inherit the model class.
  *
@@ -35,6 +73,15 @@ protected:
     /// The normalization scale factor, scales the model matrix to fit the model inside a unit cube.
     float scale;
 
+    /// Axis-aligned bounding box in object space.
+    Eigen::AlignedBox3f bounding_box;
+
+    /// Center of the tight bounding sphere.
+    Eigen::Vector3f sphere_center;
+
+    /// Radius of the tight bounding sphere.
+    float sphere_radius;
+
 public:
 
     /**
@@ -47,6 +94,9 @@ public:
         centroid = Eigen::Vector3f::Zero();
         radius = 1.0;
         scale = 1.0;
+        bounding_box.setEmpty();
+        sphere_center = Eigen::Vector3f::Zero();
+        sphere_radius = 1.0;
     }
 
     /**
@@ -77,6 +127,78 @@ public:
         return radius;
     }
 
+    /**
+     * @brief Returns the axis-aligned bounding box in object space, as expected by Frustum::isCullable.
+     * @return Bounding box, empty if the model has no vertices.
+     */
+    const Eigen::AlignedBox3f& getBoundingBox (void) const
+    {
+        return bounding_box;
+    }
+
+    /**
+     * @brief Returns the axis-aligned bounding box of the model transformed by the model matrix.
+     * @return Box enclosing the transformed object space box.
+     */
+    Eigen::AlignedBox3f getTransformedBoundingBox (void) const
+    {
+        Eigen::AlignedBox3f box;
+        if (bounding_box.isEmpty())
+            return box;
+        for (int i = 0; i < 8; ++i)
+            box.extend(model_matrix * bounding_box.corner((Eigen::AlignedBox3f::CornerType)i));
+        return box;
+    }
+
+    /**
+     * @brief Returns the center of the tight bounding sphere.
+     * Unlike the sphere around the centroid, this sphere is centered to fit the vertices closely, which makes it better for culling.
+     * @return Center of the tight bounding sphere.
+     */
+    Eigen::Vector3f getTightBoundingSphereCenter (void) const
+    {
+        return sphere_center;
+    }
+
+    /**
+     * @brief Returns the radius of the tight bounding sphere.
+     * @return Radius of the tight bounding sphere.
+     */
+    float getTightBoundingSphereRadius (void) const
+    {
+        return sphere_radius;
+    }
+
+    /**
+     * @brief Returns all bounding volumes of the model.
+     * @return Bounding information in object space.
+     */
+    BoundingInfo getBoundingInfo (void) const
+    {
+        BoundingInfo info;
+        info.box = bounding_box;
+        info.centroid = centroid;
+        info.radius = radius;
+        info.sphere_center = sphere_center;
+        info.sphere_radius = sphere_radius;
+        return info;
+    }
+
+    /**
+     * @brief Sets the bounding volumes of the model and the normalization scale.
+     * @param info Bounding information in object space.
+     */
+    void setBoundingInfo (const BoundingInfo& info)
+    {
+        bounding_box = info.box;
+        objectCenter = info.box.isEmpty() ? Eigen::Vector3f(Eigen::Vector3f::Zero()) : info.box.center();
+        centroid = info.centroid;
+        radius = info.radius;
+        sphere_center = info.sphere_center;
+        sphere_radius = info.sphere_radius;
+        scale = (radius > 0.0) ? 1.0/radius : 1.0;
+    }
+
     /**
      * @brief Returns the model matrix.
      * @return Model matrix as an Affine 3f matrix.
@@ -24,9 +24,12 @@
 #define __TUCANOSHADER__
 
 #include "tucano.hpp"
+#include "glstate.hpp"
 
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <Eigen/Dense>
 
 using namespace std;
@@ -34,6 +37,40 @@ using namespace std;
 namespace Tucano
 {
 
+/**
+ * @brief Active uniform variable of a linked shader program.
+ */
+struct UniformInfo
+{
+    /// Name of the uniform, arrays are listed both with and without the "[0]" suffix.
+    string name;
+
+    /// Location of the uniform, -1 for members of uniform blocks.
+    GLint location;
+
+    /// Type of the uniform, as returned by glGetActiveUniform.
+    GLenum type;
+
+    /// Number of array elements, one for non array uniforms.
+    GLint size;
+};
+
+/**
+ * @brief Counters of uniform updates of a shader.
+ *
+ * Issued counts glUniform calls sent to OpenGL, skipped counts updates elided because the uniform already had the value.
+ */
+struct UniformStatistics
+{
+    /// Number of glUniform calls issued.
+    size_t issued;
+
+    /// Number of redundant updates skipped.
+    size_t skipped;
+
+    UniformStatistics (void) : issued(0), skipped(0) {}
+};
+
 /**
  * @brief A Shader object represents one GLSL program.
  *
@@ -102,6 +139,32 @@ private:
     /// Debug level for outputing warnings and messages
     int debug_level;
 
+    /// Last value set to a non array uniform, a negative size means the location is not cached.
+    struct UniformValue
+    {
+        GLint bytes;
+        unsigned char data[16*sizeof(GLfloat)];
+        UniformValue (void) : bytes(-1) {}
+    };
+
+    /// Active uniforms of the linked program, sorted by name.
+    vector<UniformInfo> uniforms;
+
+    /// Last value set to each uniform, indexed by location.
+    vector<UniformValue> uniform_values;
+
+    /// True once the uniform table is built for the linked program.
+    bool uniforms_ready = false;
+
+    /// Counters of issued and skipped uniform updates.
+    UniformStatistics uniform_statistics;
+
+    /// Binding points requested for uniform blocks, applied again every time the program is linked.
+    vector< pair<string, GLuint> > uniform_block_bindings;
+
+    /// Attribute locations queried so far for the linked program, sorted by name.
+    vector< pair<string, GLint> > attribute_locations;
+
 public:
 
     /**
@@ -376,8 +439,9 @@ public:
 			cout << "[Ok]       Linked program successfully : " << shaderName << endl << endl;
         }
         #endif
-    }
 
+        buildUniformTable(result == GL_TRUE);
+    }
 
     /**
      * @brief Initializes shader and prepares it to use Transform Feedback.
@@ -1072,10 +1136,11 @@ public:
      * @brief Enables the shader program for usage.
      *
      * After enabling a shader any OpenGL draw call will use it for rendering.
+     * Nothing is issued if the program is already current (see GLState).
      */
     void bind (void)
     {
-        glUseProgram(shaderProgram);
+        glState().useProgram(shaderProgram);
     }
 
     /**
@@ -1083,7 +1148,7 @@ public:
      */
     void unbind (void)
     {
-        glUseProgram(0);
+        glState().useProgram(0);
     }
 
     /**
@@ -1102,6 +1167,7 @@ public:
 		glDeleteShader(tesselationCtrlShader);
         glDeleteShader(vertexShader);
         glDeleteProgram(shaderProgram);
+        buildUniformTable(false);
     }
 
 	/**
@@ -1130,22 +1196,113 @@ public:
 
     /**
      * Given the name of a uniform used inside the shader, returns it's location.
+     *
+     * Served from the table built at link time. Names that are not in the table, such as single array elements,
+     * are queried once and then added to the table.
      * @param name Name of the uniform variable in shader.
      * @return The uniform location.
      */
     GLint getUniformLocation (const GLchar* name) 
     {
-        return glGetUniformLocation(shaderProgram, name);
+        vector<UniformInfo>::iterator it = lower_bound(uniforms.begin(), uniforms.end(), name, [] (const UniformInfo& u, const GLchar* n) { return strcmp(u.name.c_str(), n) < 0; });
+        if (it != uniforms.end() && it->name == name)
+            return it->location;
+
+        GLint location = glGetUniformLocation(shaderProgram, name);
+        if (uniforms_ready)
+        {
+            UniformInfo info;
+            info.name = name;
+            info.location = location;
+            info.type = GL_NONE;
+            info.size = 0;
+            uniforms.insert(it, info);
+        }
+        return location;
+    }
+
+    /**
+     * @brief Binds a uniform block to a binding point, where a UniformBuffer is bound with bindBase.
+     *
+     * The binding is remembered and applied again when the program is linked or reloaded,
+     * so it can be set before the shader is initialized.
+     * @param block_name Name of the uniform block in the shader code.
+     * @param binding Binding point.
+     * @return True if the linked program has the block.
+     */
+    bool setUniformBlockBinding (const GLchar* block_name, GLuint binding)
+    {
+        size_t i = 0;
+        while (i < uniform_block_bindings.size() && uniform_block_bindings[i].first != block_name)
+            ++i;
+        if (i == uniform_block_bindings.size())
+            uniform_block_bindings.push_back(make_pair(string(block_name), binding));
+        uniform_block_bindings[i].second = binding;
+
+        if (!uniforms_ready)
+            return false;
+        return applyUniformBlockBinding(block_name, binding);
+    }
+
+    /**
+     * @brief Returns the active uniforms of the linked program, sorted by name.
+     * @return Uniform table.
+     */
+    const vector<UniformInfo>& getActiveUniforms (void) const
+    {
+        return uniforms;
+    }
+
+    /**
+     * @brief Returns the counters of issued and skipped uniform updates since the last reset.
+     *
+     * Reset once per frame with resetUniformStatistics to get per frame counts.
+     * @return Uniform update counters.
+     */
+    const UniformStatistics& getUniformStatistics (void) const
+    {
+        return uniform_statistics;
+    }
+
+    /**
+     * @brief Resets the counters of issued and skipped uniform updates.
+     */
+    void resetUniformStatistics (void)
+    {
+        uniform_statistics = UniformStatistics();
+    }
+
+    /**
+     * @brief Forgets the cached uniform values, so the next updates are all issued.
+     *
+     * Redundant updates are detected by comparing with the last value set through this object. Call this function
+     * if the uniforms of the program were changed by other means (glUniform or glProgramUniform directly, or another Shader object sharing the program).
+     */
+    void invalidateUniformValues (void)
+    {
+        for (size_t i = 0; i < uniform_values.size(); ++i)
+            if (uniform_values[i].bytes > 0)
+                uniform_values[i].bytes = 0;
     }
 
     /**
      * Returns the location of an attribute, such as a vertex attribute
+     *
+     * Each name is queried once per link, so meshes can set their attribute locations at every draw
+     * (see Mesh::setAttributeLocation) without querying OpenGL.
      * @param name Name of the attribute variable in the shader.
      * @return The attribute location, or -1 if the attribute was not found or has an invalid name.
      */
     GLint getAttributeLocation (const GLchar* name) 
     {
-        return glGetAttribLocation(shaderProgram, name);
+        vector< pair<string, GLint> >::iterator it = lower_bound(attribute_locations.begin(), attribute_locations.end(), name, [] (const pair<string, GLint>& a, const GLchar* n) { return strcmp(a.first.c_str(), n) < 0; });
+        if (it != attribute_locations.end() && it->first == name)
+            return it->second;
+
+        GLint location = glGetAttribLocation(shaderProgram, name);
+        if (uniforms_ready)
+            attribute_locations.insert(it, make_pair(string(name), location));
+        return location;
     }
 
     //============================Uniforms Setters==========================================================
@@ -1163,7 +1320,9 @@ public:
      */
     void setUniform (GLint location, GLint a, GLint b, GLint c, GLint d)
     {
-        glUniform4i(location, a, b, c, d);
+        GLint v[4] = {a, b, c, d};
+        if (uniformChanged(location, v, sizeof(v)))
+            glUniform4i(location, a, b, c, d);
     }
 
     /**
@@ -1175,7 +1334,9 @@ public:
      */
     void setUniform (GLint location, GLint a, GLint b, GLint c)
     {
-        glUniform3i(location, a, b, c);
+        GLint v[3] = {a, b, c};
+        if (uniformChanged(location, v, sizeof(v)))
+            glUniform3i(location, a, b, c);
     }
 
     /**
@@ -1186,7 +1347,9 @@ public:
      */
     void setUniform (GLint location, GLint a, GLint b)
     {
-        glUniform2i(location, a, b);
+        GLint v[2] = {a, b};
+        if (uniformChanged(location, v, sizeof(v)))
+            glUniform2i(location, a, b);
     }
 
     /**
@@ -1196,7 +1359,8 @@ public:
      */
     void setUniform (GLint location, GLint a)
     {
-        glUniform1i(location, a);
+        if (uniformChanged(location, &a, sizeof(a)))
+            glUniform1i(location, a);
     }
 
     /**
@@ -1256,7 +1420,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector4i &vec)
     {
-        glUniform4i(location, vec[0], vec[1], vec[2], vec[3]);
+        if (uniformChanged(location, vec.data(), 4*sizeof(GLint)))
+            glUniform4i(location, vec[0], vec[1], vec[2], vec[3]);
     }
 
     /**
@@ -1266,7 +1431,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector3i &vec)
     {
-        glUniform3i(location, vec[0], vec[1], vec[2]);
+        if (uniformChanged(location, vec.data(), 3*sizeof(GLint)))
+            glUniform3i(location, vec[0], vec[1], vec[2]);
     }
 
     /**
@@ -1276,7 +1442,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector2i &vec)
     {
-        glUniform2i(location, vec[0], vec[1]);
+        if (uniformChanged(location, vec.data(), 2*sizeof(GLint)))
+            glUniform2i(location, vec[0], vec[1]);
     }
 
     /**
@@ -1325,7 +1492,9 @@ public:
      */
     void setUniform (GLint location, GLfloat a, GLfloat b, GLfloat c, GLfloat d)
     {
-        glUniform4f(location, a, b, c, d);
+        GLfloat v[4] = {a, b, c, d};
+        if (uniformChanged(location, v, sizeof(v)))
+            glUniform4f(location, a, b, c, d);
     }
 
     /**
@@ -1337,7 +1506,9 @@ public:
      */
     void setUniform (GLint location, GLfloat a, GLfloat b, GLfloat c)
     {
-        glUniform3f(location, a, b, c);
+        GLfloat v[3] = {a, b, c};
+        if (uniformChanged(location, v, sizeof(v)))
+            glUniform3f(location, a, b, c);
     }
 
     /**
@@ -1348,7 +1519,9 @@ public:
      */
     void setUniform (GLint location, GLfloat a, GLfloat b)
     {
-        glUniform2f(location, a, b);
+        GLfloat v[2] = {a, b};
+        if (uniformChanged(location, v, sizeof(v)))
+            glUniform2f(location, a, b);
     }
 
     /**
@@ -1358,7 +1531,8 @@ public:
      */
     void setUniform (GLint location, GLfloat a)
     {
-        glUniform1f(location, a);
+        if (uniformChanged(location, &a, sizeof(a)))
+            glUniform1f(location, a);
     }
 
     /**
@@ -1418,7 +1592,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector4f &vec)
     {
-        glUniform4f(location, vec[0], vec[1], vec[2], vec[3]);
+        if (uniformChanged(location, vec.data(), 4*sizeof(GLfloat)))
+            glUniform4f(location, vec[0], vec[1], vec[2], vec[3]);
     }
 
     /**
@@ -1428,7 +1603,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector3f &vec)
     {
-        glUniform3f(location, vec[0], vec[1], vec[2]);
+        if (uniformChanged(location, vec.data(), 3*sizeof(GLfloat)))
+            glUniform3f(location, vec[0], vec[1], vec[2]);
     }
 
     /**
@@ -1438,7 +1614,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector2f &vec)
     {
-        glUniform2f(location, vec[0], vec[1]);
+        if (uniformChanged(location, vec.data(), 2*sizeof(GLfloat)))
+            glUniform2f(location, vec[0], vec[1]);
     }
 
     /**
@@ -1487,7 +1664,7 @@ public:
      */
     void setUniform (GLint location, GLdouble a, GLdouble b, GLdouble c, GLdouble d)
     {
-        glUniform4f(location, (GLfloat)a, (GLfloat)b, (GLfloat)c, (GLfloat)d);
+        setUniform(location, (GLfloat)a, (GLfloat)b, (GLfloat)c, (GLfloat)d);
     }
 
     /**
@@ -1500,7 +1677,7 @@ public:
      */
     void setUniform (GLint location, GLdouble a, GLdouble b, GLdouble c)
     {
-        glUniform3f(location, (GLfloat)a, (GLfloat)b, (GLfloat)c);
+        setUniform(location, (GLfloat)a, (GLfloat)b, (GLfloat)c);
     }
 
     /**
@@ -1512,7 +1689,7 @@ public:
      */
     void setUniform (GLint location, GLdouble a, GLdouble b)
     {
-        glUniform2f(location, (GLfloat)a, (GLfloat)b);
+        setUniform(location, (GLfloat)a, (GLfloat)b);
     }
 
     /**
@@ -1522,7 +1699,7 @@ public:
      */
     void setUniform (GLint location, GLdouble a)
     {
-        glUniform1f(location, (GLfloat)a);
+        setUniform(location, (GLfloat)a);
     }
 
     /**
@@ -1588,7 +1765,7 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector4d vec)
     {
-        glUniform4f(location, (GLfloat)vec[0], (GLfloat)vec[1], (GLfloat)vec[2], (GLfloat)vec[3]);
+        setUniform(location, (GLfloat)vec[0], (GLfloat)vec[1], (GLfloat)vec[2], (GLfloat)vec[3]);
     }
 
     /**
@@ -1598,7 +1775,7 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector3d vec)
     {
-        glUniform3f(location, (GLfloat)vec[0], (GLfloat)vec[1], (GLfloat)vec[2]);
+        setUniform(location, (GLfloat)vec[0], (GLfloat)vec[1], (GLfloat)vec[2]);
     }
 
     /**
@@ -1608,7 +1785,7 @@ public:
      */
     void setUniform (GLint location, const Eigen::Vector2d vec)
     {
-        glUniform2f(location, (GLfloat)vec[0], (GLfloat)vec[1]);
+        setUniform(location, (GLfloat)vec[0], (GLfloat)vec[1]);
     }
 
     /**
@@ -1658,6 +1835,8 @@ public:
      */
     void setUniform (GLint location, const GLint* v, GLuint nvalues, GLsizei count = 1)
     {
+        if (!((count == 1) ? uniformChanged(location, v, nvalues*sizeof(GLint)) : uniformUncached(location)))
+            return;
         switch (nvalues)
         {
             case 1: glUniform1iv(location, count, v); break;
@@ -1678,6 +1857,8 @@ public:
      */
     void setUniform (GLint location, const GLfloat* v, GLuint nvalues, GLsizei count = 1)
     {
+        if (!((count == 1) ? uniformChanged(location, v, nvalues*sizeof(GLfloat)) : uniformUncached(location)))
+            return;
         switch (nvalues)
         {
             case 1: glUniform1fv(location, count, v); break;
@@ -1735,6 +1916,8 @@ public:
      */
     void setUniform (GLint location, const GLfloat* m, GLuint dim, GLboolean transpose = GL_FALSE, GLsizei count = 1)
     {
+        if (!((count == 1 && transpose == GL_FALSE) ? uniformChanged(location, m, dim*dim*sizeof(GLfloat)) : uniformUncached(location)))
+            return;
         switch(dim)
         {
             case 2: glUniformMatrix2fv(location, count, transpose, m); break;
@@ -1768,7 +1951,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Matrix4f &matrix)
     {
-        glUniformMatrix4fv(location, 1, GL_FALSE, matrix.data());
+        if (uniformChanged(location, matrix.data(), 16*sizeof(GLfloat)))
+            glUniformMatrix4fv(location, 1, GL_FALSE, matrix.data());
     }
 
     /**
@@ -1778,7 +1962,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Matrix3f &matrix)
     {
-        glUniformMatrix3fv(location, 1, GL_FALSE, matrix.data());
+        if (uniformChanged(location, matrix.data(), 9*sizeof(GLfloat)))
+            glUniformMatrix3fv(location, 1, GL_FALSE, matrix.data());
     }
 
     /**
@@ -1788,7 +1973,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Matrix2f &matrix)
     {
-        glUniformMatrix2fv(location, 1, GL_FALSE, matrix.data());
+        if (uniformChanged(location, matrix.data(), 4*sizeof(GLfloat)))
+            glUniformMatrix2fv(location, 1, GL_FALSE, matrix.data());
     }
 
     /**
@@ -1831,7 +2017,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Affine3f &affine_matrix)
     {
-        glUniformMatrix4fv(location, 1, GL_FALSE, affine_matrix.matrix().data());
+        if (uniformChanged(location, affine_matrix.matrix().data(), 16*sizeof(GLfloat)))
+            glUniformMatrix4fv(location, 1, GL_FALSE, affine_matrix.matrix().data());
     }
 
     /**
@@ -1841,7 +2028,8 @@ public:
      */
     void setUniform (GLint location, const Eigen::Affine2f &affine_matrix)
     {
-        glUniformMatrix3fv(location, 1, GL_FALSE, affine_matrix.matrix().data());
+        if (uniformChanged(location, affine_matrix.matrix().data(), 9*sizeof(GLfloat)))
+            glUniformMatrix3fv(location, 1, GL_FALSE, affine_matrix.matrix().data());
     }
 
     /**
@@ -1867,6 +2055,130 @@ public:
     }
 
 
+private:
+
+    /**
+     * @brief Builds the table of active uniforms of the linked program and clears the cached uniform values and attribute locations.
+     *
+     * Called once at link time, so setting a uniform by name does not query OpenGL for its location.
+     * @param linked True if the program linked successfully, otherwise the table is left empty.
+     */
+    void buildUniformTable (bool linked)
+    {
+        uniforms.clear();
+        uniform_values.clear();
+        attribute_locations.clear();
+        uniforms_ready = linked;
+        if (!linked)
+            return;
+
+        GLint num_uniforms = 0, max_length = 0;
+        glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &num_uniforms);
+        glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+        vector<GLchar> name (max_length + 1);
+        vector<GLint> cached_locations;
+        for (GLint i = 0; i < num_uniforms; ++i)
+        {
+            UniformInfo info;
+            GLsizei length = 0;
+            glGetActiveUniform(shaderProgram, i, (GLsizei)name.size(), &length, &info.size, &info.type, &name[0]);
+            info.name = string(&name[0], length);
+            info.location = glGetUniformLocation(shaderProgram, info.name.c_str());
+            uniforms.push_back(info);
+
+            // arrays are also set through their plain name, and are never cached (even with a single element)
+            size_t bracket = info.name.rfind("[0]");
+            if (bracket != string::npos && bracket + 3 == info.name.size())
+            {
+                info.name.erase(bracket);
+                uniforms.push_back(info);
+            }
+            else if (info.size == 1 && info.location >= 0)
+                cached_locations.push_back(info.location);
+        }
+        sort(uniforms.begin(), uniforms.end(), [] (const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+
+        // non array uniforms get a value slot for eliding redundant updates
+        GLint max_location = -1;
+        for (size_t i = 0; i < cached_locations.size(); ++i)
+            max_location = max(max_location, cached_locations[i]);
+        uniform_values.resize(max_location + 1);
+        for (size_t i = 0; i < cached_locations.size(); ++i)
+            uniform_values[cached_locations[i]].bytes = 0;
+
+        for (size_t i = 0; i < uniform_block_bindings.size(); ++i)
+            applyUniformBlockBinding(uniform_block_bindings[i].first.c_str(), uniform_block_bindings[i].second);
+
+        #ifdef TUCANODEBUG
+        cout << shaderName << ": " << num_uniforms << " active uniforms" << endl;
+        #endif
+    }
+
+    /**
+     * @brief Binds a uniform block of the linked program to a binding point.
+     * @param block_name Name of the uniform block.
+     * @param binding Binding point.
+     * @return True if the program has the block.
+     */
+    bool applyUniformBlockBinding (const GLchar* block_name, GLuint binding)
+    {
+        GLuint index = glGetUniformBlockIndex(shaderProgram, block_name);
+        if (index == GL_INVALID_INDEX)
+            return false;
+        glUniformBlockBinding(shaderProgram, index, binding);
+        return true;
+    }
+
+    /**
+     * @brief Records an update of a uniform and returns false if it already holds the value.
+     *
+     * Uniforms without a value slot (arrays, unknown locations) are always updated.
+     * @param location Location of the uniform.
+     * @param value Value as sent to OpenGL.
+     * @param bytes Size of the value in bytes.
+     * @return True if the glUniform call must be issued.
+     */
+    bool uniformChanged (GLint location, const void* value, size_t bytes)
+    {
+        if (location < 0)
+        {
+            // OpenGL ignores location -1
+            uniform_statistics.skipped++;
+            return false;
+        }
+        if ((size_t)location < uniform_values.size() && uniform_values[location].bytes >= 0 && bytes <= sizeof(uniform_values[location].data))
+        {
+            UniformValue& cached = uniform_values[location];
+            if ((size_t)cached.bytes == bytes && memcmp(cached.data, value, bytes) == 0)
+            {
+                uniform_statistics.skipped++;
+                return false;
+            }
+            cached.bytes = (GLint)bytes;
+            memcpy(cached.data, value, bytes);
+        }
+        uniform_statistics.issued++;
+        return true;
+    }
+
+    /**
+     * @brief Records an update that is not compared to the cached value (arrays, transposed matrices), forgetting the cached value.
+     * @param location Location of the uniform.
+     * @return True if the glUniform call must be issued.
+     */
+    bool uniformUncached (GLint location)
+    {
+        if (location < 0)
+        {
+            uniform_statistics.skipped++;
+            return false;
+        }
+        uniform_statistics.issued++;
+        if ((size_t)location < uniform_values.size() && uniform_values[location].bytes > 0)
+            uniform_values[location].bytes = 0;
+        return true;
+    }
 };
 
 }
@@ -105,6 +105,7 @@ public:
     {
         camerarep_shader.load("phongshader", shader_dir);
 		camerarep_shader.initialize();
+		FrameUniforms::attach(camerarep_shader);
     }
 
 
@@ -120,28 +121,27 @@ public:
 	void render (const Tucano::Camera& camera, const Tucano::Camera& light)
 	{
 	    Eigen::Vector4f viewport = camera.getViewport();
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		sharedFrameUniforms().update(camera, light);
 
 		camerarep_shader.bind();
         
-		camerarep_shader.setUniform("viewMatrix", camera.getViewMatrix());
-       	camerarep_shader.setUniform("projectionMatrix", camera.getProjectionMatrix());
        	camerarep_shader.setUniform("nearPlane", camera.getNearPlane());
        	camerarep_shader.setUniform("farPlane", camera.getFarPlane());
 
        	Eigen::Vector4f color (1.0, 1.0, 0.0, 1.0);
        	camerarep_shader.setUniform("modelMatrix", model_matrix);
-		camerarep_shader.setUniform("lightViewMatrix", light.getViewMatrix());
        	camerarep_shader.setUniform("has_color", true);
        	camerarep_shader.setUniform("default_color", color);
 
 		setAttributeLocation(camerarep_shader);
 
-		glEnable(GL_DEPTH_TEST);
+		glState().enable(GL_DEPTH_TEST);
 		bindBuffers();
 		renderElements();
 		unbindBuffers();
-		glDisable(GL_DEPTH_TEST);
+		glState().disable(GL_DEPTH_TEST);
 
        	camerarep_shader.unbind();
 		
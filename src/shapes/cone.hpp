@@ -24,6 +24,7 @@
 #define __CONE__
 
 #include "mesh.hpp"
+#include "frameuniforms.hpp"
 #include "camera.hpp"
 #include <Eigen/Dense>
 #include <cmath>
@@ -41,7 +42,7 @@ const string cone_fragment_code = "\n"
 		"in vec3 normal;\n"
 		"in vec4 vert;\n"
         "out vec4 out_Color;\n"
-		"uniform mat4 lightViewMatrix;\n"
+		+ frame_uniforms_block +
         "void main(void)\n"
         "{\n"
 		"   vec3 lightDirection = (lightViewMatrix * vec4(0.0, 0.0, 1.0, 0.0)).xyz;\n"
@@ -59,21 +60,25 @@ const string cone_fragment_code = "\n"
 const string cone_vertex_code = "\n"
         "#version 430\n"
 		"layout(location=0) in vec4 in_Position;\n"
+		"in mat4 in_InstanceMatrix;\n"
+		"in vec4 in_InstanceColor;\n"
         "out vec4 color;\n"
 		"out vec3 normal;\n"
 		"out vec4 vert;\n"
         "uniform mat4 modelMatrix;\n"
-        "uniform mat4 viewMatrix;\n"
-        "uniform mat4 projectionMatrix;\n"
+        + frame_uniforms_block +
         "uniform vec4 in_Color;\n"
+        "uniform bool instanced;\n"
+        "uniform bool instance_colors;\n"
         "void main(void)\n"
         "{\n"
-		"   mat4 modelViewMatrix = viewMatrix * modelMatrix;\n"
+		"   mat4 model = instanced ? modelMatrix * in_InstanceMatrix : modelMatrix;\n"
+		"   mat4 modelViewMatrix = viewMatrix * model;\n"
 		"   mat4 normalMatrix = transpose(inverse(modelViewMatrix));\n"
 		"   normal = normalize(vec3(normalMatrix * vec4(in_Position.xyz,0.0)).xyz);\n"
 		"   vert = modelViewMatrix * in_Position;\n"
         "   gl_Position = projectionMatrix * modelViewMatrix * in_Position;\n"
-        "   color = in_Color;\n"
+        "   color = instance_colors ? in_InstanceColor : in_Color;\n"
         "}\n";
 
 
@@ -110,6 +115,7 @@ public:
 
 		cone_shader.setShaderName("coneShader");
 		cone_shader.initializeFromStrings(cone_vertex_code, cone_fragment_code);
+		FrameUniforms::attach(cone_shader);
 
 	}
 
@@ -133,23 +139,74 @@ public:
 	void render (const Tucano::Camera& camera, const Tucano::Camera& light)
 	{
 		Eigen::Vector4f viewport = camera.getViewport();
-		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		sharedFrameUniforms().update(camera, light);
 
 		cone_shader.bind();
 
        	cone_shader.setUniform("modelMatrix", model_matrix);
-		cone_shader.setUniform("viewMatrix", camera.getViewMatrix());
-       	cone_shader.setUniform("projectionMatrix", camera.getProjectionMatrix());
-		cone_shader.setUniform("lightViewMatrix", light.getViewMatrix());
        	cone_shader.setUniform("in_Color", color);
+       	cone_shader.setUniform("instanced", false);
+       	cone_shader.setUniform("instance_colors", false);
 
  		this->setAttributeLocation(&cone_shader);
 
-		glEnable(GL_DEPTH_TEST);
+		glState().enable(GL_DEPTH_TEST);
 		this->bindBuffers();
 		this->renderElements();
 		this->unbindBuffers();
-		glDisable(GL_DEPTH_TEST);
+		glState().disable(GL_DEPTH_TEST);
+
+       	cone_shader.unbind();
+
+		#ifdef TUCANODEBUG
+		errorCheckFunc(__FILE__, __LINE__);
+		#endif
+		
+	}
+
+	/**
+	* @brief Render several cones with a single draw call
+	*
+	* Each instance is placed by its own model matrix, applied before the cone model matrix.
+	* @param camera Current camera for viewing scene
+	* @param light Camera representing light (position and orientation)
+	* @param models One model matrix per instance
+	* @param colors One color per instance, if empty all instances use the cone color
+	*/
+	void renderInstances (const Tucano::Camera& camera, const Tucano::Camera& light, const vector<Eigen::Matrix4f>& models, const vector<Eigen::Vector4f>& colors = vector<Eigen::Vector4f>())
+	{
+		if (models.empty())
+			return;
+
+		Eigen::Vector4f viewport = camera.getViewport();
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		loadInstanceAttribute("in_InstanceMatrix", models);
+		bool has_colors = (colors.size() == models.size());
+		if (has_colors)
+			loadInstanceAttribute("in_InstanceColor", colors);
+
+		sharedFrameUniforms().update(camera, light);
+
+		cone_shader.bind();
+
+       	cone_shader.setUniform("modelMatrix", model_matrix);
+       	cone_shader.setUniform("in_Color", color);
+       	cone_shader.setUniform("instanced", true);
+       	cone_shader.setUniform("instance_colors", has_colors);
+
+ 		this->setAttributeLocation(&cone_shader);
+		// colors of a previous call are not read, their array stays disabled
+		if (!has_colors)
+			this->setAttributeLocation("in_InstanceColor", -1);
+
+		glState().enable(GL_DEPTH_TEST);
+		this->bindBuffers();
+		this->renderElementsInstanced(models.size());
+		this->unbindBuffers();
+		glState().disable(GL_DEPTH_TEST);
 
        	cone_shader.unbind();
 
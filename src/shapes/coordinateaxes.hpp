@@ -69,24 +69,52 @@ public:
 	*/
 	void render (const Tucano::Camera &camera, const Tucano::Camera &light)
 	{
-        glEnable(GL_DEPTH_TEST);
+		vector<Eigen::Matrix4f> models (1, this->modelMatrix()->matrix());
+		renderInstances(camera, light, models);
+	}
+
+	/**
+	* @brief Render several coordinate axes with a single draw call
+	*
+	* The three arrows of all axes are drawn as instances of the same arrow mesh.
+	* As in render, only the rotation of each model matrix is used to orient its axes.
+	* @param camera Current camera for viewing scene
+	* @param light Camera representing light (position and orientation)
+	* @param models One model matrix per coordinate axes
+	*/
+	void renderInstances (const Tucano::Camera &camera, const Tucano::Camera &light, const vector<Eigen::Matrix4f>& models)
+	{
+        glState().enable(GL_DEPTH_TEST);
 
 		arrow.resetModelMatrix();
 		arrow.modelMatrix()->scale(0.2);
-		arrow.modelMatrix()->rotate(this->modelMatrix()->rotation());
-
-		arrow.setColor(Eigen::Vector4f(0.0, 0.0, 1.0, 1.0));
-		arrow.render(camera, light);
-
-		arrow.modelMatrix()->rotate(Eigen::AngleAxisf(-M_PI*0.5, Eigen::Vector3f::UnitX()));
-		arrow.setColor(Eigen::Vector4f(0.0, 1.0, 0.0, 1.0));
-		arrow.render(camera, light);
 
-		arrow.modelMatrix()->rotate(Eigen::AngleAxisf(M_PI*0.5, Eigen::Vector3f::UnitX()));
-		arrow.modelMatrix()->rotate(Eigen::AngleAxisf(M_PI*0.5, Eigen::Vector3f::UnitY()));
-		arrow.setColor(Eigen::Vector4f(1.0, 0.0, 0.0, 1.0));
-		arrow.render(camera, light);
-	
+		// arrow points to z, rotate it to y and x axes
+		Eigen::Affine3f axis_rotation[3];
+		axis_rotation[0] = Eigen::Affine3f::Identity();
+		axis_rotation[1] = Eigen::AngleAxisf(-M_PI*0.5, Eigen::Vector3f::UnitX());
+		axis_rotation[2] = Eigen::AngleAxisf(M_PI*0.5, Eigen::Vector3f::UnitY());
+
+		Eigen::Vector4f axis_color[3];
+		axis_color[0] = Eigen::Vector4f(0.0, 0.0, 1.0, 1.0);
+		axis_color[1] = Eigen::Vector4f(0.0, 1.0, 0.0, 1.0);
+		axis_color[2] = Eigen::Vector4f(1.0, 0.0, 0.0, 1.0);
+
+		vector<Eigen::Matrix4f> arrow_models;
+		vector<Eigen::Vector4f> arrow_colors;
+		arrow_models.reserve(models.size()*3);
+		arrow_colors.reserve(models.size()*3);
+		for (unsigned int i = 0; i < models.size(); ++i)
+		{
+			Eigen::Affine3f rotation (Eigen::Affine3f(models[i]).rotation());
+			for (int j = 0; j < 3; ++j)
+			{
+				arrow_models.push_back((rotation * axis_rotation[j]).matrix());
+				arrow_colors.push_back(axis_color[j]);
+			}
+		}
+
+		arrow.renderInstances(camera, light, arrow_models, arrow_colors);
 	}
 
 
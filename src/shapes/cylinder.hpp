@@ -24,6 +24,7 @@
 #define __CYLINDER__
 
 #include "mesh.hpp"
+#include "frameuniforms.hpp"
 #include <Eigen/Dense>
 #include <cmath>
 
@@ -40,7 +41,7 @@ const string cylinder_fragment_code = "\n"
 		"in vec3 normal;\n"
 		"in vec4 vert;\n"
         "out vec4 out_Color;\n"
-		"uniform mat4 lightViewMatrix;\n"
+		+ frame_uniforms_block +
         "void main(void)\n"
         "{\n"
 		"   vec3 lightDirection = (lightViewMatrix * vec4(0.0, 0.0, 1.0, 0.0)).xyz;\n"
@@ -58,21 +59,25 @@ const string cylinder_fragment_code = "\n"
 const string cylinder_vertex_code = "\n"
         "#version 430\n"
 		"layout(location=0) in vec4 in_Position;\n"
+		"in mat4 in_InstanceMatrix;\n"
+		"in vec4 in_InstanceColor;\n"
         "out vec4 color;\n"
 		"out vec3 normal;\n"
 		"out vec4 vert;\n"
         "uniform mat4 modelMatrix;\n"
-        "uniform mat4 viewMatrix;\n"
-        "uniform mat4 projectionMatrix;\n"
+        + frame_uniforms_block +
         "uniform vec4 in_Color;\n"
+        "uniform bool instanced;\n"
+        "uniform bool instance_colors;\n"
         "void main(void)\n"
         "{\n"
-		"   mat4 modelViewMatrix = viewMatrix * modelMatrix;\n"
+		"   mat4 model = instanced ? modelMatrix * in_InstanceMatrix : modelMatrix;\n"
+		"   mat4 modelViewMatrix = viewMatrix * model;\n"
 		"   mat4 normalMatrix = transpose(inverse(modelViewMatrix));\n"
 		"   normal = normalize(vec3(normalMatrix * vec4(in_Position.xyz,0.0)).xyz);\n"
 		"   vert = modelViewMatrix * in_Position;\n"
         "   gl_Position = projectionMatrix * modelViewMatrix * in_Position;\n"
-        "   color = in_Color;\n"
+        "   color = instance_colors ? in_InstanceColor : in_Color;\n"
         "}\n";
 
 
@@ -111,6 +116,7 @@ public:
 
 		cylinder_shader.setShaderName("cylinderShader");
 		cylinder_shader.initializeFromStrings(cylinder_vertex_code, cylinder_fragment_code);
+		FrameUniforms::attach(cylinder_shader);
 
 	}
 
@@ -134,19 +140,20 @@ public:
 	void render (const Tucano::Camera& camera, const Tucano::Camera& light)
 	{
 		Eigen::Vector4f viewport = camera.getViewport();
-		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		sharedFrameUniforms().update(camera, light);
 
 		cylinder_shader.bind();
 
        	cylinder_shader.setUniform("modelMatrix", model_matrix);
-		cylinder_shader.setUniform("viewMatrix", camera.getViewMatrix());
-       	cylinder_shader.setUniform("projectionMatrix", camera.getProjectionMatrix());
-		cylinder_shader.setUniform("lightViewMatrix", light.getViewMatrix());
        	cylinder_shader.setUniform("in_Color", color);
+       	cylinder_shader.setUniform("instanced", false);
+       	cylinder_shader.setUniform("instance_colors", false);
 
  		this->setAttributeLocation(&cylinder_shader);
 
-		glEnable(GL_DEPTH_TEST);
+		glState().enable(GL_DEPTH_TEST);
 		this->bindBuffers();
 		this->renderElements();
 		this->unbindBuffers();
@@ -159,6 +166,55 @@ public:
 		
 	}
 
+	/**
+	* @brief Render several cylinders with a single draw call
+	*
+	* Each instance is placed by its own model matrix, applied before the cylinder model matrix.
+	* @param camera Current camera for viewing scene
+	* @param light Camera representing light (position and orientation)
+	* @param models One model matrix per instance
+	* @param colors One color per instance, if empty all instances use the cylinder color
+	*/
+	void renderInstances (const Tucano::Camera& camera, const Tucano::Camera& light, const vector<Eigen::Matrix4f>& models, const vector<Eigen::Vector4f>& colors = vector<Eigen::Vector4f>())
+	{
+		if (models.empty())
+			return;
+
+		Eigen::Vector4f viewport = camera.getViewport();
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		loadInstanceAttribute("in_InstanceMatrix", models);
+		bool has_colors = (colors.size() == models.size());
+		if (has_colors)
+			loadInstanceAttribute("in_InstanceColor", colors);
+
+		sharedFrameUniforms().update(camera, light);
+
+		cylinder_shader.bind();
+
+       	cylinder_shader.setUniform("modelMatrix", model_matrix);
+       	cylinder_shader.setUniform("in_Color", color);
+       	cylinder_shader.setUniform("instanced", true);
+       	cylinder_shader.setUniform("instance_colors", has_colors);
+
+ 		this->setAttributeLocation(&cylinder_shader);
+		// colors of a previous call are not read, their array stays disabled
+		if (!has_colors)
+			this->setAttributeLocation("in_InstanceColor", -1);
+
+		glState().enable(GL_DEPTH_TEST);
+		this->bindBuffers();
+		this->renderElementsInstanced(models.size());
+		this->unbindBuffers();
+
+       	cylinder_shader.unbind();
+
+		#ifdef TUCANODEBUG
+		errorCheckFunc(__FILE__, __LINE__);
+		#endif
+		
+	}
+
 
 	/**
 	* @brief Create cylinder with given parameters
@@ -24,6 +24,7 @@
 #define __ICOSAHEDRON__
 
 #include "mesh.hpp"
+#include "shapes/spheregeometry.hpp"
 #include <Eigen/Dense>
 #include <cmath>
 
@@ -58,6 +59,7 @@ const string icosahedron_fragment_code = "\n"
 const string icosahedron_vertex_code = "\n"
         "#version 430\n"
 		"layout(location=0) in vec4 in_Position;\n"
+		"layout(location=1) in vec3 in_Normal;\n"
         "out vec4 color;\n"
 		"out vec3 normal;\n"
 		"out vec4 vert;\n"
@@ -69,7 +71,7 @@ const string icosahedron_vertex_code = "\n"
         "{\n"
 		"   mat4 modelViewMatrix = viewMatrix * modelMatrix;\n"
 		"   mat4 normalMatrix = transpose(inverse(modelViewMatrix));\n"
-		"   normal = normalize(vec3(normalMatrix * vec4(in_Position.xyz,0.0)).xyz);\n"
+		"   normal = normalize(vec3(normalMatrix * vec4(in_Normal,0.0)).xyz);\n"
 		"   vert = modelViewMatrix * in_Position;\n"
         "   gl_Position = projectionMatrix * modelViewMatrix * in_Position;\n"
         "   color = in_Color;\n"
@@ -89,12 +91,16 @@ private:
 	// Icosahedron color
 	Eigen::Vector4f color;
 
+	// Number of times each triangle is split into 4
+	int subdivisions;
+
 public:
 
 	/**
 	* @brief Default Constructor
+	* @param levels Number of subdivision levels, zero for the plain icosahedron
 	*/
-	Icosahedron()
+	Icosahedron(int levels = 0) : subdivisions(levels)
 	{
 	}
 
@@ -132,7 +138,7 @@ public:
 	void render (const Tucano::Camera& camera, const Tucano::Camera& light)
 	{
 		Eigen::Vector4f viewport = camera.getViewport();
-		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
 		shader.bind();
 
@@ -142,16 +148,13 @@ public:
 		shader.setUniform("lightViewMatrix", light.getViewMatrix());
        	shader.setUniform("in_Color", color);
 
-		vector <string> attribs;
-		shader.getActiveAttributes(attribs);
-
  		this->setAttributeLocation(&shader);
 
-		glEnable(GL_DEPTH_TEST);
+		glState().enable(GL_DEPTH_TEST);
 		this->bindBuffers();
 		this->renderElements();
 		this->unbindBuffers();
-		glDisable(GL_DEPTH_TEST);
+		glState().disable(GL_DEPTH_TEST);
 
        	shader.unbind();
 
@@ -164,52 +167,14 @@ public:
 private:
 
 
+	/**
+	* @brief Define a unitary icosahedron geometry, optionally subdivided towards a sphere
+	*
+	* The buffers are shared by all icosahedra with the same subdivision level (see sharedSphereGeometry).
+	*/
 	void createGeometry()
 	{
-		vector< Eigen::Vector4f > vert;
-		vert.push_back(Eigen::Vector4f(0.000f, 0.000f, 1.000f, 1.0f));
-		vert.push_back(Eigen::Vector4f(0.894f, 0.000f, 0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(0.276f, 0.851f, 0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(-0.724f, 0.526f, 0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(-0.724f, -0.526f, 0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(0.276f, -0.851f, 0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(0.724f, 0.526f, -0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(-0.276f, 0.851f, -0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(-0.894f, 0.000f, -0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(-0.276f, -0.851f, -0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(0.724f, -0.526f, -0.447f, 1.0f));
-		vert.push_back(Eigen::Vector4f(0.000f, 0.000f, -1.000f, 1.0f));
-
-
-		vector< GLuint > faces = {
-			2, 1, 0,
-			3, 2, 0,
-			4, 3, 0,
-			5, 4, 0,
-			1, 5, 0,
-
-			11, 6, 7,
-			11, 7, 8,
-			11, 8, 9,
-			11, 9, 10,
-			11, 10, 6,
-
-			1, 2, 6,
-			2, 3, 7,
-			3, 4, 8,
-			4, 5, 9,
-			5, 1, 10,
-
-			2, 7, 6,
-			3, 8, 7,
-			4, 9, 8,
-			5, 10, 9,
-			1, 6, 10 };
-
-		loadVertices(vert);
-		loadIndices(faces);
-
-		setDefaultAttribLocations();
+		shareGeometry(sharedSphereGeometry(SPHERE_BASE_ICOSAHEDRON, subdivisions));
 	}
 
 };
@@ -24,6 +24,8 @@
 #define __SPHERE__
 
 #include "mesh.hpp"
+#include "frameuniforms.hpp"
+#include "shapes/spheregeometry.hpp"
 #include <Eigen/Dense>
 #include <cmath>
 
@@ -40,7 +42,7 @@ const string sphere_fragment_code = "\n"
 		"in vec3 normal;\n"
 		"in vec4 vert;\n"
         "out vec4 out_Color;\n"
-		"uniform mat4 lightViewMatrix;\n"
+		+ frame_uniforms_block +
         "void main(void)\n"
         "{\n"
 		"   vec3 lightDirection = (lightViewMatrix * vec4(0.0, 0.0, 1.0, 0.0)).xyz;\n"
@@ -58,21 +60,26 @@ const string sphere_fragment_code = "\n"
 const string sphere_vertex_code = "\n"
         "#version 430\n"
 		"layout(location=0) in vec4 in_Position;\n"
+		"layout(location=1) in vec3 in_Normal;\n"
+		"in mat4 in_InstanceMatrix;\n"
+		"in vec4 in_InstanceColor;\n"
         "out vec4 color;\n"
 		"out vec3 normal;\n"
 		"out vec4 vert;\n"
         "uniform mat4 modelMatrix;\n"
-        "uniform mat4 viewMatrix;\n"
-        "uniform mat4 projectionMatrix;\n"
+        + frame_uniforms_block +
         "uniform vec4 in_Color;\n"
+        "uniform bool instanced;\n"
+        "uniform bool instance_colors;\n"
         "void main(void)\n"
         "{\n"
-		"   mat4 modelViewMatrix = viewMatrix * modelMatrix;\n"
+		"   mat4 model = instanced ? modelMatrix * in_InstanceMatrix : modelMatrix;\n"
+		"   mat4 modelViewMatrix = viewMatrix * model;\n"
 		"   mat4 normalMatrix = transpose(inverse(modelViewMatrix));\n"
-		"   normal = normalize(vec3(normalMatrix * vec4(in_Position.xyz,0.0)).xyz);\n"
+		"   normal = normalize(vec3(normalMatrix * vec4(in_Normal,0.0)).xyz);\n"
 		"   vert = modelViewMatrix * in_Position;\n"
         "   gl_Position = projectionMatrix * modelViewMatrix * in_Position;\n"
-        "   color = in_Color;\n"
+        "   color = instance_colors ? in_InstanceColor : in_Color;\n"
         "}\n";
 
 
@@ -105,6 +112,7 @@ public:
 
 		sphere_shader.setShaderName("sphereShader");
 		sphere_shader.initializeFromStrings(sphere_vertex_code, sphere_fragment_code);
+		FrameUniforms::attach(sphere_shader);
 
 	}
 
@@ -128,26 +136,74 @@ public:
 	void render (const Tucano::Camera& camera, const Tucano::Camera& light)
 	{
 		Eigen::Vector4f viewport = camera.getViewport();
-		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		sharedFrameUniforms().update(camera, light);
 
 		sphere_shader.bind();
 
        	sphere_shader.setUniform("modelMatrix", model_matrix);
-		sphere_shader.setUniform("viewMatrix", camera.getViewMatrix());
-       	sphere_shader.setUniform("projectionMatrix", camera.getProjectionMatrix());
-		sphere_shader.setUniform("lightViewMatrix", light.getViewMatrix());
        	sphere_shader.setUniform("in_Color", color);
-
-		vector <string> attribs;
-		sphere_shader.getActiveAttributes(attribs);
+       	sphere_shader.setUniform("instanced", false);
+       	sphere_shader.setUniform("instance_colors", false);
 
  		this->setAttributeLocation(&sphere_shader);
 
-		glEnable(GL_DEPTH_TEST);
+		glState().enable(GL_DEPTH_TEST);
 		this->bindBuffers();
 		this->renderElements();
 		this->unbindBuffers();
-		glDisable(GL_DEPTH_TEST);
+		glState().disable(GL_DEPTH_TEST);
+
+       	sphere_shader.unbind();
+
+		#ifdef TUCANODEBUG
+		errorCheckFunc(__FILE__, __LINE__);
+		#endif
+		
+	}
+
+	/**
+	* @brief Render several spheres with a single draw call
+	*
+	* Each instance is placed by its own model matrix, applied before the sphere model matrix.
+	* @param camera Current camera for viewing scene
+	* @param light Camera representing light (position and orientation)
+	* @param models One model matrix per instance
+	* @param colors One color per instance, if empty all instances use the sphere color
+	*/
+	void renderInstances (const Tucano::Camera& camera, const Tucano::Camera& light, const vector<Eigen::Matrix4f>& models, const vector<Eigen::Vector4f>& colors = vector<Eigen::Vector4f>())
+	{
+		if (models.empty())
+			return;
+
+		Eigen::Vector4f viewport = camera.getViewport();
+		glState().viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+		loadInstanceAttribute("in_InstanceMatrix", models);
+		bool has_colors = (colors.size() == models.size());
+		if (has_colors)
+			loadInstanceAttribute("in_InstanceColor", colors);
+
+		sharedFrameUniforms().update(camera, light);
+
+		sphere_shader.bind();
+
+       	sphere_shader.setUniform("modelMatrix", model_matrix);
+       	sphere_shader.setUniform("in_Color", color);
+       	sphere_shader.setUniform("instanced", true);
+       	sphere_shader.setUniform("instance_colors", has_colors);
+
+ 		this->setAttributeLocation(&sphere_shader);
+		// colors of a previous call are not read, their array stays disabled
+		if (!has_colors)
+			this->setAttributeLocation("in_InstanceColor", -1);
+
+		glState().enable(GL_DEPTH_TEST);
+		this->bindBuffers();
+		this->renderElementsInstanced(models.size());
+		this->unbindBuffers();
+		glState().disable(GL_DEPTH_TEST);
 
        	sphere_shader.unbind();
 
@@ -163,60 +219,14 @@ private:
 	/**
 	* @brief Define a unitary sphere geometry
 	*
-	* Sphere is created by starting with an octahedron and subdividing triangles
-	* for a nice reference see: https://sites.google.com/site/dlampetest/python/triangulating-a-sphere-recursively
-	* No need to set normal, just use the position in shader since it is the same
+	* Sphere is created by starting with an octahedron and subdividing triangles (see subdivideSphere).
+	* The buffers are shared by all spheres with the same subdivision level (see sharedSphereGeometry),
+	* so creating many spheres does not rebuild or duplicate the geometry.
+	* @param subdivisions Number of subdivision levels.
 	*/
 	void createGeometry (int subdivisions = 4)
 	{
-		vector< Eigen::Vector4f > vert;
-		vector< GLuint > faces;
-	
-		vert.push_back ( Eigen::Vector4f( 1.0, 0.0, 0.0, 1.0) );
-		vert.push_back ( Eigen::Vector4f(-1.0, 0.0, 0.0, 1.0) );
-		vert.push_back ( Eigen::Vector4f( 0.0, 1.0, 0.0, 1.0) );
-		vert.push_back ( Eigen::Vector4f( 0.0,-1.0, 0.0, 1.0) );
-		vert.push_back ( Eigen::Vector4f( 0.0, 0.0, 1.0, 1.0) );
-		vert.push_back ( Eigen::Vector4f( 0.0, 0.0,-1.0, 1.0) );
-
-		int a[24] = { 0, 4, 2, 2, 4, 1, 1, 4, 3, 3, 4, 0, 0, 2, 5, 2, 1, 5, 1, 3, 5, 3, 0, 5 };
-		faces.insert(faces.end(), a, a+24);
-	
-		// now subdivide, divide each triangle into 4
-		for (int s = 0; s < subdivisions; ++s)
-		{
-			vector< GLuint > sub_faces;
-			for (int i = 0; i < (int)faces.size(); i=i+3)
-			{
-				Eigen::Vector4f p0 = vert[faces[i+0]];
-				Eigen::Vector4f p1 = vert[faces[i+1]];
-				Eigen::Vector4f p2 = vert[faces[i+2]];
-
-				Eigen::Vector4f p3 = (p0 + p1)*0.5;
-				Eigen::Vector4f p4 = (p0 + p2)*0.5;
-				Eigen::Vector4f p5 = (p1 + p2)*0.5;
-				p3.head(3).normalize();
-				p4.head(3).normalize();
-				p5.head(3).normalize();
-			
-				vert.push_back(p3);
-				vert.push_back(p4);
-				vert.push_back(p5);
-
-				int ind = vert.size()-3;
-				// new faces are: (p0, p4, p3), (p4, p1, p5), (p3, p4, p5), (p3, p5, p2)
-				int b[12] = {(int)faces[i+0], ind, ind+1, ind+1, ind+2, (int)faces[i+2], ind, ind+2, ind+1, ind, (int)faces[i+1], ind+2};
-				sub_faces.insert(sub_faces.end(), b, b+12);  
-			}
-			faces.clear();
-			faces = sub_faces;
-		}
-
-		loadVertices(vert);
-		loadIndices(faces);
-
-		setDefaultAttribLocations();
-		
+		shareGeometry(sharedSphereGeometry(SPHERE_BASE_OCTAHEDRON, subdivisions));
 	}
 
 };
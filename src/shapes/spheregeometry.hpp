@@ -0,0 +1,222 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __SPHEREGEOMETRY__
+#define __SPHEREGEOMETRY__
+
+#include "mesh.hpp"
+#include <Eigen/Dense>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Tucano
+{
+
+namespace Shapes
+{
+
+/// Base polyhedron that is subdivided to approximate a unit sphere
+enum SphereBase
+{
+	SPHERE_BASE_OCTAHEDRON = 0,
+	SPHERE_BASE_ICOSAHEDRON = 1
+};
+
+/**
+* @brief Fills the arrays with a unit octahedron (6 vertices, 8 faces).
+* @param vert Vertex positions (w = 1).
+* @param faces Triangle indices, clockwise seen from outside (face normals point inward).
+*/
+inline void octahedronGeometry (vector< Eigen::Vector4f > &vert, vector< GLuint > &faces)
+{
+	vert = {
+		Eigen::Vector4f( 1.0, 0.0, 0.0, 1.0),
+		Eigen::Vector4f(-1.0, 0.0, 0.0, 1.0),
+		Eigen::Vector4f( 0.0, 1.0, 0.0, 1.0),
+		Eigen::Vector4f( 0.0,-1.0, 0.0, 1.0),
+		Eigen::Vector4f( 0.0, 0.0, 1.0, 1.0),
+		Eigen::Vector4f( 0.0, 0.0,-1.0, 1.0) };
+
+	faces = { 0, 4, 2, 2, 4, 1, 1, 4, 3, 3, 4, 0, 0, 2, 5, 2, 1, 5, 1, 3, 5, 3, 0, 5 };
+}
+
+/**
+* @brief Fills the arrays with a regular icosahedron inscribed in the unit sphere (12 vertices, 20 faces).
+*
+* One vertex at each pole, and two rings of five vertices at heights +-1/sqrt(5) rotated by 36 degrees from each other.
+* @param vert Vertex positions (w = 1).
+* @param faces Triangle indices, clockwise seen from outside like octahedronGeometry.
+*/
+inline void icosahedronGeometry (vector< Eigen::Vector4f > &vert, vector< GLuint > &faces)
+{
+	const double pi = 3.14159265358979323846;
+	const double h = 1.0 / sqrt(5.0);
+	const double r = 2.0 / sqrt(5.0);
+
+	vert.clear();
+	vert.push_back(Eigen::Vector4f(0.0, 0.0, 1.0, 1.0));
+	for (int i = 0; i < 5; ++i)
+	{
+		double a = i * 2.0 * pi / 5.0;
+		vert.push_back(Eigen::Vector4f(r*cos(a), r*sin(a), h, 1.0));
+	}
+	for (int i = 0; i < 5; ++i)
+	{
+		double a = (i * 2.0 + 1.0) * pi / 5.0;
+		vert.push_back(Eigen::Vector4f(r*cos(a), r*sin(a), -h, 1.0));
+	}
+	vert.push_back(Eigen::Vector4f(0.0, 0.0, -1.0, 1.0));
+
+	faces = {
+		2, 1, 0,
+		3, 2, 0,
+		4, 3, 0,
+		5, 4, 0,
+		1, 5, 0,
+
+		11, 6, 7,
+		11, 7, 8,
+		11, 8, 9,
+		11, 9, 10,
+		11, 10, 6,
+
+		1, 2, 6,
+		2, 3, 7,
+		3, 4, 8,
+		4, 5, 9,
+		5, 1, 10,
+
+		2, 7, 6,
+		3, 8, 7,
+		4, 9, 8,
+		5, 10, 9,
+		1, 6, 10 };
+}
+
+/**
+* @brief Subdivides a triangle mesh inscribed in the unit sphere, splitting each triangle into 4 per level.
+*
+* Edge midpoints are projected onto the sphere and cached by edge, so the two triangles sharing an edge
+* share its midpoint vertex: every level adds exactly one vertex per edge (V + F/2 * 3),
+* instead of three vertices per triangle.
+* for a nice reference see: https://sites.google.com/site/dlampetest/python/triangulating-a-sphere-recursively
+* @param vert Vertex positions (w = 1), new vertices are appended.
+* @param faces Triangle indices, replaced by the subdivided triangles with the same winding.
+* @param levels Number of subdivision levels.
+*/
+inline void subdivideSphere (vector< Eigen::Vector4f > &vert, vector< GLuint > &faces, int levels)
+{
+	unordered_map< uint64_t, GLuint > midpoints;
+	vector< GLuint > sub_faces;
+
+	for (int s = 0; s < levels; ++s)
+	{
+		// a closed triangle mesh has 3F/2 edges
+		midpoints.clear();
+		midpoints.reserve(faces.size()/2);
+		vert.reserve(vert.size() + faces.size()/2);
+		sub_faces.clear();
+		sub_faces.reserve(faces.size()*4);
+
+		auto midpoint = [&] (GLuint a, GLuint b) -> GLuint
+		{
+			uint64_t key = (a < b) ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+			auto it = midpoints.find(key);
+			if (it != midpoints.end())
+				return it->second;
+
+			Eigen::Vector4f p = (vert[a] + vert[b])*0.5;
+			p.head(3).normalize();
+			GLuint ind = vert.size();
+			vert.push_back(p);
+			midpoints[key] = ind;
+			return ind;
+		};
+
+		for (unsigned int i = 0; i < faces.size(); i = i+3)
+		{
+			GLuint p0 = faces[i+0];
+			GLuint p1 = faces[i+1];
+			GLuint p2 = faces[i+2];
+			GLuint p3 = midpoint(p0, p1);
+			GLuint p4 = midpoint(p0, p2);
+			GLuint p5 = midpoint(p1, p2);
+
+			// new faces are: (p0, p3, p4), (p4, p5, p2), (p3, p5, p4), (p3, p1, p5)
+			GLuint b[12] = {p0, p3, p4, p4, p5, p2, p3, p5, p4, p3, p1, p5};
+			sub_faces.insert(sub_faces.end(), b, b+12);
+		}
+		faces.swap(sub_faces);
+	}
+}
+
+/**
+* @brief Returns the unit sphere mesh for a base polyhedron and subdivision level, shared by the whole process.
+*
+* The mesh holds positions, normals (equal to the positions on the unit sphere) and indices.
+* The first call for a (base, level) pair builds and uploads it, later calls return the same mesh while any
+* user still holds it, so all shapes of the same level render from one VBO/IBO (see Mesh::shareGeometry).
+* Must be called from the GL thread; the buffers belong to the current context (or share group).
+* @param base Base polyhedron.
+* @param levels Number of subdivision levels.
+* @return Shared sphere mesh.
+*/
+inline shared_ptr<Mesh> sharedSphereGeometry (SphereBase base, int levels)
+{
+	static map< pair<int, int>, weak_ptr<Mesh> > cache;
+
+	pair<int, int> key (base, levels);
+	shared_ptr<Mesh> mesh = cache[key].lock();
+	if (mesh)
+		return mesh;
+
+	vector< Eigen::Vector4f > vert;
+	vector< GLuint > faces;
+	if (base == SPHERE_BASE_ICOSAHEDRON)
+		icosahedronGeometry(vert, faces);
+	else
+		octahedronGeometry(vert, faces);
+	subdivideSphere(vert, faces, levels);
+
+	vector< Eigen::Vector3f > norm (vert.size());
+	for (unsigned int i = 0; i < vert.size(); ++i)
+	{
+		norm[i] = vert[i].head(3);
+	}
+
+	mesh = make_shared<Mesh>();
+	mesh->loadVertices(vert);
+	mesh->loadNormals(norm);
+	mesh->loadIndices(faces);
+	mesh->setDefaultAttribLocations();
+
+	cache[key] = mesh;
+	return mesh;
+}
+
+}
+}
+#endif
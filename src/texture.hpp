@@ -113,11 +113,11 @@ public:
         depth = dpt;
 
         if (tex_id != 0)
-            glDeleteTextures(1, &tex_id);
+            glState().deleteTexture(tex_id);
 
         glGenTextures(1, &tex_id);        
 
-        glBindTexture(tex_type, tex_id);
+        glState().bindTexture(tex_type, tex_id);
         if(tex_type == GL_TEXTURE_2D || tex_type == GL_TEXTURE_RECTANGLE)
         {            
             glTexImage2D(tex_type, lod, internal_format, width, height, 0, format, pixel_type, data);           
@@ -134,7 +134,7 @@ public:
         // default parameters
         setTexParameters();
 
-        glBindTexture(tex_type, 0);
+        glState().bindTexture(tex_type, 0);
         return tex_id;
     }
 
@@ -159,7 +159,7 @@ public:
     void destroy (void)
     {
         if (tex_id != 0) {
-            glDeleteTextures(1, &tex_id);
+            glState().deleteTexture(tex_id);
         }
         tex_id = 0;
     }
@@ -211,7 +211,7 @@ public:
     void update (const GLvoid* data)
     {
 
-        glBindTexture(tex_type, tex_id);
+        glState().bindTexture(tex_type, tex_id);
         if(tex_type == GL_TEXTURE_2D || tex_type == GL_TEXTURE_RECTANGLE) {
             glTexImage2D(tex_type, lod, internal_format, width, height, 0, format,pixel_type,data);
         }
@@ -221,7 +221,7 @@ public:
         else if (tex_type == GL_TEXTURE_1D) {
             glTexImage1D(tex_type, lod, internal_format,width,0,format,pixel_type,data);
         }
-        glBindTexture(tex_type,0);
+        glState().bindTexture(tex_type, 0);
 
     }
 
@@ -4,6 +4,7 @@
 /// Defines our unique instance of this singleton class.
 #define texManager TextureManager::Instance()
 
+#include "glstate.hpp"
 #include <set>
 #include <vector>
 
@@ -44,8 +45,7 @@ class TextureManager : public GLObject{
      */
     void bindTexture (GLenum texType, GLuint texID, int texture_unit)
     {
-        glActiveTexture(GL_TEXTURE0 + texture_unit);
-        glBindTexture(texType, texID);
+        glState().bindTexture(texture_unit, texType, texID);
 
         if (used_units[texture_unit] != -1)
         {
@@ -65,8 +65,7 @@ class TextureManager : public GLObject{
 
         if (free_unit != -1)
         {
-            glActiveTexture(GL_TEXTURE0 + free_unit);
-            glBindTexture(texType, texID);
+            glState().bindTexture(free_unit, texType, texID);
             used_units[free_unit] = texID;
         }
         else
@@ -100,8 +99,7 @@ class TextureManager : public GLObject{
 	///Unbinds the texture from the specific texture unit.
     void unbindTexture(GLenum texType, int texture_unit)
     {
-        glActiveTexture(GL_TEXTURE0 + texture_unit);
-        glBindTexture(texType, 0);
+        glState().bindTexture(texture_unit, texType, 0);
         used_units[texture_unit] = -1;
     }
 
@@ -115,8 +113,7 @@ class TextureManager : public GLObject{
     {
        for (int i = 0; i < max_texture_units; ++i) {
          if (used_units[i] == (GLint)texID) {
-             glActiveTexture(GL_TEXTURE0 + i);
-             glBindTexture(texType, 0);
+             glState().bindTexture(i, texType, 0);
              used_units[i] = -1;
          }
        }
@@ -0,0 +1,769 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __BVH__
+#define __BVH__
+
+#include <utils/meshdata.hpp>
+#include <utils/parallel.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Node of a bounding volume hierarchy, 32 bytes.
+ *
+ * Interior nodes have count zero and index pointing to the first of their two children, stored one after the other.
+ * Leaves have count triangles starting at index in the hierarchy triangle order.
+ */
+struct BVHNode
+{
+    /// Minimum corner of the node box.
+    Eigen::Vector3f box_min;
+
+    /// First child of an interior node, or first triangle of a leaf.
+    GLuint index;
+
+    /// Maximum corner of the node box.
+    Eigen::Vector3f box_max;
+
+    /// Number of triangles of a leaf, zero for interior nodes.
+    GLuint count;
+};
+
+/**
+ * @brief Closest intersection of a ray with the triangles.
+ */
+struct RayHit
+{
+    /// Distance along the ray, in units of the ray direction length.
+    float t;
+
+    /// Barycentric coordinates of the hit point relative to the second and third vertices.
+    float u, v;
+
+    /// Index of the triangle in the input index list (position / 3).
+    GLuint triangle;
+};
+
+/**
+ * @brief Closest point of the triangles to a query point.
+ */
+struct NearestHit
+{
+    /// Closest point.
+    Eigen::Vector3f point;
+
+    /// Distance to the query point.
+    float distance;
+
+    /// Index of the triangle in the input index list (position / 3).
+    GLuint triangle;
+};
+
+/**
+ * @brief Bounding volume hierarchy over the triangles of a mesh, for ray casting and proximity queries on the CPU.
+ *
+ * Built top-down with the surface area heuristic evaluated on bins of triangle centroids. The top levels are
+ * split on the calling thread (binning large nodes in parallel), then the subtrees are built in parallel.
+ * The subtrees only depend on the mesh, so the hierarchy is the same for any number of threads.
+ * Queries are const and can run concurrently. Coordinates are those of the vertex arrays (object space).
+ */
+class TriangleBVH
+{
+
+public:
+
+    /**
+     * @brief Default Constructor.
+     */
+    TriangleBVH (void)
+    {
+    }
+
+    /**
+     * @brief Builds the hierarchy from vertex positions and a triangle list.
+     * @param vertices Vertex positions.
+     * @param indices Triangle list indices.
+     * @param num_threads Number of threads, if zero uses the number of hardware threads.
+     */
+    void build (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, unsigned int num_threads = 0)
+    {
+        size_t num_faces = indices.size() / 3;
+        nodes.clear();
+        triangles.clear();
+        triangle_ids.clear();
+        if (num_faces == 0)
+            return;
+        if (num_threads == 0)
+            num_threads = Misc::defaultThreadCount();
+
+        // per triangle bounds and centroids
+        Build b;
+        b.refs.resize(num_faces);
+        Misc::parallelFor(num_faces, [&] (size_t begin, size_t end, unsigned int)
+        {
+            for (size_t f = begin; f < end; ++f)
+            {
+                Eigen::Vector3f a = vertices[indices[3*f]].head<3>();
+                Eigen::Vector3f c = vertices[indices[3*f+1]].head<3>();
+                Eigen::Vector3f d = vertices[indices[3*f+2]].head<3>();
+                b.refs[f].box_min = a.cwiseMin(c).cwiseMin(d);
+                b.refs[f].box_max = a.cwiseMax(c).cwiseMax(d);
+                b.refs[f].triangle = (GLuint)f;
+            }
+        }, (unsigned int)min((size_t)num_threads, num_faces/65536 + 1));
+
+        // top levels, deferring the subtrees below the task size
+        b.task_size = max(num_faces / 256, (size_t)4096);
+        b.num_threads = num_threads;
+        nodes.resize(1);
+        buildNode(b, nodes, 0, 0, num_faces, 0, true);
+
+        // subtrees in parallel, each in its own array
+        vector< vector<BVHNode> > subtrees (b.tasks.size());
+        Misc::parallelFor(b.tasks.size(), [&] (size_t begin, size_t end, unsigned int)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                subtrees[i].resize(1);
+                buildNode(b, subtrees[i], 0, b.tasks[i].begin, b.tasks[i].end, b.tasks[i].depth, false);
+            }
+        }, (unsigned int)min((size_t)num_threads, b.tasks.size()));
+
+        // stitch the subtrees, their root replaces the deferred node
+        for (size_t i = 0; i < b.tasks.size(); ++i)
+        {
+            GLuint offset = (GLuint)nodes.size() - 1;
+            vector<BVHNode>& sub = subtrees[i];
+            for (size_t k = 0; k < sub.size(); ++k)
+                if (sub[k].count == 0)
+                    sub[k].index += offset;
+            nodes[b.tasks[i].node] = sub[0];
+            nodes.insert(nodes.end(), sub.begin()+1, sub.end());
+        }
+
+        // triangle vertices in hierarchy order
+        triangle_ids.resize(num_faces);
+        for (size_t i = 0; i < num_faces; ++i)
+            triangle_ids[i] = b.refs[i].triangle;
+        triangles.resize(3*num_faces);
+        for (size_t i = 0; i < num_faces; ++i)
+            for (int k = 0; k < 3; ++k)
+                triangles[3*i+k] = vertices[indices[3*triangle_ids[i]+k]].head<3>();
+
+        #ifdef TUCANODEBUG
+        cout << "bvh: " << nodes.size() << " nodes for " << num_faces << " triangles" << endl;
+        #endif
+    }
+
+    /**
+     * @brief Builds the hierarchy from the arrays of a mesh.
+     * @param data Mesh arrays.
+     * @param num_threads Number of threads, if zero uses the number of hardware threads.
+     */
+    void build (const MeshData& data, unsigned int num_threads = 0)
+    {
+        build(data.vertices, data.indices, num_threads);
+    }
+
+    /**
+     * @brief Returns true if the hierarchy has no triangle.
+     * @return True if empty.
+     */
+    bool empty (void) const
+    {
+        return nodes.empty();
+    }
+
+    /**
+     * @brief Returns the nodes, the root is the first one.
+     * @return Nodes.
+     */
+    const vector<BVHNode>& getNodes (void) const
+    {
+        return nodes;
+    }
+
+    /**
+     * @brief Returns the bounding box of all triangles.
+     * @return Root box, empty if there is no triangle.
+     */
+    Eigen::AlignedBox3f getBoundingBox (void) const
+    {
+        if (nodes.empty())
+            return Eigen::AlignedBox3f();
+        return Eigen::AlignedBox3f(nodes[0].box_min, nodes[0].box_max);
+    }
+
+    /**
+     * @brief Finds the closest intersection of a ray with the triangles, both faces count.
+     * @param origin Ray origin.
+     * @param direction Ray direction, not necessarily unit length.
+     * @param hit Receives the closest intersection.
+     * @param t_max Largest distance along the ray.
+     * @return True if the ray hits a triangle before t_max.
+     */
+    bool intersect (const Eigen::Vector3f& origin, const Eigen::Vector3f& direction, RayHit& hit, float t_max = numeric_limits<float>::max()) const
+    {
+        return traverse(origin, direction, t_max, false, hit);
+    }
+
+    /**
+     * @brief Tests if any triangle lies along a segment of a ray, stopping at the first one found.
+     *
+     * Cheaper than intersect, suited for visibility and collision tests.
+     * @param origin Ray origin.
+     * @param direction Ray direction, not necessarily unit length.
+     * @param t_max Largest distance along the ray.
+     * @return True if a triangle is hit before t_max.
+     */
+    bool occluded (const Eigen::Vector3f& origin, const Eigen::Vector3f& direction, float t_max = numeric_limits<float>::max()) const
+    {
+        RayHit hit;
+        return traverse(origin, direction, t_max, true, hit);
+    }
+
+    /**
+     * @brief Finds the closest point of the triangles to a point.
+     * @param point Query point.
+     * @param nearest Receives the closest point.
+     * @param max_distance Largest distance searched.
+     * @return True if a triangle is closer than max_distance.
+     */
+    bool nearestPoint (const Eigen::Vector3f& point, NearestHit& nearest, float max_distance = numeric_limits<float>::max()) const
+    {
+        if (nodes.empty())
+            return false;
+
+        float best = (max_distance < sqrt(numeric_limits<float>::max())) ? max_distance*max_distance : numeric_limits<float>::max();
+        bool found = false;
+        GLuint stack[MAX_DEPTH+2];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const BVHNode& node = nodes[stack[--top]];
+            if (boxDistance2(node, point) >= best)
+                continue;
+            if (node.count > 0)
+            {
+                for (GLuint i = node.index; i < node.index + node.count; ++i)
+                {
+                    Eigen::Vector3f q = closestPointTriangle(point, triangles[3*i], triangles[3*i+1], triangles[3*i+2]);
+                    float d = (q - point).squaredNorm();
+                    if (d < best)
+                    {
+                        best = d;
+                        nearest.point = q;
+                        nearest.triangle = triangle_ids[i];
+                        found = true;
+                    }
+                }
+                continue;
+            }
+            // visit the closest child first
+            float d0 = boxDistance2(nodes[node.index], point);
+            float d1 = boxDistance2(nodes[node.index+1], point);
+            GLuint near_child = node.index, far_child = node.index+1;
+            if (d1 < d0)
+                swap(near_child, far_child);
+            stack[top++] = far_child;
+            stack[top++] = near_child;
+        }
+        if (found)
+            nearest.distance = sqrt(best);
+        return found;
+    }
+
+    /**
+     * @brief Returns the closest point of a triangle to a point.
+     *
+     * Real-Time Collision Detection, Christer Ericson, section 5.1.5.
+     * @param p Query point.
+     * @param a First triangle vertex.
+     * @param b Second triangle vertex.
+     * @param c Third triangle vertex.
+     * @return Closest point of the triangle.
+     */
+    static Eigen::Vector3f closestPointTriangle (const Eigen::Vector3f& p, const Eigen::Vector3f& a, const Eigen::Vector3f& b, const Eigen::Vector3f& c)
+    {
+        Eigen::Vector3f ab = b - a, ac = c - a, ap = p - a;
+        float d1 = ab.dot(ap), d2 = ac.dot(ap);
+        if (d1 <= 0.0 && d2 <= 0.0)
+            return a;
+
+        Eigen::Vector3f bp = p - b;
+        float d3 = ab.dot(bp), d4 = ac.dot(bp);
+        if (d3 >= 0.0 && d4 <= d3)
+            return b;
+
+        float vc = d1*d4 - d3*d2;
+        if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+            return a + ab * (d1 / (d1 - d3));
+
+        Eigen::Vector3f cp = p - c;
+        float d5 = ab.dot(cp), d6 = ac.dot(cp);
+        if (d6 >= 0.0 && d5 <= d6)
+            return c;
+
+        float vb = d5*d2 - d1*d6;
+        if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+            return a + ac * (d2 / (d2 - d6));
+
+        float va = d3*d6 - d5*d4;
+        if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+private:
+
+    /// Number of centroid bins per axis evaluated by the surface area heuristic, smaller nodes use one per triangle.
+    static const int NUM_BINS = 16;
+
+    /// Largest number of triangles in a leaf.
+    static const GLuint MAX_LEAF_TRIANGLES = 8;
+
+    /// Largest depth of a leaf, keeps the traversal stacks bounded on degenerate inputs.
+    static const int MAX_DEPTH = 60;
+
+    /// Cost of visiting a node relative to intersecting a triangle.
+    static constexpr float TRAVERSAL_COST = 1.0f;
+
+    /// Triangle range whose subtree is built later, in parallel.
+    struct Task
+    {
+        size_t node, begin, end;
+        int depth;
+    };
+
+    /// Bounding box of a triangle, sorted in place by the build so every pass reads memory in order.
+    struct Reference
+    {
+        Eigen::Vector3f box_min;
+        GLuint triangle;
+        Eigen::Vector3f box_max;
+        float padding;
+
+        float centroid (int axis) const
+        {
+            return (box_min[axis] + box_max[axis]) * 0.5f;
+        }
+    };
+
+    /// Temporary data of a build.
+    struct Build
+    {
+        vector<Reference> refs;
+        vector<Task> tasks;
+        size_t task_size;
+        unsigned int num_threads;
+    };
+
+    /// Centroid bins of the surface area heuristic, for the three axes.
+    struct Bins
+    {
+        Eigen::AlignedBox3f box[3][NUM_BINS];
+        size_t count[3][NUM_BINS];
+        int size;
+        Bins (int num_bins) : size(num_bins)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+                for (int k = 0; k < size; ++k)
+                {
+                    box[axis][k].setEmpty();
+                    count[axis][k] = 0;
+                }
+        }
+    };
+
+    /**
+     * @brief Returns half the surface area of a box, zero if empty.
+     * @param box Box.
+     * @return Half area.
+     */
+    static float halfArea (const Eigen::AlignedBox3f& box)
+    {
+        if (box.isEmpty())
+            return 0.0;
+        Eigen::Vector3f d = box.sizes();
+        return d.x()*d.y() + d.y()*d.z() + d.z()*d.x();
+    }
+
+    /**
+     * @brief Builds the subtree of a triangle range.
+     * @param b Build data, the range of references is reordered.
+     * @param out Node array, children pairs are appended.
+     * @param node Index of the node to fill in out.
+     * @param begin First triangle of the range.
+     * @param end One past the last triangle of the range.
+     * @param depth Depth of the node.
+     * @param defer If true, ranges smaller than the task size are recorded as tasks instead of being built.
+     */
+    static void buildNode (Build& b, vector<BVHNode>& out, size_t node, size_t begin, size_t end, int depth, bool defer)
+    {
+        size_t count = end - begin;
+        bool parallel = defer && count > 65536;
+
+        // node and centroid bounds, in parallel blocks for the large top nodes
+        Eigen::AlignedBox3f bounds, centroid_bounds;
+        if (parallel)
+        {
+            vector<Eigen::AlignedBox3f> part_bounds (b.num_threads), part_centroids (b.num_threads);
+            Misc::parallelFor(count, [&] (size_t first, size_t last, unsigned int block)
+            {
+                boundRange(b, begin + first, begin + last, part_bounds[block], part_centroids[block]);
+            }, b.num_threads);
+            for (unsigned int i = 0; i < b.num_threads; ++i)
+            {
+                bounds.extend(part_bounds[i]);
+                centroid_bounds.extend(part_centroids[i]);
+            }
+        }
+        else
+            boundRange(b, begin, end, bounds, centroid_bounds);
+        out[node].box_min = bounds.min();
+        out[node].box_max = bounds.max();
+
+        if (defer && count <= b.task_size)
+        {
+            Task task = {node, begin, end, depth};
+            b.tasks.push_back(task);
+            return;
+        }
+
+        if (count <= 2 || depth == MAX_DEPTH)
+        {
+            makeLeaf(out[node], begin, count);
+            return;
+        }
+
+        // bin the centroids along the three axes in one pass
+        Eigen::Vector3f extent = centroid_bounds.sizes();
+        Eigen::Vector3f lo = centroid_bounds.min();
+        Eigen::Vector3f scale;
+        int num_bins = (int)min(count, (size_t)NUM_BINS);
+        for (int axis = 0; axis < 3; ++axis)
+            scale[axis] = (extent[axis] > 0.0) ? num_bins / extent[axis] : 0.0f;
+
+        Bins bins (num_bins);
+        if (parallel)
+        {
+            vector<Bins> part_bins (b.num_threads, Bins(num_bins));
+            Misc::parallelFor(count, [&] (size_t first, size_t last, unsigned int block)
+            {
+                binRange(b, begin + first, begin + last, lo, scale, part_bins[block]);
+            }, b.num_threads);
+            for (unsigned int p = 0; p < b.num_threads; ++p)
+                for (int axis = 0; axis < 3; ++axis)
+                    for (int k = 0; k < num_bins; ++k)
+                    {
+                        bins.count[axis][k] += part_bins[p].count[axis][k];
+                        bins.box[axis][k].extend(part_bins[p].box[axis][k]);
+                    }
+        }
+        else
+            binRange(b, begin, end, lo, scale, bins);
+
+        // surface area heuristic, sweeping the bins from the right then from the left
+        int best_axis = -1, best_bin = 0;
+        float best_cost = numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (extent[axis] <= 0.0)
+                continue;
+            float right_area[NUM_BINS];
+            size_t right_count[NUM_BINS];
+            Eigen::AlignedBox3f box;
+            size_t sum = 0;
+            for (int k = num_bins-1; k > 0; --k)
+            {
+                box.extend(bins.box[axis][k]);
+                sum += bins.count[axis][k];
+                right_area[k] = halfArea(box);
+                right_count[k] = sum;
+            }
+            box.setEmpty();
+            sum = 0;
+            for (int k = 0; k < num_bins-1; ++k)
+            {
+                box.extend(bins.box[axis][k]);
+                sum += bins.count[axis][k];
+                if (sum == 0 || right_count[k+1] == 0)
+                    continue;
+                float cost = halfArea(box) * sum + right_area[k+1] * right_count[k+1];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = k;
+                }
+            }
+        }
+
+        float node_area = halfArea(bounds);
+        float leaf_cost = node_area * count;
+        size_t middle;
+        if (best_axis < 0)
+        {
+            // all centroids in one bin: split the range in half to bound the leaf size
+            if (count <= MAX_LEAF_TRIANGLES)
+            {
+                makeLeaf(out[node], begin, count);
+                return;
+            }
+            middle = begin + count/2;
+        }
+        else
+        {
+            if (TRAVERSAL_COST * node_area + best_cost >= leaf_cost && count <= MAX_LEAF_TRIANGLES)
+            {
+                makeLeaf(out[node], begin, count);
+                return;
+            }
+            middle = partition(b.refs.begin() + begin, b.refs.begin() + end, [&] (const Reference& r)
+            {
+                return binIndex(r.centroid(best_axis), lo[best_axis], scale[best_axis], num_bins) <= best_bin;
+            }) - b.refs.begin();
+        }
+
+        size_t left = out.size();
+        out[node].index = (GLuint)left;
+        out[node].count = 0;
+        out.resize(left + 2);
+        buildNode(b, out, left, begin, middle, depth+1, defer);
+        buildNode(b, out, left+1, middle, end, depth+1, defer);
+    }
+
+    /**
+     * @brief Returns the bin of a centroid coordinate.
+     * @param x Centroid coordinate.
+     * @param lo Smallest centroid coordinate of the node.
+     * @param scale Number of bins over the centroid extent.
+     * @param num_bins Number of bins.
+     * @return Bin index.
+     */
+    static inline int binIndex (float x, float lo, float scale, int num_bins)
+    {
+        return min((int)((x - lo) * scale), num_bins-1);
+    }
+
+    /**
+     * @brief Extends the triangle and centroid bounds with a range of triangles.
+     * @param b Build data.
+     * @param begin First triangle of the range.
+     * @param end One past the last triangle of the range.
+     * @param bounds Triangle bounds.
+     * @param centroid_bounds Centroid bounds.
+     */
+    static void boundRange (const Build& b, size_t begin, size_t end, Eigen::AlignedBox3f& bounds, Eigen::AlignedBox3f& centroid_bounds)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Reference& r = b.refs[i];
+            bounds.extend(r.box_min);
+            bounds.extend(r.box_max);
+            centroid_bounds.extend((r.box_min + r.box_max) * 0.5f);
+        }
+    }
+
+    /**
+     * @brief Adds a range of triangles to the centroid bins.
+     * @param b Build data.
+     * @param begin First triangle of the range.
+     * @param end One past the last triangle of the range.
+     * @param lo Smallest centroid coordinates of the node.
+     * @param scale Number of bins over the centroid extent, per axis.
+     * @param bins Bins.
+     */
+    static void binRange (const Build& b, size_t begin, size_t end, const Eigen::Vector3f& lo, const Eigen::Vector3f& scale, Bins& bins)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Reference& r = b.refs[i];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                int k = binIndex(r.centroid(axis), lo[axis], scale[axis], bins.size);
+                bins.count[axis][k]++;
+                bins.box[axis][k].extend(r.box_min);
+                bins.box[axis][k].extend(r.box_max);
+            }
+        }
+    }
+
+    /**
+     * @brief Turns a node into a leaf.
+     * @param node Node.
+     * @param begin First triangle.
+     * @param count Number of triangles.
+     */
+    static void makeLeaf (BVHNode& node, size_t begin, size_t count)
+    {
+        node.index = (GLuint)begin;
+        node.count = (GLuint)count;
+    }
+
+    /**
+     * @brief Intersects a ray with a node box.
+     * @param node Node.
+     * @param origin Ray origin.
+     * @param inv_direction Inverse of the ray direction components.
+     * @param t_max Largest distance along the ray.
+     * @return Entry distance, infinity if the box is missed.
+     */
+    static float boxEntry (const BVHNode& node, const Eigen::Vector3f& origin, const Eigen::Vector3f& inv_direction, float t_max)
+    {
+        Eigen::Vector3f t0 = (node.box_min - origin).cwiseProduct(inv_direction);
+        Eigen::Vector3f t1 = (node.box_max - origin).cwiseProduct(inv_direction);
+        float t_near = max(t0.cwiseMin(t1).maxCoeff(), 0.0f);
+        float t_far = min(t0.cwiseMax(t1).minCoeff(), t_max);
+        return (t_near <= t_far) ? t_near : numeric_limits<float>::infinity();
+    }
+
+    /**
+     * @brief Returns the squared distance from a point to a node box.
+     * @param node Node.
+     * @param p Point.
+     * @return Squared distance, zero inside the box.
+     */
+    static float boxDistance2 (const BVHNode& node, const Eigen::Vector3f& p)
+    {
+        Eigen::Vector3f d = (node.box_min - p).cwiseMax(p - node.box_max).cwiseMax(Eigen::Vector3f::Zero());
+        return d.squaredNorm();
+    }
+
+    /**
+     * @brief Traverses the hierarchy along a ray, intersecting the triangles with the Moller-Trumbore test.
+     * @param origin Ray origin.
+     * @param direction Ray direction.
+     * @param t_max Largest distance along the ray.
+     * @param any_hit Stop at the first intersection found.
+     * @param hit Receives the closest intersection.
+     * @return True if a triangle was hit.
+     */
+    bool traverse (const Eigen::Vector3f& origin, const Eigen::Vector3f& direction, float t_max, bool any_hit, RayHit& hit) const
+    {
+        if (nodes.empty())
+            return false;
+
+        Eigen::Vector3f inv_direction;
+        for (int i = 0; i < 3; ++i)
+            inv_direction[i] = (direction[i] != 0.0) ? 1.0f / direction[i] : numeric_limits<float>::max();
+
+        bool found = false;
+        GLuint stack[MAX_DEPTH+2];
+        float entry[MAX_DEPTH+2];
+        int top = 0;
+        float root = boxEntry(nodes[0], origin, inv_direction, t_max);
+        if (root == numeric_limits<float>::infinity())
+            return false;
+        stack[top] = 0;
+        entry[top++] = root;
+
+        while (top > 0)
+        {
+            --top;
+            if (entry[top] > t_max)
+                continue;
+            const BVHNode& node = nodes[stack[top]];
+            if (node.count > 0)
+            {
+                for (GLuint i = node.index; i < node.index + node.count; ++i)
+                {
+                    const Eigen::Vector3f& a = triangles[3*i];
+                    Eigen::Vector3f e1 = triangles[3*i+1] - a;
+                    Eigen::Vector3f e2 = triangles[3*i+2] - a;
+                    Eigen::Vector3f p = direction.cross(e2);
+                    float det = e1.dot(p);
+                    if (fabs(det) < 1e-20f)
+                        continue;
+                    float inv_det = 1.0f / det;
+                    Eigen::Vector3f s = origin - a;
+                    float u = s.dot(p) * inv_det;
+                    if (u < 0.0 || u > 1.0)
+                        continue;
+                    Eigen::Vector3f q = s.cross(e1);
+                    float v = direction.dot(q) * inv_det;
+                    if (v < 0.0 || u + v > 1.0)
+                        continue;
+                    float t = e2.dot(q) * inv_det;
+                    if (t < 0.0 || t > t_max)
+                        continue;
+                    t_max = t;
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = v;
+                    hit.triangle = triangle_ids[i];
+                    found = true;
+                    if (any_hit)
+                        return true;
+                }
+                continue;
+            }
+
+            // push the farther child first so the nearer one is visited next
+            float e0 = boxEntry(nodes[node.index], origin, inv_direction, t_max);
+            float e1 = boxEntry(nodes[node.index+1], origin, inv_direction, t_max);
+            GLuint c0 = node.index, c1 = node.index+1;
+            if (e1 < e0)
+            {
+                swap(e0, e1);
+                swap(c0, c1);
+            }
+            if (e1 != numeric_limits<float>::infinity())
+            {
+                stack[top] = c1;
+                entry[top++] = e1;
+            }
+            if (e0 != numeric_limits<float>::infinity())
+            {
+                stack[top] = c0;
+                entry[top++] = e0;
+            }
+        }
+        return found;
+    }
+
+    /// Nodes, the root is the first one.
+    vector<BVHNode> nodes;
+
+    /// Triangle vertices in hierarchy order, three per triangle.
+    vector<Eigen::Vector3f> triangles;
+
+    /// Input index of each triangle in hierarchy order.
+    vector<GLuint> triangle_ids;
+};
+
+}
+#endif
@@ -69,6 +69,20 @@ namespace Tucano
 		 * @returns true if the box is outside the frustum, false otherwise. */
 		bool isCullable( const Box& box );
 		
+		/** Tests a bounding sphere against the frustum planes.
+		 * @returns true if the sphere is outside the frustum, false otherwise. */
+		bool isCullable( const Vector3f& center, const float& radius ) const
+		{
+			for( int i = 0; i < 6; ++i )
+			{
+				if( m_planes[ i ]->signedDistance( center ) > radius )
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		
 		friend ostream& operator<<( ostream& out, const Frustum& f )
 		{
 			cout << "Frustum planes:" << endl << endl;
@@ -0,0 +1,244 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MAPPEDFILE__
+#define __MAPPEDFILE__
+
+#include <string>
+#include <cstddef>
+
+#if _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace Tucano
+{
+
+/**
+ * @brief A read-only memory mapped file.
+ *
+ * The whole file is mapped into the address space, so parsers can walk the bytes
+ * directly without copying them into intermediate strings or streams.
+ * The mapping is released when the instance is destroyed or closed.
+ */
+class MappedFile
+{
+
+private:
+
+    /// Pointer to the first byte of the mapped file.
+    const char* file_data;
+
+    /// Size of the mapped file in bytes.
+    size_t file_size;
+
+    /// True if the file was successfully opened, even if it is empty.
+    bool is_open;
+
+#if _WIN32
+    /// File handle.
+    HANDLE file_handle;
+
+    /// File mapping handle.
+    HANDLE mapping_handle;
+#endif
+
+    // mappings are not shareable, avoid copies unmapping the same region twice
+    MappedFile (const MappedFile&);
+    MappedFile& operator= (const MappedFile&);
+
+public:
+
+    /**
+     * @brief Default constructor.
+     */
+    MappedFile (void) : file_data(NULL), file_size(0), is_open(false)
+    {
+#if _WIN32
+        file_handle = INVALID_HANDLE_VALUE;
+        mapping_handle = NULL;
+#endif
+    }
+
+    /**
+     * @brief Constructor that immediately maps a file.
+     * @param filename Path of the file to be mapped.
+     */
+    MappedFile (const std::string& filename) : file_data(NULL), file_size(0), is_open(false)
+    {
+#if _WIN32
+        file_handle = INVALID_HANDLE_VALUE;
+        mapping_handle = NULL;
+#endif
+        open(filename);
+    }
+
+    /**
+     * @brief Default destructor, unmaps the file.
+     */
+    ~MappedFile (void)
+    {
+        close();
+    }
+
+    /**
+     * @brief Maps a file for reading.
+     * @param filename Path of the file to be mapped.
+     * @return True if the file was opened and mapped, false otherwise.
+     */
+    bool open (const std::string& filename)
+    {
+        close();
+
+#if _WIN32
+        file_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file_handle == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_handle, &size))
+        {
+            close();
+            return false;
+        }
+        file_size = (size_t)size.QuadPart;
+
+        if (file_size > 0)
+        {
+            mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping_handle == NULL)
+            {
+                close();
+                return false;
+            }
+            file_data = (const char*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+            if (file_data == NULL)
+            {
+                close();
+                return false;
+            }
+        }
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            ::close(fd);
+            return false;
+        }
+        file_size = (size_t)st.st_size;
+
+        if (file_size > 0)
+        {
+            void* addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                ::close(fd);
+                file_size = 0;
+                return false;
+            }
+            // we usually parse from start to end, let the kernel read ahead aggressively
+            madvise(addr, file_size, MADV_SEQUENTIAL);
+            file_data = (const char*)addr;
+        }
+        // the mapping stays valid after closing the descriptor
+        ::close(fd);
+#endif
+
+        is_open = true;
+        return true;
+    }
+
+    /**
+     * @brief Unmaps the file, if one is mapped.
+     */
+    void close (void)
+    {
+#if _WIN32
+        if (file_data)
+            UnmapViewOfFile(file_data);
+        if (mapping_handle != NULL)
+            CloseHandle(mapping_handle);
+        if (file_handle != INVALID_HANDLE_VALUE)
+            CloseHandle(file_handle);
+        mapping_handle = NULL;
+        file_handle = INVALID_HANDLE_VALUE;
+#else
+        if (file_data)
+            munmap((void*)file_data, file_size);
+#endif
+        file_data = NULL;
+        file_size = 0;
+        is_open = false;
+    }
+
+    /**
+     * @brief Returns wether a file is currently mapped.
+     * @return True if file is open, false otherwise.
+     */
+    bool isOpen (void) const
+    {
+        return is_open;
+    }
+
+    /**
+     * @brief Returns a pointer to the first byte of the file.
+     * @return Pointer to the mapped bytes, NULL if the file is empty or not open.
+     */
+    const char* data (void) const
+    {
+        return file_data;
+    }
+
+    /**
+     * @brief Returns the size of the mapped file.
+     * @return Size in bytes.
+     */
+    size_t size (void) const
+    {
+        return file_size;
+    }
+
+    /**
+     * @brief Returns a pointer to one past the last byte of the file.
+     * @return Pointer to the end of the mapped bytes.
+     */
+    const char* end (void) const
+    {
+        return file_data + file_size;
+    }
+
+};
+
+}
+#endif
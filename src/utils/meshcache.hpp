@@ -0,0 +1,780 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHCACHE__
+#define __MESHCACHE__
+
+#include <mesh.hpp>
+#include <utils/meshdata.hpp>
+#include <utils/meshimportsettings.hpp>
+#include <utils/meshnormals.hpp>
+#include <utils/meshtangents.hpp>
+#include <utils/meshoptimizer.hpp>
+#include <utils/mappedfile.hpp>
+#include <utils/misc.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#if _WIN32
+    #include <direct.h>
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace Tucano
+{
+
+/// Identifies a Tucano binary mesh file.
+const char MESH_CACHE_MAGIC[8] = {'T','U','C','M','E','S','H','\0'};
+
+/// Version of the binary mesh format, files with other versions are ignored.
+const uint32_t MESH_CACHE_VERSION = 3;
+
+/// Alignment in bytes of the attribute blocks inside the file.
+const size_t MESH_CACHE_ALIGNMENT = 64;
+
+/**
+ * @brief Header of a Tucano binary mesh file.
+ *
+ * The file layout is: header, one MeshCacheBlock per array, the source path (path_length bytes),
+ * and the arrays, each starting at a MESH_CACHE_ALIGNMENT aligned offset. Values are stored in the
+ * byte order of the machine writing the file, byte_order tells if it matches the reader.
+ */
+struct MeshCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t num_blocks;
+    uint32_t path_length;
+    /// Modification time of the source file, zero if not written from a source file.
+    int64_t source_mtime;
+    /// Size of the source file.
+    uint64_t source_size;
+    /// Bounding volumes, see BoundingInfo.
+    float box_min[3];
+    float box_max[3];
+    float centroid[3];
+    float radius;
+    float sphere_center[3];
+    float sphere_radius;
+};
+
+/**
+ * @brief Describes one array stored in a Tucano binary mesh file.
+ */
+struct MeshCacheBlock
+{
+    /// Attribute name (ex. "in_Position"), or "indices" for the index buffer.
+    char name[32];
+    /// Component type (ex. GL_FLOAT).
+    uint32_t type;
+    /// Number of components per element.
+    uint32_t element_size;
+    /// GL_ARRAY_BUFFER for attributes, GL_ELEMENT_ARRAY_BUFFER for indices.
+    uint32_t array_type;
+    /// Non-zero if integer components are normalized when read by shaders.
+    uint32_t normalized;
+    /// Number of elements.
+    uint64_t count;
+    /// Offset of the array from the start of the file.
+    uint64_t offset;
+    /// Size of the array in bytes.
+    uint64_t bytes;
+};
+
+namespace MeshImporter
+{
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static bool writeMeshCache (const string& filename, const MeshData& data, const BoundingInfo& bounds, const string& source) __attribute__ ((unused));
+static bool writeMeshCache (const string& filename, Mesh* mesh, const string& source) __attribute__ ((unused));
+static bool loadMeshCache (Mesh* mesh, const string& filename, const string& source) __attribute__ ((unused));
+static bool readMeshCache (const string& filename, MeshData& data, BoundingInfo& bounds, const string& source) __attribute__ ((unused));
+static string meshCachePath (const string& source, const MeshImportSettings& settings) __attribute__ ((unused));
+static bool loadCachedMesh (Mesh* mesh, const string& source, const MeshImportSettings& settings) __attribute__ ((unused));
+static bool readCachedMesh (const string& source, const MeshImportSettings& settings, MeshData& data, BoundingInfo& bounds) __attribute__ ((unused));
+static void storeCachedMesh (const string& source, const MeshImportSettings& settings, const MeshData& data, const BoundingInfo& bounds) __attribute__ ((unused));
+static void storeCachedMesh (const string& source, const MeshImportSettings& settings, const MeshData& data) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Returns the modification time and size of a file.
+ * @param filename Given filename.
+ * @param mtime Receives the modification time.
+ * @param size Receives the size in bytes.
+ * @return True if the file exists, false otherwise.
+ */
+static inline bool fileStamp (const string& filename, int64_t& mtime, uint64_t& size)
+{
+#if _WIN32
+    struct _stat64 st;
+    if (_stat64(filename.c_str(), &st) != 0)
+        return false;
+#else
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+#endif
+    mtime = (int64_t)st.st_mtime;
+    size = (uint64_t)st.st_size;
+    return true;
+}
+
+/**
+ * @brief Returns the absolute form of a path, or the path itself if it cannot be resolved.
+ * @param filename Given filename.
+ * @return Absolute path.
+ */
+static inline string absolutePath (const string& filename)
+{
+#if _WIN32
+    char buffer[_MAX_PATH];
+    if (_fullpath(buffer, filename.c_str(), _MAX_PATH))
+        return string(buffer);
+#else
+    char* resolved = realpath(filename.c_str(), NULL);
+    if (resolved)
+    {
+        string path (resolved);
+        free(resolved);
+        return path;
+    }
+#endif
+    return filename;
+}
+
+/**
+ * @brief Creates a directory and its missing parents.
+ * @param directory Given directory.
+ * @return True if the directory exists at the end, false otherwise.
+ */
+static inline bool createDirectories (const string& directory)
+{
+    for (size_t pos = 1; pos <= directory.size(); ++pos)
+    {
+        if (pos == directory.size() || directory[pos] == '/' || directory[pos] == '\\')
+        {
+            string partial = directory.substr(0, pos);
+#if _WIN32
+            _mkdir(partial.c_str());
+#else
+            mkdir(partial.c_str(), 0755);
+#endif
+        }
+    }
+    struct stat st;
+    return stat(directory.c_str(), &st) == 0 && (st.st_mode & S_IFDIR);
+}
+
+/**
+ * @brief Returns the file caching a given source mesh file.
+ *
+ * The cached file name is a hash of the absolute source path and of the optimization and normal generation settings,
+ * the source modification time and size are stored inside the cached file and checked when it is read.
+ * @param source Path of the OBJ or PLY file.
+ * @param settings Import settings.
+ * @return Path of the cached binary mesh, empty if the cache is disabled.
+ */
+static string meshCachePath (const string& source, const MeshImportSettings& settings)
+{
+    if (!settings.cache.enabled || settings.cache.directory.empty())
+        return string();
+
+    // FNV-1a, stable across runs and platforms
+    string path = absolutePath(source);
+    stringstream tag;
+    const MeshOptimizerSettings& optimizer = settings.optimizer;
+    if (optimizer.enabled)
+    {
+        tag << "?optimized";
+        if (optimizer.overdraw)
+            tag << "&overdraw=" << optimizer.overdraw_threshold;
+    }
+    // default normal generation keeps the plain key
+    const NormalGenerationSettings& normals = settings.normals;
+    if (!normals.enabled || normals.weighting != NORMAL_WEIGHT_ANGLE || normals.crease_angle < 180.0)
+    {
+        tag << (optimizer.enabled ? "&" : "?") << "normals=";
+        if (!normals.enabled)
+            tag << "none";
+        else
+            tag << (normals.weighting == NORMAL_WEIGHT_AREA ? "area" : "angle") << "&crease=" << min(normals.crease_angle, 180.0f);
+    }
+    if (settings.tangents.enabled)
+        tag << (tag.str().empty() ? "?" : "&") << "tangents";
+    path += tag.str();
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        hash ^= (unsigned char)path[i];
+        hash *= 1099511628211ULL;
+    }
+
+    char name[32];
+    sprintf(name, "%016llx.tmc", (unsigned long long)hash);
+    return settings.cache.directory + "/" + name;
+}
+
+/**
+ * @brief Array to be written in a binary mesh file.
+ */
+struct MeshCacheArray
+{
+    string name;
+    GLenum type;
+    int element_size;
+    GLenum array_type;
+    bool normalized;
+    size_t count;
+    const void* data;
+};
+
+/**
+ * @brief Writes arrays and bounding information to a binary mesh file.
+ *
+ * The file is written under a unique temporary name and then renamed, so concurrent readers never see a partial file
+ * and concurrent writers of the same file do not mix their output.
+ * @param filename Output file.
+ * @param arrays Arrays to be written.
+ * @param bounds Bounding volumes of the vertices.
+ * @param source Source file whose modification time is recorded, may be empty.
+ * @return True if the file was written, false otherwise.
+ */
+static inline bool writeMeshCacheArrays (const string& filename, const vector<MeshCacheArray>& arrays,
+                                         const BoundingInfo& bounds, const string& source)
+{
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MESH_CACHE_VERSION;
+    header.byte_order = 0x01020304;
+    header.num_blocks = (uint32_t)arrays.size();
+    for (int i = 0; i < 3; ++i)
+    {
+        header.box_min[i] = bounds.box.min()[i];
+        header.box_max[i] = bounds.box.max()[i];
+        header.centroid[i] = bounds.centroid[i];
+        header.sphere_center[i] = bounds.sphere_center[i];
+    }
+    header.radius = bounds.radius;
+    header.sphere_radius = bounds.sphere_radius;
+
+    string path;
+    if (!source.empty())
+    {
+        if (!fileStamp(source, header.source_mtime, header.source_size))
+            return false;
+        path = absolutePath(source);
+    }
+    header.path_length = (uint32_t)path.size();
+
+    // lay out the blocks after the header, block table and path
+    vector<MeshCacheBlock> blocks (arrays.size());
+    uint64_t offset = sizeof(MeshCacheHeader) + arrays.size()*sizeof(MeshCacheBlock) + path.size();
+    for (size_t i = 0; i < arrays.size(); ++i)
+    {
+        MeshCacheBlock& b = blocks[i];
+        memset(&b, 0, sizeof(b));
+        strncpy(b.name, arrays[i].name.c_str(), sizeof(b.name)-1);
+        b.type = arrays[i].type;
+        b.element_size = arrays[i].element_size;
+        b.array_type = arrays[i].array_type;
+        b.normalized = arrays[i].normalized ? 1 : 0;
+        b.count = arrays[i].count;
+        b.bytes = b.count * VertexAttribute::elementBytes(b.type, b.element_size);
+        offset = (offset + MESH_CACHE_ALIGNMENT-1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+        b.offset = offset;
+        offset += b.bytes;
+    }
+
+    // unique among threads and processes writing the same entry
+#if _WIN32
+    stringstream tmp;
+    tmp << filename << "." << _getpid() << "." << hash<thread::id>()(this_thread::get_id()) << ".tmp";
+    string tmp_filename = tmp.str();
+#else
+    string tmp_filename = filename + ".XXXXXX";
+    int fd = mkstemp(&tmp_filename[0]);
+    if (fd < 0)
+        return false;
+    close(fd);
+#endif
+
+    ofstream out (tmp_filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open())
+    {
+        remove(tmp_filename.c_str());
+        return false;
+    }
+
+    out.write((const char*)&header, sizeof(header));
+    if (!blocks.empty())
+        out.write((const char*)&blocks[0], blocks.size()*sizeof(MeshCacheBlock));
+    out.write(path.data(), path.size());
+
+    const char zeros[MESH_CACHE_ALIGNMENT] = {0};
+    uint64_t written = sizeof(MeshCacheHeader) + blocks.size()*sizeof(MeshCacheBlock) + path.size();
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        out.write(zeros, blocks[i].offset - written);
+        out.write((const char*)arrays[i].data, blocks[i].bytes);
+        written = blocks[i].offset + blocks[i].bytes;
+    }
+    out.close();
+
+    if (out.fail())
+    {
+        remove(tmp_filename.c_str());
+        return false;
+    }
+
+#if _WIN32
+    remove(filename.c_str());
+#endif
+    if (rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    {
+        remove(tmp_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes decoded mesh data to a binary mesh file.
+ * @param filename Output file.
+ * @param data Decoded mesh data.
+ * @param bounds Bounding volumes of the vertices.
+ * @param source Source file whose modification time is recorded, may be empty.
+ * @return True if the file was written, false otherwise.
+ */
+static bool writeMeshCache (const string& filename, const MeshData& data, const BoundingInfo& bounds, const string& source)
+{
+    vector<MeshCacheArray> arrays;
+    MeshCacheArray a;
+    a.type = GL_FLOAT;
+    a.array_type = GL_ARRAY_BUFFER;
+    a.normalized = false;
+    if (!data.vertices.empty())
+    {
+        a.name = "in_Position"; a.element_size = 4; a.count = data.vertices.size(); a.data = data.vertices.data();
+        arrays.push_back(a);
+    }
+    if (!data.normals.empty())
+    {
+        a.name = "in_Normal"; a.element_size = 3; a.count = data.normals.size(); a.data = data.normals.data();
+        arrays.push_back(a);
+    }
+    if (!data.texCoords.empty())
+    {
+        a.name = "in_TexCoords"; a.element_size = 2; a.count = data.texCoords.size(); a.data = data.texCoords.data();
+        arrays.push_back(a);
+    }
+    if (!data.colors.empty())
+    {
+        a.name = "in_Color"; a.element_size = 4; a.count = data.colors.size(); a.data = data.colors.data();
+        arrays.push_back(a);
+    }
+    if (!data.tangents.empty())
+    {
+        a.name = "in_Tangent"; a.element_size = 4; a.count = data.tangents.size(); a.data = data.tangents.data();
+        arrays.push_back(a);
+    }
+    if (!data.indices.empty())
+    {
+        a.name = "indices"; a.type = GL_UNSIGNED_INT; a.array_type = GL_ELEMENT_ARRAY_BUFFER;
+        a.element_size = 1; a.count = data.indices.size(); a.data = data.indices.data();
+        arrays.push_back(a);
+    }
+    return writeMeshCacheArrays(filename, arrays, bounds, source);
+}
+
+/**
+ * @brief Writes a loaded mesh to a binary mesh file.
+ *
+ * All vertex attributes and the index buffer are read back from the GL buffers,
+ * so it must be called from the thread owning the GL context.
+ * @param filename Output file.
+ * @param mesh Pointer to the mesh to be written.
+ * @param source Source file whose modification time is recorded, may be empty.
+ * @return True if the file was written, false otherwise.
+ */
+static bool writeMeshCache (const string& filename, Mesh* mesh, const string& source)
+{
+    const char* names[] = {"in_Position", "in_Normal", "in_TexCoords", "in_Color", "in_Tangent"};
+    vector< vector<char> > buffers;
+    vector<MeshCacheArray> arrays;
+
+    for (int i = 0; i < 5; ++i)
+    {
+        VertexAttribute* va = mesh->getAttribute(names[i]);
+        if (!va || va->getSize() == 0)
+            continue;
+        buffers.push_back(vector<char>(va->getSizeInBytes()));
+        va->read(&buffers.back()[0]);
+
+        MeshCacheArray a;
+        a.name = names[i]; a.type = va->getType(); a.element_size = va->getElementSize();
+        a.array_type = GL_ARRAY_BUFFER; a.normalized = va->isNormalized(); a.count = va->getSize();
+        arrays.push_back(a);
+    }
+
+    vector<GLuint> indices;
+    mesh->readIndices(indices);
+    if (!indices.empty())
+    {
+        MeshCacheArray a;
+        a.name = "indices"; a.type = GL_UNSIGNED_INT; a.element_size = 1;
+        a.array_type = GL_ELEMENT_ARRAY_BUFFER; a.normalized = false; a.count = indices.size(); a.data = indices.data();
+        arrays.push_back(a);
+    }
+
+    // buffers do not move anymore, set the attribute pointers
+    for (size_t i = 0; i < buffers.size(); ++i)
+        arrays[i].data = &buffers[i][0];
+
+    return writeMeshCacheArrays(filename, arrays, mesh->getBoundingInfo(), source);
+}
+
+/**
+ * @brief Maps a binary mesh file and checks its header.
+ *
+ * Every block must lie inside the file and its size must match its element count and format,
+ * so corrupt or truncated files are rejected before any array is read.
+ * @param in Mapped file.
+ * @param filename Binary mesh file.
+ * @param source If not empty, the file is only accepted if it was written from this source file and the source has not changed.
+ * @return Pointer to the header inside the mapping, NULL if the file is missing, invalid or stale.
+ */
+static inline const MeshCacheHeader* openMeshCache (MappedFile& in, const string& filename, const string& source)
+{
+    if (!in.open(filename) || in.size() < sizeof(MeshCacheHeader))
+        return NULL;
+
+    const MeshCacheHeader* header = (const MeshCacheHeader*)in.data();
+    if (memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != MESH_CACHE_VERSION || header->byte_order != 0x01020304)
+        return NULL;
+
+    uint64_t table_end = sizeof(MeshCacheHeader) + (uint64_t)header->num_blocks*sizeof(MeshCacheBlock) + header->path_length;
+    if (table_end > in.size())
+        return NULL;
+
+    // the readers size their arrays from count and copy bytes, both must agree and fit in the file
+    uint64_t file_size = in.size();
+    const MeshCacheBlock* blocks = (const MeshCacheBlock*)(header+1);
+    for (uint32_t i = 0; i < header->num_blocks; ++i)
+    {
+        const MeshCacheBlock& b = blocks[i];
+        if (b.offset < table_end || b.offset > file_size || b.bytes > file_size - b.offset)
+            return NULL;
+        if (b.element_size < 1 || b.element_size > 4 || memchr(b.name, '\0', sizeof(b.name)) == NULL)
+            return NULL;
+        uint64_t element_bytes = VertexAttribute::elementBytes(b.type, b.element_size);
+        if (b.count > b.bytes / element_bytes || b.bytes != b.count * element_bytes)
+            return NULL;
+    }
+
+    if (!source.empty())
+    {
+        int64_t mtime;
+        uint64_t size;
+        const char* path = (const char*)(blocks + header->num_blocks);
+        if (!fileStamp(source, mtime, size) || mtime != header->source_mtime || size != header->source_size ||
+            absolutePath(source).compare(0, string::npos, path, header->path_length) != 0)
+            return NULL;
+    }
+    return header;
+}
+
+/**
+ * @brief Returns the bounding volumes stored in a binary mesh file header.
+ * @param header File header.
+ * @return Bounding information.
+ */
+static inline BoundingInfo meshCacheBounds (const MeshCacheHeader* header)
+{
+    BoundingInfo bounds;
+    bounds.box = Eigen::AlignedBox3f(Eigen::Vector3f(header->box_min[0], header->box_min[1], header->box_min[2]),
+                                     Eigen::Vector3f(header->box_max[0], header->box_max[1], header->box_max[2]));
+    bounds.centroid = Eigen::Vector3f(header->centroid[0], header->centroid[1], header->centroid[2]);
+    bounds.radius = header->radius;
+    bounds.sphere_center = Eigen::Vector3f(header->sphere_center[0], header->sphere_center[1], header->sphere_center[2]);
+    bounds.sphere_radius = header->sphere_radius;
+    return bounds;
+}
+
+/**
+ * @brief Reads a binary mesh file into CPU side mesh data, without touching OpenGL.
+ *
+ * Only the standard attributes (in_Position, in_Normal, in_TexCoords, in_Color, in_Tangent) and GLuint indices are read,
+ * attributes stored in a compact encoding are decoded back to floats.
+ * @param filename Binary mesh file.
+ * @param data Receives the decoded arrays, previous content is discarded.
+ * @param bounds Receives the bounding volumes of the vertices.
+ * @param source If not empty, the file is only read if it was written from this source file and the source has not changed.
+ * @return True if the file was read, false otherwise.
+ */
+static bool readMeshCache (const string& filename, MeshData& data, BoundingInfo& bounds, const string& source)
+{
+    MappedFile in;
+    const MeshCacheHeader* header = openMeshCache(in, filename, source);
+    if (!header)
+        return false;
+
+    data.clear();
+    const MeshCacheBlock* blocks = (const MeshCacheBlock*)(header+1);
+    for (uint32_t i = 0; i < header->num_blocks; ++i)
+    {
+        const MeshCacheBlock& b = blocks[i];
+        const char* p = in.data() + b.offset;
+        string name (b.name);
+        if (b.array_type == GL_ELEMENT_ARRAY_BUFFER && b.type == GL_UNSIGNED_INT && b.element_size == 1)
+        {
+            data.indices.resize(b.count);
+            memcpy(data.indices.data(), p, b.bytes);
+        }
+        else if (b.type == GL_FLOAT && !name.compare("in_Position") && b.element_size == 4)
+        {
+            data.vertices.resize(b.count);
+            memcpy((void*)data.vertices.data(), p, b.bytes);
+        }
+        else if (b.type == GL_FLOAT && !name.compare("in_Normal") && b.element_size == 3)
+        {
+            data.normals.resize(b.count);
+            memcpy((void*)data.normals.data(), p, b.bytes);
+        }
+        else if (b.type == GL_FLOAT && !name.compare("in_TexCoords") && b.element_size == 2)
+        {
+            data.texCoords.resize(b.count);
+            memcpy((void*)data.texCoords.data(), p, b.bytes);
+        }
+        else if (b.type == GL_FLOAT && !name.compare("in_Color") && b.element_size == 4)
+        {
+            data.colors.resize(b.count);
+            memcpy((void*)data.colors.data(), p, b.bytes);
+        }
+        else if (b.type == GL_FLOAT && !name.compare("in_Tangent") && b.element_size == 4)
+        {
+            data.tangents.resize(b.count);
+            memcpy((void*)data.tangents.data(), p, b.bytes);
+        }
+        else if (b.array_type == GL_ARRAY_BUFFER)
+        {
+            // compact encoding, decode element by element
+            VertexFormat format = {(int)b.element_size, (GLenum)b.type, b.normalized != 0, VertexAttribute::elementBytes(b.type, b.element_size)};
+            float v[4];
+            if (!name.compare("in_Position"))
+            {
+                data.vertices.resize(b.count);
+                for (uint64_t j = 0; j < b.count; ++j)
+                {
+                    v[3] = 1.0;
+                    Misc::decodeAttribute(format, p + j*format.bytes, v);
+                    data.vertices[j] = Eigen::Vector4f(v[0], v[1], v[2], v[3]);
+                }
+            }
+            else if (!name.compare("in_Normal"))
+            {
+                data.normals.resize(b.count);
+                for (uint64_t j = 0; j < b.count; ++j)
+                {
+                    Misc::decodeAttribute(format, p + j*format.bytes, v);
+                    data.normals[j] = Eigen::Vector3f(v[0], v[1], v[2]);
+                }
+            }
+            else if (!name.compare("in_TexCoords"))
+            {
+                data.texCoords.resize(b.count);
+                for (uint64_t j = 0; j < b.count; ++j)
+                {
+                    Misc::decodeAttribute(format, p + j*format.bytes, v);
+                    data.texCoords[j] = Eigen::Vector2f(v[0], v[1]);
+                }
+            }
+            else if (!name.compare("in_Color"))
+            {
+                data.colors.resize(b.count);
+                for (uint64_t j = 0; j < b.count; ++j)
+                {
+                    Misc::decodeAttribute(format, p + j*format.bytes, v);
+                    data.colors[j] = Eigen::Vector4f(v[0], v[1], v[2], v[3]);
+                }
+            }
+        }
+    }
+
+    bounds = meshCacheBounds(header);
+    return true;
+}
+
+/**
+ * @brief Loads a mesh from a binary mesh file.
+ *
+ * The file is memory mapped and each array is handed directly to glBufferData, without intermediate copies.
+ * Meshes using the interleaved layout or a compact encoding, and files holding encoded attributes,
+ * are read into MeshData and packed or encoded as the mesh requests instead.
+ * @param mesh Pointer to mesh instance to load file.
+ * @param filename Binary mesh file.
+ * @param source If not empty, the file is only loaded if it was written from this source file and the source has not changed.
+ * @return True if the file was loaded, false otherwise (the mesh is left untouched).
+ */
+static bool loadMeshCache (Mesh* mesh, const string& filename, const string& source)
+{
+    MappedFile in;
+    const MeshCacheHeader* header = openMeshCache(in, filename, source);
+    if (!header)
+        return false;
+
+    const MeshCacheBlock* blocks = (const MeshCacheBlock*)(header+1);
+    bool direct = !mesh->isInterleaved() && mesh->getEncoding() == 0;
+    for (uint32_t i = 0; i < header->num_blocks; ++i)
+    {
+        if (blocks[i].array_type == GL_ARRAY_BUFFER && blocks[i].type != GL_FLOAT)
+            direct = false;
+        if (blocks[i].array_type == GL_ELEMENT_ARRAY_BUFFER && (blocks[i].type != GL_UNSIGNED_INT || blocks[i].element_size != 1))
+            direct = false;
+    }
+
+    if (!direct)
+    {
+        // the blocks are not stored as the mesh wants them, convert them on the way
+        in.close();
+        MeshData data;
+        BoundingInfo bounds;
+        if (!readMeshCache(filename, data, bounds, source))
+            return false;
+        uploadMeshData(mesh, std::move(data));
+        mesh->setBoundingInfo(bounds);
+        return true;
+    }
+
+    #ifdef TUCANODEBUG
+    cout << "Loading cached mesh " << filename.c_str() << endl << endl;
+    #endif
+
+    for (uint32_t i = 0; i < header->num_blocks; ++i)
+    {
+        const MeshCacheBlock& b = blocks[i];
+        const char* data = in.data() + b.offset;
+        if (b.array_type == GL_ELEMENT_ARRAY_BUFFER)
+            mesh->loadIndices((const GLuint*)data, b.count);
+        else
+            mesh->createAttribute(string(b.name), b.count, b.element_size, b.type, data, b.normalized != 0);
+    }
+
+    mesh->setBoundingInfo(meshCacheBounds(header));
+
+    // sets the default locations for accesing attributes in shaders
+    mesh->setDefaultAttribLocations();
+
+    #ifdef TUCANODEBUG
+    Misc::errorCheckFunc(__FILE__, __LINE__);
+    #endif
+
+    return true;
+}
+
+/**
+ * @brief Loads a mesh from the cache, if an up to date cached copy of the source file exists.
+ * @param mesh Pointer to mesh instance to load file.
+ * @param source Path of the OBJ or PLY file.
+ * @param settings Import settings.
+ * @return True if the mesh was loaded from the cache, false otherwise.
+ */
+static bool loadCachedMesh (Mesh* mesh, const string& source, const MeshImportSettings& settings)
+{
+    string cached = meshCachePath(source, settings);
+    return !cached.empty() && loadMeshCache(mesh, cached, source);
+}
+
+/**
+ * @brief Reads a mesh from the cache, if an up to date cached copy of the source file exists.
+ * @param source Path of the OBJ or PLY file.
+ * @param settings Import settings.
+ * @param data Receives the decoded arrays.
+ * @param bounds Receives the bounding volumes of the vertices.
+ * @return True if the mesh was read from the cache, false otherwise.
+ */
+static bool readCachedMesh (const string& source, const MeshImportSettings& settings, MeshData& data, BoundingInfo& bounds)
+{
+    string cached = meshCachePath(source, settings);
+    return !cached.empty() && readMeshCache(cached, data, bounds, source);
+}
+
+/**
+ * @brief Stores decoded mesh data in the cache, failures are silently ignored.
+ * @param source Path of the OBJ or PLY file the data was decoded from.
+ * @param settings Import settings.
+ * @param data Decoded mesh data.
+ * @param bounds Bounding volumes of the vertices.
+ */
+static void storeCachedMesh (const string& source, const MeshImportSettings& settings, const MeshData& data, const BoundingInfo& bounds)
+{
+    string cached = meshCachePath(source, settings);
+    if (cached.empty() || !createDirectories(settings.cache.directory))
+        return;
+    if (!writeMeshCache(cached, data, bounds, source))
+    {
+        #ifdef TUCANODEBUG
+        cerr << "Could not write mesh cache " << cached.c_str() << endl;
+        #endif
+    }
+}
+
+/**
+ * @brief Stores decoded mesh data in the cache, computing its bounding information.
+ * @param source Path of the OBJ or PLY file the data was decoded from.
+ * @param settings Import settings.
+ * @param data Decoded mesh data.
+ */
+static void storeCachedMesh (const string& source, const MeshImportSettings& settings, const MeshData& data)
+{
+    if (meshCachePath(source, settings).empty())
+        return;
+
+    BoundingInfo bounds;
+    if (!data.vertices.empty())
+        Mesh::computeBoundingInfo(data.vertices, bounds);
+    storeCachedMesh(source, settings, data, bounds);
+}
+
+}
+}
+#endif
@@ -0,0 +1,180 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MESHDATA__
+#define __MESHDATA__
+
+#include <mesh.hpp>
+#include <vector>
+#include <utility>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief CPU side content of a mesh, as decoded from a file.
+ *
+ * Holds the attribute arrays and the index buffer before they are uploaded to a Mesh.
+ * Filling a MeshData does not touch OpenGL, so files can be decoded on worker threads
+ * and uploaded later on the thread owning the GL context.
+ */
+struct MeshData
+{
+    /// Vertex coordinates (x,y,z,w).
+    vector<Eigen::Vector4f> vertices;
+
+    /// Vertex normals, empty if not available.
+    vector<Eigen::Vector3f> normals;
+
+    /// Texture coordinates, empty if not available.
+    vector<Eigen::Vector2f> texCoords;
+
+    /// Vertex colors (r,g,b,a), empty if not available.
+    vector<Eigen::Vector4f> colors;
+
+    /// Vertex tangents (x,y,z) and bitangent sign (w), empty if not available (see meshtangents.hpp).
+    vector<Eigen::Vector4f> tangents;
+
+    /// Triangle indices, empty for point clouds.
+    vector<GLuint> indices;
+
+    /**
+     * @brief Releases all arrays.
+     */
+    void clear (void)
+    {
+        vector<Eigen::Vector4f>().swap(vertices);
+        vector<Eigen::Vector3f>().swap(normals);
+        vector<Eigen::Vector2f>().swap(texCoords);
+        vector<Eigen::Vector4f>().swap(colors);
+        vector<Eigen::Vector4f>().swap(tangents);
+        vector<GLuint>().swap(indices);
+    }
+
+    /**
+     * @brief Returns the number of bytes held by the arrays.
+     * @return Size in bytes.
+     */
+    size_t sizeInBytes (void) const
+    {
+        return vertices.size()*sizeof(Eigen::Vector4f) + normals.size()*sizeof(Eigen::Vector3f) +
+               texCoords.size()*sizeof(Eigen::Vector2f) + colors.size()*sizeof(Eigen::Vector4f) +
+               tangents.size()*sizeof(Eigen::Vector4f) + indices.size()*sizeof(GLuint);
+    }
+};
+
+namespace MeshImporter
+{
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static void uploadMeshData (Mesh* mesh, const MeshData& data) __attribute__ ((unused));
+static void uploadMeshData (Mesh* mesh, MeshData&& data) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Uploads decoded mesh data to a mesh.
+ *
+ * Creates one vertex attribute for each non empty array (or a single interleaved buffer if the mesh
+ * uses the interleaved layout, tangents are kept in their own buffer), loads the indices and sets the default attribute locations.
+ * Must be called from the thread owning the GL context.
+ * @param mesh Pointer to mesh instance receiving the data.
+ * @param data Decoded mesh data.
+ */
+static void uploadMeshData (Mesh* mesh, const MeshData& data)
+{
+    if (mesh->isInterleaved() && data.vertices.size() > 0)
+    {
+        mesh->loadInterleaved(data.vertices, data.normals, data.texCoords, data.colors);
+        if (data.tangents.size() > 0)
+            mesh->loadTangents(data.tangents);
+        if (data.indices.size() > 0)
+            mesh->loadIndices(data.indices);
+        mesh->setDefaultAttribLocations();
+        return;
+    }
+
+    // load attributes found in file
+    if (data.vertices.size() > 0)
+        mesh->loadVertices(data.vertices);
+    if (data.normals.size() > 0)
+        mesh->loadNormals(data.normals);
+    if (data.texCoords.size() > 0)
+        mesh->loadTexCoords(data.texCoords);
+    if (data.colors.size() > 0)
+        mesh->loadColors(data.colors);
+    if (data.tangents.size() > 0)
+        mesh->loadTangents(data.tangents);
+    if (data.indices.size() > 0)
+        mesh->loadIndices(data.indices);
+
+    // sets the default locations for accesing attributes in shaders
+    mesh->setDefaultAttribLocations();
+}
+
+/**
+ * @brief Uploads decoded mesh data to a mesh, releasing each array right after its upload.
+ *
+ * Keeps the peak memory close to the size of the largest array instead of the whole mesh,
+ * since the GL already holds its own copy of the uploaded arrays.
+ * @param mesh Pointer to mesh instance receiving the data.
+ * @param data Decoded mesh data, empty on return.
+ */
+static void uploadMeshData (Mesh* mesh, MeshData&& data)
+{
+    if (mesh->isInterleaved() && data.vertices.size() > 0)
+    {
+        mesh->loadInterleaved(data.vertices, data.normals, data.texCoords, data.colors);
+        if (data.tangents.size() > 0)
+            mesh->loadTangents(std::move(data.tangents));
+        if (data.indices.size() > 0)
+            mesh->loadIndices(std::move(data.indices));
+        data.clear();
+        mesh->setDefaultAttribLocations();
+        return;
+    }
+
+    if (data.vertices.size() > 0)
+        mesh->loadVertices(std::move(data.vertices));
+    if (data.normals.size() > 0)
+        mesh->loadNormals(std::move(data.normals));
+    if (data.texCoords.size() > 0)
+        mesh->loadTexCoords(std::move(data.texCoords));
+    if (data.colors.size() > 0)
+        mesh->loadColors(std::move(data.colors));
+    if (data.tangents.size() > 0)
+        mesh->loadTangents(std::move(data.tangents));
+    if (data.indices.size() > 0)
+        mesh->loadIndices(std::move(data.indices));
+
+    // sets the default locations for accesing attributes in shaders
+    mesh->setDefaultAttribLocations();
+}
+
+}
+}
+#endif
@@ -0,0 +1,90 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHIMPORTSETTINGS__
+#define __MESHIMPORTSETTINGS__
+
+#include <utils/meshnormals.hpp>
+#include <utils/meshtangents.hpp>
+#include <utils/meshoptimizer.hpp>
+
+#include <string>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Settings of the binary mesh cache used by the importers (see meshcache.hpp).
+ */
+struct MeshCacheSettings
+{
+    /// If false the importers never read or write cached meshes.
+    bool enabled;
+
+    /// Directory holding the cached meshes, created on the first write.
+    string directory;
+
+    /**
+     * @brief Default constructor, the cache is disabled.
+     */
+    MeshCacheSettings (void) : enabled(false) {}
+
+    /**
+     * @brief Enables the cache in a given directory.
+     * @param dir Directory holding the cached meshes, an empty string disables the cache.
+     */
+    MeshCacheSettings (const string& dir) : enabled(!dir.empty()), directory(dir) {}
+};
+
+/**
+ * @brief Settings of the mesh import pipeline.
+ *
+ * Passed to MeshImporter::loadObjFile, MeshImporter::loadPlyFile and MeshLoader::load.
+ * The importers only read the settings, so the same instance can be shared by loads running on different threads.
+ *
+ * Example:
+ *
+ *     MeshImportSettings settings;
+ *     settings.cache = MeshCacheSettings("cache");
+ *     settings.optimizer.enabled = true;
+ *     MeshImporter::loadObjFile(&mesh, "bunny.obj", settings);
+ */
+struct MeshImportSettings
+{
+    /// Binary mesh cache, disabled by default.
+    MeshCacheSettings cache;
+
+    /// Normal generation for meshes without normals, enabled by default.
+    NormalGenerationSettings normals;
+
+    /// Tangent generation for textured meshes, disabled by default.
+    TangentGenerationSettings tangents;
+
+    /// Vertex cache, overdraw and vertex fetch optimization of decoded meshes, disabled by default.
+    MeshOptimizerSettings optimizer;
+};
+
+}
+#endif
@@ -0,0 +1,285 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHLETS__
+#define __MESHLETS__
+
+#include <utils/meshdata.hpp>
+#include <utils/parallel.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief A cluster of neighboring triangles with the data to cull it as a whole.
+ */
+struct Meshlet
+{
+    /// Position of the first index of the meshlet in the meshlet index list.
+    GLuint first;
+
+    /// Number of indices (three per triangle).
+    GLuint count;
+
+    /// Number of distinct vertices referenced.
+    GLuint vertex_count;
+
+    /// Center of the bounding sphere.
+    Eigen::Vector3f center;
+
+    /// Radius of the bounding sphere.
+    float radius;
+
+    /// Mean direction of the triangle normals.
+    Eigen::Vector3f cone_axis;
+
+    /// Sine of the largest angle between the axis and a triangle normal, 1 if the meshlet cannot be back-face culled.
+    float cone_cutoff;
+};
+
+namespace MeshImporter
+{
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static void computeMeshletBounds (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, Meshlet& meshlet) __attribute__ ((unused));
+static void buildMeshlets (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, unsigned int max_vertices, unsigned int max_triangles, vector<Meshlet>& meshlets, vector<GLuint>& meshlet_indices) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Computes the bounding sphere and the normal cone of a meshlet.
+ * @param vertices Vertex positions.
+ * @param indices Meshlet index list, the meshlet range is given by first and count.
+ * @param meshlet Meshlet, receives the bounds.
+ */
+static void computeMeshletBounds (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, Meshlet& meshlet)
+{
+    Eigen::AlignedBox3f box;
+    for (GLuint i = meshlet.first; i < meshlet.first + meshlet.count; ++i)
+        box.extend(vertices[indices[i]].head<3>());
+    meshlet.center = box.center();
+    meshlet.radius = 0.0;
+    for (GLuint i = meshlet.first; i < meshlet.first + meshlet.count; ++i)
+        meshlet.radius = max(meshlet.radius, (vertices[indices[i]].head<3>() - meshlet.center).norm());
+
+    // normal cone, from the unit normals so small triangles count as much as large ones
+    vector<Eigen::Vector3f> normals;
+    Eigen::Vector3f axis = Eigen::Vector3f::Zero();
+    for (GLuint i = meshlet.first; i < meshlet.first + meshlet.count; i += 3)
+    {
+        Eigen::Vector3f a = vertices[indices[i]].head<3>();
+        Eigen::Vector3f n = (vertices[indices[i+1]].head<3>() - a).cross(vertices[indices[i+2]].head<3>() - a);
+        float len = n.norm();
+        if (len == 0.0)
+            continue;
+        normals.push_back(n / len);
+        axis += normals.back();
+    }
+    meshlet.cone_axis = Eigen::Vector3f::UnitZ();
+    meshlet.cone_cutoff = 1.0;
+    float len = axis.norm();
+    if (normals.empty() || len == 0.0)
+        return;
+    axis /= len;
+    float min_dot = 1.0;
+    for (size_t i = 0; i < normals.size(); ++i)
+        min_dot = min(min_dot, axis.dot(normals[i]));
+    meshlet.cone_axis = axis;
+    // a cone of 90 degrees or more always has a front facing triangle
+    if (min_dot > 0.0)
+        meshlet.cone_cutoff = sqrt(1.0f - min_dot*min_dot);
+}
+
+/**
+ * @brief Partitions a triangle list in meshlets of neighboring triangles.
+ *
+ * Meshlets are grown greedily: each step adds the triangle adjacent to the meshlet that brings the fewest new
+ * vertices, preferring triangles whose vertices have few unassigned triangles left (so no small pockets are left
+ * behind) and then the closest to the meshlet centroid, until the vertex or triangle limit is reached.
+ * A new meshlet starts next to the previous one, or from the first unassigned triangle in index order.
+ * @param vertices Vertex positions.
+ * @param indices Triangle list indices.
+ * @param max_vertices Largest number of distinct vertices per meshlet (at least 3).
+ * @param max_triangles Largest number of triangles per meshlet.
+ * @param meshlets Receives the meshlets, with their bounds.
+ * @param meshlet_indices Receives the triangle list reordered meshlet by meshlet.
+ */
+static void buildMeshlets (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, unsigned int max_vertices, unsigned int max_triangles,
+                           vector<Meshlet>& meshlets, vector<GLuint>& meshlet_indices)
+{
+    size_t n = vertices.size();
+    size_t num_faces = indices.size() / 3;
+    max_vertices = max(max_vertices, 3u);
+    max_triangles = max(max_triangles, 1u);
+    meshlets.clear();
+    meshlet_indices.clear();
+    meshlet_indices.reserve(indices.size());
+
+    // triangles around each vertex
+    vector<GLuint> first (n+1, 0);
+    for (size_t i = 0; i < indices.size(); ++i)
+        first[indices[i]+1]++;
+    for (size_t v = 0; v < n; ++v)
+        first[v+1] += first[v];
+    vector<GLuint> incident (indices.size());
+    {
+        vector<GLuint> fill (first.begin(), first.end()-1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            incident[fill[indices[i]]++] = (GLuint)(i/3);
+    }
+
+    auto triangleCentroid = [&] (const GLuint* t) -> Eigen::Vector3f
+    {
+        return (vertices[t[0]].head<3>() + vertices[t[1]].head<3>() + vertices[t[2]].head<3>()) / 3.0f;
+    };
+
+    // unassigned triangles around each vertex, triangles on nearly finished vertices are taken first to avoid leaving small pockets
+    vector<GLuint> live (n);
+    for (size_t v = 0; v < n; ++v)
+        live[v] = first[v+1] - first[v];
+    auto liveScore = [&] (const GLuint* t) -> GLuint
+    {
+        return live[t[0]] + live[t[1]] + live[t[2]];
+    };
+
+    vector<char> emitted (num_faces, 0);
+    vector<char> in_meshlet (n, 0);
+    vector<GLuint> meshlet_vertices, candidates;
+    size_t seed = 0;
+
+    while (true)
+    {
+        // continue next to the previous meshlet, or from the first unassigned triangle in index order
+        int start = -1;
+        GLuint start_score = 0;
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            GLuint t = candidates[i];
+            if (!emitted[t] && (start < 0 || liveScore(&indices[3*t]) < start_score))
+            {
+                start = (int)t;
+                start_score = liveScore(&indices[3*t]);
+            }
+        }
+        if (start < 0)
+        {
+            while (seed < num_faces && emitted[seed])
+                ++seed;
+            if (seed == num_faces)
+                break;
+            start = (int)seed;
+        }
+
+        Meshlet meshlet;
+        meshlet.first = (GLuint)meshlet_indices.size();
+        meshlet_vertices.clear();
+        candidates.clear();
+        candidates.push_back((GLuint)start);
+        GLuint triangles = 0;
+        Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+
+        while (triangles < max_triangles)
+        {
+            // adjacent triangle adding the fewest vertices, then with the fewest unassigned neighbors,
+            // then closest to the meshlet centroid, dropping the ones already taken
+            int best = -1, best_new = 4;
+            GLuint best_score = 0;
+            float best_distance = 0.0;
+            Eigen::Vector3f centroid = sum / max(triangles, 1u);
+            for (size_t i = 0; i < candidates.size(); )
+            {
+                GLuint t = candidates[i];
+                if (emitted[t])
+                {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                const GLuint* c = &indices[3*t];
+                int added = !in_meshlet[c[0]] + !in_meshlet[c[1]] + !in_meshlet[c[2]];
+                if (added <= best_new)
+                {
+                    GLuint score = liveScore(c);
+                    float distance = (triangleCentroid(c) - centroid).squaredNorm();
+                    if (added < best_new || score < best_score || (score == best_score && distance < best_distance))
+                    {
+                        best = (int)i;
+                        best_new = added;
+                        best_score = score;
+                        best_distance = distance;
+                    }
+                }
+                ++i;
+            }
+            if (best < 0 || meshlet_vertices.size() + best_new > max_vertices)
+                break;
+
+            GLuint t = candidates[best];
+            emitted[t] = 1;
+            ++triangles;
+            sum += triangleCentroid(&indices[3*t]);
+            for (int k = 0; k < 3; ++k)
+            {
+                GLuint v = indices[3*t+k];
+                meshlet_indices.push_back(v);
+                live[v]--;
+                if (in_meshlet[v])
+                    continue;
+                in_meshlet[v] = 1;
+                meshlet_vertices.push_back(v);
+                for (GLuint i = first[v]; i < first[v+1]; ++i)
+                    if (!emitted[incident[i]])
+                        candidates.push_back(incident[i]);
+            }
+        }
+
+        for (size_t i = 0; i < meshlet_vertices.size(); ++i)
+            in_meshlet[meshlet_vertices[i]] = 0;
+        meshlet.count = (GLuint)meshlet_indices.size() - meshlet.first;
+        meshlet.vertex_count = (GLuint)meshlet_vertices.size();
+        meshlets.push_back(meshlet);
+    }
+
+    Misc::parallelFor(meshlets.size(), [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t i = begin; i < end; ++i)
+            computeMeshletBounds(vertices, meshlet_indices, meshlets[i]);
+    }, (unsigned int)min((size_t)Misc::defaultThreadCount(), meshlets.size()/1024 + 1));
+
+    #ifdef TUCANODEBUG
+    cout << "meshlets: " << meshlets.size() << " for " << num_faces << " triangles, " << (meshlets.empty() ? 0.0 : (double)num_faces / meshlets.size()) << " triangles per meshlet" << endl;
+    #endif
+}
+
+}
+}
+#endif
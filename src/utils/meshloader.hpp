@@ -0,0 +1,579 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHLOADER__
+#define __MESHLOADER__
+
+#include <mesh.hpp>
+#include <utils/meshdata.hpp>
+#include <utils/meshimportsettings.hpp>
+#include <utils/objimporter.hpp>
+#include <utils/plyimporter.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Loads meshes in the background.
+ *
+ * Files are decoded into MeshData by worker threads, which never touch OpenGL.
+ * Like the importers, the workers read and fill the binary mesh cache if it is enabled in the import settings (see meshcache.hpp).
+ * The decoded arrays are then uploaded by pump, which must be called regularly (usually once per frame)
+ * on the thread owning the GL context. Each call uploads at most a given number of bytes or runs for at most
+ * a given time, so large models stream in over several frames and the application keeps rendering meanwhile.
+ *
+ * The target mesh is only modified once all its buffers are uploaded, so it can still be rendered with its
+ * previous content while the new one is loading. The mesh must outlive the load.
+ * If the mesh uses the interleaved layout (Mesh::setInterleaved) the workers also pack the vertices.
+ *
+ * Example:
+ *
+ *     MeshLoader loader;
+ *     shared_future<bool> loaded = loader.load(&mesh, "bunny.ply");
+ *     ...
+ *     // every frame, with the context current
+ *     loader.pump();
+ */
+class MeshLoader
+{
+
+private:
+
+    /// Number of upload stages: positions, normals, texcoords, colors, tangents and indices.
+    static const int NUM_UPLOAD_STAGES = 6;
+
+    /// Array uploaded in one stage, in its final buffer format.
+    struct UploadArray
+    {
+        string name;
+        const char* data;
+        int count;
+        int element_size;
+        GLenum type;
+        bool normalized;
+        GLenum array_type;
+    };
+
+    /// One mesh being loaded.
+    struct Job
+    {
+        /// Mesh receiving the data.
+        Mesh* mesh;
+
+        /// File being loaded.
+        string filename;
+
+        /// Import settings, copied when the load is queued.
+        MeshImportSettings settings;
+
+        /// Receives the optimization statistics, may be NULL.
+        MeshOptimizationReport* report;
+
+        /// Decoded arrays.
+        MeshData data;
+
+        /// Bounding volumes, computed by the worker.
+        BoundingInfo bounds;
+
+        /// Signaled when the mesh is ready to be rendered, or the load failed.
+        promise<bool> done;
+
+        /// Array currently being uploaded.
+        int stage;
+
+        /// Number of elements of the current array already uploaded.
+        int uploaded;
+
+        /// Buffers already created, adopted by the mesh when all of them are filled.
+        vector<VertexAttribute> attributes;
+
+        /// True if the mesh uses the interleaved layout, sampled when the load is queued.
+        bool interleaved;
+
+        /// Encoding flags of the mesh, sampled when the load is queued.
+        unsigned int encoding;
+
+        /// Smallest index type of the mesh, sampled when the load is queued.
+        GLenum smallest_index_type;
+
+        /// Array uploaded in each stage, prepared by the worker.
+        UploadArray arrays[NUM_UPLOAD_STAGES];
+
+        /// Encoded (or interleaved) vertex arrays and narrowed indices, owned by the job.
+        vector<char> encoded[NUM_UPLOAD_STAGES];
+
+        /// Attributes present in the interleaved array.
+        bool has_normals, has_texcoords, has_colors;
+
+        Job (Mesh* m, const string& f, const MeshImportSettings& s, MeshOptimizationReport* r) : mesh(m), filename(f), settings(s), report(r), stage(0), uploaded(0), interleaved(m->isInterleaved()),
+            encoding(m->getEncoding()), smallest_index_type(m->getSmallestIndexType()), has_normals(false), has_texcoords(false), has_colors(false) {}
+    };
+
+    /// Worker threads decoding files.
+    vector<thread> workers;
+
+    /// Number of worker threads to be created on the first load.
+    unsigned int num_workers;
+
+    /// Jobs waiting to be decoded.
+    deque< shared_ptr<Job> > decode_queue;
+
+    /// Decoded jobs waiting to be uploaded.
+    deque< shared_ptr<Job> > upload_queue;
+
+    /// Job being uploaded, only accessed by the GL thread.
+    shared_ptr<Job> current;
+
+    /// Number of jobs not yet finished, including the one being uploaded.
+    size_t pending_jobs;
+
+    /// Guards the queues and the pending counter.
+    mutable mutex queue_mutex;
+
+    /// Wakes up workers when a job is queued or the loader is destroyed.
+    condition_variable queue_condition;
+
+    /// Tells workers to exit.
+    bool stopping;
+
+    // threads hold a pointer to the loader
+    MeshLoader (const MeshLoader&);
+    MeshLoader& operator= (const MeshLoader&);
+
+    /**
+     * @brief Returns the lower case extension of a filename.
+     * @param filename Given filename.
+     * @return Extension without the dot, empty if there is none.
+     */
+    static string fileExtension (const string& filename)
+    {
+        size_t dot = filename.find_last_of('.');
+        if (dot == string::npos)
+            return string();
+        string ext = filename.substr(dot+1);
+        for (size_t i = 0; i < ext.size(); ++i)
+            ext[i] = (char)tolower((unsigned char)ext[i]);
+        return ext;
+    }
+
+    /**
+     * @brief Decodes the file of a job, runs on a worker thread.
+     * @param job Job to be decoded.
+     * @return True if the file was decoded, false otherwise.
+     */
+    static bool decode (Job& job)
+    {
+        if (job.report)
+            job.report->optimized = false;
+        bool ok = MeshImporter::readCachedMesh(job.filename, job.settings, job.data, job.bounds);
+        if (!ok)
+        {
+            string ext = fileExtension(job.filename);
+            if (ext.compare("ply") == 0)
+                ok = MeshImporter::readPlyFile(job.filename, job.data);
+            else if (ext.compare("obj") == 0)
+                ok = MeshImporter::readObjFile(job.filename, job.data, 0);
+            else
+                cerr << "file format [" << ext << "] not supported" << endl;
+
+            if (ok)
+            {
+                MeshImporter::generateImportedNormals(job.data, job.settings.normals);
+                MeshImporter::generateImportedTangents(job.data, job.settings.tangents);
+                MeshImporter::optimizeImportedMesh(job.data, job.settings.optimizer, job.report);
+            }
+            if (ok && job.data.vertices.size() > 0)
+                Mesh::computeBoundingInfo(job.data.vertices, job.bounds);
+            if (ok)
+                MeshImporter::storeCachedMesh(job.filename, job.settings, job.data, job.bounds);
+        }
+
+        if (ok)
+            prepare(job);
+        return ok;
+    }
+
+    /**
+     * @brief Worker thread loop, decodes queued jobs until the loader is destroyed.
+     */
+    void workerLoop (void)
+    {
+        while (true)
+        {
+            shared_ptr<Job> job;
+            {
+                unique_lock<mutex> lock (queue_mutex);
+                while (!stopping && decode_queue.empty())
+                    queue_condition.wait(lock);
+                if (stopping)
+                    return;
+                job = decode_queue.front();
+                decode_queue.pop_front();
+            }
+
+            bool ok = decode(*job);
+
+            lock_guard<mutex> lock (queue_mutex);
+            if (ok)
+            {
+                upload_queue.push_back(job);
+            }
+            else
+            {
+                job->done.set_value(false);
+                --pending_jobs;
+            }
+        }
+    }
+
+    /**
+     * @brief Converts the decoded arrays to their buffer format, runs on a worker thread.
+     *
+     * Encodes the attributes selected by the mesh encoding, or packs them in a single array for the interleaved
+     * layout, and narrows the indices to the smallest index type. Source arrays that are not uploaded as they are
+     * get released.
+     * @param job Decoded job.
+     */
+    static void prepare (Job& job)
+    {
+        MeshData& d = job.data;
+        const char* names[NUM_UPLOAD_STAGES] = {"in_Position", "in_Normal", "in_TexCoords", "in_Color", "in_Tangent", "indices"};
+        for (int i = 0; i < NUM_UPLOAD_STAGES; ++i)
+        {
+            UploadArray a = {names[i], NULL, 0, 0, GL_FLOAT, false, GL_ARRAY_BUFFER};
+            job.arrays[i] = a;
+        }
+
+        UploadArray& ind = job.arrays[NUM_UPLOAD_STAGES-1];
+        ind.data = (const char*)d.indices.data(); ind.count = d.indices.size(); ind.element_size = 1;
+        ind.type = Mesh::chooseIndexType(d.indices.data(), d.indices.size(), job.smallest_index_type);
+        ind.array_type = GL_ELEMENT_ARRAY_BUFFER;
+        if (ind.type != GL_UNSIGNED_INT)
+        {
+            Mesh::narrowIndices(d.indices.data(), d.indices.size(), ind.type, job.encoded[NUM_UPLOAD_STAGES-1]);
+            ind.data = job.encoded[NUM_UPLOAD_STAGES-1].data();
+            vector<GLuint>().swap(d.indices);
+        }
+
+        // tangents are uploaded as floats in their own buffer, whatever the layout
+        UploadArray& tang = job.arrays[4];
+        tang.data = (const char*)d.tangents.data(); tang.count = d.tangents.size(); tang.element_size = 4;
+
+        if (job.interleaved && d.vertices.size() > 0)
+        {
+            size_t n = d.vertices.size();
+            job.has_normals = (d.normals.size() == n);
+            job.has_texcoords = (d.texCoords.size() == n);
+            job.has_colors = (d.colors.size() == n);
+            int stride = Mesh::packInterleaved(d.vertices, d.normals, d.texCoords, d.colors, job.encoding, job.encoded[0]);
+
+            UploadArray& a = job.arrays[0];
+            a.name = "interleaved"; a.data = job.encoded[0].data(); a.count = n; a.element_size = stride; a.type = GL_UNSIGNED_BYTE;
+
+            vector<Eigen::Vector4f>().swap(d.vertices);
+            vector<Eigen::Vector3f>().swap(d.normals);
+            vector<Eigen::Vector2f>().swap(d.texCoords);
+            vector<Eigen::Vector4f>().swap(d.colors);
+            return;
+        }
+
+        VertexFormat formats[4] = {Misc::positionFormat(job.encoding), Misc::normalFormat(job.encoding),
+                                   Misc::texCoordFormat(job.encoding), Misc::colorFormat(job.encoding)};
+        const char* floats[4] = {(const char*)d.vertices.data(), (const char*)d.normals.data(),
+                                 (const char*)d.texCoords.data(), (const char*)d.colors.data()};
+        int counts[4] = {(int)d.vertices.size(), (int)d.normals.size(), (int)d.texCoords.size(), (int)d.colors.size()};
+        int float_bytes[4] = {(int)sizeof(Eigen::Vector4f), (int)sizeof(Eigen::Vector3f), (int)sizeof(Eigen::Vector2f), (int)sizeof(Eigen::Vector4f)};
+
+        for (int i = 0; i < 4; ++i)
+        {
+            UploadArray& a = job.arrays[i];
+            a.count = counts[i]; a.element_size = formats[i].components; a.type = formats[i].type; a.normalized = formats[i].normalized;
+            if (formats[i].type == GL_FLOAT && formats[i].bytes == float_bytes[i])
+            {
+                a.data = floats[i];
+                continue;
+            }
+            switch (i)
+            {
+                case 0: Misc::encodeArray(d.vertices, job.encoding, formats[i].bytes, Misc::encodePosition, job.encoded[i]); vector<Eigen::Vector4f>().swap(d.vertices); break;
+                case 1: Misc::encodeArray(d.normals, job.encoding, formats[i].bytes, Misc::encodeNormal, job.encoded[i]); vector<Eigen::Vector3f>().swap(d.normals); break;
+                case 2: Misc::encodeArray(d.texCoords, job.encoding, formats[i].bytes, Misc::encodeTexCoord, job.encoded[i]); vector<Eigen::Vector2f>().swap(d.texCoords); break;
+                default: Misc::encodeArray(d.colors, job.encoding, formats[i].bytes, Misc::encodeColor, job.encoded[i]); vector<Eigen::Vector4f>().swap(d.colors); break;
+            }
+            a.data = job.encoded[i].data();
+        }
+    }
+
+    /**
+     * @brief Hands the uploaded buffers to the mesh and signals the job.
+     *
+     * Only the previous buffers of the mesh are released, its model matrix is kept.
+     * @param job Job whose buffers are all filled.
+     */
+    void finish (Job& job)
+    {
+        Mesh* mesh = job.mesh;
+        mesh->clearGeometry();
+        mesh->initGL();
+
+        for (unsigned int i = 0; i < job.attributes.size(); ++i)
+        {
+            if (job.attributes[i].getArrayType() == GL_ELEMENT_ARRAY_BUFFER)
+                mesh->setIndexBuffer(job.attributes[i]);
+            else if (!job.attributes[i].getName().compare("interleaved"))
+                mesh->addInterleavedAttributes(job.attributes[i].getBufferID(), job.attributes[i].getSize(),
+                                               job.has_normals, job.has_texcoords, job.has_colors, job.encoding);
+            else
+                mesh->addAttribute(job.attributes[i]);
+        }
+        job.attributes.clear();
+
+        if (job.arrays[0].count > 0)
+            mesh->setBoundingInfo(job.bounds);
+
+        // sets the default locations for accesing attributes in shaders
+        mesh->setDefaultAttribLocations();
+
+        #ifdef TUCANODEBUG
+        Misc::errorCheckFunc(__FILE__, __LINE__);
+        #endif
+
+        job.data.clear();
+        for (int i = 0; i < NUM_UPLOAD_STAGES; ++i)
+            vector<char>().swap(job.encoded[i]);
+        job.done.set_value(true);
+
+        lock_guard<mutex> lock (queue_mutex);
+        --pending_jobs;
+    }
+
+    /**
+     * @brief Signals false to all jobs not yet finished and drops them, the queue mutex must be held.
+     * Buffers already created for the current job are not deleted.
+     */
+    void cancelJobs (void)
+    {
+        if (current)
+        {
+            upload_queue.push_front(current);
+            current.reset();
+        }
+        while (!decode_queue.empty())
+        {
+            decode_queue.front()->done.set_value(false);
+            decode_queue.pop_front();
+            --pending_jobs;
+        }
+        while (!upload_queue.empty())
+        {
+            upload_queue.front()->done.set_value(false);
+            upload_queue.pop_front();
+            --pending_jobs;
+        }
+    }
+
+public:
+
+    /**
+     * @brief Default constructor.
+     * Worker threads are only created on the first load.
+     * @param decode_threads Number of files decoded at the same time.
+     */
+    MeshLoader (unsigned int decode_threads = 1) : num_workers(max(decode_threads, 1u)), pending_jobs(0), stopping(false) {}
+
+    /**
+     * @brief Destructor, cancels the loads not yet finished and waits for the workers to finish the file they are decoding.
+     *
+     * The futures of cancelled loads hold false, so threads waiting on them are released.
+     * Buffers of a partially uploaded mesh are not deleted here, since the GL context may already be gone,
+     * call clear with the context current to release them.
+     */
+    ~MeshLoader (void)
+    {
+        {
+            lock_guard<mutex> lock (queue_mutex);
+            stopping = true;
+        }
+        queue_condition.notify_all();
+        for (unsigned int i = 0; i < workers.size(); ++i)
+            workers[i].join();
+
+        // workers are gone, jobs they decoded last are in the upload queue
+        lock_guard<mutex> lock (queue_mutex);
+        cancelJobs();
+    }
+
+    /**
+     * @brief Queues a mesh file (OBJ or PLY) to be loaded.
+     *
+     * Returns immediately, the file is decoded on a worker thread and uploaded by subsequent calls to pump.
+     * @param mesh Mesh receiving the file content, its previous content is replaced when the upload is complete.
+     * @param filename Given mesh file.
+     * @param settings Import settings, copied so the caller may change them while the load runs.
+     * @param report If not NULL receives the vertex cache statistics of the optimization, valid once the future is ready.
+     * @return Future holding true when the mesh is ready to be rendered, or false if the file could not be read.
+     */
+    shared_future<bool> load (Mesh* mesh, const string& filename, const MeshImportSettings& settings = MeshImportSettings(),
+                              MeshOptimizationReport* report = 0)
+    {
+        shared_ptr<Job> job (new Job(mesh, filename, settings, report));
+        shared_future<bool> result = job->done.get_future().share();
+        {
+            lock_guard<mutex> lock (queue_mutex);
+            if (workers.empty())
+            {
+                for (unsigned int i = 0; i < num_workers; ++i)
+                    workers.push_back(thread(&MeshLoader::workerLoop, this));
+            }
+            decode_queue.push_back(job);
+            ++pending_jobs;
+        }
+        queue_condition.notify_one();
+        return result;
+    }
+
+    /**
+     * @brief Uploads decoded meshes, must be called on the thread owning the GL context.
+     *
+     * Uploads arrays in slices until the byte or the time budget is spent. At least one slice is uploaded per call,
+     * so loads always make progress. When all arrays of a mesh are uploaded the mesh content is replaced
+     * and its future becomes ready.
+     * @param max_milliseconds Time budget, zero for no limit.
+     * @param max_bytes Upload budget in bytes, zero for no limit.
+     * @return Number of meshes whose load finished during this call.
+     */
+    int pump (double max_milliseconds = 4.0, size_t max_bytes = 16*1024*1024)
+    {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        size_t uploaded_bytes = 0;
+        int finished = 0;
+
+        while (true)
+        {
+            if (!current)
+            {
+                lock_guard<mutex> lock (queue_mutex);
+                if (upload_queue.empty())
+                    break;
+                current = upload_queue.front();
+                upload_queue.pop_front();
+            }
+
+            Job& job = *current;
+            if (job.stage == NUM_UPLOAD_STAGES)
+            {
+                finish(job);
+                current.reset();
+                ++finished;
+            }
+            else
+            {
+                const UploadArray& a = job.arrays[job.stage];
+
+                if (job.uploaded == a.count)
+                {
+                    // array done (or empty), move to next one
+                    job.stage++;
+                    job.uploaded = 0;
+                    continue;
+                }
+
+                if (job.uploaded == 0)
+                {
+                    job.attributes.push_back(VertexAttribute(a.name, a.count, a.element_size, a.type, a.array_type));
+                    job.attributes.back().setNormalized(a.normalized);
+                    job.attributes.back().allocate();
+                }
+
+                VertexAttribute& va = job.attributes.back();
+                size_t stride = va.getElementBytes();
+                int slice = a.count - job.uploaded;
+                if (max_bytes > 0)
+                {
+                    size_t budget = (max_bytes > uploaded_bytes) ? max_bytes - uploaded_bytes : 0;
+                    slice = (int)min((size_t)slice, max(budget / stride, (size_t)1));
+                }
+                va.update(job.uploaded, slice, a.data + job.uploaded*stride);
+                job.uploaded += slice;
+                uploaded_bytes += slice*stride;
+            }
+
+            if (max_bytes > 0 && uploaded_bytes >= max_bytes)
+                break;
+            if (max_milliseconds > 0.0 && chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count() >= max_milliseconds)
+                break;
+        }
+        return finished;
+    }
+
+    /**
+     * @brief Returns the number of loads not yet finished.
+     * @return Number of meshes being decoded or uploaded.
+     */
+    size_t pending (void) const
+    {
+        lock_guard<mutex> lock (queue_mutex);
+        return pending_jobs;
+    }
+
+    /**
+     * @brief Returns wether there are loads not yet finished.
+     * @return True if some mesh is being decoded or uploaded.
+     */
+    bool busy (void) const
+    {
+        return pending() > 0;
+    }
+
+    /**
+     * @brief Cancels all loads not yet uploaded, their futures hold false.
+     * Files being decoded at the moment are still finished and uploaded.
+     * Must be called with the GL context current, since partially uploaded buffers are deleted.
+     */
+    void clear (void)
+    {
+        lock_guard<mutex> lock (queue_mutex);
+        if (current)
+        {
+            for (unsigned int i = 0; i < current->attributes.size(); ++i)
+                current->attributes[i].destroy();
+        }
+        cancelJobs();
+    }
+
+};
+
+}
+#endif
@@ -0,0 +1,438 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHNORMALS__
+#define __MESHNORMALS__
+
+#include <utils/meshdata.hpp>
+#include <utils/parallel.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/// Weight of each triangle in the normal of its vertices.
+enum NormalWeighting
+{
+    /// Weighted by triangle area, large triangles dominate.
+    NORMAL_WEIGHT_AREA = 0,
+    /// Weighted by the triangle angle at the vertex, independent of the tessellation.
+    NORMAL_WEIGHT_ANGLE = 1
+};
+
+/**
+ * @brief Settings of the normal generation run by the importers.
+ */
+struct NormalGenerationSettings
+{
+    /// If true the importers generate normals for triangle meshes without normals.
+    bool enabled;
+
+    /// Weight of each triangle in the vertex normals.
+    NormalWeighting weighting;
+
+    /// Vertices are split where adjacent triangles meet at a larger angle (degrees), 180 disables the split.
+    float crease_angle;
+
+    /**
+     * @brief Default constructor, normals are generated with angle weighting and no crease split.
+     */
+    NormalGenerationSettings (void) : enabled(true), weighting(NORMAL_WEIGHT_ANGLE), crease_angle(180.0) {}
+};
+
+namespace MeshImporter
+{
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static void computeVertexNormals (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, vector<Eigen::Vector3f>& normals, NormalWeighting weighting, unsigned int num_threads) __attribute__ ((unused));
+static void computeCreaseNormals (MeshData& data, NormalWeighting weighting, float crease_angle, unsigned int num_threads) __attribute__ ((unused));
+static void generateNormals (MeshData& data, NormalWeighting weighting, float crease_angle, unsigned int num_threads) __attribute__ ((unused));
+static void generateImportedNormals (MeshData& data, const NormalGenerationSettings& settings) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Computes the angles of a triangle at its three corners.
+ * @param a First vertex.
+ * @param b Second vertex.
+ * @param c Third vertex.
+ * @param angles Receives the angle at a, b and c in radians.
+ * @return False for degenerate triangles (zero area), the angles are then left undefined.
+ */
+inline bool triangleCornerAngles (const Eigen::Vector3f& a, const Eigen::Vector3f& b, const Eigen::Vector3f& c, float angles[3])
+{
+    Eigen::Vector3f e0 = b - a;
+    Eigen::Vector3f e1 = c - b;
+    Eigen::Vector3f e2 = a - c;
+    float l0 = e0.norm(), l1 = e1.norm(), l2 = e2.norm();
+    if (l0 == 0.0 || l1 == 0.0 || l2 == 0.0 || e0.cross(e2).squaredNorm() == 0.0)
+        return false;
+
+    // angle at each corner between its two edges
+    angles[0] = acos(max(-1.0f, min(1.0f, -e0.dot(e2) / (l0*l2))));
+    angles[1] = acos(max(-1.0f, min(1.0f, -e1.dot(e0) / (l1*l0))));
+    angles[2] = acos(max(-1.0f, min(1.0f, -e2.dot(e1) / (l2*l1))));
+    return true;
+}
+
+/**
+ * @brief Returns the contribution of a triangle to the normals of its three corners.
+ * @param a First vertex.
+ * @param b Second vertex.
+ * @param c Third vertex.
+ * @param weighting Area or angle weighting.
+ * @param w Receives the contribution to the normal of each corner, zero for degenerate triangles.
+ */
+inline void triangleNormalWeights (const Eigen::Vector3f& a, const Eigen::Vector3f& b, const Eigen::Vector3f& c,
+                                   NormalWeighting weighting, Eigen::Vector3f w[3])
+{
+    // the cross product length is twice the area
+    Eigen::Vector3f n = (b - a).cross(c - a);
+    if (weighting == NORMAL_WEIGHT_AREA)
+    {
+        w[0] = w[1] = w[2] = n;
+        return;
+    }
+
+    float angles[3];
+    if (!triangleCornerAngles(a, b, c, angles))
+    {
+        w[0] = w[1] = w[2] = Eigen::Vector3f::Zero();
+        return;
+    }
+    n.normalize();
+    for (int k = 0; k < 3; ++k)
+        w[k] = n * angles[k];
+}
+
+/**
+ * @brief Sums per corner values of a triangle mesh into its vertices, in parallel.
+ *
+ * Each thread accumulates a block of triangles in its own array, covering only the range of vertices
+ * referenced by its block, and the arrays are then summed over vertex ranges in parallel.
+ * There is no atomic or shared write; with the usual index locality the arrays are much smaller than the mesh.
+ * The function receives a triangle index and writes the values of its three corners: corners(f, w).
+ * Triangles referencing vertices out of range are skipped.
+ * @param indices Triangle list indices.
+ * @param num_vertices Number of vertices.
+ * @param corners Function computing the corner values of a triangle.
+ * @param sums Receives one sum per vertex, zero for vertices not referenced.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+template <class T, class Allocator, class Function>
+void accumulateCorners (const vector<GLuint>& indices, size_t num_vertices, Function corners, vector<T, Allocator>& sums, unsigned int num_threads = 0)
+{
+    size_t num_faces = indices.size() / 3;
+    size_t n = num_vertices;
+    sums.assign(n, T::Zero());
+    if (num_faces == 0 || n == 0)
+        return;
+
+    // small meshes are not worth the threads
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    num_threads = (unsigned int)min((size_t)num_threads, num_faces/65536 + 1);
+
+    struct Partial
+    {
+        size_t first;
+        vector<T, Allocator> sum;
+    };
+    vector<Partial> partials (num_threads);
+
+    // per thread accumulation over the vertex range of each triangle block
+    unsigned int blocks = Misc::parallelFor(num_faces, [&] (size_t begin, size_t end, unsigned int t)
+    {
+        Partial& p = partials[t];
+        p.first = 0;
+        GLuint lo = ~0u, hi = 0;
+        for (size_t i = 3*begin; i < 3*end; ++i)
+        {
+            lo = min(lo, indices[i]);
+            hi = max(hi, indices[i]);
+        }
+        if (begin == end || lo >= n)
+            return;
+        hi = (GLuint)min((size_t)hi, n-1);
+        p.first = lo;
+        p.sum.assign(hi - lo + 1, T::Zero());
+
+        T w[3];
+        for (size_t f = begin; f < end; ++f)
+        {
+            const GLuint* v = &indices[3*f];
+            if (v[0] >= n || v[1] >= n || v[2] >= n)
+                continue;
+            corners(f, w);
+            for (int k = 0; k < 3; ++k)
+                p.sum[v[k] - lo] += w[k];
+        }
+    }, num_threads);
+
+    // reduction over vertex ranges, each output value is written by one thread
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (unsigned int t = 0; t < blocks; ++t)
+        {
+            const Partial& p = partials[t];
+            size_t first = max(begin, p.first);
+            size_t last = min(end, p.first + p.sum.size());
+            for (size_t v = first; v < last; ++v)
+                sums[v] += p.sum[v - p.first];
+        }
+    }, num_threads);
+}
+
+/**
+ * @brief Computes smooth vertex normals of a triangle mesh.
+ *
+ * Triangle contributions are summed in parallel without shared writes (see accumulateCorners).
+ * Vertices not referenced by any triangle get a zero normal.
+ * @param vertices Vertex positions.
+ * @param indices Triangle list indices.
+ * @param normals Receives one unit normal per vertex.
+ * @param weighting Area or angle weighting.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+static void computeVertexNormals (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, vector<Eigen::Vector3f>& normals,
+                                  NormalWeighting weighting = NORMAL_WEIGHT_ANGLE, unsigned int num_threads = 0)
+{
+    accumulateCorners(indices, vertices.size(), [&] (size_t f, Eigen::Vector3f w[3])
+    {
+        const GLuint* v = &indices[3*f];
+        triangleNormalWeights(vertices[v[0]].head<3>(), vertices[v[1]].head<3>(), vertices[v[2]].head<3>(), weighting, w);
+    }, normals, num_threads);
+
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    Misc::parallelFor(normals.size(), [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            float len = normals[v].norm();
+            if (len > 0.0)
+                normals[v] /= len;
+        }
+    }, (unsigned int)min((size_t)num_threads, normals.size()/65536 + 1));
+}
+
+/**
+ * @brief Computes vertex normals of a triangle mesh, splitting vertices along creases.
+ *
+ * The normal of a triangle corner averages only the adjacent triangles whose normals are within the crease angle
+ * of the corner triangle. Corners of a vertex ending with different normals get their own copy of the vertex,
+ * with the other attributes duplicated, and the indices are updated.
+ * Vertices and corners are processed in parallel, the vertex to triangle adjacency is built in a serial counting pass.
+ * @param data Mesh data, normals are replaced.
+ * @param weighting Area or angle weighting.
+ * @param crease_angle Crease angle in degrees.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+static void computeCreaseNormals (MeshData& data, NormalWeighting weighting = NORMAL_WEIGHT_ANGLE,
+                                  float crease_angle = 180.0, unsigned int num_threads = 0)
+{
+    const vector<Eigen::Vector4f>& vertices = data.vertices;
+    const vector<GLuint>& indices = data.indices;
+    size_t num_faces = indices.size() / 3;
+    size_t n = vertices.size();
+    if (num_faces == 0 || n == 0)
+        return;
+
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    num_threads = (unsigned int)min((size_t)num_threads, num_faces/65536 + 1);
+
+    // corner contributions and unit face normals
+    vector<Eigen::Vector3f> weights (3*num_faces);
+    vector<Eigen::Vector3f> face_normals (num_faces);
+    Misc::parallelFor(num_faces, [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t f = begin; f < end; ++f)
+        {
+            const GLuint* v = &indices[3*f];
+            if (v[0] >= n || v[1] >= n || v[2] >= n)
+            {
+                weights[3*f] = weights[3*f+1] = weights[3*f+2] = face_normals[f] = Eigen::Vector3f::Zero();
+                continue;
+            }
+            triangleNormalWeights(vertices[v[0]].head<3>(), vertices[v[1]].head<3>(), vertices[v[2]].head<3>(), weighting, &weights[3*f]);
+            face_normals[f] = (vertices[v[1]] - vertices[v[0]]).head<3>().cross((vertices[v[2]] - vertices[v[0]]).head<3>());
+            float len = face_normals[f].norm();
+            if (len > 0.0)
+                face_normals[f] /= len;
+        }
+    }, num_threads);
+
+    // corners of each vertex (compressed rows)
+    vector<size_t> first (n+1, 0);
+    for (size_t i = 0; i < indices.size(); ++i)
+        if (indices[i] < n)
+            first[indices[i]+1]++;
+    for (size_t v = 0; v < n; ++v)
+        first[v+1] += first[v];
+    vector<GLuint> corners (first[n]);
+    {
+        vector<size_t> fill (first.begin(), first.end()-1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            if (indices[i] < n)
+                corners[fill[indices[i]]++] = (GLuint)i;
+    }
+
+    // corner normals and number of distinct normals per vertex
+    float cos_crease = cos(min(180.0f, max(0.0f, crease_angle)) * 3.14159265358979f / 180.0f);
+    vector<Eigen::Vector3f> corner_normals (indices.size(), Eigen::Vector3f::Zero());
+    vector<size_t> copies (n+1, 0);
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            size_t count = 0;
+            for (size_t i = first[v]; i < first[v+1]; ++i)
+            {
+                const Eigen::Vector3f& fn = face_normals[corners[i]/3];
+                Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+                for (size_t j = first[v]; j < first[v+1]; ++j)
+                {
+                    if (i == j || fn.dot(face_normals[corners[j]/3]) >= cos_crease)
+                        sum += weights[corners[j]];
+                }
+                float len = sum.norm();
+                if (len > 0.0)
+                    sum /= len;
+                corner_normals[corners[i]] = sum;
+
+                // identical neighbor sets sum to the same normal, so equal normals share a vertex
+                bool found = false;
+                for (size_t j = first[v]; j < i && !found; ++j)
+                    found = (corner_normals[corners[j]] == sum);
+                if (!found)
+                    ++count;
+            }
+            // unreferenced vertices are kept
+            copies[v+1] = max(count, (size_t)1);
+        }
+    }, num_threads);
+    for (size_t v = 0; v < n; ++v)
+        copies[v+1] += copies[v];
+
+    // split vertices, each source vertex owns a contiguous range of output vertices
+    size_t m = copies[n];
+    vector<Eigen::Vector4f> out_vertices (m);
+    vector<Eigen::Vector3f> out_normals (m, Eigen::Vector3f::Zero());
+    vector<Eigen::Vector2f> out_texcoords (data.texCoords.size() == n ? m : 0);
+    vector<Eigen::Vector4f> out_colors (data.colors.size() == n ? m : 0);
+    vector<Eigen::Vector4f> out_tangents (data.tangents.size() == n ? m : 0);
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            size_t next = copies[v];
+            for (size_t c = copies[v]; c < copies[v+1]; ++c)
+            {
+                out_vertices[c] = vertices[v];
+                if (!out_texcoords.empty())
+                    out_texcoords[c] = data.texCoords[v];
+                if (!out_colors.empty())
+                    out_colors[c] = data.colors[v];
+                if (!out_tangents.empty())
+                    out_tangents[c] = data.tangents[v];
+            }
+            for (size_t i = first[v]; i < first[v+1]; ++i)
+            {
+                size_t corner = corners[i];
+                size_t target = next;
+                for (size_t j = first[v]; j < i; ++j)
+                {
+                    if (corner_normals[corners[j]] == corner_normals[corner])
+                    {
+                        target = data.indices[corners[j]];
+                        break;
+                    }
+                }
+                if (target == next)
+                {
+                    out_normals[next] = corner_normals[corner];
+                    ++next;
+                }
+                data.indices[corner] = (GLuint)target;
+            }
+        }
+    }, num_threads);
+
+    data.vertices.swap(out_vertices);
+    data.normals.swap(out_normals);
+    if (!out_texcoords.empty())
+        data.texCoords.swap(out_texcoords);
+    if (!out_colors.empty())
+        data.colors.swap(out_colors);
+    if (!out_tangents.empty())
+        data.tangents.swap(out_tangents);
+}
+
+/**
+ * @brief Generates the normals of a triangle mesh.
+ *
+ * Without crease (angle of 180 degrees or more) the vertices are kept and get smooth normals,
+ * otherwise vertices on creases are split (see computeCreaseNormals).
+ * @param data Mesh data, normals are replaced.
+ * @param weighting Area or angle weighting.
+ * @param crease_angle Crease angle in degrees.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+static void generateNormals (MeshData& data, NormalWeighting weighting = NORMAL_WEIGHT_ANGLE,
+                             float crease_angle = 180.0, unsigned int num_threads = 0)
+{
+    if (data.indices.empty() || data.indices.size() % 3 != 0 || data.vertices.empty())
+        return;
+
+    if (crease_angle >= 180.0)
+        computeVertexNormals(data.vertices, data.indices, data.normals, weighting, num_threads);
+    else
+        computeCreaseNormals(data, weighting, crease_angle, num_threads);
+}
+
+/**
+ * @brief Generates normals for freshly decoded triangle meshes without normals, if enabled in the settings.
+ * Called by the importers before the mesh optimization.
+ * @param data Mesh data.
+ * @param settings Normal generation settings (see MeshImportSettings).
+ */
+static void generateImportedNormals (MeshData& data, const NormalGenerationSettings& settings)
+{
+    if (!settings.enabled || !data.normals.empty())
+        return;
+
+    generateNormals(data, settings.weighting, settings.crease_angle);
+}
+
+}
+}
+#endif
@@ -0,0 +1,544 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHOPTIMIZER__
+#define __MESHOPTIMIZER__
+
+#include <utils/meshdata.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Post-transform vertex cache statistics of an index buffer.
+ */
+struct VertexCacheStatistics
+{
+    /// Number of vertices transformed (cache misses).
+    size_t vertices_transformed;
+
+    /// Average cache miss ratio: transformed vertices per triangle (0.5 is ideal for regular grids, 3 is the worst).
+    float acmr;
+
+    /// Average transform to vertex ratio: transformed vertices per referenced vertex (1 is ideal).
+    float atvr;
+};
+
+/**
+ * @brief Result of the optimization of an imported mesh.
+ */
+struct MeshOptimizationReport
+{
+    /// True if the mesh was optimized, false if the optimization is disabled, the mesh came from the cache or it has no triangles.
+    bool optimized;
+
+    /// Cache statistics of the decoded triangles.
+    VertexCacheStatistics before;
+
+    /// Cache statistics of the optimized triangles.
+    VertexCacheStatistics after;
+};
+
+/**
+ * @brief Settings of the mesh optimization run by the importers.
+ */
+struct MeshOptimizerSettings
+{
+    /// If true the importers reorder the decoded triangles and vertices before uploading them.
+    bool enabled;
+
+    /// If true triangles are also sorted in clusters to reduce overdraw.
+    bool overdraw;
+
+    /// Cache efficiency the overdraw sort may give up, 1.05 allows a 5% higher ACMR.
+    float overdraw_threshold;
+
+    /**
+     * @brief Default constructor, the optimization is disabled.
+     */
+    MeshOptimizerSettings (void) : enabled(false), overdraw(false), overdraw_threshold(1.05) {}
+};
+
+namespace MeshImporter
+{
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static VertexCacheStatistics analyzeVertexCache (const vector<GLuint>& indices, size_t vertex_count, unsigned int cache_size) __attribute__ ((unused));
+static void optimizeVertexCache (vector<GLuint>& indices, size_t vertex_count) __attribute__ ((unused));
+static void optimizeOverdraw (vector<GLuint>& indices, const vector<Eigen::Vector4f>& vertices, float threshold) __attribute__ ((unused));
+static void optimizeVertexFetch (MeshData& data) __attribute__ ((unused));
+static bool optimizeMeshData (MeshData& data, bool overdraw, float threshold, VertexCacheStatistics* before, VertexCacheStatistics* after) __attribute__ ((unused));
+static void optimizeImportedMesh (MeshData& data, const MeshOptimizerSettings& settings, MeshOptimizationReport* report) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Simulates a FIFO post-transform vertex cache over an index buffer.
+ * @param indices Triangle list indices.
+ * @param vertex_count Number of vertices referenced by the indices.
+ * @param cache_size Number of entries of the simulated cache.
+ * @return Cache statistics.
+ */
+static VertexCacheStatistics analyzeVertexCache (const vector<GLuint>& indices, size_t vertex_count, unsigned int cache_size = 16)
+{
+    VertexCacheStatistics stats;
+    stats.vertices_transformed = 0;
+    stats.acmr = 0.0;
+    stats.atvr = 0.0;
+
+    // a vertex is in the cache if it was inserted less than cache_size insertions ago
+    vector<size_t> inserted (vertex_count, 0);
+    vector<bool> referenced (vertex_count, false);
+    size_t timestamp = cache_size + 1;
+    size_t unique = 0;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        GLuint v = indices[i];
+        if (timestamp - inserted[v] > cache_size)
+        {
+            inserted[v] = timestamp++;
+            stats.vertices_transformed++;
+        }
+        if (!referenced[v])
+        {
+            referenced[v] = true;
+            unique++;
+        }
+    }
+
+    if (indices.size() >= 3)
+        stats.acmr = (float)stats.vertices_transformed / (indices.size() / 3);
+    if (unique > 0)
+        stats.atvr = (float)stats.vertices_transformed / unique;
+    return stats;
+}
+
+/// Number of entries of the cache modelled by optimizeVertexCache.
+const int VERTEX_CACHE_OPTIMIZER_SIZE = 32;
+
+/**
+ * @brief Score of a vertex in optimizeVertexCache.
+ * @param cache_position Position of the vertex in the modelled cache, -1 if not cached.
+ * @param live_triangles Number of triangles using the vertex that were not emitted yet.
+ * @return Vertex score, higher scores are emitted first.
+ */
+static inline float vertexCacheScore (int cache_position, unsigned int live_triangles)
+{
+    if (live_triangles == 0)
+        return -1.0;
+
+    float score = 0.0;
+    if (cache_position >= 0)
+    {
+        // the last triangle vertices get a fixed score, so the next triangle does not reuse the same edge
+        if (cache_position < 3)
+            score = 0.75;
+        else
+            score = pow(1.0f - (cache_position - 3) / (float)(VERTEX_CACHE_OPTIMIZER_SIZE - 3), 1.5f);
+    }
+
+    // favour vertices with few triangles left, so they do not linger
+    return score + 2.0f / sqrt((float)live_triangles);
+}
+
+/**
+ * @brief Reorders triangles to improve post-transform vertex cache hits.
+ *
+ * Greedy linear time algorithm by Tom Forsyth: repeatedly emits the triangle with the highest score,
+ * where vertex scores favour recently used vertices and vertices with few remaining triangles.
+ * The result is good for any cache size, not only the modelled one.
+ * @param indices Triangle list indices, reordered in place.
+ * @param vertex_count Number of vertices referenced by the indices.
+ */
+static void optimizeVertexCache (vector<GLuint>& indices, size_t vertex_count)
+{
+    size_t num_triangles = indices.size() / 3;
+    if (num_triangles == 0)
+        return;
+
+    // triangles of each vertex, in compressed rows
+    vector<unsigned int> live (vertex_count, 0);
+    for (size_t i = 0; i < num_triangles*3; ++i)
+        live[indices[i]]++;
+
+    vector<size_t> first_triangle (vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v)
+        first_triangle[v+1] = first_triangle[v] + live[v];
+
+    vector<unsigned int> vertex_triangles (num_triangles*3);
+    {
+        vector<size_t> fill (first_triangle.begin(), first_triangle.end()-1);
+        for (size_t i = 0; i < num_triangles*3; ++i)
+            vertex_triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+    }
+
+    vector<float> vertex_score (vertex_count);
+    vector<int> cache_position (vertex_count, -1);
+    for (size_t v = 0; v < vertex_count; ++v)
+        vertex_score[v] = vertexCacheScore(-1, live[v]);
+
+    vector<float> triangle_score (num_triangles);
+    vector<bool> emitted (num_triangles, false);
+    for (size_t t = 0; t < num_triangles; ++t)
+        triangle_score[t] = vertex_score[indices[3*t]] + vertex_score[indices[3*t+1]] + vertex_score[indices[3*t+2]];
+
+    vector<GLuint> result;
+    result.reserve(num_triangles*3);
+
+    int cache[VERTEX_CACHE_OPTIMIZER_SIZE + 3];
+    int cache_count = 0;
+    size_t next_unemitted = 0;
+
+    long best = 0;
+    for (size_t t = 1; t < num_triangles; ++t)
+        if (triangle_score[t] > triangle_score[best])
+            best = t;
+
+    while (best >= 0)
+    {
+        emitted[best] = true;
+        const GLuint* tri = &indices[3*best];
+        result.insert(result.end(), tri, tri+3);
+
+        // the triangle vertices move to the front of the cache
+        int new_cache[VERTEX_CACHE_OPTIMIZER_SIZE + 3];
+        int new_count = 0;
+        for (int k = 0; k < 3; ++k)
+            new_cache[new_count++] = tri[k];
+        for (int k = 0; k < cache_count; ++k)
+            if (cache[k] != (int)tri[0] && cache[k] != (int)tri[1] && cache[k] != (int)tri[2])
+                new_cache[new_count++] = cache[k];
+
+        // remove the triangle from the lists of its vertices
+        for (int k = 0; k < 3; ++k)
+        {
+            GLuint v = tri[k];
+            unsigned int* list = &vertex_triangles[first_triangle[v]];
+            for (unsigned int j = 0; j < live[v]; ++j)
+            {
+                if (list[j] == (unsigned int)best)
+                {
+                    list[j] = list[live[v]-1];
+                    break;
+                }
+            }
+            live[v]--;
+        }
+
+        // update the scores of cached vertices and of their triangles, picking the best one
+        best = -1;
+        float best_score = -1.0;
+        for (int k = 0; k < new_count; ++k)
+        {
+            int v = new_cache[k];
+            int position = (k < VERTEX_CACHE_OPTIMIZER_SIZE) ? k : -1;
+            cache_position[v] = position;
+            float score = vertexCacheScore(position, live[v]);
+            float delta = score - vertex_score[v];
+            vertex_score[v] = score;
+
+            const unsigned int* list = &vertex_triangles[first_triangle[v]];
+            for (unsigned int j = 0; j < live[v]; ++j)
+            {
+                unsigned int t = list[j];
+                triangle_score[t] += delta;
+                if (triangle_score[t] > best_score)
+                {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+
+        cache_count = min(new_count, VERTEX_CACHE_OPTIMIZER_SIZE);
+        copy(new_cache, new_cache + cache_count, cache);
+
+        // no cached vertex has triangles left, restart from the next triangle in input order
+        if (best < 0)
+        {
+            while (next_unemitted < num_triangles && emitted[next_unemitted])
+                next_unemitted++;
+            if (next_unemitted < num_triangles)
+                best = next_unemitted;
+        }
+    }
+
+    indices.swap(result);
+}
+
+/**
+ * @brief Sorts clusters of triangles front to back, to reduce overdraw from any view point.
+ *
+ * Approach of Sander et al. ("Fast triangle reordering for vertex locality and reduced overdraw"):
+ * the vertex cache ordered triangles are split in clusters where the cache restarts, clusters are further
+ * split while their cache efficiency stays within the threshold, and clusters facing away from the mesh
+ * centroid are drawn first. Should run after optimizeVertexCache.
+ * @param indices Triangle list indices, reordered in place.
+ * @param vertices Vertex positions.
+ * @param threshold Allowed ACMR increase, 1.05 allows a 5% higher ACMR.
+ */
+static void optimizeOverdraw (vector<GLuint>& indices, const vector<Eigen::Vector4f>& vertices, float threshold = 1.05)
+{
+    const unsigned int cache_size = 16;
+    size_t num_triangles = indices.size() / 3;
+    if (num_triangles == 0)
+        return;
+
+    // misses of each triangle, with the cache simulated from the start
+    vector<size_t> inserted (vertices.size(), 0);
+    size_t timestamp = cache_size + 1;
+    vector<unsigned char> misses (num_triangles, 0);
+    for (size_t t = 0; t < num_triangles; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            GLuint v = indices[3*t+k];
+            if (timestamp - inserted[v] > cache_size)
+            {
+                inserted[v] = timestamp++;
+                misses[t]++;
+            }
+        }
+    }
+
+    // hard boundaries where all three vertices miss, the cache starts over anyway
+    vector<size_t> hard;
+    for (size_t t = 0; t < num_triangles; ++t)
+        if (t == 0 || misses[t] == 3)
+            hard.push_back(t);
+    hard.push_back(num_triangles);
+
+    // soft boundaries inside each hard cluster, as long as the cache restarts cost little
+    vector<size_t> clusters;
+    for (size_t c = 0; c+1 < hard.size(); ++c)
+    {
+        size_t begin = hard[c], end = hard[c+1];
+        size_t cluster_misses = 0;
+        for (size_t t = begin; t < end; ++t)
+            cluster_misses += misses[t];
+        float cluster_acmr = (float)cluster_misses / (end - begin);
+
+        timestamp += cache_size + 1;
+        size_t start = begin;
+        size_t running_misses = 0;
+        clusters.push_back(begin);
+        for (size_t t = begin; t < end; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                GLuint v = indices[3*t+k];
+                if (timestamp - inserted[v] > cache_size)
+                {
+                    inserted[v] = timestamp++;
+                    running_misses++;
+                }
+            }
+            if (t+1 < end && (float)running_misses / (t+1 - start) <= cluster_acmr * threshold)
+            {
+                clusters.push_back(t+1);
+                start = t+1;
+                running_misses = 0;
+                timestamp += cache_size + 1;
+            }
+        }
+    }
+    clusters.push_back(num_triangles);
+
+    // sort key: how much the cluster faces away from the mesh centroid
+    Eigen::Vector3f mesh_centroid (0.0, 0.0, 0.0);
+    for (size_t i = 0; i < vertices.size(); ++i)
+        mesh_centroid += vertices[i].head<3>();
+    if (!vertices.empty())
+        mesh_centroid /= (float)vertices.size();
+
+    size_t num_clusters = clusters.size() - 1;
+    vector< pair<float, size_t> > order (num_clusters);
+    for (size_t c = 0; c < num_clusters; ++c)
+    {
+        Eigen::Vector3f centroid (0.0, 0.0, 0.0), normal (0.0, 0.0, 0.0);
+        float area = 0.0;
+        for (size_t t = clusters[c]; t < clusters[c+1]; ++t)
+        {
+            Eigen::Vector3f a = vertices[indices[3*t]].head<3>();
+            Eigen::Vector3f b = vertices[indices[3*t+1]].head<3>();
+            Eigen::Vector3f d = vertices[indices[3*t+2]].head<3>();
+            Eigen::Vector3f n = (b - a).cross(d - a);
+            float triangle_area = n.norm();
+            centroid += (a + b + d) * (triangle_area / 3.0f);
+            normal += n;
+            area += triangle_area;
+        }
+        if (area > 0.0)
+            centroid /= area;
+        if (normal.norm() > 0.0)
+            normal.normalize();
+        order[c] = make_pair(-(centroid - mesh_centroid).dot(normal), c);
+    }
+    stable_sort(order.begin(), order.end());
+
+    vector<GLuint> result;
+    result.reserve(indices.size());
+    for (size_t i = 0; i < num_clusters; ++i)
+    {
+        size_t c = order[i].second;
+        result.insert(result.end(), indices.begin() + 3*clusters[c], indices.begin() + 3*clusters[c+1]);
+    }
+    indices.swap(result);
+}
+
+/**
+ * @brief Reorders vertices in the order they are first used by the indices, to improve vertex fetch locality.
+ *
+ * All attribute arrays with one entry per vertex are permuted and the indices remapped.
+ * Vertices not used by any triangle are kept at the end, so point data and bounds are unchanged.
+ * @param data Mesh data, reordered in place.
+ */
+static void optimizeVertexFetch (MeshData& data)
+{
+    size_t n = data.vertices.size();
+    if (n == 0 || data.indices.empty())
+        return;
+
+    const GLuint unused = 0xFFFFFFFF;
+    vector<GLuint> remap (n, unused);
+    GLuint next = 0;
+    for (size_t i = 0; i < data.indices.size(); ++i)
+    {
+        GLuint& v = data.indices[i];
+        if (remap[v] == unused)
+            remap[v] = next++;
+        v = remap[v];
+    }
+    for (size_t v = 0; v < n; ++v)
+        if (remap[v] == unused)
+            remap[v] = next++;
+
+    if (data.vertices.size() == n)
+    {
+        vector<Eigen::Vector4f> vert (n);
+        for (size_t v = 0; v < n; ++v)
+            vert[remap[v]] = data.vertices[v];
+        data.vertices.swap(vert);
+    }
+    if (data.normals.size() == n)
+    {
+        vector<Eigen::Vector3f> norm (n);
+        for (size_t v = 0; v < n; ++v)
+            norm[remap[v]] = data.normals[v];
+        data.normals.swap(norm);
+    }
+    if (data.texCoords.size() == n)
+    {
+        vector<Eigen::Vector2f> tex (n);
+        for (size_t v = 0; v < n; ++v)
+            tex[remap[v]] = data.texCoords[v];
+        data.texCoords.swap(tex);
+    }
+    if (data.colors.size() == n)
+    {
+        vector<Eigen::Vector4f> clrs (n);
+        for (size_t v = 0; v < n; ++v)
+            clrs[remap[v]] = data.colors[v];
+        data.colors.swap(clrs);
+    }
+    if (data.tangents.size() == n)
+    {
+        vector<Eigen::Vector4f> tang (n);
+        for (size_t v = 0; v < n; ++v)
+            tang[remap[v]] = data.tangents[v];
+        data.tangents.swap(tang);
+    }
+}
+
+/**
+ * @brief Runs the vertex cache, overdraw (optional) and vertex fetch optimizations on decoded mesh data.
+ *
+ * Only triangle lists are optimized, other data is left untouched.
+ * @param data Mesh data, reordered in place.
+ * @param overdraw If true also sorts triangle clusters to reduce overdraw.
+ * @param threshold Allowed ACMR increase for the overdraw sort.
+ * @param before If not NULL receives the cache statistics of the input.
+ * @param after If not NULL receives the cache statistics of the result.
+ * @return True if the data was optimized, false if it is not a triangle list (before and after are then left untouched).
+ */
+static bool optimizeMeshData (MeshData& data, bool overdraw = false, float threshold = 1.05,
+                              VertexCacheStatistics* before = NULL, VertexCacheStatistics* after = NULL)
+{
+    if (data.indices.empty() || data.indices.size() % 3 != 0 || data.vertices.empty())
+        return false;
+
+    if (before)
+        *before = analyzeVertexCache(data.indices, data.vertices.size());
+
+    optimizeVertexCache(data.indices, data.vertices.size());
+    if (overdraw)
+        optimizeOverdraw(data.indices, data.vertices, threshold);
+    optimizeVertexFetch(data);
+
+    if (after)
+        *after = analyzeVertexCache(data.indices, data.vertices.size());
+    return true;
+}
+
+/**
+ * @brief Optimizes freshly decoded mesh data if enabled in the settings, called by the importers.
+ * @param data Mesh data, reordered in place.
+ * @param settings Optimization settings (see MeshImportSettings).
+ * @param report If not NULL receives the cache statistics before and after the optimization.
+ */
+static void optimizeImportedMesh (MeshData& data, const MeshOptimizerSettings& settings, MeshOptimizationReport* report = 0)
+{
+    if (report)
+        report->optimized = false;
+    if (!settings.enabled)
+        return;
+
+    VertexCacheStatistics before, after;
+    if (!optimizeMeshData(data, settings.overdraw, settings.overdraw_threshold, &before, &after))
+        return;
+
+    if (report)
+    {
+        report->optimized = true;
+        report->before = before;
+        report->after = after;
+    }
+
+    #ifdef TUCANODEBUG
+    cout << "Optimized mesh: ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << endl << endl;
+    #endif
+}
+
+}
+}
+#endif
@@ -0,0 +1,747 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHSIMPLIFIER__
+#define __MESHSIMPLIFIER__
+
+#include <utils/meshdata.hpp>
+#include <utils/meshnormals.hpp>
+#include <utils/parallel.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <iostream>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Stopping criteria of one level of detail.
+ */
+struct LodTarget
+{
+    /// Fraction of the input triangles to keep (0 to stop on the error only).
+    float ratio;
+
+    /// Largest geometric error allowed, in the units of the vertex positions.
+    float max_error;
+};
+
+/**
+ * @brief One level of detail of a simplified mesh.
+ *
+ * Indices refer to the vertex buffer of the input mesh, so all the levels share the same vertices.
+ */
+struct LodLevel
+{
+    /// Triangle list indices.
+    vector<GLuint> indices;
+
+    /// Geometric error of the level (RMS distance to the planes of the original surface it replaces).
+    float error;
+};
+
+/**
+ * @brief Timing of a simplification.
+ */
+struct SimplificationReport
+{
+    /// Number of triangles of the input mesh.
+    size_t input_triangles;
+
+    /// Number of triangles of each level, the first is the input.
+    vector<size_t> triangles;
+
+    /// Total time in milliseconds.
+    double milliseconds;
+
+    /// Time in milliseconds per million input triangles.
+    double milliseconds_per_million;
+};
+
+namespace MeshImporter
+{
+
+/// Vertex quadric: upper triangle of the 4x4 plane matrix (10 values) and the sum of the plane weights.
+/// Double precision, collapse errors are tiny differences of large terms.
+typedef Eigen::Matrix<double, 11, 1> Quadric;
+
+/// Number of triangles per spatial cluster simplified independently.
+const size_t SIMPLIFIER_CLUSTER_TRIANGLES = 16384;
+
+struct SimplifierContext;
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static float simplifyRegion (SimplifierContext& ctx, const vector<char>& excluded, const vector<GLuint>& region, vector<GLuint>& indices, vector<char>& alive, size_t target, float max_error, vector<GLuint>& local) __attribute__ ((unused));
+static void initSimplifier (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, SimplifierContext& ctx, unsigned int num_threads) __attribute__ ((unused));
+static float simplifyLevel (SimplifierContext& ctx, vector<GLuint>& indices, size_t target, float max_error, unsigned int num_threads) __attribute__ ((unused));
+static float simplifyMesh (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, size_t target_triangles, float max_error, vector<GLuint>& result, unsigned int num_threads) __attribute__ ((unused));
+static void buildLodChain (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, const vector<LodTarget>& targets, vector<LodLevel>& lods, SimplificationReport* report, unsigned int num_threads) __attribute__ ((unused));
+static vector<LodTarget> defaultLodTargets (int levels, float ratio) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Returns the quadric of a plane, weighted.
+ * @param n Unit normal of the plane.
+ * @param d Plane offset (n.x + d = 0).
+ * @param w Weight, usually the triangle area.
+ * @return Plane quadric.
+ */
+inline Quadric planeQuadric (const Eigen::Vector3d& n, double d, double w)
+{
+    Quadric q;
+    q << n.x()*n.x(), n.x()*n.y(), n.x()*n.z(), n.x()*d,
+         n.y()*n.y(), n.y()*n.z(), n.y()*d,
+         n.z()*n.z(), n.z()*d,
+         d*d, 1.0f;
+    return q * w;
+}
+
+/**
+ * @brief Evaluates a quadric at a position.
+ * @param q Quadric.
+ * @param p Position.
+ * @return Weighted RMS distance of the position to the planes of the quadric.
+ */
+inline float quadricError (const Quadric& q, const Eigen::Vector3f& p)
+{
+    double x = p.x(), y = p.y(), z = p.z();
+    double e = q[0]*x*x + 2.0*(q[1]*x*y + q[2]*x*z + q[3]*x) +
+              q[4]*y*y + 2.0*(q[5]*y*z + q[6]*y) +
+              q[7]*z*z + 2.0*q[8]*z + q[9];
+    return (q[10] > 0.0) ? (float)sqrt(max(e, 0.0) / q[10]) : 0.0f;
+}
+
+/**
+ * @brief Vertex data shared by all the levels of a simplification.
+ */
+struct SimplifierContext
+{
+    /// Positions, centered on the bounding box to keep the quadrics precise.
+    vector<Eigen::Vector3f> positions;
+
+    /// Accumulated quadric of each vertex.
+    vector<Quadric> quadrics;
+
+    /// Vertices that never move: on open or non-manifold edges, or sharing their position with another vertex (attribute seams).
+    vector<char> locked;
+};
+
+/**
+ * @brief Collapses edges of a region of the mesh until it reaches the target number of triangles or the error limit.
+ *
+ * Greedy edge collapse ordered by quadric error, each vertex is collapsed onto one of its neighbors (no new vertex
+ * is created). Collapses that change the topology (link condition) or flip a triangle are rejected.
+ * Excluded vertices are neither moved nor used as a collapse target, so regions without common non excluded
+ * vertices can be simplified in parallel.
+ * @param ctx Vertex data, quadrics of the region vertices are updated.
+ * @param excluded If not empty, flags vertices the region must not touch.
+ * @param region Triangles of the region (indices of triangles in the index buffer), all alive.
+ * @param indices Triangle list, triangles of the region are rewritten.
+ * @param alive Flag of each triangle, cleared for the collapsed triangles of the region.
+ * @param target Number of region triangles to keep.
+ * @param max_error Largest collapse error allowed.
+ * @param local Scratch map from mesh to region vertices, one entry per mesh vertex all set to ~0u, left unchanged.
+ * @return Largest error of the collapses performed, zero if none.
+ */
+static float simplifyRegion (SimplifierContext& ctx, const vector<char>& excluded, const vector<GLuint>& region,
+                             vector<GLuint>& indices, vector<char>& alive, size_t target, float max_error, vector<GLuint>& local)
+{
+    const GLuint none = ~0u;
+    size_t nt = region.size();
+    if (nt <= target)
+        return 0.0;
+
+    // local vertex numbering
+    vector<GLuint> verts;
+    vector<GLuint> tri (3*nt);
+    for (size_t k = 0; k < nt; ++k)
+        for (int i = 0; i < 3; ++i)
+        {
+            GLuint g = indices[3*region[k]+i];
+            if (local[g] == none)
+            {
+                local[g] = (GLuint)verts.size();
+                verts.push_back(g);
+            }
+            tri[3*k+i] = local[g];
+        }
+    size_t nv = verts.size();
+    for (size_t v = 0; v < nv; ++v)
+        local[verts[v]] = none;
+
+    vector<GLuint> first (nv+1, 0);
+    for (size_t c = 0; c < 3*nt; ++c)
+        first[tri[c]+1]++;
+    for (size_t v = 0; v < nv; ++v)
+        first[v+1] += first[v];
+    vector<GLuint> incident (3*nt);
+    {
+        vector<GLuint> fill (first.begin(), first.end()-1);
+        for (size_t c = 0; c < 3*nt; ++c)
+            incident[fill[tri[c]]++] = (GLuint)(c/3);
+    }
+
+    vector<Eigen::Vector3f> pos (nv);
+    vector<Quadric> quad (nv);
+    vector<char> movable (nv), usable (nv), dead (nv, 0);
+    vector<GLuint> version (nv, 0), chain_next (nv, none), chain_tail (nv);
+    for (size_t v = 0; v < nv; ++v)
+    {
+        GLuint g = verts[v];
+        pos[v] = ctx.positions[g];
+        quad[v] = ctx.quadrics[g];
+        usable[v] = excluded.empty() || !excluded[g];
+        movable[v] = usable[v] && !ctx.locked[g];
+        chain_tail[v] = (GLuint)v;
+    }
+    vector<char> tri_alive (nt, 1);
+
+    // candidate collapses, min-heap on the error, each edge in its cheapest direction first
+    struct Candidate
+    {
+        float cost;
+        GLuint from, to, from_version, to_version;
+        bool reversible;
+        bool operator< (const Candidate& c) const { return cost > c.cost; }
+    };
+    vector<Candidate> heap;
+    heap.reserve(3*nt);
+    auto candidate = [&] (GLuint a, GLuint b, Candidate& c) -> bool
+    {
+        if (!usable[a] || !usable[b] || (!movable[a] && !movable[b]))
+            return false;
+        Quadric q = quad[a] + quad[b];
+        float ab = movable[a] ? quadricError(q, pos[b]) : numeric_limits<float>::max();
+        float ba = movable[b] ? quadricError(q, pos[a]) : numeric_limits<float>::max();
+        if (ba < ab)
+            swap(a, b);
+        Candidate e = {min(ab, ba), a, b, version[a], version[b], movable[a] && movable[b]};
+        c = e;
+        return true;
+    };
+    auto push = [&] (GLuint a, GLuint b)
+    {
+        Candidate c;
+        if (candidate(a, b, c))
+        {
+            heap.push_back(c);
+            push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    // alive triangles around a vertex, following the chain of vertices collapsed onto it
+    vector<GLuint> around_from, around_to, ring_from, ring_to, merged;
+    auto gather = [&] (GLuint v, vector<GLuint>& tris, vector<GLuint>& ring)
+    {
+        tris.clear();
+        ring.clear();
+        for (GLuint u = v; u != none; u = chain_next[u])
+        {
+            for (GLuint i = first[u]; i < first[u+1]; ++i)
+            {
+                GLuint t = incident[i];
+                const GLuint* c = &tri[3*t];
+                if (tri_alive[t] && (c[0] == v || c[1] == v || c[2] == v))
+                {
+                    tris.push_back(t);
+                    for (int k = 0; k < 3; ++k)
+                        if (c[k] != v)
+                            ring.push_back(c[k]);
+                }
+            }
+        }
+        sort(ring.begin(), ring.end());
+        ring.erase(unique(ring.begin(), ring.end()), ring.end());
+    };
+
+    for (size_t k = 0; k < nt; ++k)
+        for (int i = 0; i < 3; ++i)
+        {
+            GLuint a = tri[3*k+i], b = tri[3*k+(i+1)%3];
+            Candidate c;
+            if (a < b && candidate(a, b, c))
+                heap.push_back(c);
+        }
+    make_heap(heap.begin(), heap.end());
+
+    size_t live = nt;
+    float reached = 0.0;
+    while (live > target && !heap.empty())
+    {
+        pop_heap(heap.begin(), heap.end());
+        Candidate c = heap.back();
+        heap.pop_back();
+        if (dead[c.from] || dead[c.to] || version[c.from] != c.from_version || version[c.to] != c.to_version)
+            continue;
+        if (c.cost > max_error)
+            break;
+
+        gather(c.from, around_from, ring_from);
+        gather(c.to, around_to, ring_to);
+
+        // link condition: the common neighbors are exactly the opposite vertices of the collapsed triangles
+        size_t shared = 0;
+        for (size_t i = 0; i < around_from.size(); ++i)
+        {
+            const GLuint* t = &tri[3*around_from[i]];
+            if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+                ++shared;
+        }
+        size_t common = 0;
+        for (size_t i = 0, j = 0; i < ring_from.size() && j < ring_to.size(); )
+        {
+            if (ring_from[i] < ring_to[j])
+                ++i;
+            else if (ring_to[j] < ring_from[i])
+                ++j;
+            else
+            {
+                ++common;
+                ++i;
+                ++j;
+            }
+        }
+        bool valid = (shared > 0 && common == shared);
+
+        // reject collapses flipping, degenerating or folding (more than about 75 degrees) a triangle
+        for (size_t i = 0; i < around_from.size() && valid; ++i)
+        {
+            const GLuint* t = &tri[3*around_from[i]];
+            if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+                continue;
+            Eigen::Vector3f p[3], q[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                p[k] = pos[t[k]];
+                q[k] = (t[k] == c.from) ? pos[c.to] : pos[t[k]];
+            }
+            Eigen::Vector3f n0 = (p[1]-p[0]).cross(p[2]-p[0]);
+            Eigen::Vector3f n1 = (q[1]-q[0]).cross(q[2]-q[0]);
+            valid = (n0.dot(n1) > 0.25f * n0.norm() * n1.norm());
+        }
+
+        // try the other direction of the edge later
+        if (!valid)
+        {
+            if (c.reversible)
+            {
+                Candidate r = {quadricError(quad[c.from] + quad[c.to], pos[c.from]), c.to, c.from, c.to_version, c.from_version, false};
+                heap.push_back(r);
+                push_heap(heap.begin(), heap.end());
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < around_from.size(); ++i)
+        {
+            GLuint* t = &tri[3*around_from[i]];
+            if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+            {
+                tri_alive[around_from[i]] = 0;
+                --live;
+            }
+            else
+            {
+                for (int k = 0; k < 3; ++k)
+                    if (t[k] == c.from)
+                        t[k] = c.to;
+            }
+        }
+        chain_next[chain_tail[c.to]] = c.from;
+        chain_tail[c.to] = chain_tail[c.from];
+        dead[c.from] = 1;
+        quad[c.to] += quad[c.from];
+        version[c.to]++;
+        reached = max(reached, c.cost);
+
+        // the new neighbors of the target are the union of both rings
+        merged.clear();
+        set_union(ring_from.begin(), ring_from.end(), ring_to.begin(), ring_to.end(), back_inserter(merged));
+        for (size_t i = 0; i < merged.size(); ++i)
+            if (merged[i] != c.from && merged[i] != c.to)
+                push(c.to, merged[i]);
+    }
+
+    for (size_t k = 0; k < nt; ++k)
+    {
+        GLuint t = region[k];
+        alive[t] = tri_alive[k];
+        if (tri_alive[k])
+            for (int i = 0; i < 3; ++i)
+                indices[3*t+i] = verts[tri[3*k+i]];
+    }
+    for (size_t v = 0; v < nv; ++v)
+        if (usable[v])
+            ctx.quadrics[verts[v]] = quad[v];
+
+    return reached;
+}
+
+/**
+ * @brief Prepares the vertex data of a simplification: centered positions, plane quadrics and locked vertices.
+ * @param vertices Vertex positions.
+ * @param indices Triangle list indices.
+ * @param ctx Receives the vertex data.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+static void initSimplifier (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, SimplifierContext& ctx, unsigned int num_threads)
+{
+    size_t n = vertices.size();
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    unsigned int threads = (unsigned int)min((size_t)num_threads, n/65536 + 1);
+
+    Eigen::AlignedBox3f box;
+    for (size_t v = 0; v < n; ++v)
+        box.extend(vertices[v].head<3>());
+    Eigen::Vector3f center = box.center();
+    ctx.positions.resize(n);
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t v = begin; v < end; ++v)
+            ctx.positions[v] = vertices[v].head<3>() - center;
+    }, threads);
+
+    // area weighted plane quadrics
+    accumulateCorners(indices, n, [&] (size_t f, Quadric w[3])
+    {
+        const GLuint* t = &indices[3*f];
+        Eigen::Vector3d a = ctx.positions[t[0]].cast<double>();
+        Eigen::Vector3d normal = (ctx.positions[t[1]].cast<double>() - a).cross(ctx.positions[t[2]].cast<double>() - a);
+        double len = normal.norm();
+        if (len == 0.0)
+        {
+            w[0] = w[1] = w[2] = Quadric::Zero();
+            return;
+        }
+        normal /= len;
+        w[0] = w[1] = w[2] = planeQuadric(normal, -normal.dot(a), 0.5*len);
+    }, ctx.quadrics, num_threads);
+
+    // triangles around each vertex
+    vector<size_t> first (n+1, 0);
+    for (size_t i = 0; i < indices.size(); ++i)
+        first[indices[i]+1]++;
+    for (size_t v = 0; v < n; ++v)
+        first[v+1] += first[v];
+    vector<GLuint> incident (first[n]);
+    {
+        vector<size_t> fill (first.begin(), first.end()-1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            incident[fill[indices[i]]++] = (GLuint)(i/3);
+    }
+
+    // lock vertices on edges not shared by exactly two triangles
+    ctx.locked.assign(n, 0);
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
+    {
+        vector<GLuint> ring;
+        for (size_t v = begin; v < end; ++v)
+        {
+            ring.clear();
+            for (size_t i = first[v]; i < first[v+1]; ++i)
+            {
+                const GLuint* t = &indices[3*incident[i]];
+                for (int k = 0; k < 3; ++k)
+                    if (t[k] != v)
+                        ring.push_back(t[k]);
+            }
+            // every neighbor must appear twice (the two triangles of the edge)
+            sort(ring.begin(), ring.end());
+            for (size_t i = 0; i < ring.size() && !ctx.locked[v]; )
+            {
+                size_t j = i;
+                while (j < ring.size() && ring[j] == ring[i])
+                    ++j;
+                if (j - i != 2)
+                    ctx.locked[v] = 1;
+                i = j;
+            }
+        }
+    }, threads);
+
+    // lock vertices sharing their position with another vertex, their attributes differ across the seam
+    vector<GLuint> order (n);
+    for (size_t v = 0; v < n; ++v)
+        order[v] = (GLuint)v;
+    sort(order.begin(), order.end(), [&] (GLuint a, GLuint b)
+    {
+        const Eigen::Vector3f& p = ctx.positions[a];
+        const Eigen::Vector3f& q = ctx.positions[b];
+        return (p.x() < q.x()) || (p.x() == q.x() && ((p.y() < q.y()) || (p.y() == q.y() && p.z() < q.z())));
+    });
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (ctx.positions[order[i]] == ctx.positions[order[i-1]])
+            ctx.locked[order[i]] = ctx.locked[order[i-1]] = 1;
+    }
+}
+
+/**
+ * @brief Simplifies a triangle list down to a target number of triangles, in parallel over spatial clusters.
+ *
+ * Triangles are grouped in a grid of clusters of about SIMPLIFIER_CLUSTER_TRIANGLES triangles. Clusters are simplified
+ * in parallel, keeping the vertices they share with other clusters, then the triangles around those vertices are
+ * simplified together to close the gap to the target. The number of clusters only depends on the mesh, so the
+ * result does not depend on the number of threads.
+ * @param ctx Vertex data, quadrics are updated.
+ * @param indices Triangle list, replaced by the simplified one.
+ * @param target Number of triangles to keep.
+ * @param max_error Largest collapse error allowed.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ * @return Largest error of the collapses performed.
+ */
+static float simplifyLevel (SimplifierContext& ctx, vector<GLuint>& indices, size_t target, float max_error, unsigned int num_threads)
+{
+    const GLuint shared = ~0u, unowned = ~0u - 1;
+    size_t num_faces = indices.size() / 3;
+    size_t n = ctx.positions.size();
+    if (num_faces <= target)
+        return 0.0;
+
+    vector<char> alive (num_faces, 1);
+    for (size_t f = 0; f < num_faces; ++f)
+    {
+        const GLuint* t = &indices[3*f];
+        if (t[0] == t[1] || t[1] == t[2] || t[2] == t[0])
+            alive[f] = 0;
+    }
+
+    // grid of clusters over the triangle centroids
+    Eigen::AlignedBox3f box;
+    for (size_t v = 0; v < n; ++v)
+        box.extend(ctx.positions[v]);
+    int cells = (int)ceil(cbrt((double)num_faces / SIMPLIFIER_CLUSTER_TRIANGLES));
+    cells = max(cells, 1);
+    Eigen::Vector3f scale = Eigen::Vector3f::Constant((float)cells).cwiseQuotient(box.sizes().cwiseMax(1e-30f));
+    size_t num_clusters = (size_t)cells*cells*cells;
+
+    vector<GLuint> cluster_of (num_faces);
+    vector<size_t> cluster_first (num_clusters+1, 0);
+    for (size_t f = 0; f < num_faces; ++f)
+    {
+        const GLuint* t = &indices[3*f];
+        Eigen::Vector3f c = (ctx.positions[t[0]] + ctx.positions[t[1]] + ctx.positions[t[2]]) / 3.0f;
+        Eigen::Vector3f g = (c - box.min()).cwiseProduct(scale);
+        int x = min(max((int)g.x(), 0), cells-1), y = min(max((int)g.y(), 0), cells-1), z = min(max((int)g.z(), 0), cells-1);
+        cluster_of[f] = (GLuint)((z*cells + y)*cells + x);
+        if (alive[f])
+            cluster_first[cluster_of[f]+1]++;
+    }
+    for (size_t c = 0; c < num_clusters; ++c)
+        cluster_first[c+1] += cluster_first[c];
+    vector<GLuint> cluster_faces (cluster_first[num_clusters]);
+    {
+        vector<size_t> fill (cluster_first.begin(), cluster_first.end()-1);
+        for (size_t f = 0; f < num_faces; ++f)
+            if (alive[f])
+                cluster_faces[fill[cluster_of[f]]++] = (GLuint)f;
+    }
+    size_t live = cluster_faces.size();
+    if (live <= target)
+        target = live;
+
+    // vertices used by more than one cluster
+    vector<GLuint> owner (n, unowned);
+    vector<char> excluded (n, 0);
+    for (size_t f = 0; f < num_faces; ++f)
+    {
+        if (!alive[f])
+            continue;
+        for (int k = 0; k < 3; ++k)
+        {
+            GLuint& o = owner[indices[3*f+k]];
+            if (o == unowned)
+                o = cluster_of[f];
+            else if (o != cluster_of[f])
+                o = shared;
+        }
+    }
+    for (size_t v = 0; v < n; ++v)
+        excluded[v] = (owner[v] == shared);
+
+    // clusters in parallel, each keeping the same fraction of its triangles
+    double keep = (double)target / max(live, (size_t)1);
+    vector<float> errors (num_clusters, 0.0f);
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    Misc::parallelFor(num_clusters, [&] (size_t begin, size_t end, unsigned int)
+    {
+        vector<GLuint> region, local (n, ~0u);
+        for (size_t c = begin; c < end; ++c)
+        {
+            region.assign(cluster_faces.begin() + cluster_first[c], cluster_faces.begin() + cluster_first[c+1]);
+            size_t cluster_target = (size_t)ceil(region.size() * keep);
+            errors[c] = simplifyRegion(ctx, excluded, region, indices, alive, cluster_target, max_error, local);
+        }
+    }, (unsigned int)min((size_t)num_threads, num_clusters));
+    float reached = *max_element(errors.begin(), errors.end());
+
+    live = 0;
+    for (size_t f = 0; f < num_faces; ++f)
+        live += alive[f];
+
+    // triangles around the shared vertices, bounded by the vertices of the other triangles
+    if (live > target && num_clusters > 1)
+    {
+        vector<GLuint> band;
+        fill(excluded.begin(), excluded.end(), 0);
+        for (size_t f = 0; f < num_faces; ++f)
+        {
+            if (!alive[f])
+                continue;
+            const GLuint* t = &indices[3*f];
+            if (owner[t[0]] == shared || owner[t[1]] == shared || owner[t[2]] == shared)
+                band.push_back((GLuint)f);
+            else
+                excluded[t[0]] = excluded[t[1]] = excluded[t[2]] = 1;
+        }
+        size_t band_target = (band.size() > live - target) ? band.size() - (live - target) : 0;
+        vector<GLuint> local (n, ~0u);
+        reached = max(reached, simplifyRegion(ctx, excluded, band, indices, alive, band_target, max_error, local));
+    }
+
+    // compact the alive triangles
+    size_t m = 0;
+    for (size_t f = 0; f < num_faces; ++f)
+    {
+        if (!alive[f])
+            continue;
+        for (int k = 0; k < 3; ++k)
+            indices[3*m+k] = indices[3*f+k];
+        ++m;
+    }
+    indices.resize(3*m);
+    return reached;
+}
+
+/**
+ * @brief Simplifies a triangle list with quadric error edge collapses.
+ *
+ * Vertices are never created nor moved, the result indexes the input vertex buffer.
+ * Vertices on open edges and attribute seams are kept.
+ * @param vertices Vertex positions.
+ * @param indices Triangle list indices.
+ * @param target_triangles Number of triangles to keep.
+ * @param max_error Largest geometric error allowed, in the units of the positions.
+ * @param result Receives the simplified triangle list.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ * @return Geometric error of the result.
+ */
+static float simplifyMesh (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, size_t target_triangles, float max_error, vector<GLuint>& result, unsigned int num_threads = 0)
+{
+    SimplifierContext ctx;
+    initSimplifier(vertices, indices, ctx, num_threads);
+    result = indices;
+    return simplifyLevel(ctx, result, target_triangles, max_error, num_threads);
+}
+
+/**
+ * @brief Builds a chain of levels of detail sharing the vertex buffer of the input mesh.
+ *
+ * Each level continues the simplification of the previous one, so the quadrics keep the error of all
+ * the collapses and the reported errors never decrease along the chain.
+ * @param vertices Vertex positions.
+ * @param indices Triangle list indices.
+ * @param targets Stopping criteria of each level after the first.
+ * @param lods Receives the levels, the first one is the input triangle list with zero error.
+ * @param report If not null receives the number of triangles of each level and the timing.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+static void buildLodChain (const vector<Eigen::Vector4f>& vertices, const vector<GLuint>& indices, const vector<LodTarget>& targets, vector<LodLevel>& lods, SimplificationReport* report = 0, unsigned int num_threads = 0)
+{
+    auto start = chrono::steady_clock::now();
+    size_t num_faces = indices.size() / 3;
+
+    SimplifierContext ctx;
+    initSimplifier(vertices, indices, ctx, num_threads);
+
+    lods.assign(1, LodLevel());
+    lods[0].indices = indices;
+    lods[0].error = 0.0;
+
+    vector<GLuint> current = indices;
+    float error = 0.0;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        size_t target = (size_t)(targets[i].ratio * num_faces);
+        error = max(error, simplifyLevel(ctx, current, target, targets[i].max_error, num_threads));
+        // nothing left to collapse within the error limit
+        if (current.size() == lods.back().indices.size())
+            break;
+        lods.push_back(LodLevel());
+        lods.back().indices = current;
+        lods.back().error = error;
+    }
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (report)
+    {
+        report->input_triangles = num_faces;
+        report->triangles.clear();
+        for (size_t i = 0; i < lods.size(); ++i)
+            report->triangles.push_back(lods[i].indices.size()/3);
+        report->milliseconds = ms;
+        report->milliseconds_per_million = (num_faces > 0) ? ms * 1e6 / num_faces : 0.0;
+    }
+
+    #ifdef TUCANODEBUG
+    cout << "lod chain of " << num_faces << " triangles in " << ms << " ms (" << ms * 1e6 / max(num_faces, (size_t)1) << " ms per million triangles):";
+    for (size_t i = 0; i < lods.size(); ++i)
+        cout << " " << lods[i].indices.size()/3 << " (" << lods[i].error << ")";
+    cout << endl;
+    #endif
+}
+
+/**
+ * @brief Returns level targets dividing the number of triangles by a constant ratio, without error limit.
+ * @param levels Number of levels after the input.
+ * @param ratio Fraction of triangles kept from one level to the next.
+ * @return Level targets.
+ */
+static vector<LodTarget> defaultLodTargets (int levels, float ratio = 0.5)
+{
+    vector<LodTarget> targets;
+    float keep = 1.0;
+    for (int i = 0; i < levels; ++i)
+    {
+        keep *= ratio;
+        LodTarget t = {keep, numeric_limits<float>::max()};
+        targets.push_back(t);
+    }
+    return targets;
+}
+
+}
+}
+#endif
@@ -0,0 +1,198 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __MESHTANGENTS__
+#define __MESHTANGENTS__
+
+#include <utils/meshdata.hpp>
+#include <utils/meshnormals.hpp>
+#include <utils/parallel.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace Tucano
+{
+
+/**
+ * @brief Settings of the tangent generation run by the importers.
+ */
+struct TangentGenerationSettings
+{
+    /// If true the importers generate tangents for textured triangle meshes.
+    bool enabled;
+
+    /**
+     * @brief Default constructor, disabled since only normal and parallax mapping use tangents.
+     */
+    TangentGenerationSettings (void) : enabled(false) {}
+};
+
+namespace MeshImporter
+{
+
+#if _WIN32  //define something for Windows (32-bit and 64-bit, this part is common)
+    #pragma warning(disable:4996)
+#else
+// avoid warnings of unused function
+static void computeTangents (const vector<Eigen::Vector4f>& vertices, const vector<Eigen::Vector3f>& normals, const vector<Eigen::Vector2f>& texCoords, const vector<GLuint>& indices, vector<Eigen::Vector4f>& tangents, unsigned int num_threads) __attribute__ ((unused));
+static bool generateTangents (MeshData& data, unsigned int num_threads) __attribute__ ((unused));
+static void generateImportedTangents (MeshData& data, const TangentGenerationSettings& settings) __attribute__ ((unused));
+#endif
+
+/**
+ * @brief Computes per vertex tangent frames of an indexed triangle mesh, following the MikkTSpace conventions.
+ *
+ * The texture space directions of each triangle are projected onto the tangent plane of each corner normal,
+ * normalized and weighted by the corner angle, then summed per vertex in parallel without shared writes
+ * (see accumulateCorners). The tangent is orthogonalized against the normal and its w component holds
+ * the bitangent sign, so shaders rebuild the bitangent as cross(normal, tangent.xyz) * tangent.w.
+ * Vertices on mirrored texture seams must not be shared by both sides, which holds for meshes indexed by
+ * (position, texcoord, normal) such as the ones read by the importers.
+ * Vertices without a texture space direction get any tangent perpendicular to their normal.
+ * @param vertices Vertex positions.
+ * @param normals Vertex normals, one per vertex.
+ * @param texCoords Texture coordinates, one per vertex.
+ * @param indices Triangle list indices.
+ * @param tangents Receives one tangent per vertex.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ */
+static void computeTangents (const vector<Eigen::Vector4f>& vertices, const vector<Eigen::Vector3f>& normals, const vector<Eigen::Vector2f>& texCoords,
+                             const vector<GLuint>& indices, vector<Eigen::Vector4f>& tangents, unsigned int num_threads = 0)
+{
+    typedef Eigen::Matrix<float, 6, 1> Frame;
+    size_t n = vertices.size();
+    if (normals.size() != n || texCoords.size() != n)
+    {
+        tangents.clear();
+        return;
+    }
+
+    // tangent (head) and bitangent (tail) of each vertex
+    vector<Frame> frames;
+    accumulateCorners(indices, n, [&] (size_t f, Frame w[3])
+    {
+        const GLuint* v = &indices[3*f];
+        Eigen::Vector3f p[3] = {vertices[v[0]].head<3>(), vertices[v[1]].head<3>(), vertices[v[2]].head<3>()};
+        Eigen::Vector2f d1 = texCoords[v[1]] - texCoords[v[0]];
+        Eigen::Vector2f d2 = texCoords[v[2]] - texCoords[v[0]];
+        float det = d1.x()*d2.y() - d1.y()*d2.x();
+
+        float angles[3];
+        if (det == 0.0 || !triangleCornerAngles(p[0], p[1], p[2], angles))
+        {
+            w[0] = w[1] = w[2] = Frame::Zero();
+            return;
+        }
+
+        Eigen::Vector3f e1 = p[1] - p[0];
+        Eigen::Vector3f e2 = p[2] - p[0];
+        Eigen::Vector3f sdir = (e1*d2.y() - e2*d1.y()) / det;
+        Eigen::Vector3f tdir = (e2*d1.x() - e1*d2.x()) / det;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            const Eigen::Vector3f& nk = normals[v[k]];
+            Eigen::Vector3f t = sdir - nk * nk.dot(sdir);
+            Eigen::Vector3f b = tdir - nk * nk.dot(tdir);
+            float lt = t.norm(), lb = b.norm();
+            w[k].head<3>() = (lt > 0.0) ? Eigen::Vector3f(t * (angles[k] / lt)) : Eigen::Vector3f::Zero();
+            w[k].tail<3>() = (lb > 0.0) ? Eigen::Vector3f(b * (angles[k] / lb)) : Eigen::Vector3f::Zero();
+        }
+    }, frames, num_threads);
+
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    tangents.resize(n);
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            const Eigen::Vector3f& nv = normals[v];
+            Eigen::Vector3f t = frames[v].head<3>();
+            Eigen::Vector3f b = frames[v].tail<3>();
+
+            // Gram-Schmidt against the normal
+            t -= nv * nv.dot(t);
+            float len = t.norm();
+            if (len > 0.0)
+            {
+                t /= len;
+            }
+            else
+            {
+                // no texture space direction, any perpendicular will do
+                Eigen::Vector3f axis = (fabs(nv.x()) < 0.9) ? Eigen::Vector3f::UnitX() : Eigen::Vector3f::UnitY();
+                t = nv.cross(axis).cross(nv);
+                len = t.norm();
+                t = (len > 0.0) ? Eigen::Vector3f(t / len) : Eigen::Vector3f::UnitX();
+            }
+
+            float sign = (nv.cross(t).dot(b) < 0.0) ? -1.0 : 1.0;
+            tangents[v] = Eigen::Vector4f(t.x(), t.y(), t.z(), sign);
+        }
+    }, (unsigned int)min((size_t)num_threads, n/65536 + 1));
+}
+
+/**
+ * @brief Generates the tangents of a textured triangle mesh.
+ *
+ * Normals are generated first if the mesh has none (see generateNormals).
+ * @param data Mesh data, tangents are replaced.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ * @return True if tangents were generated, false if the mesh has no triangles or no texture coordinates.
+ */
+static bool generateTangents (MeshData& data, unsigned int num_threads = 0)
+{
+    if (data.indices.empty() || data.indices.size() % 3 != 0 || data.vertices.empty() ||
+        data.texCoords.size() != data.vertices.size())
+        return false;
+
+    if (data.normals.size() != data.vertices.size())
+        generateNormals(data, NORMAL_WEIGHT_ANGLE, 180.0, num_threads);
+
+    computeTangents(data.vertices, data.normals, data.texCoords, data.indices, data.tangents, num_threads);
+    return !data.tangents.empty();
+}
+
+/**
+ * @brief Generates tangents for freshly decoded textured meshes, if enabled in the settings.
+ * Called by the importers after the normal generation and before the mesh optimization.
+ * @param data Mesh data.
+ * @param settings Tangent generation settings (see MeshImportSettings).
+ */
+static void generateImportedTangents (MeshData& data, const TangentGenerationSettings& settings)
+{
+    if (!settings.enabled || !data.tangents.empty())
+        return;
+
+    generateTangents(data);
+}
+
+}
+}
+#endif
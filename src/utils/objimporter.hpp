@@ -24,13 +24,50 @@
 #define __OBJIMPORTER__
 
 #include <utils/misc.hpp>
+#include <utils/mappedfile.hpp>
+#include <utils/parallel.hpp>
+#include <utils/meshdata.hpp>
+#include <utils/meshcache.hpp>
+#include <utils/meshimportsettings.hpp>
+#include <utils/meshnormals.hpp>
+#include <utils/meshtangents.hpp>
+#include <utils/meshoptimizer.hpp>
 #include <mesh.hpp>
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdint.h>
+
 using namespace std;
 
 namespace Tucano
 {
 
+/**
+ * @brief Timing of the decode of an OBJ file, see MeshImporter::readObjFile.
+ */
+struct ObjParseReport
+{
+    /// Size of the file in bytes.
+    size_t bytes;
+
+    /// Number of threads the text was parsed with, small files are parsed by a single thread.
+    unsigned int threads;
+
+    /// Time in milliseconds spent parsing the text of the file.
+    double parse_milliseconds;
+
+    /// Total time in milliseconds, including mapping the file and welding the face corners.
+    double milliseconds;
+
+    /// Parse throughput in megabytes per second.
+    double megabytes_per_second;
+
+    ObjParseReport (void) : bytes(0), threads(0), parse_milliseconds(0.0), milliseconds(0.0), megabytes_per_second(0.0) {}
+};
+
 namespace MeshImporter
 {
 
@@ -38,17 +75,185 @@ namespace MeshImporter
     #pragma warning(disable:4996)
 #else
 // avoid warnings of unused function
-static void loadObjFile (Mesh* mesh, string filename) __attribute__ ((unused));
+static bool loadObjFile (Mesh* mesh, string filename) __attribute__ ((unused));
+static bool loadObjFile (Mesh* mesh, string filename, unsigned int num_threads) __attribute__ ((unused));
+static bool loadObjFile (Mesh* mesh, string filename, const MeshImportSettings& settings, unsigned int num_threads, MeshOptimizationReport* report, ObjParseReport* parse_report) __attribute__ ((unused));
+static bool readObjFile (const string& filename, MeshData& data, unsigned int num_threads, ObjParseReport* report) __attribute__ ((unused));
 #endif
 
 /**
- * @brief Loads a mesh from an OBJ file.
+ * @brief Returns true for the characters separating tokens in a line.
+ * Carriage returns are treated as blanks so files with DOS line endings are parsed as well.
+ */
+static inline bool isObjBlank (char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @brief Advances the pointer until the first non blank character or the end of the line.
+ */
+static inline void skipObjBlanks (const char*& p, const char* end)
+{
+    while (p < end && isObjBlank(*p))
+        ++p;
+}
+
+/**
+ * @brief Parses a signed integer directly from the file bytes.
+ * @param p Current position, advanced past the number if one is found.
+ * @param end End of the current line.
+ * @param value Parsed value.
+ * @return True if at least one digit was read.
+ */
+static inline bool parseObjInt (const char*& p, const char* end, long& value)
+{
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = (*s == '-');
+        ++s;
+    }
+    if (s >= end || *s < '0' || *s > '9')
+        return false;
+
+    long v = 0;
+    while (s < end && *s >= '0' && *s <= '9')
+    {
+        v = v*10 + (*s - '0');
+        ++s;
+    }
+    value = negative ? -v : v;
+    p = s;
+    return true;
+}
+
+/**
+ * @brief Parses a decimal floating point number directly from the file bytes.
  *
- * Loads vertex coordinates and normals, texcoords and color when available.
- * @param mesh Pointer to mesh instance to load file.
- * @param filename Given filename of the OBJ file.
+ * Does not allocate and does not depend on the current locale. Numbers with up to 19 significant
+ * digits and small exponents, which covers virtually every mesh file, are converted exactly with a single
+ * floating point operation. Anything else (very long mantissas, huge exponents, nan, inf) falls back to strtod.
+ * @param p Current position, advanced past the number if one is found.
+ * @param end End of the current line.
+ * @param value Parsed value.
+ * @return True if a number was read.
  */
-static void loadObjFile (Mesh* mesh, string filename)
+static inline bool parseObjFloat (const char*& p, const char* end, float& value)
+{
+    static const double powers_of_ten[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+
+    // integer part
+    while (s < end && *s >= '0' && *s <= '9')
+    {
+        has_digits = true;
+        if (significant_digits < 19)
+        {
+            mantissa = mantissa*10 + (*s - '0');
+            if (mantissa > 0)
+                ++significant_digits;
+        }
+        else
+        {
+            ++exponent;
+        }
+        ++s;
+    }
+
+    // fractional part
+    if (s < end && *s == '.')
+    {
+        ++s;
+        while (s < end && *s >= '0' && *s <= '9')
+        {
+            has_digits = true;
+            if (significant_digits < 19)
+            {
+                mantissa = mantissa*10 + (*s - '0');
+                if (mantissa > 0)
+                    ++significant_digits;
+                --exponent;
+            }
+            ++s;
+        }
+    }
+
+    if (has_digits)
+    {
+        // exponent part
+        if (s < end && (*s == 'e' || *s == 'E'))
+        {
+            const char* e = s + 1;
+            long exp_value;
+            if (parseObjInt(e, end, exp_value))
+            {
+                exponent += (exp_value > 10000) ? 10000 : ((exp_value < -10000) ? -10000 : (int)exp_value);
+                s = e;
+            }
+        }
+
+        if (mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+        {
+            double d = (double)mantissa;
+            d = (exponent < 0) ? d / powers_of_ten[-exponent] : d * powers_of_ten[exponent];
+            value = (float)(negative ? -d : d);
+            p = s;
+            return true;
+        }
+    }
+    else
+    {
+        // no digits, could still be nan or inf, let strtod decide
+        while (s < end && !isObjBlank(*s) && *s != '/')
+            ++s;
+    }
+
+    // slow path, copy the token so strtod does not run past the mapped memory
+    char token[128];
+    size_t length = (size_t)(s - p);
+    if (length == 0 || length >= sizeof(token))
+        return false;
+    memcpy(token, p, length);
+    token[length] = '\0';
+    char* token_end;
+    double d = strtod(token, &token_end);
+    if (token_end == token)
+        return false;
+    value = (float)d;
+    p += (token_end - token);
+    return true;
+}
+
+/// Marks a face corner without texture or normal index.
+const GLuint OBJ_NO_INDEX = 0xFFFFFFFF;
+
+/**
+ * @brief Attributes and face indices parsed from an OBJ file, or from a chunk of it.
+ *
+ * Face indices are 0-based and stored per face corner: the three element arrays always have the same
+ * length, corners without texture or normal index hold OBJ_NO_INDEX. The number of corners of each
+ * face is kept in faceSizes.
+ * Relative (negative) indices are resolved against the number of elements read in the same chunk;
+ * the positions of those entries are kept so they can be rebased when chunks are merged.
+ */
+struct ObjChunk
 {
     vector<Eigen::Vector4f> vert;
     vector<Eigen::Vector3f> norm;
@@ -57,130 +262,622 @@ static void loadObjFile (Mesh* mesh, string filename)
     vector<GLuint> elementsVertices;
     vector<GLuint> elementsNormals;
     vector<GLuint> elementsTexIDs;
+    vector<GLuint> faceSizes;
 
-    //Opening file:
-    #ifdef TUCANODEBUG
-    cout << "Opening Wavefront obj file " << filename.c_str() << endl << endl;
-    #endif
+    /// Positions in elementsVertices holding relative indices.
+    vector<size_t> relativeVertices;
+    /// Positions in elementsNormals holding relative indices.
+    vector<size_t> relativeNormals;
+    /// Positions in elementsTexIDs holding relative indices.
+    vector<size_t> relativeTexIDs;
+};
 
-    ifstream in(filename.c_str(),ios::in);
-    if (!in)
+/**
+ * @brief Converts an OBJ index to a 0-based index and appends it to an index list.
+ * @param index Index as written in the file (1-based, or negative when relative to the end of the list).
+ * @param count Number of elements read so far in the corresponding list.
+ * @param elements Index list.
+ * @param relative Receives the position of the new entry if the index is relative.
+ */
+static inline void pushObjIndex (long index, size_t count, vector<GLuint>& elements, vector<size_t>& relative)
+{
+    if (index < 0)
+    {
+        relative.push_back(elements.size());
+        elements.push_back((GLuint)(count + index));
+    }
+    else
     {
-        cerr << "Cannot open " << filename.c_str() << endl; exit(1);
+        elements.push_back((GLuint)(index - 1));
     }
+}
 
-    //Reading file:
-    string line;
-    while(getline(in,line))
+/**
+ * @brief Reserves the arrays of a chunk for the records found in a range of an OBJ file.
+ *
+ * Counts the v, vn, vt and f lines with a quick scan, so the arrays do not grow (and transiently double)
+ * while parsing. Faces are assumed to be triangles, larger polygons only make the corner arrays grow.
+ * @param begin First byte of the range, must be the start of a line.
+ * @param end One past the last byte of the range.
+ * @param chunk Chunk to be reserved.
+ */
+static void reserveObjChunk (const char* begin, const char* end, ObjChunk& chunk)
+{
+    size_t num_vert = 0, num_norm = 0, num_tex = 0, num_faces = 0;
+    const char* p = begin;
+    while (p < end)
     {
+        const char* line_end = (const char*)memchr(p, '\n', end - p);
+        if (!line_end)
+            line_end = end;
 
-        //Vertices reading:
-        if(line.substr(0,2) == "v ")
+        skipObjBlanks(p, line_end);
+        if (line_end - p >= 2)
         {
-
-            istringstream s(line.substr(2));
-            Eigen::Vector4f v;
-            s >> v[0]; s >> v[1]; s >> v[2]; v[3] = 1.0f;
-            vert.push_back(v);
-
-            if(s.rdbuf()->in_avail())
+            if (p[0] == 'v')
+            {
+                if (isObjBlank(p[1]))
+                    ++num_vert;
+                else if (p[1] == 'n')
+                    ++num_norm;
+                else if (p[1] == 't')
+                    ++num_tex;
+            }
+            else if (p[0] == 'f' && isObjBlank(p[1]))
             {
-                Eigen::Vector4f c;
-                s >> c[0]; s >> c[1]; s >> c[2]; c[3] = 1.0f;
-                color.push_back(c);
+                ++num_faces;
             }
         }
+        p = line_end + 1;
+    }
 
-        //Normals reading:
-        else if(line.substr(0,2) == "vn")
-        {
-            istringstream s(line.substr(3));
-            Eigen::Vector3f vn;
-            s >> vn[0]; s >> vn[1]; s >> vn[2];            
-            norm.push_back(vn);
-        }
+    chunk.vert.reserve(num_vert);
+    chunk.norm.reserve(num_norm);
+    chunk.texCoord.reserve(num_tex);
+    chunk.elementsVertices.reserve(3*num_faces);
+    chunk.elementsNormals.reserve(3*num_faces);
+    chunk.elementsTexIDs.reserve(3*num_faces);
+    chunk.faceSizes.reserve(num_faces);
+}
 
-        //Texture Coordinates reading:
-        else if(line.substr(0,2) == "vt")
-        {
-            istringstream s(line.substr(2));
-            Eigen::Vector2f vt;
-            s >> vt[0]; s >> vt[1];
-            texCoord.push_back(vt);
-        }
+/**
+ * @brief Parses a range of an OBJ file.
+ *
+ * Only v, vn, vt and f records are interpreted, all other lines are ignored.
+ * Face indices are stored per corner as given in the file (converted to 0-based), no triangulation is performed.
+ * @param begin First byte of the range, must be the start of a line.
+ * @param end One past the last byte of the range.
+ * @param chunk Receives the parsed data.
+ */
+static void parseObjBuffer (const char* begin, const char* end, ObjChunk& chunk)
+{
+    reserveObjChunk(begin, end, chunk);
+
+    const char* p = begin;
+    while (p < end)
+    {
+        const char* line_end = (const char*)memchr(p, '\n', end - p);
+        if (!line_end)
+            line_end = end;
 
-        //Elements reading: Elements are given through a string: "f vertexID/TextureID/NormalID". If no texture is given, then the string will be: "vertexID//NormalID".
-        else if(line.substr(0,2) == "f ")
+        skipObjBlanks(p, line_end);
+
+        if (line_end - p >= 2)
         {
-            GLuint vertexID1, normalID1, textureID1;
-            istringstream s(line.substr(2));
-            while(!s.eof())
+            //Vertices reading:
+            if (p[0] == 'v' && isObjBlank(p[1]))
             {
-                s >> vertexID1;
-                elementsVertices.push_back(vertexID1-1);
-                if(s.peek() == '/')
+                p += 2;
+                Eigen::Vector4f v (0.0f, 0.0f, 0.0f, 1.0f);
+                for (int i = 0; i < 3; ++i)
                 {
-                    s.get();
-                    if(s.peek() == '/')
+                    skipObjBlanks(p, line_end);
+                    parseObjFloat(p, line_end, v[i]);
+                }
+                chunk.vert.push_back(v);
+
+                // optional per vertex color
+                skipObjBlanks(p, line_end);
+                if (p < line_end)
+                {
+                    Eigen::Vector4f c (0.0f, 0.0f, 0.0f, 1.0f);
+                    for (int i = 0; i < 3; ++i)
                     {
-                        s.get();
-                        s >> normalID1;
-                        elementsNormals.push_back(normalID1-1);
+                        skipObjBlanks(p, line_end);
+                        parseObjFloat(p, line_end, c[i]);
                     }
-                    else
+                    chunk.color.push_back(c);
+                }
+            }
+
+            //Normals reading:
+            else if (p[0] == 'v' && p[1] == 'n')
+            {
+                p += 2;
+                Eigen::Vector3f vn (0.0f, 0.0f, 0.0f);
+                for (int i = 0; i < 3; ++i)
+                {
+                    skipObjBlanks(p, line_end);
+                    parseObjFloat(p, line_end, vn[i]);
+                }
+                chunk.norm.push_back(vn);
+            }
+
+            //Texture Coordinates reading:
+            else if (p[0] == 'v' && p[1] == 't')
+            {
+                p += 2;
+                Eigen::Vector2f vt (0.0f, 0.0f);
+                for (int i = 0; i < 2; ++i)
+                {
+                    skipObjBlanks(p, line_end);
+                    parseObjFloat(p, line_end, vt[i]);
+                }
+                chunk.texCoord.push_back(vt);
+            }
+
+            //Elements reading: Elements are given through a string: "f vertexID/TextureID/NormalID". If no texture is given, then the string will be: "vertexID//NormalID".
+            else if (p[0] == 'f' && isObjBlank(p[1]))
+            {
+                p += 2;
+                GLuint corners = 0;
+                while (true)
+                {
+                    skipObjBlanks(p, line_end);
+                    long id;
+                    if (!parseObjInt(p, line_end, id))
+                        break;
+                    pushObjIndex(id, chunk.vert.size(), chunk.elementsVertices, chunk.relativeVertices);
+
+                    bool has_tex = false, has_normal = false;
+                    if (p < line_end && *p == '/')
                     {
-                        s >> textureID1;
-                        elementsTexIDs.push_back(textureID1-1);
-                        if(s.peek() == '/')
+                        ++p;
+                        if (p < line_end && *p == '/')
+                        {
+                            ++p;
+                            if (parseObjInt(p, line_end, id))
+                            {
+                                pushObjIndex(id, chunk.norm.size(), chunk.elementsNormals, chunk.relativeNormals);
+                                has_normal = true;
+                            }
+                        }
+                        else
                         {
-                            s.get();
-                            s >> normalID1;
-                            elementsNormals.push_back(normalID1-1);
+                            if (parseObjInt(p, line_end, id))
+                            {
+                                pushObjIndex(id, chunk.texCoord.size(), chunk.elementsTexIDs, chunk.relativeTexIDs);
+                                has_tex = true;
+                            }
+                            if (p < line_end && *p == '/')
+                            {
+                                ++p;
+                                if (parseObjInt(p, line_end, id))
+                                {
+                                    pushObjIndex(id, chunk.norm.size(), chunk.elementsNormals, chunk.relativeNormals);
+                                    has_normal = true;
+                                }
+                            }
                         }
                     }
+                    if (!has_tex)
+                        chunk.elementsTexIDs.push_back(OBJ_NO_INDEX);
+                    if (!has_normal)
+                        chunk.elementsNormals.push_back(OBJ_NO_INDEX);
+                    ++corners;
+
+                    // skip anything left in a malformed corner token
+                    while (p < line_end && !isObjBlank(*p))
+                        ++p;
                 }
+                if (corners > 0)
+                    chunk.faceSizes.push_back(corners);
             }
+
+            //Ignoring comment lines and any other lines
         }
 
-        //Ignoring comment lines:
-        else if(line[0] == '#') { }
+        p = line_end + 1;
+    }
+}
 
-        //Ignoring any other lines:
-        else {};
+/**
+ * @brief Appends the arrays of every chunk to the output arrays, in chunk order.
+ *
+ * The offset of every chunk in every output array is the prefix sum of the previous chunk sizes,
+ * so chunks are copied in parallel and the result is identical to a serial parse.
+ * Relative indices are rebased with the number of elements preceding their chunk.
+ * @param chunks Parsed chunks, released as they are merged.
+ * @param out Merged data.
+ * @param num_threads Number of threads for the copy.
+ */
+static void mergeObjChunks (vector<ObjChunk>& chunks, ObjChunk& out, unsigned int num_threads)
+{
+    size_t n = chunks.size();
+    vector<size_t> vert_offset(n+1, 0), norm_offset(n+1, 0), tex_offset(n+1, 0), color_offset(n+1, 0);
+    vector<size_t> ev_offset(n+1, 0), en_offset(n+1, 0), et_offset(n+1, 0), face_offset(n+1, 0);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        vert_offset[i+1] = vert_offset[i] + chunks[i].vert.size();
+        norm_offset[i+1] = norm_offset[i] + chunks[i].norm.size();
+        tex_offset[i+1] = tex_offset[i] + chunks[i].texCoord.size();
+        color_offset[i+1] = color_offset[i] + chunks[i].color.size();
+        ev_offset[i+1] = ev_offset[i] + chunks[i].elementsVertices.size();
+        en_offset[i+1] = en_offset[i] + chunks[i].elementsNormals.size();
+        et_offset[i+1] = et_offset[i] + chunks[i].elementsTexIDs.size();
+        face_offset[i+1] = face_offset[i] + chunks[i].faceSizes.size();
     }
-    if(in.is_open())
+
+    out.vert.resize(vert_offset[n]);
+    out.norm.resize(norm_offset[n]);
+    out.texCoord.resize(tex_offset[n]);
+    out.color.resize(color_offset[n]);
+    out.elementsVertices.resize(ev_offset[n]);
+    out.elementsNormals.resize(en_offset[n]);
+    out.elementsTexIDs.resize(et_offset[n]);
+    out.faceSizes.resize(face_offset[n]);
+
+    Misc::parallelFor(n, [&] (size_t begin, size_t end, unsigned int)
     {
-        in.close();
+        for (size_t i = begin; i < end; ++i)
+        {
+            ObjChunk& c = chunks[i];
+
+            for (size_t k = 0; k < c.relativeVertices.size(); ++k)
+                c.elementsVertices[c.relativeVertices[k]] += (GLuint)vert_offset[i];
+            for (size_t k = 0; k < c.relativeNormals.size(); ++k)
+                c.elementsNormals[c.relativeNormals[k]] += (GLuint)norm_offset[i];
+            for (size_t k = 0; k < c.relativeTexIDs.size(); ++k)
+                c.elementsTexIDs[c.relativeTexIDs[k]] += (GLuint)tex_offset[i];
+
+            copy(c.vert.begin(), c.vert.end(), out.vert.begin() + vert_offset[i]);
+            copy(c.norm.begin(), c.norm.end(), out.norm.begin() + norm_offset[i]);
+            copy(c.texCoord.begin(), c.texCoord.end(), out.texCoord.begin() + tex_offset[i]);
+            copy(c.color.begin(), c.color.end(), out.color.begin() + color_offset[i]);
+            copy(c.elementsVertices.begin(), c.elementsVertices.end(), out.elementsVertices.begin() + ev_offset[i]);
+            copy(c.elementsNormals.begin(), c.elementsNormals.end(), out.elementsNormals.begin() + en_offset[i]);
+            copy(c.elementsTexIDs.begin(), c.elementsTexIDs.end(), out.elementsTexIDs.begin() + et_offset[i]);
+            copy(c.faceSizes.begin(), c.faceSizes.end(), out.faceSizes.begin() + face_offset[i]);
+
+            c = ObjChunk();
+        }
+    }, num_threads);
+}
+
+/**
+ * @brief Parses an OBJ buffer using several threads.
+ *
+ * The buffer is split at line boundaries, each chunk is parsed by its own thread and the results
+ * are merged in file order, so attribute order and face indices are the same as in a serial parse.
+ * Small buffers are parsed by the calling thread only.
+ * @param begin First byte of the file.
+ * @param end One past the last byte of the file.
+ * @param out Parsed data.
+ * @param num_threads Number of threads, if zero uses the number of hardware threads.
+ * @return Number of threads the buffer was parsed with.
+ */
+static unsigned int parseObjBufferParallel (const char* begin, const char* end, ObjChunk& out, unsigned int num_threads = 0)
+{
+    // below this many bytes per chunk thread startup and merging cost more than they save
+    const size_t min_chunk_size = 1 << 20;
+
+    size_t size = end - begin;
+    if (num_threads == 0)
+        num_threads = Misc::defaultThreadCount();
+    size_t num_chunks = min((size_t)num_threads, max((size_t)1, size / min_chunk_size));
+
+    if (num_chunks <= 1)
+    {
+        parseObjBuffer(begin, end, out);
+        return 1;
     }
 
-    // load attributes found in file
-    if (vert.size() > 0)
+    // chunk boundaries are moved forward to the start of the next line
+    vector<const char*> bounds (num_chunks+1);
+    bounds[0] = begin;
+    bounds[num_chunks] = end;
+    for (size_t i = 1; i < num_chunks; ++i)
     {
-        mesh->loadVertices(vert);
+        const char* b = max(begin + size * i / num_chunks, bounds[i-1]);
+        const char* eol = (const char*)memchr(b, '\n', end - b);
+        bounds[i] = eol ? eol + 1 : end;
     }
-    if (norm.size() > 0)
+
+    vector<ObjChunk> chunks (num_chunks);
+    Misc::parallelFor(num_chunks, [&] (size_t first, size_t last, unsigned int)
     {
-        mesh->loadNormals(norm);
+        for (size_t i = first; i < last; ++i)
+            parseObjBuffer(bounds[i], bounds[i+1], chunks[i]);
+    }, (unsigned int)num_chunks);
+
+    mergeObjChunks(chunks, out, num_threads);
+    return (unsigned int)num_chunks;
+}
+
+/**
+ * @brief Welds the face corners of a parsed OBJ into a single indexed vertex stream.
+ *
+ * OBJ indexes positions, texture coordinates and normals independently, while OpenGL uses a single
+ * index for all attributes. Every distinct (position, texcoord, normal) corner tuple becomes one output
+ * vertex, found through a hash table, so vertices are only duplicated where attributes actually differ.
+ * When all corners already use the same index for every attribute the welding is skipped.
+ * Polygons are triangulated as fans, faces with less than three corners are dropped.
+ *
+ * A corner without texcoord or normal index uses its position index if the file has one texcoord (normal)
+ * per position, otherwise the attribute is zero. Colors are given per position.
+ * On return vert, norm, texCoord and color hold one entry per output vertex, elementsVertices holds
+ * the triangle indices and the per corner arrays are released.
+ * @param obj Parsed OBJ data, modified in place.
+ */
+static void weldObjCorners (ObjChunk& obj)
+{
+    size_t corners = obj.elementsVertices.size();
+    GLuint num_vert = (GLuint)obj.vert.size();
+    GLuint num_norm = (GLuint)obj.norm.size();
+    GLuint num_tex = (GLuint)obj.texCoord.size();
+    bool per_vertex_norm = (num_norm == num_vert);
+    bool per_vertex_tex = (num_tex == num_vert);
+
+    // resolve the attribute indices of every corner, checking if they all match the position index
+    bool shared_indices = per_vertex_norm || num_norm == 0;
+    shared_indices = shared_indices && (per_vertex_tex || num_tex == 0);
+    for (size_t c = 0; c < corners; ++c)
+    {
+        GLuint v = obj.elementsVertices[c];
+        GLuint& t = obj.elementsTexIDs[c];
+        GLuint& n = obj.elementsNormals[c];
+
+        if (t == OBJ_NO_INDEX && per_vertex_tex)
+            t = v;
+        else if (t != OBJ_NO_INDEX && t >= num_tex)
+            t = OBJ_NO_INDEX;
+        if (n == OBJ_NO_INDEX && per_vertex_norm)
+            n = v;
+        else if (n != OBJ_NO_INDEX && n >= num_norm)
+            n = OBJ_NO_INDEX;
+
+        if ((num_tex > 0 && t != v) || (num_norm > 0 && n != v) || v >= num_vert)
+            shared_indices = false;
+    }
+
+    vector<GLuint> corner_vertex;
+    if (!shared_indices)
+    {
+        // open addressing hash table of unique corners, keys are stored as triplets in unique_corners
+        size_t capacity = 16;
+        while (capacity < corners*2)
+            capacity <<= 1;
+        size_t mask = capacity - 1;
+        vector<GLuint> table (capacity, OBJ_NO_INDEX);
+        vector<GLuint> unique_corners;
+        unique_corners.reserve(3 * max(num_vert, max(num_norm, num_tex)));
+
+        corner_vertex.resize(corners);
+        for (size_t c = 0; c < corners; ++c)
+        {
+            GLuint v = obj.elementsVertices[c];
+            GLuint t = obj.elementsTexIDs[c];
+            GLuint n = obj.elementsNormals[c];
+
+            uint64_t h = (uint64_t)v * 0x9E3779B97F4A7C15ULL;
+            h ^= ((uint64_t)t + 0x632BE59BD9B4E019ULL) * 0xC2B2AE3D27D4EB4FULL;
+            h ^= ((uint64_t)n + 0x165667B19E3779F9ULL) * 0x85EBCA77C2B2AE63ULL;
+            h ^= h >> 29;
+
+            size_t slot = (size_t)h & mask;
+            while (true)
+            {
+                GLuint u = table[slot];
+                if (u == OBJ_NO_INDEX)
+                {
+                    u = (GLuint)(unique_corners.size() / 3);
+                    table[slot] = u;
+                    unique_corners.push_back(v);
+                    unique_corners.push_back(t);
+                    unique_corners.push_back(n);
+                    corner_vertex[c] = u;
+                    break;
+                }
+                if (unique_corners[3*u] == v && unique_corners[3*u+1] == t && unique_corners[3*u+2] == n)
+                {
+                    corner_vertex[c] = u;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+        vector<GLuint>().swap(table);
+
+        // gather the attributes of the unique corners
+        size_t num_unique = unique_corners.size() / 3;
+        vector<Eigen::Vector4f> vert (num_unique, Eigen::Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+        vector<Eigen::Vector3f> norm (num_norm > 0 ? num_unique : 0, Eigen::Vector3f::Zero());
+        vector<Eigen::Vector2f> texCoord (num_tex > 0 ? num_unique : 0, Eigen::Vector2f::Zero());
+        vector<Eigen::Vector4f> color (obj.color.empty() ? 0 : num_unique, Eigen::Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+        for (size_t u = 0; u < num_unique; ++u)
+        {
+            GLuint v = unique_corners[3*u];
+            GLuint t = unique_corners[3*u+1];
+            GLuint n = unique_corners[3*u+2];
+            if (v < num_vert)
+            {
+                vert[u] = obj.vert[v];
+                if (v < obj.color.size())
+                    color[u] = obj.color[v];
+            }
+            if (t != OBJ_NO_INDEX)
+                texCoord[u] = obj.texCoord[t];
+            if (n != OBJ_NO_INDEX)
+                norm[u] = obj.norm[n];
+        }
+        obj.vert.swap(vert);
+        obj.norm.swap(norm);
+        obj.texCoord.swap(texCoord);
+        obj.color.swap(color);
     }
-    if (texCoord.size() > 0)
+    vector<GLuint>().swap(obj.elementsNormals);
+    vector<GLuint>().swap(obj.elementsTexIDs);
+
+    const vector<GLuint>& corner_index = shared_indices ? obj.elementsVertices : corner_vertex;
+
+    // fan triangulation of every face
+    size_t num_triangles = 0;
+    for (size_t f = 0; f < obj.faceSizes.size(); ++f)
+        if (obj.faceSizes[f] >= 3)
+            num_triangles += obj.faceSizes[f] - 2;
+
+    vector<GLuint> triangles;
+    triangles.reserve(num_triangles * 3);
+    size_t first = 0;
+    for (size_t f = 0; f < obj.faceSizes.size(); ++f)
     {
-        mesh->loadTexCoords(texCoord);
+        GLuint size = obj.faceSizes[f];
+        for (GLuint k = 1; k + 1 < size; ++k)
+        {
+            triangles.push_back(corner_index[first]);
+            triangles.push_back(corner_index[first + k]);
+            triangles.push_back(corner_index[first + k + 1]);
+        }
+        first += size;
     }
-    if (color.size() > 0)
+    obj.elementsVertices.swap(triangles);
+    vector<GLuint>().swap(obj.faceSizes);
+}
+
+/**
+ * @brief Reads an OBJ file into CPU side mesh data, without touching OpenGL.
+ *
+ * Reads vertex coordinates and normals, texcoords and color when available.
+ * The file is memory mapped and parsed in place, no line or stream objects are created.
+ * Large files are parsed in parallel chunks.
+ * Face corners are welded into a single vertex stream and polygons are triangulated, see weldObjCorners.
+ * Since no GL calls are made, this function can run on any thread.
+ * @param filename Given filename of the OBJ file.
+ * @param data Receives the decoded arrays, previous content is discarded.
+ * @param num_threads Number of parsing threads, if zero uses the number of hardware threads.
+ * @param report If not NULL receives the size of the file, the parse time and throughput.
+ * @return True if the file was read, false if it could not be opened.
+ */
+static bool readObjFile (const string& filename, MeshData& data, unsigned int num_threads, ObjParseReport* report = 0)
+{
+    ObjChunk obj;
+    data.clear();
+    if (report)
+        *report = ObjParseReport();
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+
+    //Opening file:
+    #ifdef TUCANODEBUG
+    cout << "Opening Wavefront obj file " << filename.c_str() << endl << endl;
+    #endif
+
+    MappedFile in (filename);
+    if (!in.isOpen())
     {
-        mesh->loadColors(color);
+        cerr << "Cannot open " << filename.c_str() << endl;
+        return false;
     }
-    if (elementsVertices.size() > 0)
+
+    //Reading file:
+    ObjParseReport parse;
+    parse.bytes = in.size();
+    chrono::high_resolution_clock::time_point parse_start = chrono::high_resolution_clock::now();
+
+    parse.threads = parseObjBufferParallel(in.data(), in.end(), obj, num_threads);
+
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - parse_start).count();
+    double megabytes = parse.bytes / (1024.0*1024.0);
+    parse.parse_milliseconds = 1000.0*seconds;
+    parse.megabytes_per_second = (seconds > 0.0) ? megabytes/seconds : 0.0;
+
+    #ifdef TUCANODEBUG
+    cout << "Parsed " << megabytes << " MB in " << seconds << " s (" << parse.megabytes_per_second << " MB/s)" << endl << endl;
+    #endif
+
+    in.close();
+
+    weldObjCorners(obj);
+
+    // after welding all arrays are indexed by the position index
+    data.vertices.swap(obj.vert);
+    data.normals.swap(obj.norm);
+    data.texCoords.swap(obj.texCoord);
+    data.colors.swap(obj.color);
+    data.indices.swap(obj.elementsVertices);
+
+    if (report)
     {
-        mesh->loadIndices(elementsVertices);
+        parse.milliseconds = 1000.0*chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        *report = parse;
     }
 
-    // sets the default locations for accesing attributes in shaders
-    mesh->setDefaultAttribLocations();
+    return true;
+}
+
+/**
+ * @brief Loads a mesh from an OBJ file.
+ *
+ * Decodes the file with readObjFile and uploads the arrays to the mesh.
+ * If the cache is enabled in the settings and holds an up to date copy of the file it is loaded instead,
+ * otherwise the decoded mesh is added to the cache (see meshcache.hpp).
+ * Missing normals (and tangents if enabled) are generated (see meshnormals.hpp, meshtangents.hpp) and decoded meshes are reordered if enabled in the settings (see meshoptimizer.hpp).
+ * @param mesh Pointer to mesh instance to load file.
+ * @param filename Given filename of the OBJ file.
+ * @param settings Import settings.
+ * @param num_threads Number of parsing threads, if zero uses the number of hardware threads.
+ * @param report If not NULL receives the vertex cache statistics before and after the optimization.
+ * @param parse_report If not NULL receives the timing of the decode of the file, all zero if the mesh came from the cache.
+ * @return True if the file was loaded, false if it could not be opened.
+ */
+static bool loadObjFile (Mesh* mesh, string filename, const MeshImportSettings& settings, unsigned int num_threads = 0,
+                         MeshOptimizationReport* report = 0, ObjParseReport* parse_report = 0)
+{
+    if (report)
+        report->optimized = false;
+    if (parse_report)
+        *parse_report = ObjParseReport();
+    if (loadCachedMesh(mesh, filename, settings))
+        return true;
+
+    MeshData data;
+    if (!readObjFile(filename, data, num_threads, parse_report))
+        return false;
+
+    generateImportedNormals(data, settings.normals);
+    generateImportedTangents(data, settings.tangents);
+    optimizeImportedMesh(data, settings.optimizer, report);
+    storeCachedMesh(filename, settings, data);
+    uploadMeshData(mesh, std::move(data));
 
     #ifdef TUCANODEBUG
     Misc::errorCheckFunc(__FILE__, __LINE__);
     #endif
+
+    return true;
+}
+
+/**
+ * @brief Loads a mesh from an OBJ file with the default import settings.
+ * @param mesh Pointer to mesh instance to load file.
+ * @param filename Given filename of the OBJ file.
+ * @param num_threads Number of parsing threads, if zero uses the number of hardware threads.
+ * @return True if the file was loaded, false if it could not be opened.
+ */
+static bool loadObjFile (Mesh* mesh, string filename, unsigned int num_threads)
+{
+    return loadObjFile(mesh, filename, MeshImportSettings(), num_threads);
+}
+
+/**
+ * @brief Loads a mesh from an OBJ file with the default import settings, parsing with all hardware threads.
+ * @param mesh Pointer to mesh instance to load file.
+ * @param filename Given filename of the OBJ file.
+ * @return True if the file was loaded, false if it could not be opened.
+ */
+static bool loadObjFile (Mesh* mesh, string filename)
+{
+    return loadObjFile(mesh, filename, MeshImportSettings(), 0);
 }
 
 }
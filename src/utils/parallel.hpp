@@ -0,0 +1,84 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace Tucano
+{
+
+namespace Misc
+{
+
+/**
+ * @brief Returns the number of worker threads used when none is given.
+ * @return Number of hardware threads, at least one.
+ */
+inline unsigned int defaultThreadCount (void)
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return (n == 0) ? 1 : n;
+}
+
+/**
+ * @brief Splits the range [0, count) in contiguous blocks and processes each block in its own thread.
+ *
+ * The calling thread processes the first block, so a single block runs without spawning threads.
+ * The function receives the block range and the block index: func(begin, end, block).
+ * Blocks are numbered in range order, so per block results can be merged deterministically.
+ * @param count Number of items.
+ * @param func Function called once per block.
+ * @param num_threads Number of blocks, if zero uses the number of hardware threads.
+ * @return Number of blocks actually used (never more than count).
+ */
+template <class Function>
+unsigned int parallelFor (size_t count, Function func, unsigned int num_threads = 0)
+{
+    if (num_threads == 0)
+        num_threads = defaultThreadCount();
+    if ((size_t)num_threads > count)
+        num_threads = (count == 0) ? 1 : (unsigned int)count;
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (unsigned int t = 1; t < num_threads; ++t)
+    {
+        size_t begin = count * t / num_threads;
+        size_t end = count * (t+1) / num_threads;
+        workers.push_back(std::thread(func, begin, end, t));
+    }
+
+    func((size_t)0, count / num_threads, 0u);
+
+    for (unsigned int t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+    return num_threads;
+}
+
+}
+}
+#endif
@@ -98,6 +98,12 @@ private:
 	/// A sphere to visually represent the path's key positions
 	Shapes::Sphere sphere;
 
+	/// Model matrices of the spheres drawn in one call, refilled at every render
+	vector< Eigen::Matrix4f > sphere_models;
+
+	/// Colors of the spheres drawn in one call
+	vector< Eigen::Vector4f > sphere_colors;
+
 	/// Coordinate axes for visualizing quaternions at key positions
 	Shapes::CoordinateAxes axes;
 
@@ -106,6 +112,23 @@ private:
 
 	/// To render simple lines
 	Shader phong_shader;
+
+	/**
+	* @brief Appends one small sphere instance for each given point
+	* @param points Sphere centers
+	* @param color Color of the spheres
+	*/
+	void addSphereInstances (const vector< Eigen::Vector4f >& points, const Eigen::Vector4f& color)
+	{
+		for (unsigned int i = 0; i < points.size(); i++)
+		{
+			Eigen::Affine3f model = Eigen::Affine3f::Identity();
+			model.translate( Eigen::Vector3f(points[i].head(3)) );
+			model.scale( 0.03 );
+			sphere_models.push_back(model.matrix());
+			sphere_colors.push_back(color);
+		}
+	}
 	
 public:
 
@@ -166,6 +189,7 @@ public:
 
 		phong_shader.load("phongshader", shader_dir);
 		phong_shader.initialize();
+		FrameUniforms::attach(phong_shader);
     }
 
 	/**
@@ -239,7 +263,7 @@ public:
 	*/
     void render (const Tucano::Camera& camera, const Tucano::Camera& light)
     {
-		glEnable(GL_DEPTH_TEST);
+		glState().enable(GL_DEPTH_TEST);
 		if (key_positions.size() > 1)
 		{
 
@@ -263,11 +287,9 @@ public:
 
 			if (draw_control_points)
 			{
+				sharedFrameUniforms().update(camera, light);
+
 				phong_shader.bind();
-			
-				phong_shader.setUniform("viewMatrix", camera.getViewMatrix());
-				phong_shader.setUniform("projectionMatrix", camera.getProjectionMatrix());
-				phong_shader.setUniform("lightViewMatrix", light.getViewMatrix());
 
 				color << 1.0, 1.0, 0.0, 1.0;
 				phong_shader.setUniform("modelMatrix", Eigen::Affine3f::Identity());
@@ -279,57 +301,32 @@ public:
 				control_segments.unbindBuffers();
 				phong_shader.unbind();
 
-				sphere.setColor( Eigen::Vector4f (0.48, 1.0, 0.16, 1.0) );
-				// render control points
-				for (unsigned int i = 0; i < control_points_1.size(); i++)
-				{
-					sphere.resetModelMatrix();
-					Eigen::Vector3f translation = control_points_1[i].head(3);
-					sphere.modelMatrix()->translate( translation );
-					sphere.modelMatrix()->scale( 0.03 );
-					sphere.render(camera, light);
-				}
-
-				sphere.setColor( Eigen::Vector4f (0.48, 0.16, 1.0, 1.0) );
-				// render control points
-				for (unsigned int i = 0; i < control_points_2.size(); i++)
-				{
-					sphere.resetModelMatrix();
-					Eigen::Vector3f translation = control_points_2[i].head(3);
-					sphere.modelMatrix()->translate( translation );
-					sphere.modelMatrix()->scale( 0.03 );
-					sphere.render(camera, light);
-				}
-
+				// control points are drawn with the key positions below
+				addSphereInstances(control_points_1, Eigen::Vector4f (0.48, 1.0, 0.16, 1.0));
+				addSphereInstances(control_points_2, Eigen::Vector4f (0.48, 0.16, 1.0, 1.0));
 			}
 
 		}
 
 		if (draw_quaternions)
 		{
+			vector<Eigen::Matrix4f> axes_models (key_quaternions.size());
 			for (unsigned int i = 0; i < key_quaternions.size(); ++i)
 			{
-				axes.resetModelMatrix();
-				axes.modelMatrix()->rotate(key_quaternions[i]);
-				axes.modelMatrix()->scale(0.2);
-				axes.render(camera, light);	
+				axes_models[i] = Eigen::Affine3f(key_quaternions[i]).matrix();
 			}
+			axes.renderInstances(camera, light, axes_models);
 		}
 
-		sphere.setColor( Eigen::Vector4f (1.0, 0.48, 0.16, 1.0) );
-		// render key positions
-		for (unsigned int i = 0; i < key_positions.size(); i++)
-		{
-			sphere.resetModelMatrix();
-			
-			Eigen::Vector3f translation = key_positions[i].head(3);
-			sphere.modelMatrix()->translate( translation );
-			sphere.modelMatrix()->scale( 0.03 );
-			sphere.render(camera, light);
-		}
+		// render key positions, and control points if enabled, with a single draw call
+		addSphereInstances(key_positions, Eigen::Vector4f (1.0, 0.48, 0.16, 1.0));
+		sphere.resetModelMatrix();
+		sphere.renderInstances(camera, light, sphere_models, sphere_colors);
+		sphere_models.clear();
+		sphere_colors.clear();
 
 
-        glDisable(GL_DEPTH_TEST);
+        glState().disable(GL_DEPTH_TEST);
 		
 		#ifdef TUCANODEBUG
         Misc::errorCheckFunc(__FILE__, __LINE__);
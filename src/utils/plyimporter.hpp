@@ -25,6 +25,19 @@
 
 #include <mesh.hpp>
 #include <utils/rply.hpp>
+#include <utils/mappedfile.hpp>
+#include <utils/meshdata.hpp>
+#include <utils/meshcache.hpp>
+#include <utils/meshimportsettings.hpp>
+#include <utils/meshnormals.hpp>
+#include <utils/meshtangents.hpp>
+#include <utils/meshoptimizer.hpp>
+#include <utils/misc.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
 
 using namespace std;
 
@@ -38,20 +51,47 @@ namespace MeshImporter
 #else
     // avoid warnings of unused function
 	static bool loadPlyFile (Mesh* mesh, string filename) __attribute__ ((unused));
+	static bool loadPlyFile (Mesh* mesh, string filename, const MeshImportSettings& settings, MeshOptimizationReport* report) __attribute__ ((unused));
+	static bool readPlyFile (const string& filename, MeshData& data) __attribute__ ((unused));
 #endif
 
 
 
-    static int normal_cb( p_ply_argument argument )
+    /**
+     * @brief State of one PLY read with the rply callbacks.
+     *
+     * Partially read vertices, normals and colors are accumulated here instead of in static variables,
+     * so several files can be read at the same time from different threads.
+     */
+    struct PlyReadContext
     {
-        static Eigen::Vector3f v;
+        /// Arrays receiving the decoded data.
+        MeshData* data;
+
+        /// Vertex being read.
+        Eigen::Vector4f vertex;
+
+        /// Normal being read.
+        Eigen::Vector3f normal;
+
+        /// Color being read.
+        Eigen::Vector4f color;
+
+        /// Number of vertices declared in the header, face indices must be below it.
+        long num_vertices;
+
+        PlyReadContext (MeshData* d) : data(d), vertex(0.0, 0.0, 0.0, 1.0), normal(0.0, 0.0, 0.0), color(0.0, 0.0, 0.0, 1.0), num_vertices(0) {}
+    };
 
+    static int normal_cb( p_ply_argument argument )
+    {
         void* data;
         long coord;
 
         ply_get_argument_user_data( argument, &data, &coord );
 
-        vector<Eigen::Vector3f>* vec = static_cast< vector<Eigen::Vector3f>* >( data );
+        PlyReadContext* context = static_cast< PlyReadContext* >( data );
+        Eigen::Vector3f& v = context->normal;
 
         switch( coord )
         {
@@ -62,7 +102,7 @@ namespace MeshImporter
 
             case 2:
                 v[2] = ply_get_argument_value( argument );
-                vec->push_back( v );
+                context->data->normals.push_back( v );
                 break;
         }
 
@@ -71,13 +111,14 @@ namespace MeshImporter
 
     static int color_cb( p_ply_argument argument )
     {
-        static Eigen::Vector4f c;
-
         void* data;
         long coord;
 
         ply_get_argument_user_data( argument, &data, &coord );
 
+        PlyReadContext* context = static_cast< PlyReadContext* >( data );
+        Eigen::Vector4f& c = context->color;
+
         float channel = ply_get_argument_value( argument );
         if (channel > 1.0)
             channel /= 255.0;
@@ -92,7 +133,7 @@ namespace MeshImporter
             case 2:
                 c[2] = channel;
                 c[3] = 1.0;
-                (static_cast< vector<Eigen::Vector4f>* >( data ))->push_back( c );
+                context->data->colors.push_back( c );
                 break;
         }
 
@@ -101,12 +142,14 @@ namespace MeshImporter
 
     static int vertex_cb( p_ply_argument argument )
     {
-        static Eigen::Vector4f v;
         void* data;
         long coord;
 
         ply_get_argument_user_data( argument, &data, &coord );
 
+        PlyReadContext* context = static_cast< PlyReadContext* >( data );
+        Eigen::Vector4f& v = context->vertex;
+
         switch( coord )
         {
             case 0:
@@ -117,7 +160,7 @@ namespace MeshImporter
             case 2:
                 v[2] = ply_get_argument_value( argument );
                 v[3] = 1.0;
-                (static_cast< vector<Eigen::Vector4f>* >( data ))->push_back( v );
+                context->data->vertices.push_back( v );
                 break;
         }
 
@@ -137,22 +180,389 @@ namespace MeshImporter
 
         if (value_index >= 0 && value_index < 3)
         {
-            (static_cast< vector<unsigned int>* >(data))->push_back(ply_get_argument_value(argument));
+            PlyReadContext* context = static_cast< PlyReadContext* >( data );
+            double index = ply_get_argument_value(argument);
+            // negative or out of range indices abort the read
+            if (index < 0.0 || index >= context->num_vertices)
+                return 0;
+            context->data->indices.push_back((GLuint)index);
         }
 
         return 1;
     }
 
     /**
-     * @brief Loads a mesh from an PLY file.
+     * @brief Scalar types of PLY properties.
+     */
+    enum PlyScalarType
+    {
+        PLY_INVALID_TYPE, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64
+    };
+
+    /**
+     * @brief Property of a PLY element, as described in the file header.
+     */
+    struct PlyProperty
+    {
+        string name;
+        PlyScalarType type;
+        /// For list properties, the type of the list length, PLY_INVALID_TYPE for scalar properties.
+        PlyScalarType count_type;
+        /// Offset from the start of the element record, only meaningful for fixed size elements.
+        size_t offset;
+    };
+
+    /**
+     * @brief Element of a PLY file (vertex, face ...), as described in the file header.
+     */
+    struct PlyElement
+    {
+        string name;
+        size_t count;
+        vector<PlyProperty> properties;
+    };
+
+    /**
+     * @brief Returns the scalar type for a PLY type name, accepting both the old and the sized names.
+     */
+    static inline PlyScalarType plyScalarType (const string& name)
+    {
+        if (name == "char" || name == "int8") return PLY_INT8;
+        if (name == "uchar" || name == "uint8") return PLY_UINT8;
+        if (name == "short" || name == "int16") return PLY_INT16;
+        if (name == "ushort" || name == "uint16") return PLY_UINT16;
+        if (name == "int" || name == "int32") return PLY_INT32;
+        if (name == "uint" || name == "uint32") return PLY_UINT32;
+        if (name == "float" || name == "float32") return PLY_FLOAT32;
+        if (name == "double" || name == "float64") return PLY_FLOAT64;
+        return PLY_INVALID_TYPE;
+    }
+
+    /**
+     * @brief Returns the size in bytes of a PLY scalar type.
+     */
+    static inline size_t plyScalarSize (PlyScalarType type)
+    {
+        switch (type)
+        {
+            case PLY_INT8: case PLY_UINT8: return 1;
+            case PLY_INT16: case PLY_UINT16: return 2;
+            case PLY_INT32: case PLY_UINT32: case PLY_FLOAT32: return 4;
+            case PLY_FLOAT64: return 8;
+            default: return 0;
+        }
+    }
+
+    /**
+     * @brief Reads a scalar from a binary PLY body, byte swapping if the file endianness differs from the host.
+     * @param p Pointer to the first byte of the scalar.
+     * @param type Scalar type.
+     * @param swap True if bytes must be swapped.
+     * @return Scalar value converted to double.
+     */
+    static inline double readPlyScalar (const char* p, PlyScalarType type, bool swap)
+    {
+        unsigned char b[8];
+        size_t size = plyScalarSize(type);
+        if (swap)
+        {
+            for (size_t i = 0; i < size; ++i)
+                b[i] = (unsigned char)p[size-1-i];
+        }
+        else
+        {
+            memcpy(b, p, size);
+        }
+
+        switch (type)
+        {
+            case PLY_INT8:    { int8_t v;   memcpy(&v, b, 1); return v; }
+            case PLY_UINT8:   { uint8_t v;  memcpy(&v, b, 1); return v; }
+            case PLY_INT16:   { int16_t v;  memcpy(&v, b, 2); return v; }
+            case PLY_UINT16:  { uint16_t v; memcpy(&v, b, 2); return v; }
+            case PLY_INT32:   { int32_t v;  memcpy(&v, b, 4); return v; }
+            case PLY_UINT32:  { uint32_t v; memcpy(&v, b, 4); return v; }
+            case PLY_FLOAT32: { float v;    memcpy(&v, b, 4); return v; }
+            case PLY_FLOAT64: { double v;   memcpy(&v, b, 8); return v; }
+            default: return 0.0;
+        }
+    }
+
+    /**
+     * @brief Reads three consecutive float properties, the layout of virtually every position and normal.
+     * @return True if the three properties are consecutive 32 bit floats and were read.
+     */
+    static inline bool readPlyFloat3 (const char* record, const PlyProperty* const prop[3], bool swap, float* out)
+    {
+        if (prop[0]->type != PLY_FLOAT32 || prop[1]->type != PLY_FLOAT32 || prop[2]->type != PLY_FLOAT32 ||
+            prop[1]->offset != prop[0]->offset + 4 || prop[2]->offset != prop[0]->offset + 8)
+            return false;
+
+        memcpy(out, record + prop[0]->offset, 12);
+        if (swap)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                unsigned char* b = (unsigned char*)&out[i];
+                std::swap(b[0], b[3]);
+                std::swap(b[1], b[2]);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Parses the header of a PLY file.
+     * @param begin First byte of the file.
+     * @param end One past the last byte of the file.
+     * @param format Receives the format name (ascii, binary_little_endian or binary_big_endian).
+     * @param elements Receives the element descriptions.
+     * @return Pointer to the first byte of the body, NULL if the header is invalid.
+     */
+    static const char* readPlyHeader (const char* begin, const char* end, string& format, vector<PlyElement>& elements)
+    {
+        const char* p = begin;
+        bool first_line = true;
+        while (p < end)
+        {
+            const char* eol = (const char*)memchr(p, '\n', end - p);
+            if (!eol)
+                return NULL;
+
+            istringstream line (string(p, eol));
+            p = eol + 1;
+
+            string keyword;
+            line >> keyword;
+
+            if (first_line)
+            {
+                if (keyword != "ply")
+                    return NULL;
+                first_line = false;
+            }
+            else if (keyword == "format")
+            {
+                line >> format;
+            }
+            else if (keyword == "element")
+            {
+                PlyElement element;
+                line >> element.name >> element.count;
+                if (line.fail())
+                    return NULL;
+                elements.push_back(element);
+            }
+            else if (keyword == "property")
+            {
+                if (elements.empty())
+                    return NULL;
+                PlyProperty prop;
+                prop.offset = 0;
+                prop.count_type = PLY_INVALID_TYPE;
+                string type;
+                line >> type;
+                if (type == "list")
+                {
+                    string count_type;
+                    line >> count_type >> type;
+                    prop.count_type = plyScalarType(count_type);
+                    if (prop.count_type == PLY_INVALID_TYPE)
+                        return NULL;
+                }
+                prop.type = plyScalarType(type);
+                line >> prop.name;
+                if (prop.type == PLY_INVALID_TYPE || line.fail())
+                    return NULL;
+                elements.back().properties.push_back(prop);
+            }
+            else if (keyword == "end_header")
+            {
+                return p;
+            }
+            // comments, obj_info and unknown keywords are ignored
+        }
+        return NULL;
+    }
+
+    /**
+     * @brief Fast path for binary PLY files, reading the body straight into the attribute arrays.
      *
-     * @param mesh Pointer to mesh instance to load file.
+     * Handles the usual layout of scanned meshes: a vertex element with scalar properties only (fixed size records)
+     * followed by a face element with a single list of vertex indices. Anything else (ascii files, extra elements or
+     * list properties, polygons with more than three vertices) is rejected and must be read with the generic rply callbacks.
+     * The result is the same as the callback path.
+     * Files with invalid face indices are left to the callback path, which rejects them.
+     * @param file Mapped PLY file.
+     * @param data Receives the decoded arrays.
+     * @return True if the file was read, false if the fast path does not apply.
+     */
+    static bool readPlyBinary (const MappedFile& file, MeshData& data)
+    {
+        string format;
+        vector<PlyElement> elements;
+        const char* body = readPlyHeader(file.data(), file.end(), format, elements);
+        if (!body)
+            return false;
+
+        uint16_t endian_test = 1;
+        bool host_little_endian = (*(unsigned char*)&endian_test == 1);
+        bool swap;
+        if (format == "binary_little_endian")
+            swap = !host_little_endian;
+        else if (format == "binary_big_endian")
+            swap = host_little_endian;
+        else
+            return false;
+
+        // accept exactly one vertex element, optionally followed by one face element
+        if (elements.empty() || elements.size() > 2 || elements[0].name != "vertex")
+            return false;
+
+        PlyElement& vertex = elements[0];
+        const PlyProperty* position[3] = {NULL, NULL, NULL};
+        const PlyProperty* normal[3] = {NULL, NULL, NULL};
+        const PlyProperty* rgb[3] = {NULL, NULL, NULL};
+        size_t stride = 0;
+        for (size_t i = 0; i < vertex.properties.size(); ++i)
+        {
+            PlyProperty& prop = vertex.properties[i];
+            if (prop.count_type != PLY_INVALID_TYPE)
+                return false;
+            prop.offset = stride;
+            stride += plyScalarSize(prop.type);
+
+            const char* names[9] = {"x", "y", "z", "nx", "ny", "nz", "red", "green", "blue"};
+            const PlyProperty** slots[9] = {&position[0], &position[1], &position[2], &normal[0], &normal[1], &normal[2], &rgb[0], &rgb[1], &rgb[2]};
+            for (int k = 0; k < 9; ++k)
+                if (prop.name == names[k])
+                    *slots[k] = &prop;
+        }
+        if (!position[0] || !position[1] || !position[2])
+            return false;
+
+        const PlyProperty* face_list = NULL;
+        if (elements.size() == 2)
+        {
+            PlyElement& face = elements[1];
+            if (face.name != "face" || face.properties.size() != 1)
+                return false;
+            face_list = &face.properties[0];
+            if (face_list->count_type == PLY_INVALID_TYPE || (face_list->name != "vertex_indices" && face_list->name != "vertex_index"))
+                return false;
+            if (face_list->type == PLY_FLOAT32 || face_list->type == PLY_FLOAT64)
+                return false;
+        }
+
+        size_t body_size = file.end() - body;
+        if (vertex.count > body_size / max(stride, (size_t)1))
+            return false;
+
+        bool has_normals = normal[0] && normal[1] && normal[2];
+        bool has_colors = rgb[0] && rgb[1] && rgb[2];
+
+        vector<Eigen::Vector4f> fast_vertices (vertex.count);
+        vector<Eigen::Vector3f> fast_norm (has_normals ? vertex.count : 0);
+        vector<Eigen::Vector4f> fast_color (has_colors ? vertex.count : 0);
+
+        const char* record = body;
+        for (size_t i = 0; i < vertex.count; ++i, record += stride)
+        {
+            Eigen::Vector4f& v = fast_vertices[i];
+            if (!readPlyFloat3(record, position, swap, v.data()))
+            {
+                for (int k = 0; k < 3; ++k)
+                    v[k] = (float)readPlyScalar(record + position[k]->offset, position[k]->type, swap);
+            }
+            v[3] = 1.0;
+
+            if (has_normals)
+            {
+                Eigen::Vector3f& n = fast_norm[i];
+                if (!readPlyFloat3(record, normal, swap, n.data()))
+                {
+                    for (int k = 0; k < 3; ++k)
+                        n[k] = (float)readPlyScalar(record + normal[k]->offset, normal[k]->type, swap);
+                }
+            }
+
+            if (has_colors)
+            {
+                Eigen::Vector4f& c = fast_color[i];
+                for (int k = 0; k < 3; ++k)
+                {
+                    float channel = (float)readPlyScalar(record + rgb[k]->offset, rgb[k]->type, swap);
+                    if (channel > 1.0)
+                        channel /= 255.0;
+                    c[k] = channel;
+                }
+                c[3] = 1.0;
+            }
+        }
+
+        vector<GLuint> fast_indices;
+        if (face_list)
+        {
+            size_t num_faces = elements[1].count;
+            size_t count_size = plyScalarSize(face_list->count_type);
+            size_t index_size = plyScalarSize(face_list->type);
+            const char* end = file.end();
+
+            fast_indices.resize(num_faces * 3);
+            for (size_t f = 0; f < num_faces; ++f)
+            {
+                if (record + count_size + 3 * index_size > end)
+                    return false;
+                // polygons are left to the generic path
+                if (readPlyScalar(record, face_list->count_type, swap) != 3.0)
+                    return false;
+                record += count_size;
+
+                if (index_size == 4 && !swap)
+                {
+                    // negative int32 indices become huge unsigned values, caught by the range check
+                    memcpy(&fast_indices[3*f], record, 12);
+                    for (int k = 0; k < 3; ++k)
+                        if (fast_indices[3*f + k] >= vertex.count)
+                            return false;
+                }
+                else
+                {
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        double index = readPlyScalar(record + k*index_size, face_list->type, swap);
+                        if (index < 0.0 || index >= vertex.count)
+                            return false;
+                        fast_indices[3*f + k] = (GLuint)index;
+                    }
+                }
+                record += 3 * index_size;
+            }
+        }
+
+        data.vertices.swap(fast_vertices);
+        data.normals.swap(fast_norm);
+        data.colors.swap(fast_color);
+        data.indices.swap(fast_indices);
+        return true;
+    }
+
+    /**
+     * @brief Decodes a PLY file into CPU side arrays, without touching OpenGL.
+     *
+     * Binary files with a plain vertex/triangle layout are read directly from a memory mapped file,
+     * see readPlyBinary. Other files are parsed with the rply callbacks.
+     * All state is local to the call, so many files can be decoded concurrently from worker threads.
      * @param filename Given filename of the PLY file.
+     * @param data Receives the decoded arrays, previous content is discarded.
+     * @return True if the file was read, false otherwise.
      */
-    static bool loadPlyFile (Mesh *mesh, string filename)
+    static bool readPlyFile (const string& filename, MeshData& data)
     {
-        p_ply ply = ply_open( filename.c_str(), NULL, 0, NULL );
-        if( !ply || !ply_read_header( ply ) )
+        data.clear();
+
+        MappedFile file (filename);
+        if (!file.isOpen())
         {
             cerr << "Cannot open " << filename.c_str() << endl;
             return false;
@@ -162,55 +572,87 @@ namespace MeshImporter
         cout << "Opening Stanford ply file " << filename.c_str() << endl << endl;
         #endif
 
+        bool fast_path = readPlyBinary(file, data);
+        file.close();
 
-        vector<Eigen::Vector4f> vertices;
-        vector<Eigen::Vector3f> norm;
-        vector<Eigen::Vector2f> texCoord;
-        vector<Eigen::Vector4f> color;
-        std::vector<unsigned int> indices;
+        if (fast_path)
+            return true;
 
-    //    long nvertices, ncolors, nnormals, ntriangles;
+        p_ply ply = ply_open( filename.c_str(), NULL, 0, NULL );
+        if( !ply || !ply_read_header( ply ) )
+        {
+            cerr << "Cannot open " << filename.c_str() << endl;
+            if (ply)
+                ply_close( ply );
+            return false;
+        }
+
+        PlyReadContext context (&data);
+
+        // the callbacks return the number of instances of their element, reserve the arrays up front
+        long nvertices, ncolors, nnormals, ntriangles;
 
-    //    nvertices = ply_set_read_cb( ply, "vertex", "x", vertex_cb, ( void* )&vertices, 0 );
-        ply_set_read_cb( ply, "vertex", "x", vertex_cb, ( void* )&vertices, 0 );
-        ply_set_read_cb( ply, "vertex", "y", vertex_cb, ( void* )&vertices, 1 );
-        ply_set_read_cb( ply, "vertex", "z", vertex_cb, ( void* )&vertices, 2 );
+        nvertices = ply_set_read_cb( ply, "vertex", "x", vertex_cb, ( void* )&context, 0 );
+        context.num_vertices = nvertices;
+        ply_set_read_cb( ply, "vertex", "y", vertex_cb, ( void* )&context, 1 );
+        ply_set_read_cb( ply, "vertex", "z", vertex_cb, ( void* )&context, 2 );
 
-    //    ncolors = ply_set_read_cb( ply, "vertex", "red", vertex_cb, ( void* )&color, 0 );
-        ply_set_read_cb( ply, "vertex", "red", color_cb, ( void* )&color, 0 );
-        ply_set_read_cb( ply, "vertex", "green", color_cb, ( void* )&color, 1 );
-        ply_set_read_cb( ply, "vertex", "blue", color_cb, ( void* )&color, 2 );
+        ncolors = ply_set_read_cb( ply, "vertex", "red", color_cb, ( void* )&context, 0 );
+        ply_set_read_cb( ply, "vertex", "green", color_cb, ( void* )&context, 1 );
+        ply_set_read_cb( ply, "vertex", "blue", color_cb, ( void* )&context, 2 );
 
-    //    nnormals = ply_set_read_cb( ply, "vertex", "nx", normal_cb, ( void* )&norm, 0 );
-        ply_set_read_cb( ply, "vertex", "ny", normal_cb, ( void* )&norm, 1 );
-        ply_set_read_cb( ply, "vertex", "nx", normal_cb, ( void* )&norm, 0 );
-        ply_set_read_cb( ply, "vertex", "nz", normal_cb, ( void* )&norm, 2 );
+        ply_set_read_cb( ply, "vertex", "ny", normal_cb, ( void* )&context, 1 );
+        nnormals = ply_set_read_cb( ply, "vertex", "nx", normal_cb, ( void* )&context, 0 );
+        ply_set_read_cb( ply, "vertex", "nz", normal_cb, ( void* )&context, 2 );
 
-    //    ntriangles = ply_set_read_cb(ply, "face", "vertex_indices", face_cb, &indices, 0);
-        ply_set_read_cb(ply, "face", "vertex_indices", face_cb, &indices, 0);
+        ntriangles = ply_set_read_cb(ply, "face", "vertex_indices", face_cb, ( void* )&context, 0);
+
+        data.vertices.reserve(nvertices);
+        data.colors.reserve(ncolors);
+        data.normals.reserve(nnormals);
+        data.indices.reserve(3*ntriangles);
 
         if( !ply_read( ply ) )
         {
+            ply_close( ply );
+            data.clear();
             return false;
         }
 
         ply_close( ply );
 
-        // load attributes found in file
-        if (vertices.size() > 0)
-            mesh->loadVertices(vertices);
-        if (norm.size() > 0)
-            mesh->loadNormals(norm);
-        if (texCoord.size() > 0)
-            mesh->loadTexCoords(texCoord);
-        if (color.size() > 0)
-            mesh->loadColors(color);
-        if (indices.size() > 0)
-            mesh->loadIndices(indices);
+        return true;
+    }
 
-        // sets the default locations for accesing attributes in shaders
-        mesh->setDefaultAttribLocations();
+    /**
+     * @brief Loads a mesh from an PLY file.
+     *
+     * Decodes the file with readPlyFile and uploads the arrays to the mesh.
+     * If the cache is enabled in the settings and holds an up to date copy of the file it is loaded instead,
+     * otherwise the decoded mesh is added to the cache (see meshcache.hpp).
+     * Missing normals (and tangents if enabled) are generated (see meshnormals.hpp, meshtangents.hpp) and decoded meshes are reordered if enabled in the settings (see meshoptimizer.hpp).
+     * @param mesh Pointer to mesh instance to load file.
+     * @param filename Given filename of the PLY file.
+     * @param settings Import settings.
+     * @param report If not NULL receives the vertex cache statistics before and after the optimization.
+     * @return True if the file was loaded, false otherwise.
+     */
+    static bool loadPlyFile (Mesh *mesh, string filename, const MeshImportSettings& settings, MeshOptimizationReport* report = 0)
+    {
+        if (report)
+            report->optimized = false;
+        if (loadCachedMesh(mesh, filename, settings))
+            return true;
+
+        MeshData data;
+        if (!readPlyFile(filename, data))
+            return false;
 
+        generateImportedNormals(data, settings.normals);
+        generateImportedTangents(data, settings.tangents);
+        optimizeImportedMesh(data, settings.optimizer, report);
+        storeCachedMesh(filename, settings, data);
+        uploadMeshData(mesh, std::move(data));
 
         #ifdef TUCANODEBUG
         Misc::errorCheckFunc(__FILE__, __LINE__);
@@ -219,6 +661,17 @@ namespace MeshImporter
         return true;
     }
 
+    /**
+     * @brief Loads a mesh from an PLY file with the default import settings.
+     * @param mesh Pointer to mesh instance to load file.
+     * @param filename Given filename of the PLY file.
+     * @return True if the file was loaded, false otherwise.
+     */
+    static bool loadPlyFile (Mesh *mesh, string filename)
+    {
+        return loadPlyFile(mesh, filename, MeshImportSettings());
+    }
+
 }
 }
 #endif
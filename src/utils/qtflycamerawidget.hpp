@@ -26,6 +26,7 @@
 #include <qglobal.h>
 #if QT_VERSION >= 0x050400
 	#include <QOpenGLWidget>
+	#include <QOpenGLContext>
 #else
 	#include <GL/glew.h>
 	#include <QGLWidget>
@@ -70,6 +71,9 @@ protected:
     /// Trackball for manipulating the light position.
     Trackball *light_trackball;
 
+    /// Tracker of the OpenGL state of the widget context, created in initializeGL.
+    GLState* gl_state;
+
 public:
 
     /**
@@ -77,9 +81,9 @@ public:
      * @param parent Parent widget.
      */
 #if QT_VERSION >= 0x050400
-	explicit QtFlycameraWidget(QWidget *parent) : QOpenGLWidget(parent) {}
+	explicit QtFlycameraWidget(QWidget *parent) : QOpenGLWidget(parent), gl_state(NULL) {}
 #else
-	explicit QtFlycameraWidget(QWidget *parent) : QGLWidget(parent) {}
+	explicit QtFlycameraWidget(QWidget *parent) : QGLWidget(parent), gl_state(NULL) {}
 #endif
 
     /**
@@ -89,6 +93,7 @@ public:
 	{
 		delete camera;
 		delete light_trackball;
+		releaseGLState();
 	}
 
     /**
@@ -100,6 +105,14 @@ public:
 
 		initGL();
 
+		// each widget has its own context, and so its own state tracker, released before the context is destroyed
+		if (!gl_state)
+			gl_state = new GLState();
+		gl_state->makeCurrent();
+#if QT_VERSION >= 0x050400
+		connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, &QtFlycameraWidget::releaseGLState);
+#endif
+
 #if QT_VERSION < 0x050400
 #ifdef TUCANODEBUG
 		QGLFormat glCurrentFormat = this->format();
@@ -113,6 +126,7 @@ public:
      */
     virtual void resizeGL (void)
     {
+        makeStateCurrent();
         camera->setViewport(Eigen::Vector2f ((float)this->width(), (float)this->height()));
         camera->setPerspectiveMatrix(camera->getFovy(), (float)this->width()/(float)this->height(), 0.1f, 100.0f);
         light_trackball->setViewport(Eigen::Vector2f ((float)this->width(), (float)this->height()));
@@ -181,6 +195,73 @@ public:
 
 protected:
 
+    /**
+     * @brief Deletes the state tracker of the widget and the objects it owns, such as the frame uniforms.
+     * Called when the context is about to be destroyed and by the destructor.
+     */
+    void releaseGLState (void)
+    {
+        if (!gl_state)
+            return;
+        makeCurrent();
+        delete gl_state;
+        gl_state = NULL;
+        doneCurrent();
+    }
+
+    /**
+     * @brief Makes the state tracker of this widget current, see GLState.
+     * Qt binds its own framebuffer and state before calling paintGL and resizeGL, so the tracked state is also forgotten.
+     */
+    void makeStateCurrent (void)
+    {
+        if (!gl_state)
+            return;
+        gl_state->makeCurrent();
+        gl_state->invalidate();
+    }
+
+#if QT_VERSION >= 0x050400
+    /**
+     * @brief Paint event, makes the state tracker current before paintGL is called.
+     * @param event The paint event.
+     */
+    virtual void paintEvent (QPaintEvent * event)
+    {
+        makeStateCurrent();
+        QOpenGLWidget::paintEvent(event);
+    }
+
+    /**
+     * @brief Resize event, makes the state tracker current before resizeGL is called.
+     * @param event The resize event.
+     */
+    virtual void resizeEvent (QResizeEvent * event)
+    {
+        makeStateCurrent();
+        QOpenGLWidget::resizeEvent(event);
+    }
+#else
+    /**
+     * @brief Draws the widget, makes the state tracker current before paintGL is called.
+     */
+    virtual void glDraw (void)
+    {
+        makeStateCurrent();
+        QGLWidget::glDraw();
+    }
+
+    /**
+     * @brief Resize event, makes the state tracker current before resizeGL is called.
+     * @param event The resize event.
+     */
+    virtual void resizeEvent (QResizeEvent * event)
+    {
+        makeStateCurrent();
+        QGLWidget::resizeEvent(event);
+    }
+#endif
+
     /**
      * @brief Callback for key press event.
      * @param event The key event that triggered the callback.
@@ -26,6 +26,7 @@
 #include <qglobal.h>
 #if QT_VERSION >= 0x050400
 	#include <QOpenGLWidget>
+	#include <QOpenGLContext>
 #else
 	#include <GL/glew.h>
 	#include <QGLWidget>
@@ -34,12 +35,14 @@
 
 #include "objimporter.hpp"
 #include "plyimporter.hpp"
+#include "meshloader.hpp"
 
 #include <tucano.hpp>
 #include <utils/trackball.hpp>
 
 #include <QMouseEvent>
 #include <QFileDialog>
+#include <QTimer>
 
 
 namespace Tucano
@@ -69,6 +72,15 @@ protected:
     /// Trackball for manipulating the light position.
     Trackball* light_trackball;
 
+    /// Loads meshes in the background, see openMeshAsync.
+    MeshLoader mesh_loader;
+
+    /// Drives the background mesh uploads while a mesh is loading.
+    QTimer mesh_loader_timer;
+
+    /// Tracker of the OpenGL state of the widget context, created in initializeGL.
+    GLState* gl_state;
+
 public:
 
     /**
@@ -76,10 +88,13 @@ public:
      * @param parent Parent widget.
      */
 #if QT_VERSION >= 0x050400
-	explicit QtTrackballWidget(QWidget *parent) : QOpenGLWidget(parent), GLObject() {}
+	explicit QtTrackballWidget(QWidget *parent) : QOpenGLWidget(parent), GLObject(), gl_state(NULL)
 #else
-	explicit QtTrackballWidget(QWidget *parent) : QGLWidget(parent), GLObject() {}
+	explicit QtTrackballWidget(QWidget *parent) : QGLWidget(parent), GLObject(), gl_state(NULL)
 #endif
+	{
+		connect(&mesh_loader_timer, &QTimer::timeout, this, &QtTrackballWidget::pumpMeshLoader);
+	}
 
     /**
      * @brief Default destructor.
@@ -88,6 +103,7 @@ public:
 	{
 		delete camera;
 		delete light_trackball;
+		releaseGLState();
 	}
 
     /**
@@ -98,6 +114,14 @@ public:
         makeCurrent();
 
 		initGL();
+
+		// each widget has its own context, and so its own state tracker, released before the context is destroyed
+		if (!gl_state)
+			gl_state = new GLState();
+		gl_state->makeCurrent();
+#if QT_VERSION >= 0x050400
+		connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, &QtTrackballWidget::releaseGLState);
+#endif
 				
 #if QT_VERSION < 0x050400
         #ifdef TUCANODEBUG
@@ -112,6 +136,7 @@ public:
      */
     virtual void resizeGL (void)
     {
+        makeStateCurrent();
         camera->setViewport(Eigen::Vector2f ((float)this->width(), (float)this->height()));
         camera->setPerspectiveMatrix(camera->getFovy(), (float)this->width()/(float)this->height(), 0.1f, 100.0f);
         light_trackball->setViewport(Eigen::Vector2f ((float)this->width(), (float)this->height()));
@@ -176,8 +201,112 @@ public:
         mesh.normalizeModelMatrix();
     }
 
+    /**
+     * @brief Opens a mesh from file in the background.
+     *
+     * The file is decoded on a worker thread and uploaded in small slices between frames,
+     * the widget keeps rendering the current mesh until the new one is complete.
+     * @param filename Given mesh file.
+     */
+    virtual void openMeshAsync (string filename)
+    {
+        mesh_loader.load(&mesh, filename);
+        mesh_loader_timer.start(16);
+    }
+
 protected:
 
+    /**
+     * @brief Deletes the state tracker of the widget and the objects it owns, such as the frame uniforms.
+     * Called when the context is about to be destroyed and by the destructor.
+     */
+    void releaseGLState (void)
+    {
+        if (!gl_state)
+            return;
+        makeCurrent();
+        delete gl_state;
+        gl_state = NULL;
+        doneCurrent();
+    }
+
+    /**
+     * @brief Makes the state tracker of this widget current, see GLState.
+     * Qt binds its own framebuffer and state before calling paintGL and resizeGL, so the tracked state is also forgotten.
+     */
+    void makeStateCurrent (void)
+    {
+        if (!gl_state)
+            return;
+        gl_state->makeCurrent();
+        gl_state->invalidate();
+    }
+
+#if QT_VERSION >= 0x050400
+    /**
+     * @brief Paint event, makes the state tracker current before paintGL is called.
+     * @param event The paint event.
+     */
+    virtual void paintEvent (QPaintEvent * event)
+    {
+        makeStateCurrent();
+        QOpenGLWidget::paintEvent(event);
+    }
+
+    /**
+     * @brief Resize event, makes the state tracker current before resizeGL is called.
+     * @param event The resize event.
+     */
+    virtual void resizeEvent (QResizeEvent * event)
+    {
+        makeStateCurrent();
+        QOpenGLWidget::resizeEvent(event);
+    }
+#else
+    /**
+     * @brief Draws the widget, makes the state tracker current before paintGL is called.
+     */
+    virtual void glDraw (void)
+    {
+        makeStateCurrent();
+        QGLWidget::glDraw();
+    }
+
+    /**
+     * @brief Resize event, makes the state tracker current before resizeGL is called.
+     * @param event The resize event.
+     */
+    virtual void resizeEvent (QResizeEvent * event)
+    {
+        makeStateCurrent();
+        QGLWidget::resizeEvent(event);
+    }
+#endif
+
+    /**
+     * @brief Uploads a slice of the mesh being loaded in the background.
+     *
+     * Called by a timer while a load is pending, redraws once the new mesh is complete.
+     */
+    void pumpMeshLoader (void)
+    {
+        makeCurrent();
+        makeStateCurrent();
+        if (mesh_loader.pump() > 0)
+        {
+            mesh.normalizeModelMatrix();
+#if QT_VERSION >= 0x050400
+            update();
+#else
+            updateGL();
+#endif
+        }
+        if (!mesh_loader.busy())
+        {
+            mesh_loader_timer.stop();
+        }
+    }
+
     /**
      * @brief Callback for key press event.
      * @param event The key event that triggered the callback.
@@ -189,7 +318,7 @@ protected:
             QString filename = QFileDialog::getOpenFileName(this, tr("Open File"), "", tr("Mesh Files (*.obj *.ply)"));
             if (!filename.isEmpty())
             {
-                openMesh (filename.toStdString());
+                openMeshAsync (filename.toStdString());
             }
         }
         event->ignore();
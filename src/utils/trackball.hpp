@@ -554,9 +554,9 @@ public:
      */
     void bufferData (void)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, bufferIDs[1]);
+        glState().bindBuffer(GL_ARRAY_BUFFER, bufferIDs[1]);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glState().bindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     /**
@@ -565,10 +565,10 @@ public:
     void bindBuffers (void)
     {
         //VAO:
-        glBindVertexArray(bufferIDs[0]);
+        glState().bindVertexArray(bufferIDs[0]);
 
         //VBO:
-        glBindBuffer(GL_ARRAY_BUFFER,bufferIDs[1]);
+        glState().bindBuffer(GL_ARRAY_BUFFER, bufferIDs[1]);
         glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, NULL);
         glEnableVertexAttribArray(0);
     }
@@ -578,7 +578,7 @@ public:
      */
     void unbindBuffers (void)
     {
-        glBindBuffer(GL_ARRAY_BUFFER,0);
+        glState().bindBuffer(GL_ARRAY_BUFFER, 0);
         glDisableVertexAttribArray(0);
     }
 
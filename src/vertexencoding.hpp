@@ -0,0 +1,453 @@
+/**
+ * Tucano - A library for rapid prototying with Modern OpenGL and GLSL
+ * Copyright (C) 2014
+ * LCG - Laboratório de Computação Gráfica (Computer Graphics Lab) - COPPE
+ * UFRJ - Federal University of Rio de Janeiro
+ *
+ * This file is part of Tucano Library.
+ *
+ * Tucano Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Tucano Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tucano Library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __VERTEXENCODING__
+#define __VERTEXENCODING__
+
+#include "tucano.hpp"
+#include <Eigen/Dense>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+
+namespace Tucano
+{
+
+/// Stores positions with 3 floats instead of 4 (w is 1 in the shader).
+const unsigned int ENCODE_POSITION_XYZ = 1;
+
+/// Stores normals as signed normalized GL_INT_2_10_10_10_REV (4 bytes).
+const unsigned int ENCODE_NORMAL_2_10_10_10 = 2;
+
+/// Stores normals as two signed normalized 16 bit octahedral coordinates (4 bytes), decoded in the shader with octahedralDecode.
+const unsigned int ENCODE_NORMAL_OCTAHEDRAL = 4;
+
+/// Stores texture coordinates as half floats.
+const unsigned int ENCODE_TEXCOORD_HALF = 8;
+
+/// Stores colors as normalized GL_UNSIGNED_BYTE.
+const unsigned int ENCODE_COLOR_UNORM8 = 16;
+
+/// Encodings that need no shader changes.
+const unsigned int ENCODE_COMPACT = ENCODE_POSITION_XYZ | ENCODE_NORMAL_2_10_10_10 | ENCODE_TEXCOORD_HALF | ENCODE_COLOR_UNORM8;
+
+/**
+ * @brief GLSL function decoding octahedral normals, to be pasted in shaders using ENCODE_NORMAL_OCTAHEDRAL.
+ * The normal attribute must then be declared as "in vec2 in_Normal".
+ */
+const char OCTAHEDRAL_DECODE_GLSL[] =
+    "vec3 octahedralDecode (vec2 e)\n"
+    "{\n"
+    "    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));\n"
+    "    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);\n"
+    "    return normalize(n);\n"
+    "}\n";
+
+/**
+ * @brief Format of a vertex attribute in the buffer, as given to glVertexAttribPointer.
+ */
+struct VertexFormat
+{
+    /// Number of components.
+    int components;
+    /// Component type.
+    GLenum type;
+    /// True if integer values are normalized to [0,1] or [-1,1].
+    bool normalized;
+    /// Size of one attribute in bytes.
+    int bytes;
+};
+
+namespace Misc
+{
+
+/**
+ * @brief Converts a float to a half float, rounding to nearest even.
+ * @param value Float value.
+ * @return Half float bits.
+ */
+inline uint16_t floatToHalf (float value)
+{
+    uint32_t f;
+    memcpy(&f, &value, 4);
+    uint32_t sign = (f >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((f >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = f & 0x7FFFFF;
+
+    if (((f >> 23) & 0xFF) == 0xFF)
+        return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0)); // inf or nan
+    if (exponent >= 31)
+        return (uint16_t)(sign | 0x7C00); // overflow
+    if (exponent <= 0)
+    {
+        // subnormal or zero
+        if (exponent < -10)
+            return (uint16_t)sign;
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            ++half;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        ++half; // may carry into the exponent, which is the correct rounding
+    return (uint16_t)half;
+}
+
+/**
+ * @brief Converts a half float to a float.
+ * @param half Half float bits.
+ * @return Float value.
+ */
+inline float halfToFloat (uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t f;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            f = sign;
+        }
+        else
+        {
+            // normalize the subnormal
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400))
+            {
+                mantissa <<= 1;
+                --exponent;
+            }
+            f = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    }
+    else if (exponent == 31)
+    {
+        f = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &f, 4);
+    return value;
+}
+
+/**
+ * @brief Converts a value in [-1,1] to a signed normalized integer with the given number of bits.
+ */
+inline int32_t floatToSnorm (float value, int bits)
+{
+    float scale = (float)((1 << (bits-1)) - 1);
+    value = std::max(-1.0f, std::min(1.0f, value));
+    return (int32_t)std::floor(value * scale + 0.5f);
+}
+
+/**
+ * @brief Converts a signed normalized integer with the given number of bits to a value in [-1,1].
+ */
+inline float snormToFloat (int32_t value, int bits)
+{
+    float scale = (float)((1 << (bits-1)) - 1);
+    return std::max((float)value / scale, -1.0f);
+}
+
+/**
+ * @brief Packs a normal as GL_INT_2_10_10_10_REV (x in the low bits, w is zero).
+ * @param n Normal, components in [-1,1].
+ * @return Packed value.
+ */
+inline uint32_t packSnorm2_10_10_10 (const Eigen::Vector3f& n)
+{
+    uint32_t x = (uint32_t)floatToSnorm(n[0], 10) & 0x3FF;
+    uint32_t y = (uint32_t)floatToSnorm(n[1], 10) & 0x3FF;
+    uint32_t z = (uint32_t)floatToSnorm(n[2], 10) & 0x3FF;
+    return x | (y << 10) | (z << 20);
+}
+
+/**
+ * @brief Unpacks a normal stored as GL_INT_2_10_10_10_REV.
+ * @param packed Packed value.
+ * @return Normal.
+ */
+inline Eigen::Vector3f unpackSnorm2_10_10_10 (uint32_t packed)
+{
+    Eigen::Vector3f n;
+    for (int i = 0; i < 3; ++i)
+    {
+        int32_t v = (int32_t)((packed >> (10*i)) & 0x3FF);
+        if (v & 0x200)
+            v -= 0x400;
+        n[i] = snormToFloat(v, 10);
+    }
+    return n;
+}
+
+/**
+ * @brief Maps a unit vector to octahedral coordinates in [-1,1]^2.
+ * @param n Unit vector.
+ * @return Octahedral coordinates.
+ */
+inline Eigen::Vector2f octahedralEncode (const Eigen::Vector3f& n)
+{
+    float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    if (l1 == 0.0f)
+        return Eigen::Vector2f(0.0f, 0.0f);
+    Eigen::Vector2f e (n[0] / l1, n[1] / l1);
+    if (n[2] < 0.0f)
+    {
+        Eigen::Vector2f folded ((1.0f - std::fabs(e[1])) * (e[0] >= 0.0f ? 1.0f : -1.0f),
+                                (1.0f - std::fabs(e[0])) * (e[1] >= 0.0f ? 1.0f : -1.0f));
+        e = folded;
+    }
+    return e;
+}
+
+/**
+ * @brief Maps octahedral coordinates back to a unit vector (same as OCTAHEDRAL_DECODE_GLSL).
+ * @param e Octahedral coordinates.
+ * @return Unit vector.
+ */
+inline Eigen::Vector3f octahedralDecode (const Eigen::Vector2f& e)
+{
+    Eigen::Vector3f n (e[0], e[1], 1.0f - std::fabs(e[0]) - std::fabs(e[1]));
+    if (n[2] < 0.0f)
+    {
+        float x = (1.0f - std::fabs(n[1])) * (n[0] >= 0.0f ? 1.0f : -1.0f);
+        float y = (1.0f - std::fabs(n[0])) * (n[1] >= 0.0f ? 1.0f : -1.0f);
+        n[0] = x;
+        n[1] = y;
+    }
+    return n.normalized();
+}
+
+/**
+ * @brief Returns the buffer format of positions for a given encoding.
+ */
+inline VertexFormat positionFormat (unsigned int encoding)
+{
+    VertexFormat f = {4, GL_FLOAT, false, 16};
+    if (encoding & ENCODE_POSITION_XYZ)
+    {
+        f.components = 3;
+        f.bytes = 12;
+    }
+    return f;
+}
+
+/**
+ * @brief Returns the buffer format of normals for a given encoding.
+ */
+inline VertexFormat normalFormat (unsigned int encoding)
+{
+    VertexFormat f = {3, GL_FLOAT, false, 12};
+    if (encoding & ENCODE_NORMAL_OCTAHEDRAL)
+    {
+        VertexFormat oct = {2, GL_SHORT, true, 4};
+        f = oct;
+    }
+    else if (encoding & ENCODE_NORMAL_2_10_10_10)
+    {
+        VertexFormat packed = {4, GL_INT_2_10_10_10_REV, true, 4};
+        f = packed;
+    }
+    return f;
+}
+
+/**
+ * @brief Returns the buffer format of texture coordinates for a given encoding.
+ */
+inline VertexFormat texCoordFormat (unsigned int encoding)
+{
+    VertexFormat f = {2, GL_FLOAT, false, 8};
+    if (encoding & ENCODE_TEXCOORD_HALF)
+    {
+        f.type = GL_HALF_FLOAT;
+        f.bytes = 4;
+    }
+    return f;
+}
+
+/**
+ * @brief Returns the buffer format of colors for a given encoding.
+ */
+inline VertexFormat colorFormat (unsigned int encoding)
+{
+    VertexFormat f = {4, GL_FLOAT, false, 16};
+    if (encoding & ENCODE_COLOR_UNORM8)
+    {
+        f.type = GL_UNSIGNED_BYTE;
+        f.normalized = true;
+        f.bytes = 4;
+    }
+    return f;
+}
+
+/**
+ * @brief Writes one position in the format given by positionFormat.
+ */
+inline void encodePosition (const Eigen::Vector4f& v, unsigned int encoding, char* dst)
+{
+    memcpy(dst, v.data(), positionFormat(encoding).bytes);
+}
+
+/**
+ * @brief Writes one normal in the format given by normalFormat.
+ * Encoded normals are unit length, whatever the length of the input.
+ */
+inline void encodeNormal (const Eigen::Vector3f& n, unsigned int encoding, char* dst)
+{
+    if (encoding & ENCODE_NORMAL_OCTAHEDRAL)
+    {
+        Eigen::Vector2f e = octahedralEncode(n);
+        int16_t s[2] = {(int16_t)floatToSnorm(e[0], 16), (int16_t)floatToSnorm(e[1], 16)};
+        memcpy(dst, s, 4);
+    }
+    else if (encoding & ENCODE_NORMAL_2_10_10_10)
+    {
+        // normalized formats can't hold the length, keep the direction
+        float len = n.norm();
+        uint32_t packed = packSnorm2_10_10_10(len > 0.0 ? Eigen::Vector3f(n / len) : n);
+        memcpy(dst, &packed, 4);
+    }
+    else
+    {
+        memcpy(dst, n.data(), 12);
+    }
+}
+
+/**
+ * @brief Writes one texture coordinate in the format given by texCoordFormat.
+ */
+inline void encodeTexCoord (const Eigen::Vector2f& t, unsigned int encoding, char* dst)
+{
+    if (encoding & ENCODE_TEXCOORD_HALF)
+    {
+        uint16_t h[2] = {floatToHalf(t[0]), floatToHalf(t[1])};
+        memcpy(dst, h, 4);
+    }
+    else
+    {
+        memcpy(dst, t.data(), 8);
+    }
+}
+
+/**
+ * @brief Writes one color in the format given by colorFormat.
+ */
+inline void encodeColor (const Eigen::Vector4f& c, unsigned int encoding, char* dst)
+{
+    if (encoding & ENCODE_COLOR_UNORM8)
+    {
+        for (int i = 0; i < 4; ++i)
+            dst[i] = (char)(unsigned char)std::floor(std::max(0.0f, std::min(1.0f, c[i])) * 255.0f + 0.5f);
+    }
+    else
+    {
+        memcpy(dst, c.data(), 16);
+    }
+}
+
+/**
+ * @brief Encodes an array of attributes.
+ * @param attrib Attribute values.
+ * @param encoding Encoding flags.
+ * @param bytes Size in bytes of one encoded attribute.
+ * @param encode Function writing one encoded attribute.
+ * @param out Receives the encoded array.
+ */
+template <class T, class Encoder>
+void encodeArray (const std::vector<T>& attrib, unsigned int encoding, int bytes, Encoder encode, std::vector<char>& out)
+{
+    out.resize(attrib.size() * bytes);
+    for (size_t i = 0; i < attrib.size(); ++i)
+        encode(attrib[i], encoding, &out[i*bytes]);
+}
+
+/**
+ * @brief Decodes one attribute stored in any of the formats above into floats.
+ * @param format Format of the stored attribute.
+ * @param src Pointer to the stored attribute.
+ * @param out Receives format.components values (octahedral normals are decoded to 3 values).
+ * Two component GL_SHORT attributes are taken as octahedral normals.
+ * @return Number of values written.
+ */
+inline int decodeAttribute (const VertexFormat& format, const char* src, float* out)
+{
+    switch (format.type)
+    {
+        case GL_FLOAT:
+            memcpy(out, src, format.components*sizeof(float));
+            return format.components;
+        case GL_HALF_FLOAT:
+        {
+            for (int i = 0; i < format.components; ++i)
+            {
+                uint16_t h;
+                memcpy(&h, src + 2*i, 2);
+                out[i] = halfToFloat(h);
+            }
+            return format.components;
+        }
+        case GL_UNSIGNED_BYTE:
+        {
+            for (int i = 0; i < format.components; ++i)
+                out[i] = (unsigned char)src[i] / (format.normalized ? 255.0f : 1.0f);
+            return format.components;
+        }
+        case GL_SHORT:
+        {
+            int16_t s[2];
+            memcpy(s, src, 4);
+            Eigen::Vector3f n = octahedralDecode(Eigen::Vector2f(snormToFloat(s[0], 16), snormToFloat(s[1], 16)));
+            memcpy(out, n.data(), 12);
+            return 3;
+        }
+        case GL_INT_2_10_10_10_REV:
+        {
+            uint32_t packed;
+            memcpy(&packed, src, 4);
+            Eigen::Vector3f n = unpackSnorm2_10_10_10(packed);
+            memcpy(out, n.data(), 12);
+            return 3;
+        }
+        default:
+            return 0;
+    }
+}
+
+}
+}
+#endif